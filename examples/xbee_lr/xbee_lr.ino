@@ -157,15 +157,18 @@ void setup() {
         Serial.println("Failed to retrieve DevEUI");
     }
 
-    // Set LoRaWAN Network Settings
+    // Set LoRaWAN Network Settings, queued and applied in one batch
     Serial.println("Configuring...");
+    static XBeeConfigBatch config;
+    xbee->beginConfig(config);
     xbee->setLoRaWANAppEUI("37D56A3F6CDCF0A5");
     xbee->setLoRaWANAppKey("CD32AAB41C54175E9060D86F3A8B7F48");
     xbee->setLoRaWANNwkKey("CD32AAB41C54175E9060D86F3A8B7F48");
     xbee->setLoRaWANClass('C');
     xbee->setApiOptions(0x01);
-    xbee->writeConfig();
-    xbee->applyChanges();
+    if (!xbee->commitConfig(true, true)) {
+        Serial.println("Failed to configure XBee");
+    }
 
     // Connect to LoRaWAN network
     Serial.println("Connecting...");
@@ -184,6 +187,9 @@ void setup() {
 }
 
 void loop() {
+    // Let the library handle received frames (downlinks, TX status, join events)
+    xbee->process();
+
     // Check if 10 seconds have passed
     static uint32_t startTime = millis();
     if (millis() - startTime >= 10000) {
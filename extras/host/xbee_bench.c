@@ -0,0 +1,765 @@
+/**
+ * @file xbee_bench.c
+ * @brief Host benchmarks of the frame layer against the simulated XBee LR module.
+ *
+ * Measures frames/s parsed in pull and ring mode, with and without line noise, the bytes
+ * copied through `PortUartRead` per frame, AT transaction latency and TX pipeline
+ * throughput, the AT round trip before and after a baud rate switch, and a fragmented
+ * transfer against a simulated network that acknowledges fragments and raises the DR, and the
+ * cost of the binary trace, and the uplinks and airtime saved by coalescing small sensor records. Wall clock figures depend on the host; virtual figures (latencies,
+ * uplinks per virtual second) come from the simulator's clock and are reproducible.
+ *
+ * Usage: xbee_bench [frames]
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_sim.h"
+#include "xbee_lr.h"
+#include "xbee_lr_frag.h"
+#include "xbee_lr_coalesce.h"
+#include "xbee_lr_airtime.h"
+#include "xbee_3rf.h"
+#include "xbee_3rf_remote_at.h"
+#include "xbee_trace.h"
+#include "xbee_api_frames.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Payload size of the RX packets used by the parser benchmark
+#define BENCH_RX_PAYLOAD 40
+
+// Frames injected per burst, must fit in XBEE_SIM_OUTPUT_SIZE
+#define BENCH_RX_BURST 1024
+
+// Storage of the receive ring used in ring mode
+#define BENCH_RING_SIZE 4096
+
+// Port, size and uplink after which the network raises the DR (ADR) in the fragmentation benchmark
+#define BENCH_FRAG_PORT 20
+#define BENCH_FRAG_SIZE 4096
+#define BENCH_FRAG_ADR_UPLINK 20
+
+// Payload size and number of destination nodes of the XBee 3 RF benchmark
+#define BENCH_MESH_PAYLOAD 80
+#define BENCH_MESH_NODES 4
+
+// Number of nodes reconfigured by the remote AT benchmark
+#define BENCH_FLEET_NODES 200
+
+// Sensor records of the coalescing benchmark: count, size, interval, latency bound and DR
+#define BENCH_SENSOR_RECORDS 360
+#define BENCH_SENSOR_RECORD_SIZE 5
+#define BENCH_SENSOR_INTERVAL_MS 10000
+#define BENCH_SENSOR_LATENCY_MS 60000
+#define BENCH_SENSOR_DR 5
+
+static XBeeSim sim;
+static uint8_t ringStorage[BENCH_RING_SIZE];
+static XBeeRxRing ring;
+static uint32_t received;
+static uint32_t txCompleted;
+
+static void onReceive(XBee* self, void* data) {
+    (void)self;
+    (void)data;
+    received++;
+}
+
+static void onTxComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+    (void)self;
+    (void)frameId;
+    (void)status;
+    (void)report;
+    (void)ctx;
+    txCompleted++;
+}
+
+static const XBeeCTable benchCTable = {
+    .OnReceiveCallback = onReceive,
+    .OnConnectCallback = NULL,
+    .OnDisconnectCallback = NULL,
+    .OnSendCallback = NULL,
+};
+
+static double wallSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+// Wires a new instance to the simulator and clears the counters
+static XBee* benchStart(XBee* xbee) {
+    XBeeSetPortContext(xbee, &sim);
+    XBeeInit(xbee, sim.config.baudRate, NULL);
+    XBeeResetStats(xbee);
+    received = 0;
+    txCompleted = 0;
+    return xbee;
+}
+
+// Creates an XBee LR instance wired to a freshly initialized simulator
+static XBee* benchSetup(const XBeeSimConfig* config, const XBeeHTable* htable) {
+    XBeeSimInit(&sim, config);
+    XBeeLR *lr = XBeeLRCreate(&benchCTable, htable);
+    if (lr == NULL) {
+        fprintf(stderr, "XBeeLRCreate failed\n");
+        exit(1);
+    }
+    return benchStart(&lr->base);
+}
+
+// Creates an XBee 3 RF instance wired to a freshly initialized simulator
+static XBee* benchSetup3RF(const XBeeSimConfig* config) {
+    XBeeSimInit(&sim, config);
+    XBee3RF *rf = XBee3RFCreate(&benchCTable, &XBeeSimHTable);
+    if (rf == NULL) {
+        fprintf(stderr, "XBee3RFCreate failed\n");
+        exit(1);
+    }
+    return benchStart(&rf->base);
+}
+
+static void printLatency(const char* name, const XBeeLatencyStats* latency, uint16_t unitUs) {
+    if (latency->count == 0) {
+        printf("  %-22s no samples\n", name);
+        return;
+    }
+    printf("  %-22s avg %.1f us, min %lu us, max %lu us (%lu samples)\n", name,
+           (double)latency->total * unitUs / latency->count, (unsigned long)latency->min * unitUs,
+           (unsigned long)latency->max * unitUs, (unsigned long)latency->count);
+}
+
+// Records of the trace ring attached by the traced parse benchmark
+#define BENCH_TRACE_RECORDS 1024
+
+static XBeeTraceRecord traceRecords[BENCH_TRACE_RECORDS];
+static XBeeTrace trace;
+
+static void benchParse(uint32_t frames, bool useRing, uint8_t apiMode, uint32_t noisePerMillion, bool traced) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.baudRate = 115200;
+    XBee *xbee = benchSetup(&config, &XBeeSimHTable);
+    if ((apiMode != XBEE_API_MODE) && !XBeeSetAPIMode(xbee, apiMode)) {
+        fprintf(stderr, "XBeeSetAPIMode(%u) failed\n", apiMode);
+        exit(1);
+    }
+    // Noise starts after the mode switch
+    sim.config.noisePerMillion = noisePerMillion;
+    if (useRing) {
+        XBeeRxRingInit(&ring, ringStorage, sizeof(ringStorage));
+        XBeeAttachRxRing(xbee, &ring);
+    }
+    if (traced) {
+        XBeeTraceInit(&trace, traceRecords, BENCH_TRACE_RECORDS);
+        XBeeAttachTrace(xbee, &trace);
+    }
+
+    // One burst of explicit RX packets, injected over and over
+    static uint8_t burst[2 * BENCH_RX_BURST * (BENCH_RX_PAYLOAD + 14)];
+    uint32_t burstLength = 0;
+    for (uint32_t i = 0; i < BENCH_RX_BURST; i++) {
+        uint8_t data[9 + BENCH_RX_PAYLOAD] = {1, (uint8_t)-60, 8, 0x05, 0, 0, (uint8_t)(i >> 8), (uint8_t)i, 0};
+        for (int j = 0; j < BENCH_RX_PAYLOAD; j++) {
+            data[9 + j] = (uint8_t)(i + j);
+        }
+        uint8_t frame[sizeof(data) + 5];
+        uint32_t frameLength = XBeeSimEncodeFrame(frame, XBEE_API_TYPE_LR_EXPLICIT_RX_PACKET, data, sizeof(data));
+        if (apiMode == XBEE_API_MODE_ESCAPED) {
+            burstLength += XBeeSimEscapeFrame(&burst[burstLength], frame, frameLength);
+        } else {
+            memcpy(&burst[burstLength], frame, frameLength);
+            burstLength += frameLength;
+        }
+    }
+
+    uint32_t injected = 0;
+    double start = wallSeconds();
+    while (injected < frames) {
+        XBeeSimInject(&sim, burst, burstLength);
+        injected += BENCH_RX_BURST;
+        do {
+            XBeeProcess(xbee);
+        } while (XBeeSimPending(&sim) != 0);
+        // Let a frame cut short by noise time out before the next burst
+        XBeeSimAdvance(&sim, (UART_READ_TIMEOUT_MS + 1) * 1000UL);
+        XBeeProcess(xbee);
+    }
+    double elapsed = wallSeconds() - start;
+
+    XBeeStats stats;
+    XBeeGetStats(xbee, &stats);
+    printf("parse %s%s%s, noise %lu ppm: %lu frames in %.3f s, %.0f frames/s, %.1f MB/s\n",
+           useRing ? "ring" : "pull", (apiMode == XBEE_API_MODE_ESCAPED) ? " escaped" : "", traced ? " traced" : "", (unsigned long)noisePerMillion, (unsigned long)received, elapsed,
+           received / elapsed, (double)injected * (burstLength / BENCH_RX_BURST) / elapsed / 1e6);
+    printf("  bytes copied by PortUartRead per frame %.1f, reads per frame %.2f\n",
+           (double)sim.counters.bytesRead / injected, (double)sim.counters.readCalls / injected);
+    if (noisePerMillion != 0) {
+        printf("  corrupted bytes %lu, checksum errors %lu, resync bytes %lu, rx timeouts %lu, too large %lu, aborted %lu\n",
+               (unsigned long)sim.counters.corruptedBytes, (unsigned long)stats.checksumErrors,
+               (unsigned long)stats.delimiterResyncs, (unsigned long)stats.rxTimeouts,
+               (unsigned long)stats.framesTooLarge, (unsigned long)stats.framesAborted);
+    }
+    if (traced) {
+        XBeeTraceRecord last;
+        char line[96];
+        trace.tail = trace.head - 1;
+        XBeeTraceRead(&trace, &last, 1);
+        XBeeTraceFormat(&last, line, sizeof(line));
+        printf("  %lu trace records, last:%s\n", (unsigned long)trace.head, line);
+    }
+    XBeeLRDestroy((XBeeLR *)xbee);
+}
+
+// Host time and process() calls to recover from a burst of line garbage, e.g. a boot banner
+static void benchResync(uint32_t garbageBytes, bool useRing) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.baudRate = 115200;
+    XBee *xbee = benchSetup(&config, &XBeeSimHTable);
+    if (useRing) {
+        XBeeRxRingInit(&ring, ringStorage, sizeof(ringStorage));
+        XBeeAttachRxRing(xbee, &ring);
+    }
+
+    static uint8_t input[BENCH_RING_SIZE];
+    if (garbageBytes + 64 > sizeof(input)) {
+        garbageBytes = sizeof(input) - 64;
+    }
+    for (uint32_t i = 0; i < garbageBytes; i++) {
+        input[i] = (uint8_t)(0x20 + (i % 0x5E));  // Printable, never 0x7E
+    }
+    uint8_t data[9 + BENCH_RX_PAYLOAD] = {1, (uint8_t)-60, 8, 0x05, 0, 0, 0, 1, 0};
+    uint32_t length = garbageBytes + XBeeSimEncodeFrame(&input[garbageBytes], XBEE_API_TYPE_LR_EXPLICIT_RX_PACKET,
+                                                        data, sizeof(data));
+
+    const uint32_t rounds = 1000;
+    uint32_t calls = 0;
+    double start = wallSeconds();
+    for (uint32_t i = 0; i < rounds; i++) {
+        XBeeSimInject(&sim, input, length);
+        uint32_t target = received + 1;
+        while (received < target) {
+            XBeeProcess(xbee);
+            calls++;
+        }
+    }
+    double elapsed = wallSeconds() - start;
+    printf("resync %s: %lu garbage bytes skipped in %.2f us host time, %.1f process() calls\n",
+           useRing ? "ring" : "pull", (unsigned long)garbageBytes, elapsed * 1e6 / rounds, (double)calls / rounds);
+    XBeeLRDestroy((XBeeLR *)xbee);
+}
+
+static void benchAt(uint32_t transactions) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.baudRate = 115200;
+    XBee *xbee = benchSetup(&config, &XBeeSimHTable);
+
+    uint8_t response[8];
+    uint8_t responseLength = 0;
+    uint32_t failed = 0;
+    double start = wallSeconds();
+    for (uint32_t i = 0; i < transactions; i++) {
+        if (!XBeeGetParameter(xbee, AT_JS, response, sizeof(response), &responseLength)) {
+            failed++;
+        }
+    }
+    double elapsed = wallSeconds() - start;
+
+    XBeeStats stats;
+    XBeeGetStats(xbee, &stats);
+    printf("at: %lu transactions, %lu failed, %.2f us host time each\n", (unsigned long)transactions,
+           (unsigned long)failed, elapsed * 1e6 / transactions);
+    printLatency("round trip (virtual)", &stats.atLatency, stats.timeUnitUs);
+    XBeeLRDestroy((XBeeLR *)xbee);
+}
+
+static void benchTx(uint32_t uplinks) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.baudRate = 115200;
+    XBee *xbee = benchSetup(&config, &XBeeSimHTable);
+
+    uint8_t payload[BENCH_RX_PAYLOAD];
+    memset(payload, 0xA5, sizeof(payload));
+    XBeeLRPacket_t packet = {0};
+    packet.port = 2;
+    packet.payload = payload;
+    packet.payloadSize = sizeof(payload);
+
+    uint32_t sent = 0;
+    uint64_t virtualStart = sim.nowUs;
+    double start = wallSeconds();
+    while (txCompleted < uplinks) {
+        while ((sent < uplinks) && (XBeeTxPending(xbee) < XBEE_TX_TABLE_SIZE)) {
+            if (XBeeLRSendDataAsync(xbee, &packet, onTxComplete, NULL) == 0) {
+                break;
+            }
+            sent++;
+        }
+        XBeeProcess(xbee);
+        XBeeSimAdvance(&sim, 1000);
+    }
+    double elapsed = wallSeconds() - start;
+    double virtualSeconds = (double)(sim.nowUs - virtualStart) * 1e-6;
+
+    XBeeStats stats;
+    XBeeGetStats(xbee, &stats);
+    printf("tx: %lu uplinks, %lu timed out, %.1f uplinks per virtual s with %d outstanding, %.2f us host time each\n",
+           (unsigned long)uplinks, (unsigned long)stats.txTimeouts, uplinks / virtualSeconds, XBEE_TX_TABLE_SIZE,
+           elapsed * 1e6 / uplinks);
+    printf("  bytes written per uplink %.1f\n", (double)sim.counters.hostBytes / uplinks);
+    printLatency("request to status", &stats.txLatency, stats.timeUnitUs);
+    XBeeLRDestroy((XBeeLR *)xbee);
+}
+
+// Mean virtual AT round trip at the current baud rate
+static double benchAtRoundTrip(XBee* xbee, uint32_t transactions) {
+    uint8_t response[8];
+    XBeeStats stats;
+    XBeeResetStats(xbee);
+    for (uint32_t i = 0; i < transactions; i++) {
+        XBeeGetParameter(xbee, AT_JS, response, sizeof(response), NULL);
+    }
+    XBeeGetStats(xbee, &stats);
+    return stats.atLatency.count ? (double)stats.atLatency.total * stats.timeUnitUs / stats.atLatency.count : 0;
+}
+
+static void benchBaudRate(uint32_t baudRate) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.atResponseUs = 0;  // Wire time only
+    XBee *xbee = benchSetup(&config, &XBeeSimHTable);
+
+    double before = benchAtRoundTrip(xbee, 100);
+    uint32_t previous = xbee->baudRate;
+    bool switched = XBeeSetBaudRate(xbee, baudRate);
+    double after = benchAtRoundTrip(xbee, 100);
+    printf("baud: %lu -> %lu %s, AT round trip %.0f us -> %.0f us\n", (unsigned long)previous,
+           (unsigned long)baudRate, switched ? "ok" : "failed", before, after);
+    XBeeLRDestroy((XBeeLR *)xbee);
+}
+
+static void benchJoin(bool sleep) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.joinFailures = 1;
+    XBeeHTable htable = XBeeSimHTable;
+    if (!sleep) {
+        htable.PortWaitForRx = NULL;  // Poll with PortDelay(1)
+    }
+    XBee *xbee = benchSetup(&config, &htable);
+
+    XBeeLRJoinPolicy policy = {3, CONNECTION_TIMEOUT_MS, 1000, 4000};
+    XBeeLRSetJoinPolicy(xbee, &policy);
+    uint64_t virtualStart = sim.nowUs;
+    uint32_t wakeupsStart = sim.counters.wakeups;
+    bool joined = XBeeConnect(xbee);
+    printf("join %s: %s after %lu requests, %.3f virtual s, %lu wakeups\n", sleep ? "sleep" : "poll",
+           joined ? "joined" : "failed", (unsigned long)sim.counters.joinRequests,
+           (double)(sim.nowUs - virtualStart) * 1e-6, (unsigned long)(sim.counters.wakeups - wakeupsStart));
+
+    // One confirmed uplink
+    uint8_t payload[BENCH_RX_PAYLOAD] = {0};
+    XBeeLRPacket_t packet = {0};
+    packet.port = 2;
+    packet.payload = payload;
+    packet.payloadSize = sizeof(payload);
+    wakeupsStart = sim.counters.wakeups;
+    virtualStart = sim.nowUs;
+    uint8_t status = XBeeSendData(xbee, &packet);
+    printf("  send: status %u, %.3f virtual s, %lu wakeups\n", status, (double)(sim.nowUs - virtualStart) * 1e-6,
+           (unsigned long)(sim.counters.wakeups - wakeupsStart));
+    XBeeLRDestroy((XBeeLR *)xbee);
+}
+
+// Network side of the fragmentation benchmark: reassembles uplink fragments and acknowledges them
+static struct {
+    uint8_t data[BENCH_FRAG_SIZE];
+    bool seen[256];
+    uint8_t id;
+    uint8_t baseSeq;
+    uint16_t length;
+    uint32_t uplinks;
+    uint32_t lost;
+    uint8_t lossPercent;
+} benchNet;
+
+static void benchNetUplink(XBeeSim* simulator, uint8_t port, const uint8_t* payload, uint8_t length, void* ctx) {
+    (void)ctx;
+    if ((port != BENCH_FRAG_PORT) || (length < XBEE_LR_FRAG_HEADER_SIZE)) {
+        return;
+    }
+    if (++benchNet.uplinks == BENCH_FRAG_ADR_UPLINK) {
+        simulator->config.dataRate = 5;  // Reported in the TX status of this uplink
+    }
+    if ((uint32_t)(rand() % 100) < benchNet.lossPercent) {
+        benchNet.lost++;
+        return;
+    }
+
+    uint8_t id = payload[0] >> 4;
+    if (id != benchNet.id) {
+        benchNet.id = id;
+        benchNet.baseSeq = 0;
+        memset(benchNet.seen, 0, sizeof(benchNet.seen));
+    }
+    uint8_t seq = payload[1];
+    uint16_t offset = (uint16_t)((payload[2] << 8) | payload[3]);
+    uint8_t dataLength = (uint8_t)(length - XBEE_LR_FRAG_HEADER_SIZE);
+    if ((uint32_t)offset + dataLength <= sizeof(benchNet.data)) {
+        memcpy(&benchNet.data[offset], &payload[XBEE_LR_FRAG_HEADER_SIZE], dataLength);
+        benchNet.seen[seq] = true;
+        if (payload[0] & XBEE_LR_FRAG_FLAG_LAST) {
+            benchNet.length = (uint16_t)(offset + dataLength);
+        }
+    }
+    while (benchNet.seen[benchNet.baseSeq]) {
+        benchNet.baseSeq++;
+    }
+    if (payload[0] & XBEE_LR_FRAG_FLAG_ACK_REQUEST) {
+        uint8_t ack[XBEE_LR_FRAG_ACK_SIZE] = {(uint8_t)((id << 4) | XBEE_LR_FRAG_FLAG_ACK), benchNet.baseSeq, 0};
+        for (uint8_t i = 0; i < 8; i++) {
+            if (benchNet.seen[(uint8_t)(benchNet.baseSeq + 1 + i)]) {
+                ack[2] |= (uint8_t)(1U << i);
+            }
+        }
+        // RX1 opens before the module reports the TX status
+        XBeeSimSendDownlink(simulator, port, ack, sizeof(ack), simulator->config.txStatusMs * 500UL);
+    }
+}
+
+static bool fragDone;
+static bool fragSuccess;
+
+static void onFragSent(XBeeLRFrag* frag, bool success, void* ctx) {
+    (void)frag;
+    (void)ctx;
+    fragDone = true;
+    fragSuccess = success;
+}
+
+static void benchFrag(uint8_t lossPercent, bool dutyCycle) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.baudRate = 115200;
+    XBee *xbee = benchSetup(&config, &XBeeSimHTable);
+    memset(&benchNet, 0, sizeof(benchNet));
+    benchNet.id = 0xFF;
+    benchNet.lossPercent = lossPercent;
+    sim.onUplink = benchNetUplink;
+    srand(1);
+    if (!XBeeConnect(xbee)) {
+        fprintf(stderr, "XBeeConnect failed\n");
+        exit(1);
+    }
+
+    static uint8_t data[BENCH_FRAG_SIZE];
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    static XBeeLRScheduler sched;
+    static XBeeLRFrag frag;
+    // Without the 1% off-time the transfer is paced by the TX statuses and acknowledgements alone
+    XBeeLRSchedPolicy unlimited = {1, 1, {1}};
+    XBeeLRSchedInit(&sched, xbee, dutyCycle ? NULL : &unlimited);
+    XBeeLRFragInit(&frag, &sched, BENCH_FRAG_PORT, XBEE_LR_PRIORITY_BULK);
+    fragDone = false;
+    XBeeLRFragSend(&frag, data, sizeof(data), onFragSent, NULL);
+
+    uint64_t virtualStart = sim.nowUs;
+    uint32_t uplinksStart = sim.counters.txRequests;
+    while (!fragDone) {
+        XBeeProcess(xbee);
+        XBeeLRFragProcess(&frag);
+        XBeeLRSchedProcess(&sched);
+        uint32_t wait = XBeeLRFragNextDeadline(&frag);
+        uint32_t release = XBeeLRSchedNextDeadline(&sched);
+        XBeeWait(xbee, (release < wait) ? release : wait);
+    }
+    bool intact = (benchNet.length == sizeof(data)) && (memcmp(benchNet.data, data, sizeof(data)) == 0);
+    uint32_t uplinks = sim.counters.txRequests - uplinksStart;
+    printf("frag: %u bytes, %u%% loss: %s, %s, %lu uplinks (%lu lost), %.0f virtual s at %s duty cycle\n",
+           (unsigned)sizeof(data), lossPercent, fragSuccess ? "acknowledged" : "failed", intact ? "intact" : "corrupted",
+           (unsigned long)uplinks, (unsigned long)benchNet.lost,
+           (double)(sim.nowUs - virtualStart) * 1e-6, dutyCycle ? "1%" : "no");
+    XBeeLRFragDetach(&frag);
+    XBeeLRDestroy((XBeeLR *)xbee);
+}
+
+static void benchMesh(uint32_t frames, bool pipelined) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.baudRate = 115200;
+    config.txStatusMs = 4;     // Radio time of a frame and its ACK
+    config.discoveryMs = 40;
+    XBee *xbee = benchSetup3RF(&config);
+    XBee3RF *rf = (XBee3RF *)xbee;
+
+    uint8_t payload[BENCH_MESH_PAYLOAD];
+    memset(payload, 0x5A, sizeof(payload));
+    XBee3RFPacket_t packet = {0};
+    packet.address16 = XBEE_3RF_ADDRESS16_UNKNOWN;
+    packet.payload = payload;
+    packet.payloadSize = sizeof(payload);
+
+    uint32_t sent = 0;
+    uint32_t failed = 0;
+    uint64_t virtualStart = sim.nowUs;
+    double start = wallSeconds();
+    if (pipelined) {
+        while (txCompleted < frames) {
+            while ((sent < frames) && (XBeeTxPending(xbee) < XBEE_TX_TABLE_SIZE)) {
+                packet.address64 = 0x0013A20041000000ULL + (sent % BENCH_MESH_NODES);
+                if (XBee3RFSendDataAsync(xbee, &packet, onTxComplete, NULL) == 0) {
+                    break;
+                }
+                sent++;
+            }
+            XBeeProcess(xbee);
+            if (txCompleted < frames) {
+                XBeeWait(xbee, XBEE_WAIT_FOREVER);
+            }
+        }
+    } else {
+        for (; sent < frames; sent++) {
+            packet.address64 = 0x0013A20041000000ULL + (sent % BENCH_MESH_NODES);
+            if (XBeeSendData(xbee, &packet) != 0) {
+                failed++;
+            }
+        }
+    }
+    double elapsed = wallSeconds() - start;
+    double virtualSeconds = (double)(sim.nowUs - virtualStart) * 1e-6;
+
+    XBeeStats stats;
+    XBeeGetStats(xbee, &stats);
+    printf("mesh %s: %lu frames to %d nodes, %lu failed, %.1f frames per virtual s, %.2f us host time each\n",
+           pipelined ? "pipelined" : "stop-and-wait", (unsigned long)frames, BENCH_MESH_NODES,
+           (unsigned long)(failed + stats.txTimeouts), frames / virtualSeconds, elapsed * 1e6 / frames);
+    printf("  address discoveries %lu, cache hits %lu, misses %lu\n", (unsigned long)sim.counters.addressDiscoveries,
+           (unsigned long)rf->addressHits, (unsigned long)rf->addressMisses);
+    printLatency("request to status", &stats.txLatency, stats.timeUnitUs);
+    XBee3RFDestroy(rf);
+}
+
+static uint16_t fleetFailed;
+
+static void onFleetNode(XBee3RFRemoteAt* fanout, uint16_t target, int result, const xbee_at_request_t* response, void* ctx) {
+    (void)fanout; (void)target; (void)response; (void)ctx;
+    if (result != API_SEND_SUCCESS) {
+        fleetFailed++;
+    }
+}
+
+static void benchFleetWait(XBee* xbee, XBee3RFRemoteAt* fanout) {
+    while (XBee3RFRemoteAtBusy(fanout)) {
+        XBeeProcess(xbee);
+        XBee3RFRemoteAtProcess(fanout);
+        if (XBee3RFRemoteAtBusy(fanout)) {
+            XBeeWait(xbee, XBEE_WAIT_FOREVER);
+        }
+    }
+}
+
+// Sets a power level and saves it on every node of a fleet, one node at a time or XBEE_3RF_REMOTE_AT_IN_FLIGHT at once
+static void benchFleet(bool concurrent, uint8_t lossPercent) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.baudRate = 115200;
+    config.remoteAtMs = 150;   // Round trip through a few hops
+    config.discoveryMs = 40;
+    config.remoteLossPercent = lossPercent;
+    XBee *xbee = benchSetup3RF(&config);
+
+    static uint64_t targets[BENCH_FLEET_NODES];
+    for (uint16_t i = 0; i < BENCH_FLEET_NODES; i++) {
+        targets[i] = 0x0013A20042000000ULL + i;
+    }
+    static const uint8_t powerLevel = 2;
+    static const XBee3RFRemoteAtCommand commands[] = {
+        { AT_PL, &powerLevel, 1 },
+        { AT_WR, NULL, 0 },
+    };
+
+    XBee3RFRemoteAt fanout;
+    XBee3RFRemoteAtInit(&fanout, xbee);
+    fanout.timeoutMs = 1000;
+    fleetFailed = 0;
+    uint32_t retransmissions = 0;
+    uint64_t virtualStart = sim.nowUs;
+    if (concurrent) {
+        XBee3RFRemoteAtStart(&fanout, targets, BENCH_FLEET_NODES, commands, 2, true, onFleetNode, NULL);
+        benchFleetWait(xbee, &fanout);
+        retransmissions = fanout.retransmissions;
+    } else {
+        for (uint16_t i = 0; i < BENCH_FLEET_NODES; i++) {
+            XBee3RFRemoteAtStart(&fanout, &targets[i], 1, commands, 2, true, onFleetNode, NULL);
+            benchFleetWait(xbee, &fanout);
+            retransmissions += fanout.retransmissions;
+        }
+    }
+    double virtualSeconds = (double)(sim.nowUs - virtualStart) * 1e-6;
+
+    printf("remote AT %s, %u%% loss: %d nodes in %.1f virtual s, %u failed, %lu retransmissions\n",
+           concurrent ? "fan-out" : "one node at a time", lossPercent, BENCH_FLEET_NODES, virtualSeconds,
+           fleetFailed, (unsigned long)retransmissions);
+    XBee3RFDestroy((XBee3RF *)xbee);
+}
+
+static uint32_t sensorAirtimeMs;
+
+static void benchSensorUplink(XBeeSim* simulator, uint8_t port, const uint8_t* payload, uint8_t length, void* ctx) {
+    (void)simulator;
+    (void)port;
+    (void)payload;
+    (void)ctx;
+    sensorAirtimeMs += XBeeLRPayloadAirtimeMs(XBEE_LR_REGION_EU868, BENCH_SENSOR_DR, length);
+}
+
+// Periodic small sensor records, sent one uplink each or coalesced within their latency bound
+static void benchCoalesce(bool coalesce) {
+    XBeeSimConfig config;
+    XBeeSimDefaultConfig(&config);
+    config.baudRate = 115200;
+    config.dataRate = BENCH_SENSOR_DR;
+    XBee *xbee = benchSetup(&config, &XBeeSimHTable);
+    sim.onUplink = benchSensorUplink;
+    sensorAirtimeMs = 0;
+    if (!XBeeConnect(xbee) || !XBeeLRSetRegion(xbee, XBEE_LR_REGION_EU868) ||
+        !XBeeLRSetDataRate(xbee, BENCH_SENSOR_DR)) {
+        fprintf(stderr, "XBee setup failed\n");
+        exit(1);
+    }
+
+    static XBeeLRScheduler sched;
+    static XBeeLRCoalescer coalescer;
+    static uint8_t records[BENCH_SENSOR_RECORDS][BENCH_SENSOR_RECORD_SIZE];
+    XBeeLRSchedInit(&sched, xbee, NULL);
+    XBeeLRCoalesceInit(&coalescer, &sched, XBEE_LR_PRIORITY_TELEMETRY);
+
+    uint32_t produced = 0;
+    uint32_t refused = 0;
+    uint32_t uplinksStart = sim.counters.txRequests;
+    uint32_t nextRecord = xbee->htable->PortMillis(xbee->portContext);
+    while ((produced < BENCH_SENSOR_RECORDS) || (XBeeLRSchedPending(&sched) > 0) ||
+           (XBeeLRCoalescePending(&coalescer) > 0) || (XBeeTxPending(xbee) > 0)) {
+        uint32_t now = xbee->htable->PortMillis(xbee->portContext);
+        if ((produced < BENCH_SENSOR_RECORDS) && ((int32_t)(now - nextRecord) >= 0)) {
+            uint8_t* record = records[produced];
+            bool accepted;
+            if (coalesce) {
+                // Written in place into the uplink buffer
+                record = XBeeLRCoalesceReserve(&coalescer, 2, BENCH_SENSOR_RECORD_SIZE, BENCH_SENSOR_LATENCY_MS);
+                accepted = (record != NULL);
+            } else {
+                XBeeLRPacket_t packet = {0};
+                packet.port = 2;
+                packet.payload = record;
+                packet.payloadSize = BENCH_SENSOR_RECORD_SIZE;
+                accepted = XBeeLRSchedEnqueue(&sched, &packet, XBEE_LR_PRIORITY_TELEMETRY, NULL, NULL);
+            }
+            if (accepted) {
+                memset(record, (uint8_t)produced, BENCH_SENSOR_RECORD_SIZE);
+            } else {
+                refused++;
+            }
+            produced++;
+            nextRecord += BENCH_SENSOR_INTERVAL_MS;
+        }
+
+        XBeeProcess(xbee);
+        XBeeLRCoalesceProcess(&coalescer);
+        XBeeLRSchedProcess(&sched);
+        uint32_t wait = XBeeLRCoalesceNextDeadline(&coalescer);
+        uint32_t release = XBeeLRSchedNextDeadline(&sched);
+        if (release < wait) {
+            wait = release;
+        }
+        if (produced < BENCH_SENSOR_RECORDS) {
+            int32_t untilRecord = (int32_t)(nextRecord - xbee->htable->PortMillis(xbee->portContext));
+            uint32_t recordWait = (untilRecord > 0) ? (uint32_t)untilRecord : 0;
+            if (recordWait < wait) {
+                wait = recordWait;
+            }
+        }
+        XBeeWait(xbee, wait);
+    }
+    uint32_t uplinks = sim.counters.txRequests - uplinksStart;
+    printf("sensor %s: %u records of %u bytes, %lu uplinks, %lu ms airtime, %lu refused",
+           coalesce ? "coalesced" : "one per uplink", BENCH_SENSOR_RECORDS, BENCH_SENSOR_RECORD_SIZE,
+           (unsigned long)uplinks, (unsigned long)sensorAirtimeMs, (unsigned long)refused);
+    if (coalesce) {
+        printf(", %lu closed full, %lu at their deadline", (unsigned long)coalescer.fullFlushes,
+               (unsigned long)coalescer.deadlineFlushes);
+    }
+    printf("\n");
+    XBeeLRDestroy((XBeeLR *)xbee);
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = 200000;
+    if (argc > 1) {
+        frames = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (frames < BENCH_RX_BURST) {
+        frames = BENCH_RX_BURST;
+    }
+
+    benchParse(frames, false, XBEE_API_MODE, 0, false);
+    benchParse(frames, true, XBEE_API_MODE, 0, false);
+    benchParse(frames, false, XBEE_API_MODE, 200, false);
+    benchParse(frames, true, XBEE_API_MODE, 200, false);
+    benchParse(frames, false, XBEE_API_MODE_ESCAPED, 0, false);
+    benchParse(frames, true, XBEE_API_MODE_ESCAPED, 0, false);
+    benchParse(frames, false, XBEE_API_MODE_ESCAPED, 200, false);
+    benchParse(frames, true, XBEE_API_MODE_ESCAPED, 200, false);
+    benchParse(frames, false, XBEE_API_MODE, 0, true);
+    benchParse(frames, true, XBEE_API_MODE, 0, true);
+    benchResync(2048, false);
+    benchResync(2048, true);
+    benchAt(frames / 100);
+    benchTx(frames / 100);
+    benchBaudRate(921600);
+    benchJoin(false);
+    benchJoin(true);
+    benchFrag(0, true);
+    benchFrag(10, true);
+    benchFrag(0, false);
+    benchMesh(frames / 100, false);
+    benchMesh(frames / 100, true);
+    benchFleet(false, 0);
+    benchFleet(true, 0);
+    benchFleet(false, 5);
+    benchFleet(true, 5);
+    benchCoalesce(false);
+    benchCoalesce(true);
+    return 0;
+}
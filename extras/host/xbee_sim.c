@@ -0,0 +1,729 @@
+/**
+ * @file xbee_sim.c
+ * @brief Simulated XBee LR module for running the library on a desktop host.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_sim.h"
+#include "xbee_api_frames.h"
+#include "xbee_lr.h"
+#include "xbee_3rf.h"
+#include "port.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Fills a configuration with the timing of a typical XBee LR module.
+ *
+ * @param[out] config Configuration to fill.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeSimDefaultConfig(XBeeSimConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->baudRate = 9600;
+    config->atResponseUs = 2000;
+    config->joinMs = 5000;
+    config->joinFailures = 0;
+    config->txStatusMs = 1500;
+    config->discoveryMs = 100;
+    config->remoteAtMs = 200;
+    config->txStatus = 0;
+    config->dataRate = 0;
+    config->noisePerMillion = 0;
+    config->seed = 1;
+    config->apiMode = 1;
+}
+
+/**
+ * @brief Initializes a simulated module, with its virtual clock at 0.
+ *
+ * @param[out] sim Simulator to initialize.
+ * @param[in] config Timing and behaviour, NULL for `XBeeSimDefaultConfig()`.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeSimInit(XBeeSim* sim, const XBeeSimConfig* config) {
+    memset(sim, 0, sizeof(*sim));
+    if (config != NULL) {
+        sim->config = *config;
+    } else {
+        XBeeSimDefaultConfig(&sim->config);
+    }
+    sim->random = sim->config.seed ? sim->config.seed : 1;
+}
+
+// xorshift32, good enough to place noise and fully reproducible
+static uint32_t simRandom(XBeeSim* sim) {
+    uint32_t x = sim->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->random = x;
+    return x;
+}
+
+// Time the module needs to put `length` bytes on the wire, 10 bits per byte
+static uint32_t simWireUs(const XBeeSim* sim, uint32_t length) {
+    uint32_t baudRate = sim->config.baudRate ? sim->config.baudRate : 9600;
+    return (uint32_t)(((uint64_t)length * 10000000ULL) / baudRate);
+}
+
+static uint32_t simOutputFree(const XBeeSim* sim) {
+    return XBEE_SIM_OUTPUT_SIZE - (sim->outputHead - sim->outputTail);
+}
+
+// Appends bytes to the host side of the UART, applying line noise
+static bool simOutputPut(XBeeSim* sim, const uint8_t* bytes, uint32_t length) {
+    if (length > simOutputFree(sim)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        uint8_t byte = bytes[i];
+        if ((sim->config.noisePerMillion != 0) && ((simRandom(sim) % 1000000UL) < sim->config.noisePerMillion)) {
+            byte ^= (uint8_t)(1u << (simRandom(sim) & 7));
+            sim->counters.corruptedBytes++;
+        }
+        sim->output[sim->outputHead % XBEE_SIM_OUTPUT_SIZE] = byte;
+        sim->outputHead++;
+    }
+    return true;
+}
+
+// Delivers responses whose release time has passed, then feeds the attached ring like a DMA would
+static void simPump(XBeeSim* sim) {
+    while (1) {
+        XBeeSimEvent *next = NULL;
+        for (int i = 0; i < XBEE_SIM_EVENTS; i++) {
+            XBeeSimEvent *event = &sim->events[i];
+            if ((event->length != 0) && (event->releaseUs <= sim->nowUs) &&
+                ((next == NULL) || (event->releaseUs < next->releaseUs))) {
+                next = event;
+            }
+        }
+        if (next == NULL) {
+            break;
+        }
+        if ((sim->hostBaudRate != 0) && (next->baudRate != sim->hostBaudRate)) {
+            sim->counters.baudMismatches++;  // Garbage on the host side, not worth simulating byte by byte
+        } else if (!simOutputPut(sim, next->frame, next->length)) {
+            sim->counters.droppedFrames++;
+        }
+        next->length = 0;
+    }
+
+    XBeeRxRing *ring = sim->ring;
+    if (ring != NULL) {
+        while (sim->outputTail != sim->outputHead) {
+            uint16_t space = (uint16_t)(ring->mask + 1 - (uint16_t)(ring->head - ring->tail));
+            uint32_t offset = sim->outputTail % XBEE_SIM_OUTPUT_SIZE;
+            uint32_t count = sim->outputHead - sim->outputTail;
+            if (count > XBEE_SIM_OUTPUT_SIZE - offset) count = XBEE_SIM_OUTPUT_SIZE - offset;
+            if (count > space) count = space;
+            if (count == 0) {
+                break;
+            }
+            XBeeRxRingWrite(ring, &sim->output[offset], (uint16_t)count);
+            sim->outputTail += count;
+        }
+    }
+}
+
+/**
+ * @brief Advances the virtual clock.
+ *
+ * @param[in] sim Pointer to the simulator.
+ * @param[in] us Microseconds to advance by.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeSimAdvance(XBeeSim* sim, uint32_t us) {
+    sim->nowUs += us;
+    simPump(sim);
+}
+
+/**
+ * @brief Encodes an API frame: start delimiter, length, frame type, data and checksum.
+ *
+ * @param[out] buffer Destination, at least `length + 5` bytes.
+ * @param[in] frameType The frame type.
+ * @param[in] data Frame data following the frame type.
+ * @param[in] length Length of `data`.
+ *
+ * @return uint32_t Number of bytes written to `buffer`.
+ */
+uint32_t XBeeSimEncodeFrame(uint8_t* buffer, uint8_t frameType, const uint8_t* data, uint16_t length) {
+    uint8_t sum = frameType;
+    buffer[0] = 0x7E;
+    buffer[1] = (uint8_t)((length + 1) >> 8);
+    buffer[2] = (uint8_t)((length + 1) & 0xFF);
+    buffer[3] = frameType;
+    for (uint16_t i = 0; i < length; i++) {
+        buffer[4 + i] = data[i];
+        sum += data[i];
+    }
+    buffer[4 + length] = 0xFF - sum;
+    return (uint32_t)length + 5;
+}
+
+/**
+ * @brief Escapes an encoded frame for API mode 2.
+ *
+ * Every byte after the start delimiter that is 0x7E, 0x7D, 0x11 or 0x13 is replaced by
+ * 0x7D followed by the byte XOR 0x20.
+ *
+ * @param[out] output Escaped frame, at least twice the size of `frame`.
+ * @param[in] frame Frame encoded by `XBeeSimEncodeFrame()`.
+ * @param[in] length Length of `frame`.
+ *
+ * @return uint32_t Number of bytes written to `output`.
+ */
+uint32_t XBeeSimEscapeFrame(uint8_t* output, const uint8_t* frame, uint32_t length) {
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        uint8_t byte = frame[i];
+        if ((i != 0) && ((byte == 0x7E) || (byte == 0x7D) || (byte == 0x11) || (byte == 0x13))) {
+            output[written++] = 0x7D;
+            byte ^= 0x20;
+        }
+        output[written++] = byte;
+    }
+    return written;
+}
+
+/**
+ * @brief Schedules a frame from the module to the host.
+ *
+ * The frame becomes readable `delayUs` plus its time on the wire after the current
+ * virtual time.
+ *
+ * @param[in] sim Pointer to the simulator.
+ * @param[in] frameType The frame type.
+ * @param[in] data Frame data following the frame type.
+ * @param[in] length Length of `data`.
+ * @param[in] delayUs Time until the module starts sending the frame.
+ *
+ * @return bool Returns true if the frame was scheduled, false if it is too large or the event list is full.
+ */
+bool XBeeSimSendFrame(XBeeSim* sim, uint8_t frameType, const uint8_t* data, uint16_t length, uint32_t delayUs) {
+    if (length + 1 > XBEE_SIM_FRAME_SIZE) {
+        return false;
+    }
+    for (int i = 0; i < XBEE_SIM_EVENTS; i++) {
+        XBeeSimEvent *event = &sim->events[i];
+        if (event->length == 0) {
+            event->length = (uint16_t)XBeeSimEncodeFrame(event->frame, frameType, data, length);
+            if (sim->config.apiMode == 2) {
+                uint8_t plain[XBEE_SIM_FRAME_SIZE + 4];
+                memcpy(plain, event->frame, event->length);
+                event->length = (uint16_t)XBeeSimEscapeFrame(event->frame, plain, event->length);
+            }
+            event->releaseUs = sim->nowUs + delayUs + simWireUs(sim, event->length);
+            event->baudRate = sim->config.baudRate;
+            sim->counters.moduleFrames++;
+            simPump(sim);
+            return true;
+        }
+    }
+    sim->counters.droppedFrames++;
+    return false;
+}
+
+/**
+ * @brief Schedules a downlink, delivered to the host as an explicit RX packet.
+ *
+ * @param[in] sim Pointer to the simulator.
+ * @param[in] port LoRaWAN port of the downlink.
+ * @param[in] payload Payload of the downlink.
+ * @param[in] length Length of `payload`.
+ * @param[in] delayUs Time until the module starts sending the frame, e.g. the RX1 delay.
+ *
+ * @return bool Returns true if the frame was scheduled.
+ */
+bool XBeeSimSendDownlink(XBeeSim* sim, uint8_t port, const uint8_t* payload, uint8_t length, uint32_t delayUs) {
+    uint8_t data[9 + 255] = {port, (uint8_t)-80, 6, sim->config.dataRate, 0, 0, 0, 0, 0};
+    memcpy(&data[9], payload, length);
+    return XBeeSimSendFrame(sim, XBEE_API_TYPE_LR_EXPLICIT_RX_PACKET, data, (uint16_t)(9 + length), delayUs);
+}
+
+/**
+ * @brief Makes raw bytes readable by the host immediately, e.g. a burst of encoded frames.
+ *
+ * Noise is applied like to any other byte the module sends.
+ *
+ * @param[in] sim Pointer to the simulator.
+ * @param[in] bytes Bytes to deliver.
+ * @param[in] length Number of bytes.
+ *
+ * @return uint32_t Number of bytes accepted, 0 if they do not fit in the output buffer.
+ */
+uint32_t XBeeSimInject(XBeeSim* sim, const uint8_t* bytes, uint32_t length) {
+    if (!simOutputPut(sim, bytes, length)) {
+        return 0;
+    }
+    simPump(sim);
+    return length;
+}
+
+/**
+ * @brief Returns the number of bytes the host has not read yet.
+ *
+ * In ring mode this only counts bytes that did not fit into the ring.
+ *
+ * @param[in] sim Pointer to the simulator.
+ *
+ * @return uint32_t Bytes waiting for the host, excluding responses not yet released.
+ */
+uint32_t XBeeSimPending(const XBeeSim* sim) {
+    return sim->outputHead - sim->outputTail;
+}
+
+/* Scripted module */
+
+static void simStoreParam(XBeeSim* sim, uint16_t command, const uint8_t* value, uint8_t length) {
+    if (length > sizeof(sim->params[0].value)) {
+        length = sizeof(sim->params[0].value);
+    }
+    for (uint8_t i = 0; i < sim->paramCount; i++) {
+        if (sim->params[i].command == command) {
+            memcpy(sim->params[i].value, value, length);
+            sim->params[i].length = length;
+            return;
+        }
+    }
+    if (sim->paramCount < XBEE_SIM_PARAMS) {
+        sim->params[sim->paramCount].command = command;
+        memcpy(sim->params[sim->paramCount].value, value, length);
+        sim->params[sim->paramCount].length = length;
+        sim->paramCount++;
+    }
+}
+
+// Standard rates, indexed by their BD parameter code
+static const uint32_t simBaudRates[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
+
+// Value returned for a query, either the last one written by the host or a fixed default
+static uint8_t simQueryParam(XBeeSim* sim, uint16_t command, uint8_t* value) {
+    for (uint8_t i = 0; i < sim->paramCount; i++) {
+        if (sim->params[i].command == command) {
+            memcpy(value, sim->params[i].value, sim->params[i].length);
+            return sim->params[i].length;
+        }
+    }
+    switch (command) {
+        case XBEE_AT_CODE('D', 'E'): {
+            static const uint8_t devEui[8] = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x5A, 0x5A, 0x01};
+            memcpy(value, devEui, sizeof(devEui));
+            return sizeof(devEui);
+        }
+        case XBEE_AT_CODE('V', 'R'):
+            value[0] = 0x10;
+            value[1] = 0x0B;
+            return 2;
+        case XBEE_AT_CODE('B', 'D'): {
+            uint32_t code = sim->config.baudRate;
+            for (uint8_t i = 0; i < sizeof(simBaudRates) / sizeof(simBaudRates[0]); i++) {
+                if (simBaudRates[i] == sim->config.baudRate) code = i;
+            }
+            value[0] = (uint8_t)(code >> 24);
+            value[1] = (uint8_t)(code >> 16);
+            value[2] = (uint8_t)(code >> 8);
+            value[3] = (uint8_t)code;
+            return 4;
+        }
+        case XBEE_AT_CODE('J', 'S'):
+            value[0] = (sim->joinRequestsSeen > sim->config.joinFailures) ? 1 : 0;
+            return 1;
+        case XBEE_AT_CODE('L', 'V'): {
+            static const char version[] = "1.0.3";
+            memcpy(value, version, sizeof(version) - 1);
+            return sizeof(version) - 1;
+        }
+        case XBEE_AT_CODE('A', 'C'):
+        case XBEE_AT_CODE('W', 'R'):
+        case XBEE_AT_CODE('R', 'E'):
+        case XBEE_AT_CODE('N', 'R'):
+        case XBEE_AT_CODE('F', 'R'):
+            return 0;
+        default:
+            value[0] = 0;
+            return 1;
+    }
+}
+
+static void simHandleAtCommand(XBeeSim* sim, const uint8_t* data, uint16_t length) {
+    if (length < 4) {
+        return;
+    }
+    uint16_t command = XBEE_AT_CODE(data[2], data[3]);
+    uint8_t response[3 + 1 + 32];
+    uint8_t valueLength = 0;
+
+    sim->counters.atCommands++;
+    if ((command == XBEE_AT_CODE('B', 'D')) && (length > 4)) {
+        // BD is applied by AC, it is not stored like other parameters
+        uint32_t code = 0;
+        for (uint16_t i = 4; i < length; i++) {
+            code = (code << 8) | data[i];
+        }
+        sim->pendingBaudRate = (code < sizeof(simBaudRates) / sizeof(simBaudRates[0])) ? simBaudRates[code] : code;
+    } else if (length > 4) {
+        if (command == XBEE_AT_CODE('A', 'P')) {
+            sim->pendingApiMode = data[length - 1];
+        }
+        simStoreParam(sim, command, &data[4], (uint8_t)(length - 4));
+    } else {
+        valueLength = simQueryParam(sim, command, &response[4]);
+    }
+    if ((command == XBEE_AT_CODE('A', 'C')) && (sim->pendingApiMode != 0)) {
+        // Unlike the baud rate, the new framing already applies to the AC response
+        sim->config.apiMode = sim->pendingApiMode;
+        sim->pendingApiMode = 0;
+    }
+    if (data[1] == 0) {
+        return; // Frame ID 0 asks for no response
+    }
+
+    response[0] = data[1];
+    response[1] = data[2];
+    response[2] = data[3];
+    response[3] = 0; // Status OK
+    XBeeSimSendFrame(sim, XBEE_API_TYPE_AT_RESPONSE, response, 4 + valueLength, sim->config.atResponseUs);
+
+    if ((command == XBEE_AT_CODE('A', 'C')) && (sim->pendingBaudRate != 0)) {
+        // The AC response still goes out at the old rate
+        sim->config.baudRate = sim->pendingBaudRate;
+        sim->pendingBaudRate = 0;
+    }
+}
+
+static void simHandleJoinRequest(XBeeSim* sim) {
+    sim->counters.joinRequests++;
+    sim->joinRequestsSeen++;
+    // A failed attempt is reported as disassociated once the join accept windows have passed
+    uint8_t status = (sim->joinRequestsSeen > sim->config.joinFailures) ? 
+        XBEE_LR_MODEM_STATUS_JOINED : XBEE_LR_MODEM_STATUS_DISASSOCIATED;
+    XBeeSimSendFrame(sim, XBEE_API_TYPE_MODEM_STATUS, &status, 1, sim->config.joinMs * 1000UL);
+}
+
+static void simHandleTxRequest(XBeeSim* sim, const uint8_t* data, uint16_t length) {
+    if (length < 4) {
+        return;
+    }
+    sim->counters.txRequests++;
+    sim->uplinkCounter++;
+    if (sim->onUplink != NULL) {
+        sim->onUplink(sim, data[2], &data[4], (uint8_t)(length - 4), sim->uplinkContext);
+    }
+    if (data[1] == 0) {
+        return;
+    }
+
+    uint32_t counter = sim->uplinkCounter;
+    uint8_t status[9] = {
+        data[1], sim->config.txStatus, sim->config.dataRate, (uint8_t)(counter % 8), 14,
+        (uint8_t)(counter >> 24), (uint8_t)(counter >> 16), (uint8_t)(counter >> 8), (uint8_t)counter,
+    };
+    XBeeSimSendFrame(sim, XBEE_API_TYPE_LR_EXPLICIT_TX_STATUS, status, sizeof(status), sim->config.txStatusMs * 1000UL);
+}
+
+// 16-bit network address the simulated network has given a 64-bit address
+static uint16_t simAddress16(uint64_t address64) {
+    if (address64 == XBEE_3RF_BROADCAST_ADDRESS) {
+        return XBEE_3RF_ADDRESS16_UNKNOWN;
+    }
+    if (address64 == XBEE_3RF_COORDINATOR_ADDRESS) {
+        return 0x0000;
+    }
+    return (uint16_t)(0x1000 | (address64 & 0x0FFF));
+}
+
+// XBee 3 RF TX request: the radio sends queued requests one after another
+static void simHandle3RFTxRequest(XBeeSim* sim, const uint8_t* data, uint16_t length) {
+    if (length < 14) {
+        return;
+    }
+    sim->counters.txRequests++;
+
+    uint64_t address64 = 0;
+    for (int i = 0; i < 8; i++) {
+        address64 = (address64 << 8) | data[2 + i];
+    }
+    uint16_t requested16 = (uint16_t)(data[10] << 8 | data[11]);
+    uint16_t address16 = simAddress16(address64);
+    bool discover = (address16 != XBEE_3RF_ADDRESS16_UNKNOWN) && (address16 != 0x0000) && (requested16 != address16);
+
+    // The request reaches the module after the requests before it and its own time on the wire, then waits for the radio
+    uint64_t startUs = (sim->inputFreeUs > sim->nowUs) ? sim->inputFreeUs : sim->nowUs;
+    startUs += simWireUs(sim, (uint32_t)length + 4);
+    sim->inputFreeUs = startUs;
+    if (startUs < sim->radioFreeUs) {
+        startUs = sim->radioFreeUs;
+    }
+    sim->radioFreeUs = startUs + sim->config.txStatusMs * 1000UL;
+    if (discover) {
+        sim->counters.addressDiscoveries++;
+        sim->radioFreeUs += sim->config.discoveryMs * 1000UL;
+    }
+    if (data[1] == 0) {
+        return;
+    }
+
+    uint8_t status[6] = {
+        data[1], (uint8_t)(address16 >> 8), (uint8_t)address16, 0, sim->config.txStatus, discover ? 0x01 : 0x00,
+    };
+    XBeeSimSendFrame(sim, XBEE_API_TYPE_3RF_EXTENDED_TX_STATUS, status, sizeof(status), (uint32_t)(sim->radioFreeUs - sim->nowUs));
+}
+
+// Remote AT command: answered by the addressed node after a round trip through the mesh
+static void simHandleRemoteAtCommand(XBeeSim* sim, const uint8_t* data, uint16_t length) {
+    if (length < 15) {
+        return;
+    }
+    sim->counters.remoteAtCommands++;
+
+    uint64_t address64 = 0;
+    for (int i = 0; i < 8; i++) {
+        address64 = (address64 << 8) | data[2 + i];
+    }
+    uint16_t requested16 = (uint16_t)(data[10] << 8 | data[11]);
+    uint16_t address16 = simAddress16(address64);
+
+    // Requests share the UART into the module, their round trips through the mesh overlap
+    uint64_t startUs = (sim->inputFreeUs > sim->nowUs) ? sim->inputFreeUs : sim->nowUs;
+    startUs += simWireUs(sim, (uint32_t)length + 4);
+    sim->inputFreeUs = startUs;
+    uint64_t responseUs = startUs + sim->config.remoteAtMs * 1000UL;
+    if ((address16 != 0x0000) && (requested16 != address16)) {
+        sim->counters.addressDiscoveries++;
+        responseUs += sim->config.discoveryMs * 1000UL;
+    }
+    if ((sim->config.remoteLossPercent != 0) && ((simRandom(sim) % 100) < sim->config.remoteLossPercent)) {
+        sim->counters.remoteAtLost++;
+        return;
+    }
+    if (data[1] == 0) {
+        return;
+    }
+
+    uint8_t response[14] = { data[1] };
+    for (int i = 0; i < 8; i++) {
+        response[1 + i] = data[2 + i];
+    }
+    response[9] = (uint8_t)(address16 >> 8);
+    response[10] = (uint8_t)address16;
+    response[11] = data[13];
+    response[12] = data[14];
+    response[13] = 0;
+    XBeeSimSendFrame(sim, XBEE_API_TYPE_REMOTE_AT_RESPONSE, response, sizeof(response), (uint32_t)(responseUs - sim->nowUs));
+}
+
+// `data` starts with the frame type
+static void simHandleFrame(XBeeSim* sim, const uint8_t* data, uint16_t length) {
+    sim->counters.hostFrames++;
+    switch (data[0]) {
+        case XBEE_API_TYPE_AT_COMMAND:
+        case XBEE_API_TYPE_AT_COMMAND_QUEUE:
+            simHandleAtCommand(sim, data, length);
+            break;
+        case XBEE_API_TYPE_LR_JOIN_REQUEST:
+            simHandleJoinRequest(sim);
+            break;
+        case XBEE_API_TYPE_LR_TX_REQUEST:
+            simHandleTxRequest(sim, data, length);
+            break;
+        case XBEE_API_TYPE_TX_REQUEST:
+            simHandle3RFTxRequest(sim, data, length);
+            break;
+        case XBEE_API_TYPE_REMOTE_AT_COMMAND:
+            simHandleRemoteAtCommand(sim, data, length);
+            break;
+        default:
+            break;
+    }
+}
+
+// Parses the bytes written by the host, one at a time
+static void simModuleByte(XBeeSim* sim, uint8_t byte) {
+    if (sim->config.apiMode == 2) {
+        if (byte == 0x7E) {
+            // A delimiter always starts a new frame in escaped mode
+            sim->inputLength = 0;
+            sim->inputEscape = false;
+        } else if (byte == 0x7D) {
+            sim->inputEscape = true;
+            return;
+        } else if (sim->inputEscape) {
+            byte ^= 0x20;
+            sim->inputEscape = false;
+        }
+    }
+    if ((sim->inputLength == 0) && (byte != 0x7E)) {
+        return;
+    }
+    sim->input[sim->inputLength++] = byte;
+    if (sim->inputLength < 3) {
+        return;
+    }
+
+    uint16_t length = ((uint16_t)sim->input[1] << 8) | sim->input[2];
+    if ((length == 0) || (length > XBEE_SIM_FRAME_SIZE)) {
+        sim->inputLength = 0;
+        return;
+    }
+    if (sim->inputLength < length + 4) {
+        return;
+    }
+
+    uint8_t sum = 0;
+    for (uint16_t i = 0; i <= length; i++) {
+        sum += sim->input[3 + i];
+    }
+    sim->inputLength = 0;
+    if (sum != 0xFF) {
+        sim->counters.hostChecksumErrors++;
+        return;
+    }
+    simHandleFrame(sim, &sim->input[3], length);
+}
+
+/* XBeeHTable */
+
+static int simUartRead(void *ctx, uint8_t *buffer, int length) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    simPump(sim);
+    sim->counters.readCalls++;
+
+    uint32_t count = sim->outputHead - sim->outputTail;
+    if (count > (uint32_t)length) count = (uint32_t)length;
+    for (uint32_t i = 0; i < count; i++) {
+        buffer[i] = sim->output[(sim->outputTail + i) % XBEE_SIM_OUTPUT_SIZE];
+    }
+    sim->outputTail += count;
+    sim->counters.bytesRead += count;
+    return (int)count;
+}
+
+static int simUartWrite(void *ctx, const uint8_t *buf, uint16_t len) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    sim->counters.hostBytes += len;
+    if ((sim->hostBaudRate != 0) && (sim->hostBaudRate != sim->config.baudRate)) {
+        // The module cannot make sense of bytes sent at the wrong rate
+        sim->counters.baudMismatches++;
+        sim->inputLength = 0;
+        sim->inputEscape = false;
+        return len;
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        simModuleByte(sim, buf[i]);
+    }
+    return len;
+}
+
+static uint32_t simMillis(void *ctx) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    simPump(sim);
+    return (uint32_t)(sim->nowUs / 1000);
+}
+
+static uint32_t simMicros(void *ctx) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    simPump(sim);
+    return (uint32_t)sim->nowUs;
+}
+
+static void simFlushRx(void *ctx) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    sim->outputTail = sim->outputHead;
+}
+
+static int simUartInit(void *ctx, uint32_t baudrate, void *device) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    (void)device;
+    if (sim == NULL) {
+        return -1;
+    }
+    sim->hostBaudRate = baudrate;
+    return 0;
+}
+
+static void simDelay(void *ctx, uint32_t ms) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    XBeeSimAdvance(sim, ms * 1000UL);
+    sim->counters.wakeups++;
+}
+
+static void simWaitForRx(void *ctx, uint32_t timeoutMs) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    simPump(sim);
+    if (sim->outputHead == sim->outputTail) {
+        uint64_t wakeUs = sim->nowUs + (uint64_t)timeoutMs * 1000;
+        for (int i = 0; i < XBEE_SIM_EVENTS; i++) {
+            if ((sim->events[i].length != 0) && (sim->events[i].releaseUs < wakeUs)) {
+                wakeUs = sim->events[i].releaseUs;
+            }
+        }
+        if (wakeUs > sim->nowUs) {
+            XBeeSimAdvance(sim, (uint32_t)(wakeUs - sim->nowUs));
+        }
+    }
+    sim->counters.wakeups++;
+}
+
+static int simUartAttachRing(void *ctx, XBeeRxRing *ring) {
+    XBeeSim *sim = (XBeeSim *)ctx;
+    sim->ring = ring;
+    simPump(sim);
+    return 0;
+}
+
+const XBeeHTable XBeeSimHTable = {
+    .PortUartRead = simUartRead,
+    .PortUartWrite = simUartWrite,
+    .PortMillis = simMillis,
+    .PortFlushRx = simFlushRx,
+    .PortUartInit = simUartInit,
+    .PortDelay = simDelay,
+    .PortUartAttachRing = simUartAttachRing,
+    .PortUartTxSpace = NULL,
+    .PortMicros = simMicros,
+    .PortWaitForRx = simWaitForRx,
+};
+
+/**
+ * @brief Host implementation of the library's debug output.
+ *
+ * @param format The format string (same as printf).
+ * @param ... The values to print.
+ */
+void portDebugPrintf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
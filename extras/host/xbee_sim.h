@@ -0,0 +1,178 @@
+/**
+ * @file xbee_sim.h
+ * @brief Simulated XBee LR module for running the library on a desktop host.
+ *
+ * The simulator implements an `XBeeHTable` on top of a virtual clock. Frames written by
+ * the library are parsed by a scripted module that answers AT commands, join requests and
+ * TX requests after configurable delays, and the answers become readable once the virtual
+ * clock has passed their release time plus their time on the wire. Line noise can be
+ * injected into the bytes the module sends. Only `PortDelay()` and `PortWaitForRx()`, which
+ * jumps straight to the next response or the timeout, advance the clock, so runs
+ * are deterministic and independent of the speed of the host. XBee 3 RF TX requests
+ * (0x10) are answered too, with an extended TX status once the radio has sent them.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#ifndef XBEE_SIM_H
+#define XBEE_SIM_H
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#include "xbee.h"
+
+// Bytes the module can hold for the host, delivered or waiting for their release time
+#define XBEE_SIM_OUTPUT_SIZE 65536
+
+// Module responses that can wait for their release time at once
+#define XBEE_SIM_EVENTS 16
+
+// Largest frame the module parses or sends
+#define XBEE_SIM_FRAME_SIZE 300
+
+// Parameters the module remembers from AT commands with a value
+#define XBEE_SIM_PARAMS 32
+
+/**
+ * @typedef XBeeSimConfig
+ * @brief Timing and behaviour of the simulated module.
+ */
+typedef struct {
+    uint32_t baudRate;            ///< Module UART baud rate, sets the time each response spends on the wire
+    uint32_t atResponseUs;        ///< Time the module takes to answer an AT command
+    uint32_t joinMs;              ///< Time from a join request to the joined modem status
+    uint8_t joinFailures;         ///< Join requests answered with a disassociated modem status before one succeeds
+    uint32_t txStatusMs;          ///< Time from a TX request to its explicit TX status, for 0x10 requests the time the radio is busy with each one
+    uint32_t discoveryMs;         ///< Extra radio time of a 0x10 request whose 16-bit address the module has to discover
+    uint32_t remoteAtMs;          ///< Round trip from a remote AT command (0x17) reaching the module to its 0x97 response
+    uint8_t remoteLossPercent;    ///< Probability that a remote AT command or its response is lost in the mesh
+    uint8_t txStatus;             ///< Delivery status reported for every TX request
+    uint8_t dataRate;             ///< DR reported in the explicit TX status
+    uint32_t noisePerMillion;     ///< Probability that a byte sent to the host is corrupted
+    uint32_t seed;                ///< Seed of the noise generator
+    uint8_t apiMode;              ///< API mode of the module, 1 or 2 (escaped), changed by AP and AC
+} XBeeSimConfig;
+
+/**
+ * @typedef XBeeSimEvent
+ * @brief Module response waiting for its release time.
+ */
+typedef struct {
+    uint64_t releaseUs;           ///< Virtual time the last byte is on the host side of the UART
+    uint32_t baudRate;            ///< Module baud rate the frame is sent at
+    uint16_t length;              ///< Length of the encoded frame, 0 if the event is free
+    uint8_t frame[2 * (XBEE_SIM_FRAME_SIZE + 4)]; ///< Encoded API frame, escaped in API mode 2
+} XBeeSimEvent;
+
+/**
+ * @typedef XBeeSimCounters
+ * @brief Traffic seen by the simulated module.
+ */
+typedef struct {
+    uint32_t hostFrames;          ///< Frames received from the host
+    uint32_t hostBytes;           ///< Bytes written by the host
+    uint32_t hostChecksumErrors;  ///< Frames from the host with a bad checksum
+    uint32_t atCommands;          ///< AT commands answered
+    uint32_t joinRequests;        ///< Join requests received
+    uint32_t txRequests;          ///< TX requests received
+    uint32_t addressDiscoveries;  ///< 0x10 TX and 0x17 remote AT requests sent without the 16-bit address of their destination
+    uint32_t remoteAtCommands;    ///< Remote AT commands received
+    uint32_t remoteAtLost;        ///< Remote AT commands left unanswered by remoteLossPercent
+    uint32_t moduleFrames;        ///< Frames sent to the host
+    uint32_t bytesRead;           ///< Bytes copied out through PortUartRead
+    uint32_t readCalls;           ///< Calls of PortUartRead
+    uint32_t corruptedBytes;      ///< Bytes altered by the noise generator
+    uint32_t droppedFrames;       ///< Responses dropped because the output or the event list was full
+    uint32_t baudMismatches;      ///< Frames lost in either direction because host and module baud rates differ
+    uint32_t wakeups;             ///< Returns from PortDelay and PortWaitForRx, the times the host woke up
+} XBeeSimCounters;
+
+typedef struct XBeeSim_s XBeeSim;
+
+/**
+ * @typedef XBeeSimUplinkHandler
+ * @brief Network side of the simulation, sees the port and payload of every TX request.
+ *
+ * It is called before the TX status is scheduled, so it can change `config.txStatus` or
+ * `config.dataRate` for this uplink, and may answer with `XBeeSimSendDownlink()`.
+ */
+typedef void (*XBeeSimUplinkHandler)(XBeeSim* sim, uint8_t port, const uint8_t* payload, uint8_t length, void* ctx);
+
+/**
+ * @typedef XBeeSim
+ * @brief State of one simulated module, used as the port context of an XBee instance.
+ */
+struct XBeeSim_s {
+    XBeeSimConfig config;
+    uint64_t nowUs;               ///< Virtual clock
+    uint32_t hostBaudRate;        ///< Rate the host opened the UART at, 0 before PortUartInit
+    uint32_t pendingBaudRate;     ///< Rate written with BD, applied by AC
+    uint8_t pendingApiMode;       ///< Mode written with AP, applied by AC
+    XBeeRxRing *ring;             ///< Ring attached by the library, NULL in pull mode
+    uint8_t output[XBEE_SIM_OUTPUT_SIZE]; ///< Bytes readable by the host
+    uint32_t outputHead;          ///< Next write position in output
+    uint32_t outputTail;          ///< Next read position in output
+    XBeeSimEvent events[XBEE_SIM_EVENTS];
+    uint8_t input[XBEE_SIM_FRAME_SIZE + 4]; ///< Frame being received from the host
+    uint16_t inputLength;         ///< Bytes of the frame received so far
+    bool inputEscape;             ///< The last byte from the host was an escape character
+    struct {
+        uint16_t command;         ///< AT command, packed as in at_command_t
+        uint8_t length;           ///< Length of the value
+        uint8_t value[16];        ///< Last value written by the host
+    } params[XBEE_SIM_PARAMS];
+    uint8_t paramCount;           ///< Number of used params entries
+    uint8_t joinRequestsSeen;     ///< Join requests received since XBeeSimInit()
+    uint32_t uplinkCounter;       ///< Frame counter reported in the explicit TX status
+    uint64_t inputFreeUs;         ///< Virtual time the last 0x10 request written by the host has fully reached the module
+    uint64_t radioFreeUs;         ///< Virtual time the radio has sent every queued 0x10 request
+    uint32_t random;              ///< Noise generator state
+    XBeeSimUplinkHandler onUplink; ///< Network side of the simulation, NULL by default; set after XBeeSimInit()
+    void *uplinkContext;          ///< User pointer passed to onUplink
+    XBeeSimCounters counters;
+};
+
+// Hardware table backed by the simulator, use an XBeeSim as the port context
+extern const XBeeHTable XBeeSimHTable;
+
+void XBeeSimDefaultConfig(XBeeSimConfig* config);
+void XBeeSimInit(XBeeSim* sim, const XBeeSimConfig* config);
+void XBeeSimAdvance(XBeeSim* sim, uint32_t us);
+bool XBeeSimSendFrame(XBeeSim* sim, uint8_t frameType, const uint8_t* data, uint16_t length, uint32_t delayUs);
+bool XBeeSimSendDownlink(XBeeSim* sim, uint8_t port, const uint8_t* payload, uint8_t length, uint32_t delayUs);
+uint32_t XBeeSimEncodeFrame(uint8_t* buffer, uint8_t frameType, const uint8_t* data, uint16_t length);
+uint32_t XBeeSimEscapeFrame(uint8_t* output, const uint8_t* frame, uint32_t length);
+uint32_t XBeeSimInject(XBeeSim* sim, const uint8_t* bytes, uint32_t length);
+uint32_t XBeeSimPending(const XBeeSim* sim);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEE_SIM_H
@@ -0,0 +1,67 @@
+/**
+ * @file xbee_trace_decode.c
+ * @brief Prints trace records captured from a device as text.
+ *
+ * Reads records in the `XBEE_TRACE_RECORD_SIZE` byte form of `XBeeTraceEncode()`, e.g. a
+ * capture of the bytes a sketch wrote to a serial port, and prints one line per record with
+ * `XBeeTraceFormat()`. Timestamps and latencies are printed in the units the device recorded
+ * them in (`XBeeStats.timeUnitUs`).
+ *
+ * Usage: xbee_trace_decode [file], reads stdin without a file
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_trace.h"
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+    FILE* input = stdin;
+    if (argc > 1) {
+        input = fopen(argv[1], "rb");
+        if (input == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    uint8_t encoded[XBEE_TRACE_RECORD_SIZE];
+    unsigned long records = 0;
+    while (fread(encoded, 1, sizeof(encoded), input) == sizeof(encoded)) {
+        XBeeTraceRecord record;
+        char line[96];
+        XBeeTraceDecode(encoded, &record);
+        XBeeTraceFormat(&record, line, sizeof(line));
+        puts(line);
+        records++;
+    }
+    if (ferror(input)) {
+        perror("read");
+        return 1;
+    }
+    fprintf(stderr, "%lu records\n", records);
+    return 0;
+}
@@ -34,8 +34,6 @@
  * SOFTWARE.
  */
 
-XBeeArduino* XBeeArduino::instance_ = nullptr;
-
 /**
  * @brief Constructor for XBeeArduino class.
  * 
@@ -50,23 +48,87 @@ XBeeArduino* XBeeArduino::instance_ = nullptr;
 XBeeArduino::XBeeArduino(Stream* serialPort, uint32_t baudrate, XBeeModuleType moduleType,
                          void (*onReceiveCallback)(void*),
                          void (*onSendCallback)(void*))
-    : serialPort_(serialPort), moduleType_(moduleType), xbee_(nullptr), baudRate_(baudrate),
-      onReceiveCallback_(onReceiveCallback), onSendCallback_(onSendCallback) {
+    : serialPort_(serialPort), moduleType_(moduleType), xbee_(nullptr), ownsXBee_(true), scheduler_(nullptr), coalescer_(nullptr), baudRate_(baudrate),
+      onReceiveCallback_(onReceiveCallback), onSendCallback_(onSendCallback),
+      onConnectCallback_(nullptr), onDisconnectCallback_(nullptr), ctable_(), htable_(), portContext_() {
+
+    if (setupTables()) {
+        if (moduleType_ == XBEE_STANDARD) {
+            xbee_ = (XBee*)XBee3RFCreate(&ctable_, &htable_);
+        } else {
+            xbee_ = (XBee*)XBeeLRCreate(&ctable_, &htable_);
+        }
+        attachContexts();
+    }
+}
+
+/**
+ * @brief Constructor for XBeeArduino instances that live in caller provided memory.
+ * 
+ * Used by XBeeArduinoStatic: no heap memory is allocated, the XBee instance and its 
+ * buffers are provided by the caller.
+ * 
+ * @param serialPort A pointer to a Stream object (HardwareSerial or SoftwareSerial).
+ * @param baudrate The baud rate for UART communication.
+ * @param moduleType The type of XBee module (standard or LoRa).
+ * @param onReceiveCallback A callback function to handle received data.
+ * @param onSendCallback A callback function to handle post-send events.
+ * @param lrInstance Memory for the XBee LR instance, used for XBEE_LORA.
+ * @param rfInstance Memory for the XBee 3 RF instance, used for XBEE_STANDARD.
+ * @param storage Buffers for the XBee instance.
+ */
+XBeeArduino::XBeeArduino(Stream* serialPort, uint32_t baudrate, XBeeModuleType moduleType,
+                         void (*onReceiveCallback)(void*),
+                         void (*onSendCallback)(void*),
+                         XBeeLR* lrInstance, XBee3RF* rfInstance, const XBeeStorage* storage)
+    : serialPort_(serialPort), moduleType_(moduleType), xbee_(nullptr), ownsXBee_(false), scheduler_(nullptr), coalescer_(nullptr), baudRate_(baudrate),
+      onReceiveCallback_(onReceiveCallback), onSendCallback_(onSendCallback),
+      onConnectCallback_(nullptr), onDisconnectCallback_(nullptr), ctable_(), htable_(), portContext_() {
+
+    if (setupTables()) {
+        if (moduleType_ == XBEE_STANDARD) {
+            xbee_ = (XBee*)XBee3RFInitStatic(rfInstance, storage, &ctable_, &htable_);
+        } else {
+            xbee_ = (XBee*)XBeeLRInitStatic(lrInstance, storage, &ctable_, &htable_);
+        }
+        attachContexts();
+    }
+}
 
-    if (moduleType_ == XBEE_STANDARD) {
-        // Initialization for standard XBee modules
-    } else if (moduleType_ == XBEE_LORA) {
-        instance_ = this;
+/**
+ * @brief Fills the callback and hardware tables for the module type.
+ * @return True if the module type is backed by an XBee library instance, otherwise false.
+ */
+bool XBeeArduino::setupTables() {
+    if ((moduleType_ == XBEE_STANDARD) || (moduleType_ == XBEE_LORA)) {
         ctable_.OnReceiveCallback = onReceiveWrapper, 
         ctable_.OnSendCallback = onSendWrapper, 
+        ctable_.OnConnectCallback = onConnectWrapper,
+        ctable_.OnDisconnectCallback = onDisconnectWrapper,
         htable_.PortUartRead = portUartRead,
         htable_.PortUartWrite = portUartWrite,
         htable_.PortMillis = portMillis,
         htable_.PortFlushRx = portFlushRx,
         htable_.PortUartInit = portUartInit,
         htable_.PortDelay = portDelay,
+        htable_.PortMicros = portMicros,
+        htable_.PortUartSetFlowControl = portUartSetFlowControl,
+        htable_.PortWaitForRx = portWaitForRx;
+        return true;
+    }
+    return false;
+}
 
-        xbee_ = (XBee*)XBeeLRCreate(&ctable_, &htable_);
+/**
+ * @brief Routes the library's port and callback contexts to this instance.
+ * 
+ * Each radio has its own serial port and callbacks, so several XBeeArduino objects 
+ * can share the same port functions and static callback wrappers.
+ */
+void XBeeArduino::attachContexts() {
+    if (xbee_ != nullptr) {
+        XBeeSetPortContext(xbee_, &portContext_);
+        XBeeSetUserContext(xbee_, this);
     }
 }
 
@@ -78,7 +140,12 @@ XBeeArduino::XBeeArduino(Stream* serialPort, uint32_t baudrate, XBeeModuleType m
 XBeeArduino::~XBeeArduino() {
     if (xbee_ != nullptr) {
         XBeeDisconnect(xbee_);
-        delete xbee_;  // Free the memory allocated for the XBee structure
+        if (ownsXBee_ && (moduleType_ == XBEE_STANDARD)) {
+            XBee3RFDestroy((XBee3RF*)xbee_);  // Free the memory allocated by XBee3RFCreate()
+        } else if (ownsXBee_) {
+            XBeeLRDestroy((XBeeLR*)xbee_);  // Free the memory allocated by XBeeLRCreate()
+        }
+        xbee_ = nullptr;
     }
 }
 
@@ -87,7 +154,10 @@ XBeeArduino::~XBeeArduino() {
  * @return True if initialization is successful, otherwise false.
  */
 bool XBeeArduino::begin() {
-    return portUartInit(baudRate_, serialPort_) == 0;  // Corrected baudRate_ reference
+    if (xbee_ != nullptr) {
+        return XBeeInit(xbee_, baudRate_, serialPort_);
+    }
+    return portUartInit(&portContext_, baudRate_, serialPort_) == 0;  // Corrected baudRate_ reference
 }
 
 /**
@@ -108,7 +178,77 @@ bool XBeeArduino::connect() {
 void XBeeArduino::process() {
     if (xbee_ != nullptr) {
         XBeeProcess(xbee_);
+        if (coalescer_ != nullptr) {
+            XBeeLRCoalesceProcess(coalescer_);
+        }
+        if (scheduler_ != nullptr) {
+            XBeeLRSchedProcess(scheduler_);
+        }
+    }
+}
+
+/**
+ * @brief Processes several radios from one loop.
+ * 
+ * @param radios Array of XBeeArduino instances, nullptr entries are skipped.
+ * @param count Number of entries in radios.
+ */
+void XBeeArduino::processAll(XBeeArduino* const* radios, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (radios[i] != nullptr) {
+            radios[i]->process();
+        }
+    }
+}
+
+/**
+ * @brief Sleeps until the module sends something or the library has a timeout to handle.
+ * @param maxMs Longest time to sleep.
+ */
+void XBeeArduino::waitForWork(uint32_t maxMs) {
+    if (xbee_ == nullptr) {
+        return;
     }
+    if (scheduler_ != nullptr) {
+        uint32_t release = XBeeLRSchedNextDeadline(scheduler_);
+        if (release < maxMs) {
+            maxMs = release;
+        }
+    }
+    if (coalescer_ != nullptr) {
+        uint32_t due = XBeeLRCoalesceNextDeadline(coalescer_);
+        if (due < maxMs) {
+            maxMs = due;
+        }
+    }
+    XBeeWait(xbee_, maxMs);
+}
+
+/**
+ * @brief Starts joining the network without waiting for the result.
+ * @return True if a join was started or is already in progress, otherwise false.
+ */
+bool XBeeArduino::connectAsync() {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_LORA)) {
+        return XBeeLRConnectAsync(xbee_);
+    }
+    return false;
+}
+
+/**
+ * @brief Sets the callback called when the module joins the network.
+ * @param onConnectCallback Callback function, or nullptr to disable it.
+ */
+void XBeeArduino::setOnConnectCallback(void (*onConnectCallback)()) {
+    onConnectCallback_ = onConnectCallback;
+}
+
+/**
+ * @brief Sets the callback called when the module leaves the network or fails to join it.
+ * @param onDisconnectCallback Callback function, or nullptr to disable it.
+ */
+void XBeeArduino::setOnDisconnectCallback(void (*onDisconnectCallback)()) {
+    onDisconnectCallback_ = onDisconnectCallback;
 }
 
 /**
@@ -127,16 +267,320 @@ bool XBeeArduino::disconnect() {
  * @param data The data to be sent.
  * @return True if the data is sent successfully, otherwise false.
  */
-template <typename T>
-bool XBeeArduino::sendData(const T& data) {
-    if (moduleType_ == XBEE_LORA) {
+template <>
+bool XBeeArduino::sendData<XBeeLRPacket_s>(const XBeeLRPacket_s& data) {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_LORA)) {
         return XBeeSendData(xbee_, &data) == API_SEND_SUCCESS;
     }
     return false;
 }
 
-// Explicit template instantiation for XBeeLRPacket_s
-template bool XBeeArduino::sendData<XBeeLRPacket_s>(const XBeeLRPacket_s&);
+template <>
+bool XBeeArduino::sendData<XBee3RFPacket_s>(const XBee3RFPacket_s& data) {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_STANDARD)) {
+        return XBeeSendData(xbee_, &data) == API_SEND_SUCCESS;
+    }
+    return false;
+}
+
+/**
+ * @brief Queues data for transmission without waiting for the TX status.
+ * @param data The data to be sent.
+ * @return The frame ID of the transmission, or 0 if it could not be queued.
+ */
+template <>
+uint8_t XBeeArduino::sendDataAsync<XBeeLRPacket_s>(const XBeeLRPacket_s& data) {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_LORA)) {
+        XBeeLRPacket_t packet = data;
+        return XBeeLRSendDataAsync(xbee_, &packet, NULL, NULL);
+    }
+    return 0;
+}
+
+template <>
+uint8_t XBeeArduino::sendDataAsync<XBee3RFPacket_s>(const XBee3RFPacket_s& data) {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_STANDARD)) {
+        XBee3RFPacket_t packet = data;
+        return XBee3RFSendDataAsync(xbee_, &packet, NULL, NULL);
+    }
+    return 0;
+}
+
+/**
+ * @brief Queues an uplink and reports its TX status to a per-request callback.
+ * @param packet Packet to send, its frameId is set to the frame ID used.
+ * @param callback Completion callback, may be nullptr.
+ * @param ctx User pointer passed to the callback.
+ * @return The frame ID of the transmission, or 0 if it could not be queued.
+ */
+uint8_t XBeeArduino::sendDataAsync(XBeeLRPacket_t& packet, XBeeTxCompleteCallback callback, void* ctx) {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_LORA)) {
+        return XBeeLRSendDataAsync(xbee_, &packet, callback, ctx);
+    }
+    return 0;
+}
+
+/**
+ * @brief Queues a transmission to a node or a broadcast and reports its TX status to a per-request callback.
+ * @param packet Packet to send, its frameId is set to the frame ID used.
+ * @param callback Completion callback, may be nullptr.
+ * @param ctx User pointer passed to the callback.
+ * @return The frame ID of the transmission, or 0 if it could not be queued.
+ */
+uint8_t XBeeArduino::sendDataAsync(XBee3RFPacket_t& packet, XBeeTxCompleteCallback callback, void* ctx) {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_STANDARD)) {
+        return XBee3RFSendDataAsync(xbee_, &packet, callback, ctx);
+    }
+    return 0;
+}
+
+/**
+ * @brief Sends an AT command without waiting for its response.
+ * @param request Request prepared with `apiAtRequestInit()`.
+ * @param command AT command to send.
+ * @param parameter Value to set, or nullptr to query the parameter.
+ * @param paramLength Length of the value.
+ * @return True if the command was sent, otherwise false.
+ */
+bool XBeeArduino::sendAtCommandAsync(xbee_at_request_t& request, at_command_t command, 
+                                     const uint8_t* parameter, uint8_t paramLength) {
+    if (xbee_ == nullptr) {
+        return false;
+    }
+    return apiSendAtCommandAsync(xbee_, &request, command, parameter, paramLength, 5000) == API_SEND_SUCCESS;
+}
+
+/**
+ * @brief Returns the largest payload allowed at the current region and data rate.
+ * @return The maximum payload in bytes, or 0 if unknown.
+ */
+uint8_t XBeeArduino::getMaxPayload() {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_LORA)) {
+        return XBeeLRGetMaxPayload(xbee_);
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the expected time on air of a packet at the current data rate.
+ * @param packet Packet to send.
+ * @return The time on air in milliseconds, or 0 if unknown.
+ */
+uint32_t XBeeArduino::getAirtime(const XBeeLRPacket_t& packet) {
+    if ((xbee_ != nullptr) && (moduleType_ == XBEE_LORA)) {
+        return XBeeLRGetPacketAirtime(xbee_, &packet);
+    }
+    return 0;
+}
+
+/**
+ * @brief Attaches a duty-cycle aware uplink scheduler, serviced by process().
+ * @param scheduler Caller-owned scheduler, must outlive this object.
+ * @param policy Duty cycle policy, or nullptr for the default single sub-band policy.
+ * @return True on success, false if the module type has no uplink path.
+ */
+bool XBeeArduino::attachScheduler(XBeeLRScheduler& scheduler, const XBeeLRSchedPolicy* policy) {
+    if ((xbee_ == nullptr) || (moduleType_ != XBEE_LORA)) {
+        return false;
+    }
+    XBeeLRSchedInit(&scheduler, xbee_, policy);
+    scheduler_ = &scheduler;
+    return true;
+}
+
+/**
+ * @brief Queues an uplink on the attached scheduler.
+ * 
+ * The OnSendCallback reports the TX status, as for sendData().
+ * 
+ * @param packet Packet to send.
+ * @param priority Priority of the packet.
+ * @return True if the packet was queued, false if no scheduler is attached or the queue is full.
+ */
+bool XBeeArduino::queueData(const XBeeLRPacket_t& packet, xbee_lr_priority_t priority) {
+    if (scheduler_ == nullptr) {
+        return false;
+    }
+    return XBeeLRSchedEnqueue(scheduler_, &packet, priority, NULL, NULL);
+}
+
+/**
+ * @brief Attaches a coalescing stage that packs small records into shared uplinks, serviced by process().
+ * @param coalescer Caller-owned coalescing stage, must outlive this object.
+ * @param priority Scheduler priority of the coalesced uplinks.
+ * @return True on success, false if no scheduler is attached.
+ */
+bool XBeeArduino::attachCoalescer(XBeeLRCoalescer& coalescer, xbee_lr_priority_t priority) {
+    if (scheduler_ == nullptr) {
+        return false;
+    }
+    XBeeLRCoalesceInit(&coalescer, scheduler_, priority);
+    coalescer_ = &coalescer;
+    return true;
+}
+
+/**
+ * @brief Appends a record to the next coalesced uplink of a port.
+ * @param port LoRaWAN port of the record.
+ * @param data Record to append, copied.
+ * @param length Size of the record in bytes.
+ * @param maxLatencyMs Longest time the record may wait before its uplink is queued.
+ * @return True if the record was appended, otherwise false.
+ */
+bool XBeeArduino::appendRecord(uint8_t port, const void* data, uint8_t length, uint32_t maxLatencyMs) {
+    if (coalescer_ == nullptr) {
+        return false;
+    }
+    return XBeeLRCoalesceAppend(coalescer_, port, data, length, maxLatencyMs);
+}
+
+/**
+ * @brief Stores received packets in a queue drained with receive() instead of calling the receive callback.
+ * @param queue Caller-owned queue, must outlive this object.
+ * @return True on success, false if the module type has no packet receive path.
+ */
+bool XBeeArduino::attachRxQueue(XBeeLRRxQueue& queue) {
+    if ((xbee_ == nullptr) || (moduleType_ != XBEE_LORA)) {
+        return false;
+    }
+    XBeeLRAttachRxQueue(xbee_, &queue);
+    return true;
+}
+
+/**
+ * @brief Takes the oldest packet from the attached RX queue.
+ * @param packet Receives the packet, its payload stays valid until the next call.
+ * @return True if a packet was returned, false if the queue is empty or none is attached.
+ */
+bool XBeeArduino::receive(XBeeLRPacket_t& packet) {
+    if ((xbee_ == nullptr) || (moduleType_ != XBEE_LORA)) {
+        return false;
+    }
+    return XBeeLRReceive(xbee_, &packet);
+}
+
+/**
+ * @brief Returns the number of packets waiting in the attached RX queue.
+ * @return Packets not yet returned by receive().
+ */
+uint8_t XBeeArduino::available() {
+    if ((xbee_ == nullptr) || (moduleType_ != XBEE_LORA)) {
+        return 0;
+    }
+    return XBeeLRRxPending(xbee_);
+}
+
+/**
+ * @brief Registers a handler for a received API frame type.
+ * @param frameType Received frame type, 0x80-0xFF.
+ * @param handler Handler to call, or nullptr to remove the current handler.
+ * @param ctx User pointer passed to the handler.
+ * @return True on success, otherwise false.
+ */
+bool XBeeArduino::registerFrameHandler(uint8_t frameType, XBeeFrameHandler handler, void* ctx) {
+    if (xbee_ != nullptr) {
+        return XBeeRegisterFrameHandler(xbee_, frameType, handler, ctx);
+    }
+    return false;
+}
+
+/**
+ * @brief Copies the frame layer statistics of the module.
+ * @param stats Receives the counters and latencies.
+ * @return True on success, otherwise false.
+ */
+bool XBeeArduino::getStats(XBeeStats& stats) {
+    if (xbee_ != nullptr) {
+        XBeeGetStats(xbee_, &stats);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Moves the module and the host UART to a new baud rate.
+ * @param baudRate New baud rate.
+ * @return True if the link runs at the new rate, otherwise false.
+ */
+bool XBeeArduino::setBaudRate(uint32_t baudRate) {
+    if ((xbee_ != nullptr) && XBeeSetBaudRate(xbee_, baudRate)) {
+        baudRate_ = baudRate;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Enables or disables RTS/CTS hardware flow control.
+ * @param enable True to enable flow control.
+ * @param rtsPin Host pin wired to the module's RTS input, -1 if not wired.
+ * @param ctsPin Host pin wired to the module's CTS output, -1 if not wired.
+ * @return True on success, otherwise false.
+ */
+bool XBeeArduino::setFlowControl(bool enable, int8_t rtsPin, int8_t ctsPin) {
+    if (xbee_ == nullptr) {
+        return false;
+    }
+    if (enable) {
+        portContext_.rtsPin = rtsPin;
+        portContext_.ctsPin = ctsPin;
+    }
+    return XBeeSetFlowControl(xbee_, enable);
+}
+
+/**
+ * @brief Switches the module and the library to an API mode.
+ * @param mode 1 for API mode (AP=1) or 2 for escaped API mode (AP=2).
+ * @return True if both sides use the new mode, otherwise false.
+ */
+bool XBeeArduino::setApiMode(uint8_t mode) {
+    if (xbee_ != nullptr) {
+        return XBeeSetAPIMode(xbee_, mode);
+    }
+    return false;
+}
+
+/**
+ * @brief Clears the frame layer statistics of the module.
+ */
+void XBeeArduino::resetStats() {
+    if (xbee_ != nullptr) {
+        XBeeResetStats(xbee_);
+    }
+}
+
+/**
+ * @brief Records frame layer events into a binary trace ring.
+ * @param trace Initialized ring, or nullptr to stop tracing.
+ * @return True on success, otherwise false.
+ */
+bool XBeeArduino::attachTrace(XBeeTrace* trace) {
+    if (xbee_ != nullptr) {
+        return XBeeAttachTrace(xbee_, trace);
+    }
+    return false;
+}
+
+/**
+ * @brief Formats the unread records of the attached trace ring.
+ * @param out Destination of the text.
+ * @param maxRecords Largest number of records printed.
+ * @return Number of records printed.
+ */
+uint16_t XBeeArduino::printTrace(Print& out, uint16_t maxRecords) {
+    if ((xbee_ == nullptr) || (xbee_->trace == nullptr)) {
+        return 0;
+    }
+    uint16_t printed = 0;
+    XBeeTraceRecord record;
+    char line[96];
+    while ((printed < maxRecords) && (XBeeTraceRead(xbee_->trace, &record, 1) == 1)) {
+        XBeeTraceFormat(&record, line, sizeof(line));
+        out.println(line);
+        printed++;
+    }
+    return printed;
+}
 
 /**
  * @brief Checks if the XBee module is connected to the network.
@@ -171,14 +615,30 @@ bool XBeeArduino::setApiOptions(const uint8_t options) {
 }
 
 void XBeeArduino::onReceiveWrapper(XBee* xbee, void* data) {
-    if (instance_ && instance_->onReceiveCallback_) {
-        instance_->onReceiveCallback_(data);  // Forward the call to the original callback
+    XBeeArduino* self = static_cast<XBeeArduino*>(XBeeGetUserContext(xbee));
+    if (self && self->onReceiveCallback_) {
+        self->onReceiveCallback_(data);  // Forward the call to the original callback
     }
 }
 
 void XBeeArduino::onSendWrapper(XBee* xbee, void* data) {
-    if (instance_ && instance_->onSendCallback_) {
-        instance_->onSendCallback_(data);  // Forward the call to the original callback
+    XBeeArduino* self = static_cast<XBeeArduino*>(XBeeGetUserContext(xbee));
+    if (self && self->onSendCallback_) {
+        self->onSendCallback_(data);  // Forward the call to the original callback
+    }
+}
+
+void XBeeArduino::onConnectWrapper(XBee* xbee) {
+    XBeeArduino* self = static_cast<XBeeArduino*>(XBeeGetUserContext(xbee));
+    if (self && self->onConnectCallback_) {
+        self->onConnectCallback_();  // Forward the call to the original callback
+    }
+}
+
+void XBeeArduino::onDisconnectWrapper(XBee* xbee) {
+    XBeeArduino* self = static_cast<XBeeArduino*>(XBeeGetUserContext(xbee));
+    if (self && self->onDisconnectCallback_) {
+        self->onDisconnectCallback_();  // Forward the call to the original callback
     }
 }
 
@@ -200,6 +660,31 @@ bool XBeeArduino::writeConfig(void) {
     return XBeeWriteConfig(xbee_);
 }
 
+/**
+ * @brief Starts a batched configuration transaction.
+ * @param[in] batch Batch storage, must stay valid until commitConfig() returns.
+ * @return True if the batch was started, otherwise false.
+ */
+bool XBeeArduino::beginConfig(XBeeConfigBatch& batch) {
+    if (xbee_ != nullptr) {
+        return XBeeConfigBegin(xbee_, &batch);
+    }
+    return false;
+}
+
+/**
+ * @brief Applies and optionally saves all parameters queued since beginConfig().
+ * @param[in] apply True to apply the queued values (AC).
+ * @param[in] write True to save the configuration to non-volatile memory (WR).
+ * @return True if every queued parameter was accepted, otherwise false.
+ */
+bool XBeeArduino::commitConfig(bool apply, bool write) {
+    if (xbee_ != nullptr) {
+        return XBeeConfigCommit(xbee_, apply, write);
+    }
+    return false;
+}
+
 /**
  * @brief Sets the App EUI of the LoRaWAN XBee module.
  * @param value A pointer to a buffer where the App EUI will be stored.
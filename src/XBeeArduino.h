@@ -4,7 +4,14 @@
 #include <Arduino.h>
 #include "port.h"
 #include "xbee.h"
+#include "xbee_api_frames.h"
+#include "XBeeAtParam.h"
+#include "xbee_lr_sched.h"
+#include "xbee_lr_coalesce.h"
+#include "xbee_lr_airtime.h"
 #include "xbee_lr.h"  // Assuming this is where XBeeLRPacket_t and other XBee-related types are defined
+#include "xbee_3rf.h"
+#include "xbee_trace.h"
 
 /**
  * @file XBeeArduino.h
@@ -42,7 +49,7 @@
  * @brief Enum to represent the type of XBee module.
  */
 enum XBeeModuleType {
-    XBEE_STANDARD, ///< Standard XBee module
+    XBEE_STANDARD, ///< Standard XBee module (XBee 3 RF: Zigbee, 802.15.4 or DigiMesh)
     XBEE_LORA      ///< LoRa XBee module
 };
 
@@ -72,7 +79,7 @@ public:
     /**
      * @brief Destructor for XBeeArduino class.
      */
-    ~XBeeArduino();
+    virtual ~XBeeArduino();
 
     /**
      * @brief Initializes the XBee module.
@@ -86,12 +93,55 @@ public:
      */
     bool connect();
 
+    /**
+     * @brief Starts joining the network without waiting for the result.
+     * 
+     * The join is advanced by process(); the connect callback is called once joined, 
+     * the disconnect callback if every attempt failed.
+     * 
+     * @return True if a join was started or is already in progress, otherwise false.
+     */
+    bool connectAsync();
+
+    /**
+     * @brief Sets the callback called when the module joins the network.
+     * @param onConnectCallback Callback function, or nullptr to disable it.
+     */
+    void setOnConnectCallback(void (*onConnectCallback)());
+
+    /**
+     * @brief Sets the callback called when the module leaves the network or fails to join it.
+     * @param onDisconnectCallback Callback function, or nullptr to disable it.
+     */
+    void setOnDisconnectCallback(void (*onDisconnectCallback)());
+
     /**
      * @brief Lets the XBee class process 
      * @return void
      */
     void process();
 
+    /**
+     * @brief Processes several radios from one loop.
+     * 
+     * Each radio is serviced once per call, so uplinks and joins started with the 
+     * asynchronous calls on different modules overlap instead of running one after another.
+     * 
+     * @param radios Array of XBeeArduino instances, nullptr entries are skipped.
+     * @param count Number of entries in radios.
+     */
+    static void processAll(XBeeArduino* const* radios, uint8_t count);
+
+    /**
+     * @brief Sleeps until the module sends something or the library has a timeout to handle.
+     * 
+     * Call it in the loop after process(), so the MCU sleeps through long TX status and 
+     * join waits instead of spinning. The attached scheduler's next release and coalescer's next deadline are honoured.
+     * 
+     * @param maxMs Longest time to sleep, e.g. until the sketch's own next task.
+     */
+    void waitForWork(uint32_t maxMs = XBEE_WAIT_FOREVER);
+
     /**
      * @brief Disconnects the XBee module from the network.
      * @return True if disconnection is successful, otherwise false.
@@ -100,18 +150,238 @@ public:
 
     /**
      * @brief Sends data through the XBee module.
+     * 
+     * `T` is `XBeeLRPacket_t` for XBEE_LORA and `XBee3RFPacket_t` for XBEE_STANDARD.
+     * 
      * @param data The data to be sent.
      * @return True if the data is sent successfully, otherwise false.
      */
     template <typename T>
     bool sendData(const T& data);
 
+    /**
+     * @brief Queues data for transmission without waiting for the TX status.
+     * 
+     * The result is reported through the send callback once the TX status frame 
+     * has been received by process(). Several transmissions can be outstanding.
+     * 
+     * @param data The data to be sent.
+     * @return The frame ID of the transmission, or 0 if it could not be queued.
+     */
+    template <typename T>
+    uint8_t sendDataAsync(const T& data);
+
+    /**
+     * @brief Queues an uplink and reports its TX status to a per-request callback.
+     * 
+     * The callback is called from process() with the delivery status, see 
+     * `XBeeTxCompleteCallback`. The awaitable and future API of XBeeAsync.h builds on it.
+     * 
+     * @param packet Packet to send, its frameId is set to the frame ID used.
+     * @param callback Completion callback, may be nullptr.
+     * @param ctx User pointer passed to the callback.
+     * @return The frame ID of the transmission, or 0 if it could not be queued.
+     */
+    uint8_t sendDataAsync(XBeeLRPacket_t& packet, XBeeTxCompleteCallback callback, void* ctx);
+
+    /**
+     * @brief Queues a transmission to a node or a broadcast and reports its TX status to a per-request callback.
+     * 
+     * Several unicast frames can be in flight at once, see `XBee3RFSendDataAsync()`.
+     * 
+     * @param packet Packet to send, its frameId is set to the frame ID used.
+     * @param callback Completion callback, may be nullptr.
+     * @param ctx User pointer passed to the callback.
+     * @return The frame ID of the transmission, or 0 if it could not be queued.
+     */
+    uint8_t sendDataAsync(XBee3RFPacket_t& packet, XBeeTxCompleteCallback callback, void* ctx);
+
+    /**
+     * @brief Sends an AT command without waiting for its response.
+     * 
+     * The request is completed by process(), see `apiSendAtCommandAsync()`. It must stay 
+     * in scope until then.
+     * 
+     * @param request Request prepared with `apiAtRequestInit()`.
+     * @param command AT command to send.
+     * @param parameter Value to set, or nullptr to query the parameter.
+     * @param paramLength Length of the value.
+     * @return True if the command was sent, otherwise false.
+     */
+    bool sendAtCommandAsync(xbee_at_request_t& request, at_command_t command, 
+                            const uint8_t* parameter = nullptr, uint8_t paramLength = 0);
+
     /**
      * @brief Checks if the XBee module is connected to the network.
      * @return True if the module is connected, otherwise false.
      */
     bool isConnected();
 
+    /**
+     * @brief Returns the largest payload allowed at the current region and data rate.
+     * @return The maximum payload in bytes, or 0 if unknown.
+     */
+    uint8_t getMaxPayload();
+
+    /**
+     * @brief Returns the expected time on air of a packet at the current data rate.
+     * @param packet Packet to send.
+     * @return The time on air in milliseconds, or 0 if unknown.
+     */
+    uint32_t getAirtime(const XBeeLRPacket_t& packet);
+
+    /**
+     * @brief Attaches a duty-cycle aware uplink scheduler, serviced by process().
+     * @param scheduler Caller-owned scheduler, must outlive this object.
+     * @param policy Duty cycle policy, or nullptr for the default single sub-band policy.
+     * @return True on success, false if the module type has no uplink path.
+     */
+    bool attachScheduler(XBeeLRScheduler& scheduler, const XBeeLRSchedPolicy* policy = nullptr);
+
+    /**
+     * @brief Queues an uplink on the attached scheduler.
+     * 
+     * The payload buffer must stay valid until the packet has been sent, which is 
+     * signalled through the OnSendCallback.
+     * 
+     * @param packet Packet to send.
+     * @param priority Priority of the packet.
+     * @return True if the packet was queued, false if no scheduler is attached or the queue is full.
+     */
+    bool queueData(const XBeeLRPacket_t& packet, xbee_lr_priority_t priority = XBEE_LR_PRIORITY_TELEMETRY);
+
+    /**
+     * @brief Attaches a coalescing stage that packs small records into shared uplinks, serviced by process().
+     * @param coalescer Caller-owned coalescing stage, must outlive this object.
+     * @param priority Scheduler priority of the coalesced uplinks.
+     * @return True on success, false if no scheduler is attached.
+     */
+    bool attachCoalescer(XBeeLRCoalescer& coalescer, xbee_lr_priority_t priority = XBEE_LR_PRIORITY_TELEMETRY);
+
+    /**
+     * @brief Appends a record to the next coalesced uplink of a port.
+     * 
+     * The uplink is queued when the next record no longer fits the current DR's payload, 
+     * or when the latency bound of one of its records expires.
+     * 
+     * @param port LoRaWAN port of the record.
+     * @param data Record to append, copied.
+     * @param length Size of the record in bytes.
+     * @param maxLatencyMs Longest time the record may wait before its uplink is queued.
+     * @return True if the record was appended, false if no coalescer is attached, the record is too large or every buffer is in use.
+     */
+    bool appendRecord(uint8_t port, const void* data, uint8_t length, uint32_t maxLatencyMs);
+
+    /**
+     * @brief Stores received packets in a queue drained with receive() instead of calling the receive callback.
+     * @param queue Caller-owned queue, must outlive this object.
+     * @return True on success, false if the module type has no packet receive path.
+     */
+    bool attachRxQueue(XBeeLRRxQueue& queue);
+
+    /**
+     * @brief Takes the oldest packet from the attached RX queue.
+     * 
+     * The payload stays valid until the next call of receive().
+     * 
+     * @param packet Receives the packet.
+     * @return True if a packet was returned, false if the queue is empty or none is attached.
+     */
+    bool receive(XBeeLRPacket_t& packet);
+
+    /**
+     * @brief Returns the number of packets waiting in the attached RX queue.
+     * @return Packets not yet returned by receive().
+     */
+    uint8_t available();
+
+    /**
+     * @brief Registers a handler for a received API frame type, e.g. IO samples (0x92).
+     * @param frameType Received frame type, 0x80-0xFF.
+     * @param handler Handler to call, or nullptr to remove the current handler.
+     * @param ctx User pointer passed to the handler.
+     * @return True on success, otherwise false.
+     */
+    bool registerFrameHandler(uint8_t frameType, XBeeFrameHandler handler, void* ctx = nullptr);
+
+    /**
+     * @brief Copies the frame layer statistics: error counters and AT/TX latencies.
+     * @param stats Receives the snapshot, latencies are in `stats.timeUnitUs` microsecond units.
+     * @return True on success, otherwise false.
+     */
+    bool getStats(XBeeStats& stats);
+
+    /**
+     * @brief Clears all statistics counters and latencies.
+     */
+    void resetStats();
+
+    /**
+     * @brief Records frame layer events into a binary trace ring, see xbee_trace.h.
+     * @param trace Ring initialized with XBeeTraceInit(), must outlive this object; nullptr stops tracing.
+     * @return True on success, false if tracing is compiled out.
+     */
+    bool attachTrace(XBeeTrace* trace);
+
+    /**
+     * @brief Formats the unread records of the attached trace ring, one line each.
+     * 
+     * Call it from loop() when the timing no longer matters, not from a callback.
+     * 
+     * @param out Destination of the text, e.g. Serial.
+     * @param maxRecords Largest number of records printed by this call.
+     * @return Number of records printed.
+     */
+    uint16_t printTrace(Print& out, uint16_t maxRecords = 0xFFFF);
+
+    /**
+     * @brief Moves the module and the host UART to a new baud rate.
+     * 
+     * Sends BD and AC, reopens the serial port at the new rate and probes the module; if the 
+     * probe fails both sides fall back to the current rate. Use writeConfig() to keep the rate 
+     * across power cycles.
+     * 
+     * @param baudRate New baud rate, e.g. 230400, 460800 or 921600.
+     * @return True if the link runs at the new rate, otherwise false.
+     */
+    bool setBaudRate(uint32_t baudRate);
+
+    /**
+     * @brief Enables or disables RTS/CTS hardware flow control.
+     * 
+     * On ESP32 and arduino-pico the UART peripheral handles RTS/CTS. On other cores RTS is 
+     * driven by the library and only lets the module send during process() and while 
+     * waiting in waitForWork() or a blocking call, so idle in waitForWork() rather than delay().
+     * 
+     * @param enable True to enable flow control on the module (D6/D7) and the host.
+     * @param rtsPin Host pin wired to the module's RTS input, -1 if not wired.
+     * @param ctsPin Host pin wired to the module's CTS output, -1 if not wired.
+     * @return True on success, otherwise false.
+     */
+    bool setFlowControl(bool enable, int8_t rtsPin = -1, int8_t ctsPin = -1);
+
+    /**
+     * @brief Switches the module and the library to an API mode.
+     * @param mode 1 for API mode (AP=1) or 2 for escaped API mode (AP=2), which resynchronizes 
+     * reliably on noisy links.
+     * @return True if both sides use the new mode, otherwise false.
+     */
+    bool setApiMode(uint8_t mode);
+
+    /**
+     * @brief Sets a module parameter from a typed value, e.g. `setParameter<AT_XF>(xbeeAtUint32(869525000UL))`.
+     * 
+     * The value's width is checked against the command at build time.
+     * 
+     * @tparam Command The AT command of the parameter.
+     * @param value Encoded parameter value from XBeeAtParam.h.
+     * @return True if the module accepted the value, otherwise false.
+     */
+    template <at_command_t Command, uint8_t N>
+    bool setParameter(const XBeeAtValue<N>& value) {
+        return (xbee_ != nullptr) && xbeeSetParam<Command>(xbee_, value);
+    }
+
     /**
      * @brief Resets the XBee module.
      */
@@ -159,10 +429,32 @@ public:
     bool applyChanges(void);
     /**
      * @brief Write config on XBee
+     * 
+     * Always sends WR; commitConfig() skips it when no setter changed anything.
+     * 
      * @return True if the write config is successfull, otherwise false.
      */
     bool writeConfig(void);
 
+    /**
+     * @brief Starts a batched configuration transaction.
+     * 
+     * Until commitConfig() is called, the set* functions queue their value on the 
+     * module and return without waiting for its answer.
+     * 
+     * @param[in] batch Batch storage, must stay valid until commitConfig() returns.
+     * @return True if the batch was started, otherwise false.
+     */
+    bool beginConfig(XBeeConfigBatch& batch);
+
+    /**
+     * @brief Applies and optionally saves all parameters queued since beginConfig().
+     * @param[in] apply True to apply the queued values (AC).
+     * @param[in] write True to save the configuration to non-volatile memory (WR).
+     * @return True if every queued parameter was accepted, otherwise false.
+     */
+    bool commitConfig(bool apply = true, bool write = true);
+
     /**
      * @brief Sets the LoRaWAN Class on the XBee LR module.
      * 
@@ -332,18 +624,111 @@ public:
      */
     bool setLoRaWANTransmitPower(const uint8_t value);
 
+protected:
+    /**
+     * @brief Constructor for instances whose XBee object lives in caller provided memory.
+     * 
+     * @param serialPort A pointer to a Stream object (HardwareSerial or SoftwareSerial).
+     * @param baudrate The baud rate for UART communication.
+     * @param moduleType The type of XBee module (standard or LoRa).
+     * @param onReceiveCallback A callback function to handle received data.
+     * @param onSendCallback A callback function to handle post-send events.
+     * @param lrInstance Memory for the XBee LR instance, used for XBEE_LORA.
+     * @param rfInstance Memory for the XBee 3 RF instance, used for XBEE_STANDARD.
+     * @param storage Buffers for the XBee instance.
+     */
+    XBeeArduino(Stream* serialPort, uint32_t baudrate, XBeeModuleType moduleType,
+                void (*onReceiveCallback)(void*),
+                void (*onSendCallback)(void*),
+                XBeeLR* lrInstance, XBee3RF* rfInstance, const XBeeStorage* storage);
+
 private:
+    XBeeArduino(const XBeeArduino&);            ///< Not copyable, the library keeps pointers into the instance
+    XBeeArduino& operator=(const XBeeArduino&); ///< Not copyable
+    bool setupTables();
+    void attachContexts();
+
     Stream* serialPort_; ///< Pointer to the serial port (HardwareSerial or SoftwareSerial)
     XBeeModuleType moduleType_; ///< Type of XBee module (standard or LoRa)
     XBee* xbee_; ///< Pointer to the XBee object created by the library
+    bool ownsXBee_; ///< True if xbee_ was allocated by XBeeLRCreate() or XBee3RFCreate() and must be destroyed
+    XBeeLRScheduler* scheduler_; ///< Attached uplink scheduler, nullptr if none
+    XBeeLRCoalescer* coalescer_; ///< Attached coalescing stage, nullptr if none
     uint32_t baudRate_; ///< Baud rate for UART communication
     void (*onReceiveCallback_)(void*); ///< Callback for received data
     void (*onSendCallback_)(void*); ///< Callback for post-send events
+    void (*onConnectCallback_)(); ///< Callback for network join events
+    void (*onDisconnectCallback_)(); ///< Callback for network leave or join failure events
     XBeeCTable ctable_;  ///< Callback table for the XBee library
     XBeeHTable htable_;  ///< Hardware table for the XBee library
-    static XBeeArduino* instance_;
+    port_context_t portContext_; ///< Port state of this instance, holds its serial port
     static void onReceiveWrapper(XBee* xbee, void* data);
     static void onSendWrapper(XBee* xbee, void* data);
+    static void onConnectWrapper(XBee* xbee);
+    static void onDisconnectWrapper(XBee* xbee);
+};
+
+// Packet types accepted by sendData() and sendDataAsync(), defined in XBeeArduino.cpp
+template <> bool XBeeArduino::sendData<XBeeLRPacket_s>(const XBeeLRPacket_s& data);
+template <> bool XBeeArduino::sendData<XBee3RFPacket_s>(const XBee3RFPacket_s& data);
+template <> uint8_t XBeeArduino::sendDataAsync<XBeeLRPacket_s>(const XBeeLRPacket_s& data);
+template <> uint8_t XBeeArduino::sendDataAsync<XBee3RFPacket_s>(const XBee3RFPacket_s& data);
+
+/**
+ * @brief Buffers of an XBeeArduinoStatic instance.
+ * 
+ * Kept in a base class so the buffers exist before the XBeeArduino base is constructed.
+ */
+template <uint16_t MaxFrameSize, uint8_t TxQueueDepth>
+struct XBeeStaticBuffers {
+    union {
+        XBeeLR lr;    ///< The XBee LR instance, for XBEE_LORA
+        XBee3RF rf;   ///< The XBee 3 RF instance, for XBEE_STANDARD
+    } xbeeStorage_; ///< The XBee instance itself
+    uint8_t rxBuffer_[MaxFrameSize]; ///< Receive buffer
+    XBeeTxEntry txTable_[TxQueueDepth]; ///< Outstanding transmissions
+    XBeeStorage storage_; ///< Description of the buffers passed to the library
+
+    XBeeStaticBuffers() {
+        storage_.rxBuffer = rxBuffer_;
+        storage_.rxBufferSize = MaxFrameSize;
+        storage_.txTable = txTable_;
+        storage_.txTableSize = TxQueueDepth;
+    }
+};
+
+/**
+ * @class XBeeArduinoStatic
+ * @brief XBeeArduino whose XBee instance and buffers are sized at compile time.
+ * 
+ * No heap memory is used: the instance, the receive buffer and the TX table are members 
+ * of this object, so declaring it as a global places everything in static RAM.
+ * 
+ * @code
+ * XBeeArduinoStatic<64, 2> xbee(&Serial1, 9600, XBEE_LORA, OnReceiveCallback, OnSendCallback);
+ * @endcode
+ * 
+ * @tparam MaxFrameSize Largest API frame (frame type + data) accepted from the module.
+ * @tparam TxQueueDepth Number of transmissions that can wait for their TX status at the same time.
+ */
+template <uint16_t MaxFrameSize = XBEE_MAX_FRAME_DATA_SIZE, uint8_t TxQueueDepth = XBEE_TX_TABLE_SIZE>
+class XBeeArduinoStatic : private XBeeStaticBuffers<MaxFrameSize, TxQueueDepth>, public XBeeArduino {
+public:
+    /**
+     * @brief Constructor for XBeeArduinoStatic class.
+     * 
+     * @param serialPort A pointer to a Stream object (HardwareSerial or SoftwareSerial).
+     * @param baudrate The baud rate for UART communication.
+     * @param moduleType The type of XBee module (standard or LoRa).
+     * @param onReceiveCallback A callback function to handle received data.
+     * @param onSendCallback A callback function to handle post-send events.
+     */
+    XBeeArduinoStatic(Stream* serialPort, uint32_t baudrate, XBeeModuleType moduleType,
+                      void (*onReceiveCallback)(void*),
+                      void (*onSendCallback)(void*))
+        : XBeeStaticBuffers<MaxFrameSize, TxQueueDepth>(),
+          XBeeArduino(serialPort, baudrate, moduleType, onReceiveCallback, onSendCallback,
+                      &this->xbeeStorage_.lr, &this->xbeeStorage_.rf, &this->storage_) {}
 };
 
 #endif  // XBEE_ARDUINO_H
\ No newline at end of file
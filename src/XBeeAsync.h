@@ -0,0 +1,418 @@
+#ifndef XBEE_ASYNC_H
+#define XBEE_ASYNC_H
+
+/**
+ * @file XBeeAsync.h
+ * @brief Futures and C++20 awaitables on top of the asynchronous TX and AT engines.
+ *
+ * `XBeeTxFuture` and `XBeeAtFuture` work with any compiler: start the operation, keep
+ * calling `XBeeArduino::process()` and poll `ready()`. The future must stay in scope until
+ * it is ready. No heap memory is used.
+ *
+ * With C++20 coroutines, a sketch can `co_await` the same operations from an `XBeeTask`.
+ * Coroutine frames come from a fixed pool of `XBEE_ASYNC_FRAMES` frames of
+ * `XBEE_ASYNC_FRAME_SIZE` bytes (config.h); an `XBeeTask` that does not fit is not started
+ * and reports `valid() == false`. Coroutines are resumed by `xbeeAsyncPoll()`, never from
+ * inside the library, so they may use any XBeeArduino method.
+ *
+ * @code
+ * XBeeTask telemetry(XBeeArduino& xbee, XBeeLRPacket_t& packet) {
+ *     XBeeAtResult<8> devEui = co_await xbeeQuery<8>(xbee, AT_DE);
+ *     for (;;) {
+ *         uint8_t status = co_await xbeeSend(xbee, packet);
+ *         co_await xbeeDelay(60000);
+ *     }
+ * }
+ *
+ * void loop() {
+ *     xbee.process();
+ *     xbeeAsyncPoll();
+ * }
+ * @endcode
+ *
+ * @version 1.0
+ * @date 2024-08-17
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "XBeeArduino.h"
+
+/**
+ * @struct XBeeAtResult
+ * @brief Outcome of an AT command: status and up to `N` bytes of response data.
+ */
+template <uint8_t N>
+struct XBeeAtResult {
+    bool ok;               ///< The module answered with status OK
+    uint8_t length;        ///< Bytes stored in data
+    uint8_t data[N];       ///< Response data in wire order
+
+    /**
+     * @brief Decodes up to the first 4 bytes as a big-endian number.
+     */
+    uint32_t value() const {
+        uint32_t result = 0;
+        for (uint8_t i = 0; (i < length) && (i < 4); i++) {
+            result = (result << 8) | data[i];
+        }
+        return result;
+    }
+};
+
+/**
+ * @class XBeeTxFuture
+ * @brief Caller-owned state of one uplink, completed by `XBeeArduino::process()`.
+ */
+class XBeeTxFuture {
+public:
+    XBeeTxFuture() : done_(true), status_(XBEE_TX_STATUS_TIMEOUT), frameId_(0) {}
+
+    /**
+     * @brief Queues the uplink.
+     * @param xbee Radio to send with.
+     * @param packet Packet to send, its payload must stay valid until the call returns.
+     * @return True if the uplink was queued. Otherwise the future is ready with `XBEE_TX_STATUS_TIMEOUT`.
+     */
+    bool start(XBeeArduino& xbee, XBeeLRPacket_t& packet) {
+        if (!done_) {
+            return false;  // Still waiting for the previous uplink
+        }
+        status_ = XBEE_TX_STATUS_TIMEOUT;
+        done_ = false;
+        frameId_ = xbee.sendDataAsync(packet, complete, this);
+        if (frameId_ == 0) {
+            done_ = true;
+        }
+        return frameId_ != 0;
+    }
+
+    bool ready() const { return done_; }          ///< True once the TX status arrived, timed out or the send failed
+    uint8_t status() const { return status_; }    ///< Delivery status, 0 if successful
+    uint8_t frameId() const { return frameId_; }  ///< Frame ID of the uplink, 0 if it was not sent
+
+private:
+    XBeeTxFuture(const XBeeTxFuture&);            ///< Not copyable, the library holds a pointer to it
+    XBeeTxFuture& operator=(const XBeeTxFuture&);
+
+    static void complete(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+        (void)self;
+        (void)frameId;
+        (void)report;
+        XBeeTxFuture* future = static_cast<XBeeTxFuture*>(ctx);
+        future->status_ = status;
+        future->done_ = true;
+    }
+
+    volatile bool done_;
+    uint8_t status_;
+    uint8_t frameId_;
+};
+
+/**
+ * @class XBeeAtFuture
+ * @brief Caller-owned state of one AT command, completed by `XBeeArduino::process()`.
+ * @tparam N Largest response kept, longer responses are truncated.
+ */
+template <uint8_t N = 16>
+class XBeeAtFuture {
+public:
+    XBeeAtFuture() : done_(true) {
+        result_.ok = false;
+        result_.length = 0;
+    }
+
+    /**
+     * @brief Sends the AT command.
+     * @param xbee Radio to send with.
+     * @param command AT command.
+     * @param parameter Value to set, or nullptr to query the parameter.
+     * @param paramLength Length of the value.
+     * @return True if the command was sent. Otherwise the future is ready and not ok.
+     */
+    bool start(XBeeArduino& xbee, at_command_t command, const uint8_t* parameter = nullptr, uint8_t paramLength = 0) {
+        if (!done_) {
+            return false;  // Still waiting for the previous response
+        }
+        result_.ok = false;
+        result_.length = 0;
+        apiAtRequestInit(&request_, result_.data, N, complete, this);
+        done_ = false;
+        if (!xbee.sendAtCommandAsync(request_, command, parameter, paramLength)) {
+            done_ = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool ready() const { return done_; }                        ///< True once the response arrived, timed out or the send failed
+    bool ok() const { return done_ && result_.ok; }                ///< The module answered with status OK
+    const XBeeAtResult<N>& result() const { return result_; }    ///< Response, valid once ready
+
+private:
+    XBeeAtFuture(const XBeeAtFuture&);            ///< Not copyable, the library holds a pointer to it
+    XBeeAtFuture& operator=(const XBeeAtFuture&);
+
+    static void complete(XBee* self, xbee_at_request_t* request) {
+        (void)self;
+        XBeeAtFuture* future = static_cast<XBeeAtFuture*>(request->ctx);
+        future->result_.ok = (request->result == API_SEND_SUCCESS);
+        future->result_.length = (request->responseLength < N) ? request->responseLength : N;
+        future->done_ = true;
+    }
+
+    xbee_at_request_t request_;
+    XBeeAtResult<N> result_;
+    volatile bool done_;
+};
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define XBEE_ASYNC_COROUTINES 1
+#endif
+#endif
+
+#if defined(XBEE_ASYNC_COROUTINES)
+#include <coroutine>
+#include <new>
+
+namespace xbee_async_detail {
+
+// Suspended coroutine, linked into the list polled by xbeeAsyncPoll(); lives in the awaiter
+struct Waiter {
+    std::coroutine_handle<> handle;
+    bool (*ready)(const void* ctx);   ///< Returns true once the coroutine can resume
+    const void* ctx;                  ///< Awaiter passed to ready
+    Waiter* next;
+};
+
+inline Waiter*& waiting() {
+    static Waiter* head = nullptr;
+    return head;
+}
+
+inline void suspend(Waiter* waiter, std::coroutine_handle<> handle, bool (*ready)(const void*), const void* ctx) {
+    waiter->handle = handle;
+    waiter->ready = ready;
+    waiter->ctx = ctx;
+    waiter->next = waiting();
+    waiting() = waiter;
+}
+
+// Fixed pool the coroutine frames of XBeeTask are allocated from
+struct FramePool {
+    alignas(alignof(max_align_t)) unsigned char frames[XBEE_ASYNC_FRAMES][XBEE_ASYNC_FRAME_SIZE];
+    bool used[XBEE_ASYNC_FRAMES];
+};
+
+inline FramePool& pool() {
+    static FramePool framePool = {};
+    return framePool;
+}
+
+} // namespace xbee_async_detail
+
+/**
+ * @class XBeeTask
+ * @brief Fire-and-forget coroutine that can `co_await` radio operations.
+ *
+ * The coroutine starts running when it is called and its frame returns to the pool
+ * when it finishes.
+ */
+class XBeeTask {
+public:
+    struct promise_type {
+        XBeeTask get_return_object() noexcept { return XBeeTask(true); }
+        static XBeeTask get_return_object_on_allocation_failure() noexcept { return XBeeTask(false); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {}
+
+        static void* operator new(size_t size) noexcept {
+            xbee_async_detail::FramePool& framePool = xbee_async_detail::pool();
+            if (size > XBEE_ASYNC_FRAME_SIZE) {
+                return nullptr;  // Raise XBEE_ASYNC_FRAME_SIZE
+            }
+            for (uint8_t i = 0; i < XBEE_ASYNC_FRAMES; i++) {
+                if (!framePool.used[i]) {
+                    framePool.used[i] = true;
+                    return framePool.frames[i];
+                }
+            }
+            return nullptr;
+        }
+
+        static void operator delete(void* frame) noexcept {
+            xbee_async_detail::FramePool& framePool = xbee_async_detail::pool();
+            for (uint8_t i = 0; i < XBEE_ASYNC_FRAMES; i++) {
+                if (frame == framePool.frames[i]) {
+                    framePool.used[i] = false;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Returns false if the coroutine did not start because the frame pool was exhausted.
+     */
+    bool valid() const { return valid_; }
+
+private:
+    explicit XBeeTask(bool valid) : valid_(valid) {}
+    bool valid_;
+};
+
+/**
+ * @class XBeeSendAwaiter
+ * @brief Result of `xbeeSend()`; `co_await` yields the delivery status.
+ */
+class XBeeSendAwaiter {
+public:
+    XBeeSendAwaiter(XBeeArduino& xbee, XBeeLRPacket_t& packet) : xbee_(xbee), packet_(packet) {}
+
+    bool await_ready() {
+        // Started here, once the awaiter has its final address in the coroutine frame
+        future_.start(xbee_, packet_);
+        return future_.ready();
+    }
+    void await_suspend(std::coroutine_handle<> handle) { xbee_async_detail::suspend(&waiter_, handle, ready, this); }
+    uint8_t await_resume() const { return future_.status(); }
+
+private:
+    static bool ready(const void* ctx) { return static_cast<const XBeeSendAwaiter*>(ctx)->future_.ready(); }
+
+    XBeeArduino& xbee_;
+    XBeeLRPacket_t& packet_;
+    XBeeTxFuture future_;
+    xbee_async_detail::Waiter waiter_;
+};
+
+/**
+ * @class XBeeQueryAwaiter
+ * @brief Result of `xbeeQuery()`; `co_await` yields an `XBeeAtResult`.
+ */
+template <uint8_t N>
+class XBeeQueryAwaiter {
+public:
+    XBeeQueryAwaiter(XBeeArduino& xbee, at_command_t command, const uint8_t* parameter, uint8_t paramLength)
+        : xbee_(xbee), command_(command), parameter_(parameter), paramLength_(paramLength) {}
+
+    bool await_ready() {
+        future_.start(xbee_, command_, parameter_, paramLength_);
+        return future_.ready();
+    }
+    void await_suspend(std::coroutine_handle<> handle) { xbee_async_detail::suspend(&waiter_, handle, ready, this); }
+    XBeeAtResult<N> await_resume() const { return future_.result(); }
+
+private:
+    static bool ready(const void* ctx) { return static_cast<const XBeeQueryAwaiter*>(ctx)->future_.ready(); }
+
+    XBeeArduino& xbee_;
+    at_command_t command_;
+    const uint8_t* parameter_;
+    uint8_t paramLength_;
+    XBeeAtFuture<N> future_;
+    xbee_async_detail::Waiter waiter_;
+};
+
+/**
+ * @class XBeeDelayAwaiter
+ * @brief Result of `xbeeDelay()`, resumes the coroutine once the time has passed.
+ */
+class XBeeDelayAwaiter {
+public:
+    explicit XBeeDelayAwaiter(uint32_t ms) : start_(millis()), ms_(ms) {}
+
+    bool await_ready() const { return ms_ == 0; }
+    void await_suspend(std::coroutine_handle<> handle) { xbee_async_detail::suspend(&waiter_, handle, ready, this); }
+    void await_resume() const {}
+
+private:
+    static bool ready(const void* ctx) {
+        const XBeeDelayAwaiter* delay = static_cast<const XBeeDelayAwaiter*>(ctx);
+        return (uint32_t)(millis() - delay->start_) >= delay->ms_;
+    }
+
+    uint32_t start_;
+    uint32_t ms_;
+    xbee_async_detail::Waiter waiter_;
+};
+
+/**
+ * @brief Sends an uplink; `co_await` it for the delivery status.
+ * @param xbee Radio to send with.
+ * @param packet Packet to send, must stay valid while awaited.
+ */
+inline XBeeSendAwaiter xbeeSend(XBeeArduino& xbee, XBeeLRPacket_t& packet) {
+    return XBeeSendAwaiter(xbee, packet);
+}
+
+/**
+ * @brief Sends an AT command; `co_await` it for the response.
+ * @tparam N Largest response kept.
+ * @param xbee Radio to send with.
+ * @param command AT command.
+ * @param parameter Value to set, or nullptr to query the parameter.
+ * @param paramLength Length of the value.
+ */
+template <uint8_t N = 16>
+inline XBeeQueryAwaiter<N> xbeeQuery(XBeeArduino& xbee, at_command_t command,
+                                     const uint8_t* parameter = nullptr, uint8_t paramLength = 0) {
+    return XBeeQueryAwaiter<N>(xbee, command, parameter, paramLength);
+}
+
+/**
+ * @brief Suspends the coroutine for `ms` milliseconds without blocking the sketch.
+ */
+inline XBeeDelayAwaiter xbeeDelay(uint32_t ms) {
+    return XBeeDelayAwaiter(ms);
+}
+
+/**
+ * @brief Resumes every coroutine whose operation completed or whose delay expired.
+ *
+ * Call it from the loop after `XBeeArduino::process()`.
+ *
+ * @return uint8_t Number of coroutines resumed.
+ */
+inline uint8_t xbeeAsyncPoll() {
+    uint8_t resumed = 0;
+    xbee_async_detail::Waiter** link = &xbee_async_detail::waiting();
+    while (*link != nullptr) {
+        xbee_async_detail::Waiter* waiter = *link;
+        if (!waiter->ready(waiter->ctx)) {
+            link = &waiter->next;
+            continue;
+        }
+        // Unlinked first: the coroutine may suspend again, which pushes a new waiter
+        *link = waiter->next;
+        waiter->handle.resume();
+        resumed++;
+        link = &xbee_async_detail::waiting();
+    }
+    return resumed;
+}
+
+#endif // XBEE_ASYNC_COROUTINES
+
+#endif // XBEE_ASYNC_H
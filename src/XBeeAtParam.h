@@ -0,0 +1,210 @@
+#ifndef XBEE_AT_PARAM_H
+#define XBEE_AT_PARAM_H
+
+/**
+ * @file XBeeAtParam.h
+ * @brief Typed, big-endian encoding of AT command parameters for C++ code.
+ * 
+ * Values are encoded into wire order by constexpr functions, so constant parameters 
+ * are built by the compiler. `xbeeSetParam<Command>()` checks the encoded 
+ * width against the command at build time, which turns a wrong width (e.g. a 1 byte 
+ * value for the 4 byte RX2 frequency) into a compile error instead of a silently 
+ * misconfigured module.
+ * 
+ * @code
+ * xbeeSetParam<AT_XF>(xbee, xbeeAtUint32(869525000UL));
+ * xbeeSetParam<AT_AE>(xbee, xbeeAtString("37D56A3F6CDCF0A5"));
+ * @endcode
+ * 
+ * @version 1.0
+ * @date 2024-08-17
+ * 
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "xbee.h"
+
+/**
+ * @struct XBeeAtValue
+ * @brief Parameter value of `N` bytes in wire order.
+ */
+template <uint8_t N>
+struct XBeeAtValue {
+    enum { length = N };   ///< Number of bytes sent
+    uint8_t data[N];       ///< Bytes in the order they are sent
+    bool valid;            ///< False if the source held characters that are not hex digits, such a value is never sent
+};
+
+/**
+ * @brief Encodes an 8-bit numeric parameter.
+ */
+constexpr XBeeAtValue<1> xbeeAtUint8(uint8_t value) {
+    return XBeeAtValue<1>{{value}, true};
+}
+
+/**
+ * @brief Encodes a 16-bit numeric parameter, big-endian.
+ */
+constexpr XBeeAtValue<2> xbeeAtUint16(uint16_t value) {
+    return XBeeAtValue<2>{{(uint8_t)(value >> 8), (uint8_t)value}, true};
+}
+
+/**
+ * @brief Encodes a 32-bit numeric parameter, big-endian.
+ */
+constexpr XBeeAtValue<4> xbeeAtUint32(uint32_t value) {
+    return XBeeAtValue<4>{{(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value}, true};
+}
+
+// Indices 0..N-1 as a parameter pack, so the array encoders stay single-return constexpr functions under C++11
+template <size_t... I>
+struct XBeeAtIndices {};
+
+template <size_t N, size_t... I>
+struct XBeeAtMakeIndices : XBeeAtMakeIndices<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct XBeeAtMakeIndices<0, I...> {
+    typedef XBeeAtIndices<I...> type;
+};
+
+template <size_t M, size_t N, size_t... I>
+constexpr XBeeAtValue<M> xbeeAtCopy(const uint8_t (&bytes)[N], XBeeAtIndices<I...>) {
+    return XBeeAtValue<M>{{bytes[I]...}, true};
+}
+
+template <size_t M, size_t N, size_t... I>
+constexpr XBeeAtValue<M> xbeeAtCopy(const char (&text)[N], XBeeAtIndices<I...>) {
+    return XBeeAtValue<M>{{(uint8_t)text[I]...}, true};
+}
+
+/**
+ * @brief Copies raw bytes into a parameter value.
+ */
+template <size_t N>
+constexpr XBeeAtValue<N> xbeeAtBytes(const uint8_t (&bytes)[N]) {
+    static_assert(N <= 255, "AT parameters are limited to 255 bytes");
+    return xbeeAtCopy<N>(bytes, typename XBeeAtMakeIndices<N>::type());
+}
+
+/**
+ * @brief Encodes a string literal as sent by the string setters (e.g. `XBeeLRSetAppEUI()`), 
+ * without its terminator.
+ */
+template <size_t N>
+constexpr XBeeAtValue<N - 1> xbeeAtString(const char (&text)[N]) {
+    static_assert((N > 1) && (N <= 256), "AT string parameters must hold 1 to 255 characters");
+    return xbeeAtCopy<N - 1>(text, typename XBeeAtMakeIndices<N - 1>::type());
+}
+
+constexpr bool xbeeAtIsHexDigit(char c) {
+    return ((c >= '0') && (c <= '9')) || ((c >= 'A') && (c <= 'F')) || ((c >= 'a') && (c <= 'f'));
+}
+
+// Not constexpr: reaching it while the compiler evaluates a constant parameter, i.e. for a non hex digit, fails the build
+inline uint8_t xbeeAtInvalidHexDigit() {
+    return 0;
+}
+
+// Value of one hex digit, upper or lower case
+constexpr uint8_t xbeeAtHexDigit(char c) {
+    return !xbeeAtIsHexDigit(c) ? xbeeAtInvalidHexDigit()
+        : (c >= 'a') ? (uint8_t)(c - 'a' + 10) : (c >= 'A') ? (uint8_t)(c - 'A' + 10) : (uint8_t)(c - '0');
+}
+
+// True if the `count` digit pairs from `hex` are all hex digits; recurses once per byte to stay below the constexpr depth limit
+constexpr bool xbeeAtHexValid(const char* hex, size_t count) {
+    return (count == 0) || (xbeeAtIsHexDigit(hex[0]) && xbeeAtIsHexDigit(hex[1]) && xbeeAtHexValid(hex + 2, count - 1));
+}
+
+template <size_t M, size_t N, size_t... I>
+constexpr XBeeAtValue<M> xbeeAtDecodeHex(const char (&hex)[N], XBeeAtIndices<I...>) {
+    return XBeeAtValue<M>{{(uint8_t)((xbeeAtHexDigit(hex[2 * I]) << 4) | xbeeAtHexDigit(hex[2 * I + 1]))...},
+        xbeeAtHexValid(hex, M)};
+}
+
+/**
+ * @brief Decodes a hex string literal (e.g. "0013A200") into binary bytes.
+ * 
+ * A character that is not a hex digit fails the build where the value is a constant 
+ * expression (e.g. a `constexpr` variable). Otherwise the value is marked invalid and 
+ * `xbeeSetParam()` refuses it.
+ */
+template <size_t N>
+constexpr XBeeAtValue<(N - 1) / 2> xbeeAtHex(const char (&hex)[N]) {
+    static_assert(((N - 1) % 2) == 0, "Hex parameters need an even number of digits");
+    static_assert((N > 1) && (N <= 511), "Hex parameters must hold 1 to 255 bytes");
+    return xbeeAtDecodeHex<(N - 1) / 2>(hex, typename XBeeAtMakeIndices<(N - 1) / 2>::type());
+}
+
+/**
+ * @struct XBeeAtParamWidth
+ * @brief Parameter width, in bytes, expected by an AT command.
+ * 
+ * Only declared for commands whose width is known; using `xbeeSetParam()` with any 
+ * other command fails to build.
+ */
+template <at_command_t Command>
+struct XBeeAtParamWidth;
+
+#define XBEE_AT_PARAM_WIDTH(command, width) \
+    template <> struct XBeeAtParamWidth<command> { enum { value = width }; }
+
+XBEE_AT_PARAM_WIDTH(AT_AP, 1);      ///< API Enable
+XBEE_AT_PARAM_WIDTH(AT_AO, 1);      ///< API Options
+XBEE_AT_PARAM_WIDTH(AT_BD, 4);      ///< Baud Rate
+XBEE_AT_PARAM_WIDTH(AT_AE, 16);     ///< LoRaWAN Application EUI, as hex characters
+XBEE_AT_PARAM_WIDTH(AT_AK, 32);     ///< LoRaWAN Application Key, as hex characters
+XBEE_AT_PARAM_WIDTH(AT_NK, 32);     ///< LoRaWAN Network Key, as hex characters
+XBEE_AT_PARAM_WIDTH(AT_LC, 1);      ///< LoRaWAN Class
+XBEE_AT_PARAM_WIDTH(AT_AM, 1);      ///< LoRaWAN Activation Mode
+XBEE_AT_PARAM_WIDTH(AT_AD, 1);      ///< LoRaWAN ADR
+XBEE_AT_PARAM_WIDTH(AT_DR, 1);      ///< LoRaWAN DataRate
+XBEE_AT_PARAM_WIDTH(AT_LR, 1);      ///< LoRaWAN Region
+XBEE_AT_PARAM_WIDTH(AT_J1, 4);      ///< LoRaWAN Join RX1 Delay
+XBEE_AT_PARAM_WIDTH(AT_J2, 4);      ///< LoRaWAN Join RX2 Delay
+XBEE_AT_PARAM_WIDTH(AT_D1, 4);      ///< LoRaWAN RX1 Delay
+XBEE_AT_PARAM_WIDTH(AT_D2, 4);      ///< LoRaWAN RX2 Delay
+XBEE_AT_PARAM_WIDTH(AT_XD, 1);      ///< LoRaWAN RX2 Data Rate
+XBEE_AT_PARAM_WIDTH(AT_XF, 4);      ///< LoRaWAN RX2 Frequency
+XBEE_AT_PARAM_WIDTH(AT_PO, 1);      ///< LoRaWAN Transmit Power
+
+/**
+ * @brief Sets a module parameter from a typed value, checking its width at build time.
+ * 
+ * Goes through `XBeeSetParameter()`, so the parameter shadow and open configuration 
+ * batches apply as for the C setters.
+ * 
+ * @tparam Command The AT command of the parameter.
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] value Encoded parameter value.
+ * 
+ * @return bool Returns true if the module accepted the value (or already held it), otherwise 
+ * false, also for a value marked invalid by its encoder.
+ */
+template <at_command_t Command, uint8_t N>
+inline bool xbeeSetParam(XBee* self, const XBeeAtValue<N>& value) {
+    static_assert(N == (uint8_t)XBeeAtParamWidth<Command>::value, "Parameter width does not match the AT command");
+    return value.valid && XBeeSetParameter(self, Command, value.data, N);
+}
+
+#endif // XBEE_AT_PARAM_H
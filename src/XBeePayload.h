@@ -0,0 +1,453 @@
+#ifndef XBEE_PAYLOAD_H
+#define XBEE_PAYLOAD_H
+
+/**
+ * @file XBeePayload.h
+ * @brief Schema driven bit packing of LoRaWAN payloads.
+ * 
+ * A schema is a list of field descriptors: fixed bit width with integer scaling and 
+ * offset, zigzag coded delta against the previous record, or varint. Records are 
+ * packed MSB first into a bitstream, written straight into the buffer that 
+ * `XBeeLRPacket_t.payload` points to (the TX path streams the payload from that 
+ * buffer, so there is no further copy). Downlinks are decoded in place from the 
+ * received `XBeeLRPacket_t.payload`.
+ * 
+ * For schemas without varint fields the encoded size is a compile-time constant:
+ * 
+ * @code
+ * typedef XBeeSchema<
+ *     XBeeFieldUInt<7>,                 // battery, 0-100 %
+ *     XBeeFieldUInt<10, -400, 10>,      // temperature, -40.0-62.3 C in 0.1 C steps
+ *     XBeeFieldDelta<13>                // pulse counter, change of -4096 to 4095 since the last record
+ * > SensorRecord;
+ * static_assert(SensorRecord::maxBytes == 4, "record must fit 4 bytes");
+ * 
+ * uint8_t payload[SensorRecord::maxBytes];
+ * SensorRecord::State state;  // The first record's delta is taken against 0
+ * XBeePayloadWriter writer(payload, sizeof(payload));
+ * const float values[] = {87, 21.5f, 1234};
+ * if (SensorRecord::encode(writer, state, values)) {
+ *     packet.payload = payload;
+ *     packet.payloadSize = writer.length();
+ * }
+ * @endcode
+ * 
+ * `encode()` returns false, and writes nothing, when a value does not fit its field, 
+ * e.g. a delta larger than the field holds.
+ * 
+ * @version 1.0
+ * @date 2024-08-17
+ * 
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @class XBeePayloadWriter
+ * @brief Writes bit fields MSB first into a caller provided buffer.
+ */
+class XBeePayloadWriter {
+public:
+    /**
+     * @brief Starts writing at the beginning of a buffer.
+     * @param buffer Destination buffer, usually the TX packet payload.
+     * @param capacity Size of the buffer in bytes.
+     */
+    XBeePayloadWriter(uint8_t* buffer, uint8_t capacity) 
+        : buffer_(buffer), capacity_(capacity), bitPos_(0), overflow_(false) {}
+
+    /**
+     * @brief Appends the low `bits` bits of a value.
+     * @param value Value to write.
+     * @param bits Number of bits, 1 to 32.
+     * @return True on success, false if the buffer is full.
+     */
+    bool write(uint32_t value, uint8_t bits) {
+        if ((bits == 0) || (bits > 32) || ((uint32_t)bitPos_ + bits > (uint32_t)capacity_ * 8)) {
+            overflow_ = true;
+            return false;
+        }
+        while (bits > 0) {
+            uint8_t used = bitPos_ & 7;
+            uint8_t take = (uint8_t)(8 - used);
+            if (take > bits) {
+                take = bits;
+            }
+            uint8_t chunk = (uint8_t)((value >> (bits - take)) & ((1u << take) - 1));
+            uint8_t* dst = &buffer_[bitPos_ >> 3];
+            if (used == 0) {
+                *dst = 0;
+            }
+            *dst |= (uint8_t)(chunk << (8 - used - take));
+            bitPos_ += take;
+            bits -= take;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Appends a value as 7-bit groups, each preceded by a continuation bit.
+     * @param value Value to write.
+     * @return True on success, false if the buffer is full.
+     */
+    bool writeVarint(uint32_t value) {
+        do {
+            uint8_t group = (uint8_t)(value & 0x7F);
+            value >>= 7;
+            if (!write((value != 0) ? (0x80u | group) : group, 8)) {
+                return false;
+            }
+        } while (value != 0);
+        return true;
+    }
+
+    /**
+     * @brief Returns the number of bytes used so far, including a partial last byte.
+     */
+    uint8_t length() const { return (uint8_t)((bitPos_ + 7) >> 3); }
+
+    /**
+     * @brief Returns the number of bits written so far.
+     */
+    uint16_t bitLength() const { return bitPos_; }
+
+    /**
+     * @brief Returns true if a write did not fit into the buffer.
+     */
+    bool overflow() const { return overflow_; }
+
+    /**
+     * @brief Drops everything written after `bits` bits, e.g. a record that failed to encode.
+     * @param bits Bit position to return to, not beyond the current position.
+     */
+    void truncate(uint16_t bits) {
+        if (bits < bitPos_) {
+            bitPos_ = bits;
+            if ((bitPos_ & 7) != 0) {
+                buffer_[bitPos_ >> 3] &= (uint8_t)(0xFF << (8 - (bitPos_ & 7)));
+            }
+        }
+    }
+
+private:
+    uint8_t* buffer_;
+    uint8_t capacity_;
+    uint16_t bitPos_;
+    bool overflow_;
+};
+
+/**
+ * @class XBeePayloadReader
+ * @brief Reads bit fields MSB first, in place, from a received payload.
+ */
+class XBeePayloadReader {
+public:
+    /**
+     * @brief Starts reading at the beginning of a buffer.
+     * @param buffer Source buffer, e.g. the `payload` of a received XBeeLRPacket_t.
+     * @param length Number of valid bytes in the buffer.
+     */
+    XBeePayloadReader(const uint8_t* buffer, uint8_t length) 
+        : buffer_(buffer), length_(length), bitPos_(0), underflow_(false) {}
+
+    /**
+     * @brief Reads `bits` bits.
+     * @param value Receives the value.
+     * @param bits Number of bits, 1 to 32.
+     * @return True on success, false if the payload is too short.
+     */
+    bool read(uint32_t& value, uint8_t bits) {
+        if ((bits == 0) || (bits > 32) || ((uint32_t)bitPos_ + bits > (uint32_t)length_ * 8)) {
+            underflow_ = true;
+            return false;
+        }
+        value = 0;
+        while (bits > 0) {
+            uint8_t used = bitPos_ & 7;
+            uint8_t take = (uint8_t)(8 - used);
+            if (take > bits) {
+                take = bits;
+            }
+            uint8_t chunk = (uint8_t)((buffer_[bitPos_ >> 3] >> (8 - used - take)) & ((1u << take) - 1));
+            value = (value << take) | chunk;
+            bitPos_ += take;
+            bits -= take;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads a value written with XBeePayloadWriter::writeVarint().
+     * @param value Receives the value.
+     * @return True on success, false if the payload is too short or the varint is too long.
+     */
+    bool readVarint(uint32_t& value) {
+        value = 0;
+        for (uint8_t shift = 0; shift < 35; shift += 7) {
+            uint32_t group;
+            if (!read(group, 8)) {
+                return false;
+            }
+            value |= (group & 0x7F) << shift;
+            if ((group & 0x80) == 0) {
+                return true;
+            }
+        }
+        underflow_ = true;
+        return false;
+    }
+
+    /**
+     * @brief Returns the number of unread bits.
+     */
+    uint16_t remainingBits() const { return (uint16_t)(length_ * 8 - bitPos_); }
+
+    /**
+     * @brief Returns true if a read ran past the end of the payload.
+     */
+    bool underflow() const { return underflow_; }
+
+private:
+    const uint8_t* buffer_;
+    uint8_t length_;
+    uint16_t bitPos_;
+    bool underflow_;
+};
+
+// Rounds to the nearest integer without pulling in libm
+inline int32_t xbeePayloadRound(float value) {
+    return (int32_t)((value >= 0.0f) ? (value + 0.5f) : (value - 0.5f));
+}
+
+// Zigzag coding maps signed values onto unsigned ones: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+inline uint32_t xbeePayloadZigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+inline int32_t xbeePayloadUnzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+ * @struct XBeeFieldUInt
+ * @brief Fixed width field holding `round(value * Scale) - Offset`.
+ * 
+ * @tparam Bits Width of the field, 1 to 32.
+ * @tparam Offset Subtracted after scaling, so the smallest value encodes as 0.
+ * @tparam Scale Multiplier applied first, e.g. 10 for 0.1 resolution.
+ */
+template <uint8_t Bits, int32_t Offset = 0, uint16_t Scale = 1>
+struct XBeeFieldUInt {
+    static_assert((Bits >= 1) && (Bits <= 32), "Field width must be 1 to 32 bits");
+    static_assert(Scale != 0, "Scale must not be 0");
+    enum { bits = Bits, fixedSize = 1 };
+
+    static bool encode(XBeePayloadWriter& writer, float value, int32_t& previous) {
+        (void)previous;
+        int32_t raw = xbeePayloadRound(value * Scale) - Offset;
+        if ((raw < 0) || ((Bits < 32) && ((uint32_t)raw >> (Bits - 1) >> 1) != 0)) {
+            return false;  // Out of range for the field
+        }
+        return writer.write((uint32_t)raw, Bits);
+    }
+
+    static bool decode(XBeePayloadReader& reader, float& value, int32_t& previous) {
+        (void)previous;
+        uint32_t raw;
+        if (!reader.read(raw, Bits)) {
+            return false;
+        }
+        value = (float)((int32_t)raw + Offset) / Scale;
+        return true;
+    }
+};
+
+/**
+ * @struct XBeeFieldDelta
+ * @brief Fixed width field holding the zigzag coded change against the previous record.
+ * 
+ * The previous value is kept in the schema's State; a freshly initialized State makes 
+ * the first record relative to 0.
+ * 
+ * @tparam Bits Width of the field, 2 to 32.
+ * @tparam Scale Multiplier applied before the difference is taken.
+ */
+template <uint8_t Bits, uint16_t Scale = 1>
+struct XBeeFieldDelta {
+    static_assert((Bits >= 2) && (Bits <= 32), "Delta field width must be 2 to 32 bits");
+    static_assert(Scale != 0, "Scale must not be 0");
+    enum { bits = Bits, fixedSize = 1 };
+
+    static bool encode(XBeePayloadWriter& writer, float value, int32_t& previous) {
+        int32_t current = xbeePayloadRound(value * Scale);
+        uint32_t coded = xbeePayloadZigzag(current - previous);
+        if ((Bits < 32) && ((coded >> (Bits - 1) >> 1) != 0)) {
+            return false;  // Change too large for the field
+        }
+        if (!writer.write(coded, Bits)) {
+            return false;
+        }
+        previous = current;
+        return true;
+    }
+
+    static bool decode(XBeePayloadReader& reader, float& value, int32_t& previous) {
+        uint32_t coded;
+        if (!reader.read(coded, Bits)) {
+            return false;
+        }
+        previous += xbeePayloadUnzigzag(coded);
+        value = (float)previous / Scale;
+        return true;
+    }
+};
+
+/**
+ * @struct XBeeFieldVarint
+ * @brief Variable width field, 8 bits per 7 bits of value.
+ * 
+ * @tparam Signed Zigzag code the value so small negative values stay short.
+ * @tparam Scale Multiplier applied first.
+ */
+template <bool Signed = false, uint16_t Scale = 1>
+struct XBeeFieldVarint {
+    static_assert(Scale != 0, "Scale must not be 0");
+    enum { bits = 40, fixedSize = 0 };   ///< Largest encoding of a 32 bit value
+
+    static bool encode(XBeePayloadWriter& writer, float value, int32_t& previous) {
+        (void)previous;
+        int32_t raw = xbeePayloadRound(value * Scale);
+        if (!Signed && (raw < 0)) {
+            return false;
+        }
+        return writer.writeVarint(Signed ? xbeePayloadZigzag(raw) : (uint32_t)raw);
+    }
+
+    static bool decode(XBeePayloadReader& reader, float& value, int32_t& previous) {
+        (void)previous;
+        uint32_t raw;
+        if (!reader.readVarint(raw)) {
+            return false;
+        }
+        value = (float)(Signed ? xbeePayloadUnzigzag(raw) : (int32_t)raw) / Scale;
+        return true;
+    }
+};
+
+// Compile-time sums over the fields of a schema
+template <typename... Fields>
+struct XBeeSchemaTraits {
+    enum { bits = 0, fixedSize = 1 };
+};
+
+template <typename Field, typename... Rest>
+struct XBeeSchemaTraits<Field, Rest...> {
+    enum { 
+        bits = Field::bits + XBeeSchemaTraits<Rest...>::bits,
+        fixedSize = Field::fixedSize && XBeeSchemaTraits<Rest...>::fixedSize
+    };
+};
+
+// Field by field encoding and decoding, starting at field Index
+template <uint8_t Index, typename... Fields>
+struct XBeeSchemaCodec {
+    static bool encode(XBeePayloadWriter&, int32_t*, const float*) { return true; }
+    static bool decode(XBeePayloadReader&, int32_t*, float*) { return true; }
+};
+
+template <uint8_t Index, typename Field, typename... Rest>
+struct XBeeSchemaCodec<Index, Field, Rest...> {
+    static bool encode(XBeePayloadWriter& writer, int32_t* previous, const float* values) {
+        return Field::encode(writer, values[Index], previous[Index]) && 
+            XBeeSchemaCodec<Index + 1, Rest...>::encode(writer, previous, values);
+    }
+    static bool decode(XBeePayloadReader& reader, int32_t* previous, float* values) {
+        return Field::decode(reader, values[Index], previous[Index]) && 
+            XBeeSchemaCodec<Index + 1, Rest...>::decode(reader, previous, values);
+    }
+};
+
+/**
+ * @struct XBeeSchema
+ * @brief Record layout made of field descriptors.
+ * 
+ * `maxBits`/`maxBytes` give the largest encoded record; for schemas without varint 
+ * fields (`fixedSize` set) every record has exactly that size.
+ */
+template <typename... Fields>
+struct XBeeSchema {
+    enum {
+        fieldCount = sizeof...(Fields),
+        maxBits = XBeeSchemaTraits<Fields...>::bits,
+        maxBytes = (XBeeSchemaTraits<Fields...>::bits + 7) / 8,
+        fixedSize = XBeeSchemaTraits<Fields...>::fixedSize
+    };
+    static_assert(sizeof...(Fields) > 0, "A schema needs at least one field");
+
+    /**
+     * @brief Previous values of the delta fields, one stream per State.
+     */
+    struct State {
+        int32_t previous[sizeof...(Fields)];
+        State() { reset(); }
+        void reset() {
+            for (uint8_t i = 0; i < sizeof...(Fields); i++) {
+                previous[i] = 0;
+            }
+        }
+    };
+
+    /**
+     * @brief Appends one record; several records can be packed back to back.
+     * 
+     * A record that fails to encode is removed again, leaving the writer and the state 
+     * as they were before the call.
+     * 
+     * @param writer Destination.
+     * @param state Delta state of the stream.
+     * @param values One value per field, in schema order.
+     * @return True on success, false if a value is out of range or the buffer is full.
+     */
+    static bool encode(XBeePayloadWriter& writer, State& state, const float (&values)[sizeof...(Fields)]) {
+        uint16_t start = writer.bitLength();
+        State saved = state;
+        if (!XBeeSchemaCodec<0, Fields...>::encode(writer, state.previous, values)) {
+            writer.truncate(start);
+            state = saved;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads one record.
+     * @param reader Source, e.g. over the received packet's payload.
+     * @param state Delta state of the stream.
+     * @param values Receives one value per field, in schema order.
+     * @return True on success, false if the payload is too short.
+     */
+    static bool decode(XBeePayloadReader& reader, State& state, float (&values)[sizeof...(Fields)]) {
+        return XBeeSchemaCodec<0, Fields...>::decode(reader, state.previous, values);
+    }
+};
+
+#endif // XBEE_PAYLOAD_H
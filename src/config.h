@@ -41,7 +41,95 @@ extern "C"
 
 // Constants
 #define UART_READ_TIMEOUT_MS 100
-#define UART_WRITE_TIMEOUT_MS 10
+#define UART_WRITE_TIMEOUT_MS 10 // Added to the time the frame takes on the wire at the current baud rate
+
+// Largest API frame data (frame type + payload) sent, and accepted by instances created with XBeeLRCreate()
+#define XBEE_MAX_FRAME_DATA_SIZE 256
+
+// Number of transmissions that can wait for a TX status frame at the same time (XBeeLRCreate() instances)
+#define XBEE_TX_TABLE_SIZE 4
+
+// Number of distinct frame handlers an instance can hold; several frame types may share one
+#define XBEE_FRAME_HANDLER_SLOTS 8
+
+// Power of two buckets of the latency histograms in XBeeStats, the last one collects the overflow
+#define XBEE_STATS_HISTOGRAM_BUCKETS 16
+
+// API mode the host speaks until XBeeSetAPIMode()/XBeeSetHostAPIMode(): 1 (AP=1) or 2 (escaped, AP=2)
+#define XBEE_API_MODE_DEFAULT 1
+
+// Time the module needs to switch its UART after ATAC applied a new BD, and the time it has to answer the probe
+#define XBEE_BAUD_SWITCH_DELAY_MS 20
+#define XBEE_BAUD_PROBE_TIMEOUT_MS 500
+
+// Port layer: bytes buffered in the host UART above which RTS holds off the module (hardware flow control)
+#define XBEE_FLOW_CONTROL_RX_THRESHOLD 32
+
+// Number of parameters a configuration batch can queue before it has to be committed
+#define XBEE_CONFIG_BATCH_SIZE 16
+
+// Parameter shadow cache: number of written values remembered, and immutable values read once
+#define XBEE_SHADOW_WRITE_ENTRIES 16
+#define XBEE_SHADOW_READ_ENTRIES 3
+#define XBEE_SHADOW_READ_VALUE_SIZE 20
+
+// Default LoRaWAN join policy: attempts, first retry delay and retry delay cap
+#define XBEE_LR_JOIN_ATTEMPTS 1
+#define XBEE_LR_JOIN_BACKOFF_MS 10000
+#define XBEE_LR_JOIN_MAX_BACKOFF_MS 300000
+
+// Region and data rate assumed for airtime estimates until they are set or reported (EU868, DR0)
+#define XBEE_LR_DEFAULT_REGION 0
+#define XBEE_LR_DEFAULT_DATA_RATE 0
+
+// Uplink scheduler: queued packets, tracked sub-bands, default duty cycle (1/divisor, 100 = 1%)
+#define XBEE_LR_SCHED_QUEUE_SIZE 8
+#define XBEE_LR_SCHED_SUBBANDS 4
+#define XBEE_LR_SCHED_DUTY_CYCLE_DIVISOR 100
+// Channels per sub-band by default; the default of 16 accounts all channels against one budget
+#define XBEE_LR_SCHED_CHANNELS_PER_SUBBAND 16
+
+// Optional RX packet queue (XBeeLRAttachRxQueue): packet slots and payload bytes stored inline in each slot
+#define XBEE_LR_RX_QUEUE_SLOTS 4
+#define XBEE_LR_RX_QUEUE_PAYLOAD_SIZE 242
+
+// Fragmentation layer: fragments sent per acknowledgement (1 to 8), time to wait for it, retries before a transfer fails
+#define XBEE_LR_FRAG_WINDOW 8
+#define XBEE_LR_FRAG_ACK_TIMEOUT_MS 20000
+#define XBEE_LR_FRAG_RETRIES 4
+// Largest fragment including its header, the LoRaWAN maximum of any region; fragments are further limited by the current DR
+#define XBEE_LR_FRAG_MAX_PAYLOAD 242
+
+// Uplink coalescing: buffers shared by all ports (one filling per port, the others queued or free), largest payload built, records per uplink
+#define XBEE_LR_COALESCE_BUFFERS 3
+#define XBEE_LR_COALESCE_MAX_PAYLOAD 242
+#define XBEE_LR_COALESCE_MAX_RECORDS 32
+
+// XBee 3 RF: cached 64-bit to 16-bit address pairs, time to wait for a TX status and for the module to associate
+#define XBEE_3RF_ADDRESS_CACHE_SIZE 8
+#define XBEE_3RF_TX_STATUS_TIMEOUT_MS 5000
+#define XBEE_3RF_ASSOCIATION_TIMEOUT_MS 30000
+// Remote AT fan-out: commands in flight at once, time to wait for each response, retries of an unanswered command, response bytes kept per command
+#define XBEE_3RF_REMOTE_AT_IN_FLIGHT 8
+#define XBEE_3RF_REMOTE_AT_TIMEOUT_MS 6000
+#define XBEE_3RF_REMOTE_AT_RETRIES 2
+#define XBEE_3RF_REMOTE_AT_RESPONSE_SIZE 20
+
+// FreeRTOS backend (port_freertos.c): off by default, needs a FreeRTOS based core such as ESP32 or RP2350
+#define XBEE_FREERTOS_ENABLED 0
+// Radio task stack as passed to xTaskCreate() (bytes on ESP32, words on other ports), request and deferred callback queue lengths
+#define XBEE_RTOS_TASK_STACK_SIZE 4096
+#define XBEE_RTOS_REQUEST_QUEUE_SIZE 8
+#define XBEE_RTOS_EVENT_QUEUE_SIZE 8
+// Largest received payload a deferred receive callback carries, longer ones are truncated
+#define XBEE_RTOS_EVENT_PAYLOAD_SIZE 242
+
+// C++20 coroutines of XBeeAsync.h: frames that can be suspended at once, and the size of each frame
+#define XBEE_ASYNC_FRAMES 4
+#define XBEE_ASYNC_FRAME_SIZE 256
+
+// Binary trace (xbee_trace.h): trace points cost one NULL check until a trace ring is attached, 0 compiles them out
+#define XBEE_TRACE_ENABLED 1
 
 #define API_FRAME_DEBUG_PRINT_ENABLED 0
 #if API_FRAME_DEBUG_PRINT_ENABLED
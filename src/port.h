@@ -41,6 +41,7 @@ extern "C"
 #endif
     
 #include <stdint.h>
+#include <stdbool.h>
 
 // Enum for UART read status
 typedef enum {
@@ -51,12 +52,25 @@ typedef enum {
     UART_ERROR_UNKNOWN
 } uart_status_t;
 
-int portUartRead(uint8_t *buffer, int length);
-int portUartWrite(const uint8_t *buf, uint16_t len);
-uint32_t portMillis(void);
-void portFlushRx(void);
-int portUartInit(uint32_t baudrate, void *device);
-void portDelay(uint32_t ms);
+// Per-instance port state, passed to the port functions through XBeeSetPortContext()
+typedef struct {
+    void *device;   ///< UART used by this instance, set by portUartInit()
+    uint32_t baudRate; ///< Baud rate last given to portUartInit()
+    bool flowControl; ///< RTS/CTS flow control enabled by portUartSetFlowControl()
+    bool hardwareFlowControl; ///< RTS/CTS handled by the UART peripheral instead of the port functions
+    int8_t rtsPin;  ///< Host output to the module's RTS input (DIO6), -1 if not wired
+    int8_t ctsPin;  ///< Host input from the module's CTS output (DIO7), -1 if not wired
+} port_context_t;
+
+int portUartRead(void *ctx, uint8_t *buffer, int length);
+int portUartWrite(void *ctx, const uint8_t *buf, uint16_t len);
+uint32_t portMillis(void *ctx);
+uint32_t portMicros(void *ctx);
+void portFlushRx(void *ctx);
+int portUartInit(void *ctx, uint32_t baudrate, void *device);
+void portDelay(void *ctx, uint32_t ms);
+void portWaitForRx(void *ctx, uint32_t timeoutMs);
+int portUartSetFlowControl(void *ctx, bool enable);
 void portDebugPrintf(const char *format, ...);
 
 #if defined(__cplusplus)
@@ -31,27 +31,55 @@
 
 #include <Arduino.h>
 #include <stdarg.h>
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
 #include "port.h"
+#include "config.h"
 
-// Global or static variable to hold the serial instance (HardwareSerial or SoftwareSerial)
-static Stream* serialPort = NULL;
+/**
+ * @brief Returns the serial instance (HardwareSerial or SoftwareSerial) held by a port context.
+ * 
+ * @param ctx Pointer to the instance's `port_context_t`.
+ * 
+ * @return Stream* The serial port, or NULL if the context has not been initialized.
+ */
+static Stream* portSerial(void *ctx) {
+    if (ctx == NULL) {
+        return NULL;
+    }
+    return static_cast<Stream*>(static_cast<port_context_t*>(ctx)->device);
+}
+
+static bool portSetHardwareFlowControl(port_context_t* context, bool enable);
 
 /**
  * @brief Initializes the UART for communication on the Arduino platform.
  * 
- * This function sets up the UART peripheral with the specified baud rate.
+ * This function sets up the UART peripheral with the specified baud rate and stores it 
+ * in the instance's port context.
  * 
+ * @param ctx Pointer to the instance's `port_context_t`.
  * @param baudrate The baud rate for UART communication.
  * @param device Pointer to the `HardwareSerial` or `SoftwareSerial` instance representing the UART to use.
  * 
- * @return int Returns 0 on success, or -1 if the device is not specified.
+ * @return int Returns 0 on success, or -1 if the device or the context is not specified.
  */
-int portUartInit(uint32_t baudrate, void *device) {
-    if (device == NULL) {
+int portUartInit(void *ctx, uint32_t baudrate, void *device) {
+    if ((device == NULL) || (ctx == NULL)) {
         return -1; // Error: No device specified
     }
 
-    serialPort = static_cast<Stream*>(device); // Store the device globally as a Stream*
+    port_context_t* context = static_cast<port_context_t*>(ctx);
+    bool reopen = (context->device == device);
+    context->device = device; // Store the device in this instance's context
+    context->baudRate = baudrate;
+    Stream* serialPort = static_cast<Stream*>(device);
+
+    if (reopen) {
+        // Changing the baud rate of a running UART
+        ((HardwareSerial*)serialPort)->end();
+    }
 
     // Since RTTI is not available, we will assume the correct type is passed
     // if (device == &Serial1 || device == &Serial || device == &Serial2 || device == &Serial3) {
@@ -66,6 +94,11 @@ int portUartInit(uint32_t baudrate, void *device) {
         gpio_set_function(PIN_SERIAL1_RX, (gpio_function_t)11);
         uart_init(uart0, baudrate);
     }
+#endif
+#if defined(ARDUINO_ARCH_ESP32)
+    if (reopen && context->hardwareFlowControl) {
+        portSetHardwareFlowControl(context, true);  // begin() resets the UART configuration
+    }
 #endif
     return 0; // Indicate success
 }
@@ -76,55 +109,184 @@ int portUartInit(uint32_t baudrate, void *device) {
  * 
  * This function sends the specified number of bytes from the provided buffer over the UART.
  * 
+ * @param ctx Pointer to the instance's `port_context_t`.
  * @param data Pointer to the data to be written.
  * @param length Number of bytes to write.
  * 
  * @return int Returns the number of bytes successfully written, or -1 if the serial port is not initialized.
  */
-int portUartWrite(const uint8_t *data, uint16_t length) {
+int portUartWrite(void *ctx, const uint8_t *data, uint16_t length) {
+    Stream* serialPort = portSerial(ctx);
     if (serialPort == NULL) {
         return -1; // Error: Serial port not initialized
     }
+    const port_context_t* context = static_cast<const port_context_t*>(ctx);
+    if (context->flowControl && !context->hardwareFlowControl && (context->ctsPin >= 0) &&
+        (digitalRead(context->ctsPin) == HIGH)) {
+        return 0; // The module's RX buffer is full, the caller retries
+    }
     return serialPort->write(data, length);
 }
 
+/**
+ * @brief Drives RTS when flow control is done by the port functions.
+ * 
+ * The module may only send while the library is draining the RX buffer or waiting for 
+ * input, and while fewer than `XBEE_FLOW_CONTROL_RX_THRESHOLD` bytes are buffered. Between 
+ * `process()` calls RTS stays raised, so the module keeps its data instead of overrunning a 
+ * buffer nobody reads.
+ * 
+ * @param context Port context of the instance.
+ * @param serialPort Serial port of the instance.
+ * @param draining True while the library is reading or waiting for input.
+ */
+static void portUpdateRts(const port_context_t* context, Stream* serialPort, bool draining) {
+    if (!context->flowControl || context->hardwareFlowControl || (context->rtsPin < 0)) {
+        return;
+    }
+    bool ready = draining && (serialPort->available() < XBEE_FLOW_CONTROL_RX_THRESHOLD);
+    digitalWrite(context->rtsPin, ready ? LOW : HIGH);
+}
+
 /**
  * @brief Reads data from the UART.
  * 
- * This function reads up to the specified number of bytes from the UART and stores them in the provided buffer.
- * It blocks until the requested number of bytes has been read or an error occurs.
+ * This function drains up to the specified number of bytes that are already buffered by 
+ * the Stream in a single call. It never waits for more data to arrive, so it returns 
+ * `min(available(), length)` bytes, or 0 when nothing is buffered.
+ * 
+ * With flow control done in software, RTS is lowered while bytes are being drained and 
+ * raised again by the call that finds the buffer empty, which ends the parser's pass.
  * 
+ * @param ctx Pointer to the instance's `port_context_t`.
  * @param buffer Pointer to the buffer where the data will be stored.
  * @param length Maximum number of bytes to read.
  * 
  * @return int Returns the number of bytes actually read, or -1 if the serial port is not initialized.
  */
-int portUartRead(uint8_t *buffer, int length) {
+int portUartRead(void *ctx, uint8_t *buffer, int length) {
+    Stream* serialPort = portSerial(ctx);
     if (serialPort == NULL) {
         return -1; // Error: Serial port not initialized
     }
+    const port_context_t* context = static_cast<const port_context_t*>(ctx);
 
-    int bytesRead = 0;
+    int bytesAvailable = serialPort->available();
+    if (bytesAvailable <= 0 || length <= 0) {
+        portUpdateRts(context, serialPort, false);
+        return 0;
+    }
+    if (bytesAvailable > length) {
+        bytesAvailable = length;
+    }
 
+    // readBytes() returns without waiting when the bytes are already buffered
+    int bytesRead = (int)serialPort->readBytes(buffer, (size_t)bytesAvailable);
+    portUpdateRts(context, serialPort, true);
+    return bytesRead;
+}
 
-    if (serialPort->available()) {
-        int c = serialPort->read();
-        if (c == -1) {
-            return -1; // Return error if Serial.read() fails
-        }
-        buffer[bytesRead++] = (uint8_t)c;
+/**
+ * @brief Hands RTS/CTS to the UART peripheral on cores that support it.
+ * 
+ * ESP32 cores drive RTS from the RX FIFO level and hold TX while CTS is raised; on 
+ * arduino-pico the UART is restarted with its RTS and CTS pins. Pins the UART cannot use 
+ * leave flow control to the port functions.
+ * 
+ * @param context Port context of the instance, with the pins set.
+ * @param enable True to enable flow control, false to disable it.
+ * 
+ * @return bool True if the UART peripheral now handles flow control.
+ */
+static bool portSetHardwareFlowControl(port_context_t* context, bool enable) {
+#if defined(ARDUINO_ARCH_ESP32)
+    HardwareSerial* uart = static_cast<HardwareSerial*>(context->device);
+    uint8_t mode = UART_HW_FLOWCTRL_DISABLE;
+    if (enable && (context->rtsPin >= 0) && (context->ctsPin >= 0)) {
+        mode = UART_HW_FLOWCTRL_CTS_RTS;
+    } else if (enable && (context->rtsPin >= 0)) {
+        mode = UART_HW_FLOWCTRL_RTS;
+    } else if (enable && (context->ctsPin >= 0)) {
+        mode = UART_HW_FLOWCTRL_CTS;
     }
+    if (mode != UART_HW_FLOWCTRL_DISABLE) {
+        // -1 keeps the RX and TX pins the UART was started with
+        uart->setPins(-1, -1, context->ctsPin, context->rtsPin);
+    }
+    uart->setHwFlowCtrlMode(mode, XBEE_FLOW_CONTROL_RX_THRESHOLD);
+    return mode != UART_HW_FLOWCTRL_DISABLE;
+#elif defined(ARDUINO_ARCH_RP2040) && !defined(ARDUINO_ARCH_MBED)
+    // Only the UARTs are SerialUART instances, Serial is the USB port
+    if ((context->device != &Serial1) && (context->device != &Serial2)) {
+        return false;
+    }
+    SerialUART* uart = static_cast<SerialUART*>(context->device);
+    bool hardware = enable;
+    uart->end();  // The pins cannot be changed while the UART runs
+    if (!uart->setRTS((enable && (context->rtsPin >= 0)) ? context->rtsPin : UART_PIN_NOT_DEFINED) ||
+        !uart->setCTS((enable && (context->ctsPin >= 0)) ? context->ctsPin : UART_PIN_NOT_DEFINED)) {
+        uart->setRTS(UART_PIN_NOT_DEFINED);
+        uart->setCTS(UART_PIN_NOT_DEFINED);
+        hardware = false;
+    }
+    portUartInit(context, context->baudRate, context->device);
+    return hardware;
+#else
+    (void)context;
+    (void)enable;
+    return false;
+#endif
+}
 
-
-    return bytesRead;
+/**
+ * @brief Enables or disables RTS/CTS flow control for the instance.
+ * 
+ * The pins are taken from `rtsPin` and `ctsPin` of the context, either may be -1 when it 
+ * is not wired. Where the core supports it (ESP32, arduino-pico) the UART peripheral drives 
+ * RTS and watches CTS. Otherwise RTS is raised (not ready) when enabled and only lowered by 
+ * `portUartRead()` and `portWaitForRx()` while the library drains or waits for input, so 
+ * the module holds its data while the sketch is busy; `XBEE_FLOW_CONTROL_RX_THRESHOLD` 
+ * must leave room for the bytes the module sends before it reacts. While the module raises 
+ * CTS, `portUartWrite()` writes nothing.
+ * 
+ * @param ctx Pointer to the instance's `port_context_t`.
+ * @param enable True to enable flow control, false to disable it.
+ * 
+ * @return int Returns 0 on success, or -1 if the context is not specified.
+ */
+int portUartSetFlowControl(void *ctx, bool enable) {
+    if (ctx == NULL) {
+        return -1;
+    }
+    port_context_t* context = static_cast<port_context_t*>(ctx);
+    bool wasHardware = context->hardwareFlowControl;
+    if ((context->device != NULL) && (enable || wasHardware)) {
+        context->hardwareFlowControl = portSetHardwareFlowControl(context, enable);
+    }
+    if (enable && !context->hardwareFlowControl) {
+        if (context->rtsPin >= 0) {
+            pinMode(context->rtsPin, OUTPUT);
+            digitalWrite(context->rtsPin, HIGH);
+        }
+        if (context->ctsPin >= 0) {
+            pinMode(context->ctsPin, INPUT);
+        }
+    } else if (!enable && !wasHardware && (context->rtsPin >= 0)) {
+        digitalWrite(context->rtsPin, LOW);
+    }
+    context->flowControl = enable;
+    return 0;
 }
 
 /**
  * @brief Flushes the UART receive buffer.
  * 
  * This function clears any data that may be present in the UART's receive buffer.
+ * 
+ * @param ctx Pointer to the instance's `port_context_t`.
  */
-void portFlushRx() {
+void portFlushRx(void *ctx) {
+    Stream* serialPort = portSerial(ctx);
     if (serialPort == NULL) {
         return; // Error: Serial port not initialized
     }
@@ -139,23 +301,78 @@ void portFlushRx() {
  * 
  * This function uses Arduino's `millis()` function to return the time elapsed since the device was powered on.
  * 
+ * @param ctx Pointer to the instance's `port_context_t`, unused.
+ * 
  * @return uint32_t The number of milliseconds since startup.
  */
-uint32_t portMillis() {
+uint32_t portMillis(void *ctx) {
+    (void)ctx;
     return millis();
 }
 
+/**
+ * @brief Returns the number of microseconds since the program started.
+ * 
+ * Used to time the latency statistics. Arduino's `micros()` wraps after about 70 minutes, 
+ * which is fine for measuring intervals.
+ * 
+ * @param ctx Pointer to the instance's `port_context_t`, unused.
+ * 
+ * @return uint32_t The number of microseconds since startup.
+ */
+uint32_t portMicros(void *ctx) {
+    (void)ctx;
+    return micros();
+}
+
 /**
  * @brief Delays execution for a specified number of milliseconds.
  * 
  * This function pauses execution for the specified duration using Arduino's `delay()` function.
  * 
+ * @param ctx Pointer to the instance's `port_context_t`, unused.
  * @param ms The number of milliseconds to delay.
  */
-void portDelay(uint32_t ms) {
+void portDelay(void *ctx, uint32_t ms) {
+    (void)ctx;
     delay(ms);
 }
 
+/**
+ * @brief Sleeps until the UART has received a byte or the timeout expired.
+ * 
+ * The core is put into its idle sleep between interrupts where a 1 ms tick interrupt is 
+ * known to wake it: `SLEEP_MODE_IDLE` on AVR (Timer0) and `WFI` on SAMD and STM32 
+ * (SysTick). Both also wake up on the UART RX interrupt, so the timeout is kept with 
+ * millisecond resolution. Other cores, e.g. arduino-pico and mbed based cores, have no 
+ * periodic tick and could sleep past the timeout, so they fall back to `yield()`.
+ * 
+ * @param ctx Pointer to the instance's `port_context_t`.
+ * @param timeoutMs Longest time to sleep in milliseconds.
+ */
+void portWaitForRx(void *ctx, uint32_t timeoutMs) {
+    Stream* serialPort = portSerial(ctx);
+    if (serialPort == NULL) {
+        return;
+    }
+
+    const port_context_t* context = static_cast<const port_context_t*>(ctx);
+    portUpdateRts(context, serialPort, true);  // Let the module send while we wait for it
+
+    uint32_t start = millis();
+    while ((serialPort->available() <= 0) && ((millis() - start) < timeoutMs)) {
+#if defined(__AVR__)
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        sleep_mode();
+#elif defined(__arm__) && (defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_STM32))
+        __asm__ volatile ("wfi");
+#else
+        yield();
+#endif
+    }
+    portUpdateRts(context, serialPort, serialPort->available() > 0);
+}
+
 /**
  * @brief Prints debug information to the Serial output.
  * 
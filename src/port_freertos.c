@@ -0,0 +1,600 @@
+/**
+ * @file port_freertos.c
+ * @brief FreeRTOS backend: a radio task that owns an XBee instance, with a thread-safe API.
+ *
+ * Typical use, with `uartTable`/`uartContext` being an existing UART port such as the
+ * port.h functions of port_arduino.cpp:
+ *
+ *     XBeeRTOSInit(&rtos, &uartTable, &uartContext, &callbacks);
+ *     XBeeLR* lr = XBeeLRCreate(&rtos.ctable, &rtos.htable);
+ *     XBeeRTOSDefaultConfig(&config);
+ *     XBeeRTOSStart(&rtos, (XBee*)lr, &config);
+ *     XBeeRTOSBegin(&rtos, 9600, &Serial1);
+ *
+ * After that the instance must only be used through the XBeeRTOS functions.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "port_freertos.h"
+
+#if XBEE_FREERTOS_ENABLED
+
+#include <string.h>
+
+typedef enum {
+    XBEE_RTOS_REQUEST_CALL = 0,   ///< Run a function on the radio task
+    XBEE_RTOS_REQUEST_SEND        ///< Send an uplink and wait for its TX status
+} xbee_rtos_request_type_t;
+
+typedef enum {
+    XBEE_RTOS_EVENT_RECEIVE = 0,
+    XBEE_RTOS_EVENT_SEND,
+    XBEE_RTOS_EVENT_CONNECT,
+    XBEE_RTOS_EVENT_DISCONNECT
+} xbee_rtos_event_type_t;
+
+// Caller side of a request, lives on the caller's stack until the radio task notified it
+typedef struct {
+    TaskHandle_t task;            ///< Task blocked on the request
+    bool result;                  ///< Result of a call
+    uint8_t status;               ///< Delivery status of an uplink
+    XBeeLRPacket_t *packet;       ///< Uplink, updated with the TX status report
+} XBeeRTOSWaiter;
+
+typedef struct {
+    xbee_rtos_request_type_t type;
+    XBeeRTOSWaiter *waiter;
+    XBeeRTOSCallFn fn;            ///< Call: function to run
+    void *arg;                    ///< Call: argument of fn
+} XBeeRTOSRequest;
+
+typedef struct {
+    xbee_rtos_event_type_t type;
+    XBeeLRPacket_t packet;        ///< Received packet or TX status report
+    uint8_t payload[XBEE_RTOS_EVENT_PAYLOAD_SIZE]; ///< Copy of the received payload
+} XBeeRTOSEvent;
+
+// Converts milliseconds to ticks, rounding up so a wait never ends before its deadline
+static TickType_t xbeeRtosTicks(uint32_t ms) {
+    if (ms == XBEE_WAIT_FOREVER) {
+        return portMAX_DELAY;
+    }
+    uint64_t ticks = ((uint64_t)ms * configTICK_RATE_HZ + 999) / 1000;
+    if (ticks == 0) {
+        return 1;
+    }
+    return (ticks >= (uint64_t)portMAX_DELAY) ? (TickType_t)(portMAX_DELAY - 1) : (TickType_t)ticks;
+}
+
+/* XBeeHTable: hardware calls are forwarded to the UART port, waits use RTOS primitives */
+
+static int portRtosUartRead(void *ctx, uint8_t *buffer, int length) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    return rtos->uart->PortUartRead(rtos->uartContext, buffer, length);
+}
+
+static int portRtosUartWrite(void *ctx, const uint8_t *buf, uint16_t len) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    return rtos->uart->PortUartWrite(rtos->uartContext, buf, len);
+}
+
+static uint32_t portRtosMillis(void *ctx) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    return rtos->uart->PortMillis(rtos->uartContext);
+}
+
+static void portRtosFlushRx(void *ctx) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    rtos->uart->PortFlushRx(rtos->uartContext);
+}
+
+static int portRtosUartInit(void *ctx, uint32_t baudrate, void *device) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    return rtos->uart->PortUartInit(rtos->uartContext, baudrate, device);
+}
+
+static void portRtosDelay(void *ctx, uint32_t ms) {
+    (void)ctx;
+    vTaskDelay(xbeeRtosTicks(ms));
+}
+
+static int portRtosUartAttachRing(void *ctx, XBeeRxRing *ring) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    return rtos->uart->PortUartAttachRing(rtos->uartContext, ring);
+}
+
+static int portRtosUartTxSpace(void *ctx) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    return rtos->uart->PortUartTxSpace(rtos->uartContext);
+}
+
+static uint32_t portRtosMicros(void *ctx) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    return rtos->uart->PortMicros(rtos->uartContext);
+}
+
+static int portRtosUartSetFlowControl(void *ctx, bool enable) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    return rtos->uart->PortUartSetFlowControl(rtos->uartContext, enable);
+}
+
+// Blocks the radio task until RX activity, a new request or the timeout
+static void portRtosWaitForRx(void *ctx, uint32_t timeoutMs) {
+    XBeeRTOS *rtos = (XBeeRTOS *)ctx;
+    if ((rtos->config.rxPollMs != 0) && (timeoutMs > rtos->config.rxPollMs)) {
+        timeoutMs = rtos->config.rxPollMs;
+    }
+    (void)xSemaphoreTake(rtos->wake, xbeeRtosTicks(timeoutMs));
+}
+
+/* XBeeCTable: callbacks run on the radio task or are queued for XBeeRTOSDispatch() */
+
+static void xbeeRtosDeliver(XBeeRTOS* rtos, XBeeRTOSEvent* event) {
+    const XBeeCTable *callbacks = rtos->callbacks;
+    switch (event->type) {
+        case XBEE_RTOS_EVENT_RECEIVE:
+            event->packet.payload = event->payload;
+            if (callbacks->OnReceiveCallback) callbacks->OnReceiveCallback(rtos->xbee, &event->packet);
+            break;
+        case XBEE_RTOS_EVENT_SEND:
+            if (callbacks->OnSendCallback) callbacks->OnSendCallback(rtos->xbee, &event->packet);
+            break;
+        case XBEE_RTOS_EVENT_CONNECT:
+            if (callbacks->OnConnectCallback) callbacks->OnConnectCallback(rtos->xbee);
+            break;
+        case XBEE_RTOS_EVENT_DISCONNECT:
+            if (callbacks->OnDisconnectCallback) callbacks->OnDisconnectCallback(rtos->xbee);
+            break;
+        default:
+            break;
+    }
+}
+
+static void xbeeRtosPostEvent(XBeeRTOS* rtos, XBeeRTOSEvent* event) {
+    if (xQueueSend(rtos->events, event, 0) != pdTRUE) {
+        rtos->droppedEvents++;
+        XBEEDebugPrint("XBee event queue full, callback dropped\n");
+    }
+}
+
+static void xbeeRtosOnReceive(XBee* self, void* data) {
+    XBeeRTOS *rtos = (XBeeRTOS *)self->portContext;
+    if (rtos->events == NULL) {
+        if (rtos->callbacks->OnReceiveCallback) rtos->callbacks->OnReceiveCallback(self, data);
+        return;
+    }
+
+    const XBeeLRPacket_t *packet = (const XBeeLRPacket_t *)data;
+    XBeeRTOSEvent event;
+    event.type = XBEE_RTOS_EVENT_RECEIVE;
+    event.packet = *packet;
+    if (event.packet.payloadSize > sizeof(event.payload)) {
+        event.packet.payloadSize = sizeof(event.payload);  // Truncated, see XBEE_RTOS_EVENT_PAYLOAD_SIZE
+    }
+    if ((packet->payload != NULL) && (event.packet.payloadSize > 0)) {
+        memcpy(event.payload, packet->payload, event.packet.payloadSize);
+    }
+    event.packet.payload = NULL;
+    xbeeRtosPostEvent(rtos, &event);
+}
+
+static void xbeeRtosOnSend(XBee* self, void* data) {
+    XBeeRTOS *rtos = (XBeeRTOS *)self->portContext;
+    if (rtos->events == NULL) {
+        if (rtos->callbacks->OnSendCallback) rtos->callbacks->OnSendCallback(self, data);
+        return;
+    }
+
+    XBeeRTOSEvent event;
+    event.type = XBEE_RTOS_EVENT_SEND;
+    event.packet = *(const XBeeLRPacket_t *)data;
+    event.packet.payload = NULL;
+    xbeeRtosPostEvent(rtos, &event);
+}
+
+static void xbeeRtosOnConnect(XBee* self) {
+    XBeeRTOS *rtos = (XBeeRTOS *)self->portContext;
+    if (rtos->events == NULL) {
+        if (rtos->callbacks->OnConnectCallback) rtos->callbacks->OnConnectCallback(self);
+        return;
+    }
+    XBeeRTOSEvent event;
+    event.type = XBEE_RTOS_EVENT_CONNECT;
+    xbeeRtosPostEvent(rtos, &event);
+}
+
+static void xbeeRtosOnDisconnect(XBee* self) {
+    XBeeRTOS *rtos = (XBeeRTOS *)self->portContext;
+    if (rtos->events == NULL) {
+        if (rtos->callbacks->OnDisconnectCallback) rtos->callbacks->OnDisconnectCallback(self);
+        return;
+    }
+    XBeeRTOSEvent event;
+    event.type = XBEE_RTOS_EVENT_DISCONNECT;
+    xbeeRtosPostEvent(rtos, &event);
+}
+
+/* Radio task */
+
+static void xbeeRtosSendComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+    (void)self;
+    (void)frameId;
+    XBeeRTOSWaiter *waiter = (XBeeRTOSWaiter *)ctx;
+    if (report != NULL) {
+        // Hand the TX status report to the caller, its payload pointer is kept
+        const XBeeLRPacket_t *status = (const XBeeLRPacket_t *)report;
+        waiter->packet->dr = status->dr;
+        waiter->packet->channel = status->channel;
+        waiter->packet->power = status->power;
+        waiter->packet->counter = status->counter;
+    }
+    waiter->packet->status = status;
+    waiter->status = status;
+    xTaskNotifyGive(waiter->task);
+}
+
+static void xbeeRtosHandleRequest(XBeeRTOS* rtos, const XBeeRTOSRequest* request) {
+    XBeeRTOSWaiter *waiter = request->waiter;
+    switch (request->type) {
+        case XBEE_RTOS_REQUEST_CALL:
+            waiter->result = request->fn(rtos->xbee, request->arg);
+            xTaskNotifyGive(waiter->task);
+            break;
+        case XBEE_RTOS_REQUEST_SEND:
+            if (XBeeLRSendDataAsync(rtos->xbee, waiter->packet, xbeeRtosSendComplete, waiter) == 0) {
+                waiter->packet->status = XBEE_TX_STATUS_TIMEOUT;
+                waiter->status = XBEE_TX_STATUS_TIMEOUT;
+                xTaskNotifyGive(waiter->task);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void xbeeRtosTask(void* param) {
+    XBeeRTOS *rtos = (XBeeRTOS *)param;
+    XBeeRTOSRequest request;
+
+    for (;;) {
+        while (xQueuePeek(rtos->requests, &request, 0) == pdTRUE) {
+            if ((request.type == XBEE_RTOS_REQUEST_SEND) && (XBeeTxPending(rtos->xbee) >= rtos->xbee->txTableSize)) {
+                break;  // Sent once a TX status or timeout frees an entry; requests keep their order
+            }
+            (void)xQueueReceive(rtos->requests, &request, 0);
+            xbeeRtosHandleRequest(rtos, &request);
+        }
+        XBeeProcess(rtos->xbee);
+        XBeeWait(rtos->xbee, XBEE_WAIT_FOREVER);
+    }
+}
+
+// Queues a request and blocks the calling task until the radio task has completed it
+static bool xbeeRtosSubmit(XBeeRTOS* rtos, XBeeRTOSRequest* request) {
+    if ((rtos->task == NULL) || (xTaskGetCurrentTaskHandle() == rtos->task)) {
+        return false;  // Not started, or called from the radio task, which would wait for itself
+    }
+    request->waiter->task = xTaskGetCurrentTaskHandle();
+    if (xQueueSend(rtos->requests, request, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+    xSemaphoreGive(rtos->wake);
+    (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // The radio task always completes a request
+    return true;
+}
+
+/**
+ * @brief Fills a configuration with the defaults: priority 1 above idle, no core affinity,
+ * callbacks on the radio task and a 1 ms RX poll.
+ *
+ * @param[out] config Configuration to fill.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeRTOSDefaultConfig(XBeeRTOSConfig* config) {
+    config->priority = tskIDLE_PRIORITY + 1;
+    config->core = -1;
+    config->deferCallbacks = false;
+    config->rxPollMs = 1;
+}
+
+/**
+ * @brief Prepares the tables an XBee instance owned by a radio task is created with.
+ *
+ * @param[out] rtos Radio task state, must outlive the instance.
+ * @param[in] uart UART port the hardware calls are forwarded to. Its `PortDelay` and
+ * `PortWaitForRx` are replaced by `vTaskDelay()` and a semaphore wait.
+ * @param[in] uartContext Port context passed to the `uart` functions.
+ * @param[in] callbacks Application callbacks, see `XBeeRTOSConfig::deferCallbacks`.
+ *
+ * @return bool Returns true on success, false if an argument is missing or the semaphore
+ * could not be created.
+ */
+bool XBeeRTOSInit(XBeeRTOS* rtos, const XBeeHTable* uart, void* uartContext, const XBeeCTable* callbacks) {
+    if ((rtos == NULL) || (uart == NULL) || (callbacks == NULL)) {
+        return false;
+    }
+    memset(rtos, 0, sizeof(*rtos));
+    rtos->uart = uart;
+    rtos->uartContext = uartContext;
+    rtos->callbacks = callbacks;
+    XBeeRTOSDefaultConfig(&rtos->config);
+
+    rtos->htable.PortUartRead = portRtosUartRead;
+    rtos->htable.PortUartWrite = portRtosUartWrite;
+    rtos->htable.PortMillis = portRtosMillis;
+    rtos->htable.PortFlushRx = portRtosFlushRx;
+    rtos->htable.PortUartInit = portRtosUartInit;
+    rtos->htable.PortDelay = portRtosDelay;
+    rtos->htable.PortUartAttachRing = uart->PortUartAttachRing ? portRtosUartAttachRing : NULL;
+    rtos->htable.PortUartTxSpace = uart->PortUartTxSpace ? portRtosUartTxSpace : NULL;
+    rtos->htable.PortMicros = uart->PortMicros ? portRtosMicros : NULL;
+    rtos->htable.PortUartSetFlowControl = uart->PortUartSetFlowControl ? portRtosUartSetFlowControl : NULL;
+    rtos->htable.PortWaitForRx = portRtosWaitForRx;
+
+    rtos->ctable.OnReceiveCallback = xbeeRtosOnReceive;
+    rtos->ctable.OnConnectCallback = xbeeRtosOnConnect;
+    rtos->ctable.OnDisconnectCallback = xbeeRtosOnDisconnect;
+    rtos->ctable.OnSendCallback = xbeeRtosOnSend;
+
+    rtos->wake = xSemaphoreCreateBinary();
+    return rtos->wake != NULL;
+}
+
+/**
+ * @brief Starts the radio task that owns `xbee`.
+ *
+ * `xbee` must have been created with `rtos->htable` and `rtos->ctable`; its port context
+ * is set to `rtos`. From now on the instance must only be used through the XBeeRTOS
+ * functions, starting with `XBeeRTOSBegin()`.
+ *
+ * @param[in] rtos Radio task state prepared by `XBeeRTOSInit()`.
+ * @param[in] xbee Instance to own.
+ * @param[in] config Task settings, NULL for `XBeeRTOSDefaultConfig()`.
+ *
+ * @return bool Returns true if the task is running, false if a queue or the task could not be created.
+ */
+bool XBeeRTOSStart(XBeeRTOS* rtos, XBee* xbee, const XBeeRTOSConfig* config) {
+    if ((rtos == NULL) || (xbee == NULL) || (rtos->wake == NULL) || (rtos->task != NULL)) {
+        return false;
+    }
+    if (config != NULL) {
+        rtos->config = *config;
+    }
+    rtos->xbee = xbee;
+    XBeeSetPortContext(xbee, rtos);
+
+    rtos->requests = xQueueCreate(XBEE_RTOS_REQUEST_QUEUE_SIZE, sizeof(XBeeRTOSRequest));
+    if (rtos->requests == NULL) {
+        return false;
+    }
+    if (rtos->config.deferCallbacks) {
+        rtos->events = xQueueCreate(XBEE_RTOS_EVENT_QUEUE_SIZE, sizeof(XBeeRTOSEvent));
+        if (rtos->events == NULL) {
+            return false;
+        }
+    }
+
+    BaseType_t created;
+#if defined(ESP_PLATFORM)
+    created = xTaskCreatePinnedToCore(xbeeRtosTask, "xbee", XBEE_RTOS_TASK_STACK_SIZE, rtos, rtos->config.priority,
+        &rtos->task, (rtos->config.core < 0) ? tskNO_AFFINITY : rtos->config.core);
+#else
+    created = xTaskCreate(xbeeRtosTask, "xbee", XBEE_RTOS_TASK_STACK_SIZE, rtos, rtos->config.priority, &rtos->task);
+#endif
+    if (created != pdPASS) {
+        rtos->task = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Runs a function on the radio task and waits until it returned.
+ *
+ * Any library function can be called this way, e.g. a configuration batch. The radio
+ * task is busy for the duration of `fn`, other requests wait in the queue.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ * @param[in] fn Function to run with the owned instance.
+ * @param[in] arg Argument passed to `fn`.
+ *
+ * @return bool The result of `fn`, or false if the task is not running or this is the radio task.
+ */
+bool XBeeRTOSCall(XBeeRTOS* rtos, XBeeRTOSCallFn fn, void* arg) {
+    XBeeRTOSWaiter waiter = {0};
+    XBeeRTOSRequest request = {XBEE_RTOS_REQUEST_CALL, &waiter, fn, arg};
+    return xbeeRtosSubmit(rtos, &request) && waiter.result;
+}
+
+// Arguments of the XBeeRTOS wrappers built on XBeeRTOSCall()
+typedef struct {
+    uint32_t baudRate;
+    void *device;
+} XBeeRTOSBeginArgs;
+
+typedef struct {
+    at_command_t command;
+    const uint8_t *parameter;
+    uint8_t *responseBuffer;
+    uint8_t length;
+    uint8_t *responseLength;
+} XBeeRTOSParameterArgs;
+
+static bool xbeeRtosBegin(XBee* self, void* arg) {
+    const XBeeRTOSBeginArgs *args = (const XBeeRTOSBeginArgs *)arg;
+    return XBeeInit(self, args->baudRate, args->device);
+}
+
+static bool xbeeRtosConnectAsync(XBee* self, void* arg) {
+    (void)arg;
+    return XBeeLRConnectAsync(self);
+}
+
+static bool xbeeRtosSetParameter(XBee* self, void* arg) {
+    const XBeeRTOSParameterArgs *args = (const XBeeRTOSParameterArgs *)arg;
+    return XBeeSetParameter(self, args->command, args->parameter, args->length);
+}
+
+static bool xbeeRtosGetParameter(XBee* self, void* arg) {
+    const XBeeRTOSParameterArgs *args = (const XBeeRTOSParameterArgs *)arg;
+    return XBeeGetParameter(self, args->command, args->responseBuffer, args->length, args->responseLength);
+}
+
+/**
+ * @brief Initializes the owned instance and its UART on the radio task, see `XBeeInit()`.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ * @param[in] baudRate UART baud rate.
+ * @param[in] device UART device forwarded to the port's `PortUartInit`.
+ *
+ * @return bool Returns true on success, otherwise false.
+ */
+bool XBeeRTOSBegin(XBeeRTOS* rtos, uint32_t baudRate, void* device) {
+    XBeeRTOSBeginArgs args = {baudRate, device};
+    return XBeeRTOSCall(rtos, xbeeRtosBegin, &args);
+}
+
+/**
+ * @brief Sends an uplink from any task and waits for its TX status.
+ *
+ * Only the calling task blocks: the radio task keeps processing frames and other tasks'
+ * uplinks, so as many uplinks as the TX table holds can be outstanding at once. Further
+ * requests wait in the queue until an entry frees up.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ * @param[in,out] packet Uplink to send. The payload must stay valid until the call returns;
+ * `status`, `dr`, `channel`, `power` and `counter` are updated from the TX status; `status`
+ * is also set when the uplink could not be sent.
+ *
+ * @return uint8_t The delivery status, 0 if successful, `XBEE_TX_STATUS_TIMEOUT` if the frame
+ * could not be sent or no status arrived.
+ */
+uint8_t XBeeRTOSSendData(XBeeRTOS* rtos, XBeeLRPacket_t* packet) {
+    XBeeRTOSWaiter waiter = {0};
+    waiter.packet = packet;
+    XBeeRTOSRequest request = {XBEE_RTOS_REQUEST_SEND, &waiter, NULL, NULL};
+    if (!xbeeRtosSubmit(rtos, &request)) {
+        packet->status = XBEE_TX_STATUS_TIMEOUT;
+        return XBEE_TX_STATUS_TIMEOUT;
+    }
+    return waiter.status;
+}
+
+/**
+ * @brief Starts joining the network, see `XBeeLRConnectAsync()`.
+ *
+ * The result is reported through `OnConnectCallback` or `OnDisconnectCallback`.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ *
+ * @return bool Returns true if a join was started or one is already in progress.
+ */
+bool XBeeRTOSConnectAsync(XBeeRTOS* rtos) {
+    return XBeeRTOSCall(rtos, xbeeRtosConnectAsync, NULL);
+}
+
+/**
+ * @brief Sets a module parameter from any task, see `XBeeSetParameter()`.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ * @param[in] command AT command of the parameter.
+ * @param[in] parameter Value to write.
+ * @param[in] paramLength Length of `parameter`.
+ *
+ * @return bool Returns true if the module accepted the value, otherwise false.
+ */
+bool XBeeRTOSSetParameter(XBeeRTOS* rtos, at_command_t command, const uint8_t* parameter, uint8_t paramLength) {
+    XBeeRTOSParameterArgs args = {command, parameter, NULL, paramLength, NULL};
+    return XBeeRTOSCall(rtos, xbeeRtosSetParameter, &args);
+}
+
+/**
+ * @brief Reads a module parameter from any task, see `XBeeGetParameter()`.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ * @param[in] command AT command of the parameter.
+ * @param[out] responseBuffer Buffer for the value.
+ * @param[in] bufferSize Size of `responseBuffer`.
+ * @param[out] responseLength Length of the value, may be NULL.
+ *
+ * @return bool Returns true if the value was read, otherwise false.
+ */
+bool XBeeRTOSGetParameter(XBeeRTOS* rtos, at_command_t command, uint8_t* responseBuffer, uint8_t bufferSize, uint8_t* responseLength) {
+    XBeeRTOSParameterArgs args = {command, NULL, responseBuffer, bufferSize, responseLength};
+    return XBeeRTOSCall(rtos, xbeeRtosGetParameter, &args);
+}
+
+/**
+ * @brief Runs the next deferred callback on the calling task.
+ *
+ * Only used with `XBeeRTOSConfig::deferCallbacks`. Received payloads are copies, valid
+ * for the duration of the callback. The callbacks run outside the radio task, so they
+ * must use the XBeeRTOS functions rather than the `XBee*` they are given.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ * @param[in] timeout Ticks to wait for an event, 0 to return immediately.
+ *
+ * @return bool Returns true if a callback was run, false if none arrived in time.
+ */
+bool XBeeRTOSDispatch(XBeeRTOS* rtos, TickType_t timeout) {
+    XBeeRTOSEvent event;
+    if ((rtos->events == NULL) || (xQueueReceive(rtos->events, &event, timeout) != pdTRUE)) {
+        return false;
+    }
+    xbeeRtosDeliver(rtos, &event);
+    return true;
+}
+
+/**
+ * @brief Wakes the radio task because the UART received data, from task context.
+ *
+ * Call it from the UART driver's receive callback, e.g. `HardwareSerial::onReceive()` on
+ * ESP32. When every reception is signalled, `rxPollMs` can be set to 0.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeRTOSNotifyRx(XBeeRTOS* rtos) {
+    xSemaphoreGive(rtos->wake);
+}
+
+/**
+ * @brief Wakes the radio task because the UART received data, from an ISR.
+ *
+ * @param[in] rtos Pointer to the radio task state.
+ * @param[out] higherPriorityTaskWoken Set to pdTRUE if a context switch should be requested
+ * before the ISR returns, see `xSemaphoreGiveFromISR()`.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeRTOSNotifyRxFromISR(XBeeRTOS* rtos, BaseType_t* higherPriorityTaskWoken) {
+    xSemaphoreGiveFromISR(rtos->wake, higherPriorityTaskWoken);
+}
+
+#endif // XBEE_FREERTOS_ENABLED
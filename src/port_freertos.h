@@ -0,0 +1,129 @@
+/**
+ * @file port_freertos.h
+ * @brief FreeRTOS backend: a radio task that owns an XBee instance, with a thread-safe API.
+ *
+ * The XBee library is single threaded: an instance, its UART and its callbacks must only
+ * be used from one context. This backend gives that context its own task. Other tasks
+ * submit uplinks and arbitrary calls through a request queue and block on a task
+ * notification until the radio task has completed them, so no locks are needed inside
+ * the library and several tasks can have uplinks outstanding at the same time. The
+ * radio task sleeps on a semaphore between frames, which is given by new requests and
+ * by the UART through `XBeeRTOSNotifyRx()` / `XBeeRTOSNotifyRxFromISR()`. Callbacks are
+ * either run on the radio task or queued, with a copy of their data, for the task that
+ * calls `XBeeRTOSDispatch()`.
+ *
+ * Enable it with `XBEE_FREERTOS_ENABLED` in config.h. The blocking functions use the
+ * calling task's notification value and must not be called from an ISR.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#ifndef PORT_FREERTOS_H
+#define PORT_FREERTOS_H
+
+#include "config.h"
+
+#if XBEE_FREERTOS_ENABLED
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#if defined(ESP_PLATFORM)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#else
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#endif
+
+#include "xbee.h"
+#include "xbee_lr.h"
+
+/**
+ * @typedef XBeeRTOSCallFn
+ * @brief Function run on the radio task by `XBeeRTOSCall()`.
+ */
+typedef bool (*XBeeRTOSCallFn)(XBee* self, void* arg);
+
+/**
+ * @typedef XBeeRTOSConfig
+ * @brief Settings of the radio task.
+ */
+typedef struct {
+    UBaseType_t priority;         ///< Priority of the radio task
+    int8_t core;                  ///< Core the task is pinned to on ESP32, -1 for no affinity
+    bool deferCallbacks;          ///< Queue callbacks for XBeeRTOSDispatch() instead of running them on the radio task
+    uint32_t rxPollMs;            ///< Longest sleep without an RX notification, 0 if the UART always calls XBeeRTOSNotifyRx()
+} XBeeRTOSConfig;
+
+/**
+ * @typedef XBeeRTOS
+ * @brief Radio task state, used as the port context of the XBee instance it owns.
+ *
+ * `htable` and `ctable` are the tables the instance must be created with; they forward
+ * to the UART port and the application callbacks given to `XBeeRTOSInit()`.
+ */
+typedef struct {
+    XBee *xbee;                   ///< Instance owned by the radio task, set by XBeeRTOSStart()
+    XBeeHTable htable;            ///< UART port with the waits replaced by RTOS primitives
+    XBeeCTable ctable;            ///< Callbacks that hand events over to the application
+    const XBeeHTable *uart;       ///< UART port the hardware calls are forwarded to
+    void *uartContext;            ///< Port context of `uart`
+    const XBeeCTable *callbacks;  ///< Application callbacks
+    XBeeRTOSConfig config;
+    TaskHandle_t task;            ///< Radio task
+    SemaphoreHandle_t wake;       ///< Given on RX activity and new requests
+    QueueHandle_t requests;       ///< Requests submitted by other tasks
+    QueueHandle_t events;         ///< Deferred callbacks, NULL unless deferCallbacks is set
+    volatile uint32_t droppedEvents; ///< Deferred callbacks lost because the event queue was full
+} XBeeRTOS;
+
+void XBeeRTOSDefaultConfig(XBeeRTOSConfig* config);
+bool XBeeRTOSInit(XBeeRTOS* rtos, const XBeeHTable* uart, void* uartContext, const XBeeCTable* callbacks);
+bool XBeeRTOSStart(XBeeRTOS* rtos, XBee* xbee, const XBeeRTOSConfig* config);
+bool XBeeRTOSBegin(XBeeRTOS* rtos, uint32_t baudRate, void* device);
+bool XBeeRTOSCall(XBeeRTOS* rtos, XBeeRTOSCallFn fn, void* arg);
+uint8_t XBeeRTOSSendData(XBeeRTOS* rtos, XBeeLRPacket_t* packet);
+bool XBeeRTOSConnectAsync(XBeeRTOS* rtos);
+bool XBeeRTOSSetParameter(XBeeRTOS* rtos, at_command_t command, const uint8_t* parameter, uint8_t paramLength);
+bool XBeeRTOSGetParameter(XBeeRTOS* rtos, at_command_t command, uint8_t* responseBuffer, uint8_t bufferSize, uint8_t* responseLength);
+bool XBeeRTOSDispatch(XBeeRTOS* rtos, TickType_t timeout);
+void XBeeRTOSNotifyRx(XBeeRTOS* rtos);
+void XBeeRTOSNotifyRxFromISR(XBeeRTOS* rtos, BaseType_t* higherPriorityTaskWoken);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEE_FREERTOS_ENABLED
+
+#endif // PORT_FREERTOS_H
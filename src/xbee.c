@@ -35,14 +35,44 @@
 
 #include "xbee.h"
 #include "xbee_api_frames.h" 
+#include "xbee_trace.h"
+#include <string.h>
 
 // Base class methods
 
+/**
+ * @brief Initializes the common fields of a freshly created XBee instance.
+ * 
+ * Called by the subclass constructors (`XBeeLRCreate()`, `XBeeLRInitStatic()`) before the 
+ * subclass fields are set up. Every field gets a defined value, so the instance is safe to 
+ * use before `XBeeInit()`. No memory is allocated: the buffers come from `storage`.
+ * 
+ * @param[out] self Pointer to the XBee instance.
+ * @param[in] storage Buffers the instance works with.
+ * @param[in] cTable Pointer to the callback table.
+ * @param[in] hTable Pointer to the hardware table.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeInitInstance(XBee* self, const XBeeStorage* storage, const XBeeCTable* cTable, const XBeeHTable* hTable) {
+    memset(self, 0, sizeof(*self));
+    self->htable = hTable;
+    self->ctable = cTable;
+    self->frameIdCntr = 1;
+    self->apiMode = XBEE_API_MODE_DEFAULT;
+    self->rx.data = storage->rxBuffer;
+    self->rx.size = storage->rxBufferSize;
+    self->txTable = storage->txTable;
+    self->txTableSize = storage->txTableSize;
+    memset(self->txTable, 0, self->txTableSize * sizeof(XBeeTxEntry));
+    XBeeResetStats(self);
+}
+
 /**
  * @brief Initializes the XBee module.
  * 
- * This function initializes the XBee module by setting the initial frame ID counter 
- * and calling the XBee subclass specific initialization routine.
+ * This function initializes the XBee module by setting the initial frame ID counter, 
+ * resetting the API frame parser and the pending request tables, and calling the XBee subclass specific initialization routine.
  * 
  * @param[in] self Pointer to the XBee instance.
  * @param[in] baudrate Baud rate for the serial communication.
@@ -52,6 +82,13 @@
  */
 bool XBeeInit(XBee* self, uint32_t baudRate, void* device) {
     self->frameIdCntr = 1;
+    self->baudRate = baudRate;
+    self->device = device;
+    memset(self->txTable, 0, self->txTableSize * sizeof(XBeeTxEntry));
+    self->atPending = NULL;
+    self->configBatch = NULL;
+    memset(&self->shadow, 0, sizeof(self->shadow));
+    apiResetRxParser(self);
     return self->vtable->init(self, baudRate, device);
 }
 
@@ -143,6 +180,140 @@ void XBeeProcess(XBee* self) {
     self->vtable->process(self);
 }
 
+/**
+ * @brief Services several XBee instances from one loop.
+ * 
+ * Each instance is processed once per call. Since sends, joins and AT commands are 
+ * completed from `XBeeProcess()`, work started on several modules progresses in parallel 
+ * instead of one module waiting for another.
+ * 
+ * @param[in] instances Array of XBee instances, NULL entries are skipped.
+ * @param[in] count Number of entries in `instances`.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeProcessAll(XBee* const* instances, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (instances[i] != NULL) {
+            XBeeProcess(instances[i]);
+        }
+    }
+}
+
+// Milliseconds from now until deadline, 0 if it has passed
+static uint32_t xbeeTimeUntil(uint32_t deadline, uint32_t now) {
+    int32_t remaining = (int32_t)(deadline - now);
+    return (remaining > 0) ? (uint32_t)remaining : 0;
+}
+
+/**
+ * @brief Returns the time until `XBeeProcess()` has a timeout to handle.
+ * 
+ * Covers outstanding transmissions, pending AT commands, a partially received frame and 
+ * the subclass' own timers such as the join state machine. Frames arriving earlier are 
+ * not known in advance; they are signalled through `PortWaitForRx`.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint32_t Milliseconds until the earliest deadline, 0 if one is due, or 
+ * `XBEE_WAIT_FOREVER` if nothing is waiting for a timeout.
+ */
+uint32_t XBeeNextDeadline(XBee* self) {
+    uint32_t now = self->htable->PortMillis(self->portContext);
+    uint32_t next = XBEE_WAIT_FOREVER;
+    uint32_t remaining;
+
+    for (int i = 0; i < self->txTableSize; i++) {
+        if (self->txTable[i].frameId != 0) {
+            remaining = xbeeTimeUntil(self->txTable[i].deadline, now);
+            if (remaining < next) next = remaining;
+        }
+    }
+    for (const xbee_at_request_t *request = self->atPending; request != NULL; request = request->next) {
+        remaining = xbeeTimeUntil(request->deadline, now);
+        if (remaining < next) next = remaining;
+    }
+    if (self->rx.state != XBEE_RX_STATE_DELIMITER) {
+        remaining = xbeeTimeUntil(self->rx.lastByteTime + UART_READ_TIMEOUT_MS, now);
+        if (remaining < next) next = remaining;
+    }
+    if (self->vtable->nextDeadline != NULL) {
+        remaining = self->vtable->nextDeadline(self, now);
+        if (remaining < next) next = remaining;
+    }
+    return next;
+}
+
+/**
+ * @brief Waits until the module sends something or the next deadline, whichever comes first.
+ * 
+ * Meant to be called between calls to `XBeeProcess()` so the MCU only wakes up when there 
+ * is work to do. With `PortWaitForRx` the port can sleep for the whole wait; without it 
+ * this waits 1 ms, like a polling loop would. Returns immediately if received bytes are 
+ * waiting in the attached ring or a deadline is due.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] maxMs Longest time to wait, e.g. until the application's own next task, or 
+ * `XBEE_WAIT_FOREVER`.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeWait(XBee* self, uint32_t maxMs) {
+    uint32_t timeout = XBeeNextDeadline(self);
+    if (timeout > maxMs) {
+        timeout = maxMs;
+    }
+    if ((timeout == 0) || ((self->rxRing != NULL) && (self->rxRing->head != self->rx.scan))) {
+        return;
+    }
+    if (self->htable->PortWaitForRx != NULL) {
+        self->htable->PortWaitForRx(self->portContext, timeout);
+    } else {
+        self->htable->PortDelay(self->portContext, 1);
+    }
+}
+
+/**
+ * @brief Sets the context passed to every XBeeHTable function of this instance.
+ * 
+ * Ports use it to find the UART and other per-module state, which lets one hardware 
+ * table serve several modules. Must be set before `XBeeInit()`.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] portContext Port specific state, may be NULL for single instance ports.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeSetPortContext(XBee* self, void* portContext) {
+    self->portContext = portContext;
+}
+
+/**
+ * @brief Attaches an application pointer to the instance.
+ * 
+ * XBeeCTable callbacks receive the XBee instance only; the user context lets them find 
+ * the object that owns it when several modules share the same callbacks.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] userContext Application pointer.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeSetUserContext(XBee* self, void* userContext) {
+    self->userContext = userContext;
+}
+
+/**
+ * @brief Returns the pointer set with `XBeeSetUserContext()`.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return void* The user context, NULL if none was set.
+ */
+void* XBeeGetUserContext(XBee* self) {
+    return self->userContext;
+}
+
 /**
  * @brief Checks if the XBee module is connected to the network.
  * 
@@ -164,20 +335,22 @@ bool XBeeConnected(XBee* self) {
  * This function sends the ATWR command using an API frame to write the current configuration settings 
  * to the XBee module's non-volatile memory. The function waits for a response from the module 
  * to confirm that the command was successful. If the command fails or the module does not respond, 
- * a debug message is printed.
+ * a debug message is printed. WR is always sent, since parameters changed with AT commands 
+ * sent directly (e.g. `apiSendAtCommandAsync()`) are not tracked by the shadow; 
+ * `XBeeConfigCommit()` skips the write when nothing changed through the setters.
  * 
  * @param[in] self Pointer to the XBee instance.
  * 
  * @return bool Returns true if the configuration was successfully written, otherwise false.
  */
 bool XBeeWriteConfig(XBee* self) {
-    uint8_t response[33];
     uint8_t responseLength;
-    int status = apiSendAtCommandAndGetResponse(self, AT_WR, NULL, 0, response, &responseLength, 5000);
+    int status = apiSendAtCommandAndGetResponse(self, AT_WR, NULL, 0, NULL, &responseLength, 5000);
     if(status != API_SEND_SUCCESS){
         XBEEDebugPrint("Failed to Write Config\n");
         return false;
     }
+    self->shadow.dirty = false;
     return true;
 }
 
@@ -194,9 +367,8 @@ bool XBeeWriteConfig(XBee* self) {
  */
 
 bool XBeeApplyChanges(XBee* self) {
-    uint8_t response[33];
     uint8_t responseLength;
-    int status = apiSendAtCommandAndGetResponse(self, AT_AC, NULL, 0, response, &responseLength, 5000);
+    int status = apiSendAtCommandAndGetResponse(self, AT_AC, NULL, 0, NULL, &responseLength, 5000);
     if(status != API_SEND_SUCCESS){
         XBEEDebugPrint("Failed to Apply Changes\n");
         return false;
@@ -219,13 +391,856 @@ bool XBeeApplyChanges(XBee* self) {
  * @return bool Returns true if the API Options was successfully set, otherwise false.
  */
 bool XBeeSetAPIOptions(XBee* self, const uint8_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-    int status = apiSendAtCommandAndGetResponse(self, AT_AO, (const uint8_t[]){value}, 1, response, &responseLength, 5000);
-    if(status != API_SEND_SUCCESS){
+    if (!XBeeSetParameter(self, AT_AO, &value, 1)) {
         XBEEDebugPrint("Failed to set API Options\n");
         return false;
     }
     return true;
 }
 
+// Standard rates, indexed by their BD parameter code
+static const uint32_t xbeeBaudRates[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
+
+/**
+ * @brief Returns the BD parameter value for a baud rate.
+ * 
+ * @param[in] baudRate Baud rate in bits per second.
+ * 
+ * @return uint32_t The code 0-10 for a standard rate, otherwise the rate itself, which 
+ * the module accepts as a non-standard rate.
+ */
+uint32_t XBeeBaudRateCode(uint32_t baudRate) {
+    for (uint8_t i = 0; i < sizeof(xbeeBaudRates) / sizeof(xbeeBaudRates[0]); i++) {
+        if (xbeeBaudRates[i] == baudRate) return i;
+    }
+    return baudRate;
+}
+
+// Reads BD at the current host rate and checks that the module answers with the expected value
+static bool xbeeProbeBaudRate(XBee* self, uint32_t code) {
+    uint8_t response[4];
+    xbee_at_request_t request;
+
+    apiAtRequestInit(&request, response, sizeof(response), NULL, NULL);
+    if ((apiSendAtCommandAsync(self, &request, AT_BD, NULL, 0, XBEE_BAUD_PROBE_TIMEOUT_MS) != API_SEND_SUCCESS) ||
+        (apiAtRequestWait(self, &request) != API_SEND_SUCCESS)) {
+        return false;
+    }
+    uint8_t responseLength = (request.responseLength < sizeof(response)) ? request.responseLength : sizeof(response);
+
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < responseLength; i++) {
+        value = (value << 8) | response[i];
+    }
+    return value == code;
+}
+
+// Reopens the host UART at a new rate and drops whatever was received during the switch
+static bool xbeeReopenUart(XBee* self, uint32_t baudRate) {
+    self->htable->PortDelay(self->portContext, XBEE_BAUD_SWITCH_DELAY_MS);
+    if (self->htable->PortUartInit(self->portContext, baudRate, self->device) != UART_SUCCESS) {
+        return false;
+    }
+    self->baudRate = baudRate;
+    self->htable->PortFlushRx(self->portContext);
+    apiResetRxParser(self);
+    return true;
+}
+
+// Sends BD followed by AC, the module switches once it has answered AC
+static bool xbeeApplyBaudRate(XBee* self, uint32_t code) {
+    uint8_t parameter[4];
+    uint8_t responseLength;
+    parameter[0] = (uint8_t)(code >> 24);
+    parameter[1] = (uint8_t)(code >> 16);
+    parameter[2] = (uint8_t)(code >> 8);
+    parameter[3] = (uint8_t)code;
+    return (apiSendAtCommandAndGetResponse(self, AT_BD, parameter, sizeof(parameter), NULL, &responseLength, 5000) == API_SEND_SUCCESS) &&
+           (apiSendAtCommandAndGetResponse(self, AT_AC, NULL, 0, NULL, &responseLength, 5000) == API_SEND_SUCCESS);
+}
+
+/**
+ * @brief Moves the module and the host UART to a new baud rate together.
+ * 
+ * Sends BD and AC at the current rate, reopens the host UART at the new rate and reads BD 
+ * back as a probe. If the probe fails, the host UART goes back to the previous rate and the 
+ * module is told to do the same, so the link is left at the rate it worked at. The new rate 
+ * is not written to flash; call `XBeeWriteConfig()` to keep it across power cycles. Outstanding 
+ * AT commands and transmissions should be completed first, and no configuration batch may be open.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] baudRate New baud rate in bits per second, e.g. 230400-921600.
+ * 
+ * @return bool Returns true if both sides run at the new rate, false if the link is still 
+ * (or again) at the previous rate or could not be recovered.
+ */
+bool XBeeSetBaudRate(XBee* self, uint32_t baudRate) {
+    uint32_t previous = self->baudRate;
+    if ((baudRate == 0) || (self->configBatch != NULL)) {
+        return false;
+    }
+    if (baudRate == previous) {
+        return true;
+    }
+
+    if (!xbeeApplyBaudRate(self, XBeeBaudRateCode(baudRate))) {
+        XBEEDebugPrint("Failed to set baud rate %lu\n", (unsigned long)baudRate);
+        return false;
+    }
+    self->shadow.dirty = true;  // BD differs from the value in flash
+
+    if (xbeeReopenUart(self, baudRate) && xbeeProbeBaudRate(self, XBeeBaudRateCode(baudRate))) {
+        return true;
+    }
+
+    // The module did not answer at the new rate, go back to where the link worked
+    XBEEDebugPrint("Baud rate probe at %lu failed, falling back to %lu\n", (unsigned long)baudRate, (unsigned long)previous);
+    if (!xbeeReopenUart(self, previous)) {
+        return false;
+    }
+    if (!xbeeProbeBaudRate(self, XBeeBaudRateCode(previous))) {
+        // The module may have switched after all, ask it to come back from the new rate
+        if (xbeeReopenUart(self, baudRate)) {
+            xbeeApplyBaudRate(self, XBeeBaudRateCode(previous));
+        }
+        xbeeReopenUart(self, previous);
+    }
+    return false;
+}
+
+/**
+ * @brief Enables or disables RTS/CTS hardware flow control on both ends of the UART.
+ * 
+ * The module is configured with D6 (RTS) and D7 (CTS) and the port layer through 
+ * `PortUartSetFlowControl`. When enabling, the host side is switched first so RTS is 
+ * driven before the module starts to honour it; when disabling, the module goes first.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] enable True to enable flow control, false to disable it.
+ * 
+ * @return bool Returns true on success, false if the port has no flow control support 
+ * or the module rejected the configuration.
+ */
+bool XBeeSetFlowControl(XBee* self, bool enable) {
+    if ((self->htable->PortUartSetFlowControl == NULL) || (self->configBatch != NULL)) {
+        return false;
+    }
+
+    uint8_t value = enable ? 1 : 0;
+    if (enable && (self->htable->PortUartSetFlowControl(self->portContext, true) != 0)) {
+        return false;
+    }
+    if (!XBeeSetParameter(self, AT_D6, &value, 1) || !XBeeSetParameter(self, AT_D7, &value, 1) ||
+        !XBeeApplyChanges(self)) {
+        XBEEDebugPrint("Failed to configure flow control\n");
+        if (enable) {
+            self->htable->PortUartSetFlowControl(self->portContext, false);
+        }
+        return false;
+    }
+    if (!enable) {
+        self->htable->PortUartSetFlowControl(self->portContext, false);
+    }
+    return true;
+}
+
+/**
+ * @brief Selects the API mode the host speaks, without configuring the module.
+ * 
+ * Use this when the module already runs in the mode, e.g. AP=2 was written to its flash. 
+ * A partially received frame is discarded.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] mode `XBEE_API_MODE` (AP=1) or `XBEE_API_MODE_ESCAPED` (AP=2).
+ * 
+ * @return bool Returns true on success, false if the mode is not supported.
+ */
+bool XBeeSetHostAPIMode(XBee* self, uint8_t mode) {
+    if ((mode != XBEE_API_MODE) && (mode != XBEE_API_MODE_ESCAPED)) {
+        return false;
+    }
+    self->apiMode = mode;
+    apiResetRxParser(self);
+    return true;
+}
+
+/**
+ * @brief Switches the module and the host to an API mode.
+ * 
+ * Escaped mode (AP=2) makes a 0x7E inside a frame impossible, so the parser always 
+ * resynchronizes on the next frame after corruption instead of losing the frames that 
+ * follow. AP is sent in the current mode; the host switches as soon as AC has been 
+ * written, so the AC response is parsed in the new mode. The mode is not written to 
+ * flash; call `XBeeWriteConfig()` to keep it.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] mode `XBEE_API_MODE` (AP=1) or `XBEE_API_MODE_ESCAPED` (AP=2).
+ * 
+ * @return bool Returns true if both sides use the new mode, otherwise false.
+ */
+bool XBeeSetAPIMode(XBee* self, uint8_t mode) {
+    uint8_t previous = self->apiMode;
+    if (((mode != XBEE_API_MODE) && (mode != XBEE_API_MODE_ESCAPED)) || (self->configBatch != NULL)) {
+        return false;
+    }
+    if (!XBeeSetParameter(self, AT_AP, &mode, 1)) {
+        XBEEDebugPrint("Failed to set API mode %u\n", mode);
+        return false;
+    }
+
+    xbee_at_request_t request;
+    apiAtRequestInit(&request, NULL, 0, NULL, NULL);
+    if (apiSendAtCommandAsync(self, &request, AT_AC, NULL, 0, 5000) != API_SEND_SUCCESS) {
+        return false;
+    }
+    XBeeSetHostAPIMode(self, mode);
+    if (apiAtRequestWait(self, &request) != API_SEND_SUCCESS) {
+        XBEEDebugPrint("Failed to apply API mode %u\n", mode);
+        XBeeSetHostAPIMode(self, previous);
+        return false;
+    }
+    return true;
+}
+
+// FNV-1a hash of a parameter value, used to recognise values the module already holds
+static uint32_t xbeeShadowHash(const uint8_t* value, uint8_t length) {
+    uint32_t hash = 2166136261UL;
+    for (uint8_t i = 0; i < length; i++) {
+        hash = (hash ^ value[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+// Returns true if the module is known to hold this value for the parameter
+static bool xbeeShadowHolds(XBee* self, at_command_t command, uint8_t length, uint32_t hash) {
+    for (uint8_t i = 0; i < self->shadow.writeCount; i++) {
+        if (self->shadow.writes[i].command == command) {
+            return (self->shadow.writes[i].length == length) && (self->shadow.writes[i].hash == hash);
+        }
+    }
+    return false;
+}
+
+// Records a value accepted by the module, the configuration now differs from flash
+static void xbeeShadowStore(XBee* self, at_command_t command, uint8_t length, uint32_t hash) {
+    XBeeShadow *shadow = &self->shadow;
+    uint8_t i;
+    for (i = 0; i < shadow->writeCount; i++) {
+        if (shadow->writes[i].command == command) break;
+    }
+    if (i == shadow->writeCount) {
+        if (shadow->writeCount >= XBEE_SHADOW_WRITE_ENTRIES) {
+            shadow->dirty = true;
+            return; // Cache full, the value just is not remembered
+        }
+        shadow->writeCount++;
+    }
+    shadow->writes[i].command = command;
+    shadow->writes[i].length = length;
+    shadow->writes[i].hash = hash;
+    shadow->dirty = true;
+}
+
+/**
+ * @brief Sets a module parameter, or queues it when a configuration batch is open.
+ * 
+ * Without an open batch this sends the AT command and blocks until the module has 
+ * answered, exactly like the individual setters used to. Inside `XBeeConfigBegin()` / 
+ * `XBeeConfigCommit()` the value is queued with an 0x09 frame instead and the call 
+ * returns as soon as the frame has been sent; the module's answer is checked by the commit.
+ * All parameter setters go through this function.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] command The AT command of the parameter.
+ * @param[in] parameter Pointer to the parameter value (can be NULL).
+ * @param[in] paramLength Length of the parameter value in bytes.
+ * 
+ * @return bool Returns true if the parameter was set (or queued), otherwise false.
+ */
+bool XBeeSetParameter(XBee* self, at_command_t command, const uint8_t* parameter, uint8_t paramLength) {
+    uint32_t hash = xbeeShadowHash(parameter, paramLength);
+    if (xbeeShadowHolds(self, command, paramLength, hash)) {
+        // The module already holds this value
+        return true;
+    }
+
+    if (self->configBatch != NULL) {
+        return XBeeConfigAdd(self, command, parameter, paramLength);
+    }
+
+    uint8_t responseLength;
+    int status = apiSendAtCommandAndGetResponse(self, command, parameter, paramLength, NULL, &responseLength, 5000);
+    if (status != API_SEND_SUCCESS) {
+        return false;
+    }
+    xbeeShadowStore(self, command, paramLength, hash);
+    return true;
+}
+
+/**
+ * @brief Sets a 32-bit numeric module parameter.
+ * 
+ * XBee numeric parameters are big-endian on the wire, independent of the host's byte order.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] command The AT command of the parameter.
+ * @param[in] value Value to set.
+ * 
+ * @return bool Returns true if the module accepted the value (or already held it), otherwise false.
+ */
+bool XBeeSetParameterUint32(XBee* self, at_command_t command, uint32_t value) {
+    uint8_t parameter[4];
+    parameter[0] = (uint8_t)(value >> 24);
+    parameter[1] = (uint8_t)(value >> 16);
+    parameter[2] = (uint8_t)(value >> 8);
+    parameter[3] = (uint8_t)value;
+    return XBeeSetParameter(self, command, parameter, sizeof(parameter));
+}
+
+/**
+ * @brief Reads a module parameter, answering immutable ones from the shadow cache.
+ * 
+ * LV and VR never change while the module runs, so they are queried once and 
+ * returned from RAM afterwards. All other parameters are always read from the module, 
+ * including DE: `AT_DE` (Device EUI on XBee LR) has the value of `AT_DE_RF`, the writable 
+ * Destination Endpoint on XBee 3 RF, so it cannot be told apart by its command. The LR 
+ * DevEUI is cached by `XBeeLRGetDevEUI()` instead.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] command The AT command of the parameter.
+ * @param[out] responseBuffer Buffer that receives the value.
+ * @param[in] bufferSize Size of `responseBuffer` in bytes, longer values are truncated.
+ * @param[out] responseLength Length of the value reported by the module (can be NULL).
+ * 
+ * @return bool Returns true if the value was read, otherwise false.
+ */
+bool XBeeGetParameter(XBee* self, at_command_t command, uint8_t* responseBuffer, uint8_t bufferSize, uint8_t* responseLength) {
+    bool immutable = (command == AT_LV) || (command == AT_VR);
+    XBeeShadow *shadow = &self->shadow;
+
+    if (immutable) {
+        for (uint8_t i = 0; i < shadow->readCount; i++) {
+            if (shadow->reads[i].command == command) {
+                uint8_t length = shadow->reads[i].length;
+                memcpy(responseBuffer, shadow->reads[i].value, (length < bufferSize) ? length : bufferSize);
+                if (responseLength != NULL) *responseLength = length;
+                return true;
+            }
+        }
+    }
+
+    xbee_at_request_t request;
+    apiAtRequestInit(&request, responseBuffer, bufferSize, NULL, NULL);
+    if ((apiSendAtCommandAsync(self, &request, command, NULL, 0, 5000) != API_SEND_SUCCESS) ||
+        (apiAtRequestWait(self, &request) != API_SEND_SUCCESS)) {
+        return false;
+    }
+    if (responseLength != NULL) *responseLength = request.responseLength;
+
+    if (immutable && (shadow->readCount < XBEE_SHADOW_READ_ENTRIES) &&
+        (request.responseLength <= bufferSize) && (request.responseLength <= XBEE_SHADOW_READ_VALUE_SIZE)) {
+        shadow->reads[shadow->readCount].command = command;
+        shadow->reads[shadow->readCount].length = request.responseLength;
+        memcpy(shadow->reads[shadow->readCount].value, responseBuffer, request.responseLength);
+        shadow->readCount++;
+    }
+    return true;
+}
+
+/**
+ * @brief Forgets every parameter value cached for written parameters.
+ * 
+ * The next setter call sends its value again, and the next `XBeeConfigCommit()` writes 
+ * to flash. Call this after changing parameters without going through the setters.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeShadowInvalidate(XBee* self) {
+    self->shadow.writeCount = 0;
+    self->shadow.dirty = true;
+}
+
+/**
+ * @brief Opens a batched configuration transaction.
+ * 
+ * Until `XBeeConfigCommit()` is called, every parameter setter queues its value with 
+ * an 0x09 frame instead of waiting for a full round trip. The module's answers are 
+ * collected in the background and checked all at once by the commit.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] batch Caller-owned batch storage, must stay valid until the commit returns.
+ * 
+ * @return bool Returns true if the batch was opened, false if another batch is already open.
+ */
+bool XBeeConfigBegin(XBee* self, XBeeConfigBatch* batch) {
+    if ((batch == NULL) || (self->configBatch != NULL)) {
+        return false;
+    }
+    memset(batch, 0, sizeof(*batch));
+    self->configBatch = batch;
+    return true;
+}
+
+/**
+ * @brief Queues a parameter value in the open configuration batch.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] command The AT command of the parameter.
+ * @param[in] parameter Pointer to the parameter value (can be NULL).
+ * @param[in] paramLength Length of the parameter value in bytes.
+ * 
+ * @return bool Returns true if the value was sent to the module, false if no batch is open, 
+ * the batch is full or the frame could not be sent.
+ */
+bool XBeeConfigAdd(XBee* self, at_command_t command, const uint8_t* parameter, uint8_t paramLength) {
+    XBeeConfigBatch *batch = self->configBatch;
+    if (batch == NULL) {
+        return false;
+    }
+
+    if (batch->count >= XBEE_CONFIG_BATCH_SIZE) {
+        XBEEDebugPrint("Config batch full\n");
+    } else {
+        xbee_at_request_t *request = &batch->requests[batch->count];
+        apiAtRequestInit(request, NULL, 0, NULL, NULL);
+        if (apiQueueAtParameterAsync(self, request, command, parameter, paramLength, 5000) == API_SEND_SUCCESS) {
+            batch->hashes[batch->count] = xbeeShadowHash(parameter, paramLength);
+            batch->lengths[batch->count] = paramLength;
+            batch->count++;
+            return true;
+        }
+    }
+
+    if (batch->failed++ == 0) {
+        batch->failedCommand = command;
+    }
+    return false;
+}
+
+/**
+ * @brief Applies and optionally saves the open configuration batch.
+ * 
+ * Sends AC (when `apply` is set) and WR (when `write` is set) right behind the queued 
+ * parameters, then processes received frames until every request of the batch has been 
+ * answered or has timed out. WR is skipped when nothing changed since the last write. 
+ * The batch is closed in every case.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] apply True to apply the queued values with AC.
+ * @param[in] write True to save the configuration to non-volatile memory with WR.
+ * 
+ * @return bool Returns true if every queued parameter was accepted and AC/WR succeeded, otherwise false. 
+ * `batch->failed` and `batch->failedCommand` tell what went wrong.
+ */
+bool XBeeConfigCommit(XBee* self, bool apply, bool write) {
+    XBeeConfigBatch *batch = self->configBatch;
+    if (batch == NULL) {
+        return false;
+    }
+    self->configBatch = NULL;
+
+    apiAtRequestInit(&batch->apply, NULL, 0, NULL, NULL);
+    apiAtRequestInit(&batch->write, NULL, 0, NULL, NULL);
+    if (apply) {
+        (void)apiSendAtCommandAsync(self, &batch->apply, AT_AC, NULL, 0, 5000);
+    }
+    if (write && ((batch->count > 0) || self->shadow.dirty)) {
+        (void)apiSendAtCommandAsync(self, &batch->write, AT_WR, NULL, 0, 5000);
+    }
+
+    // Collect every answer in one pass
+    while (1) {
+        bool pending = apiAtRequestPending(&batch->apply) || apiAtRequestPending(&batch->write);
+        for (uint8_t i = 0; (i < batch->count) && !pending; i++) {
+            pending = apiAtRequestPending(&batch->requests[i]);
+        }
+        if (!pending) break;
+
+        // The answers are still outstanding, so there is always a deadline to wake up for
+        XBeeWait(self, XBEE_WAIT_FOREVER);
+        XBeeProcess(self);
+    }
+
+    for (uint8_t i = 0; i < batch->count; i++) {
+        xbee_at_request_t *request = &batch->requests[i];
+        if (request->result != API_SEND_SUCCESS) {
+            if (batch->failed++ == 0) {
+                batch->failedCommand = request->command;
+            }
+        } else if (apply || write) {
+            xbeeShadowStore(self, request->command, batch->lengths[i], batch->hashes[i]);
+            if (self->vtable->configCommitted != NULL) {
+                self->vtable->configCommitted(self, request->command);
+            }
+        }
+    }
+    if (batch->apply.result != API_SEND_SUCCESS) {
+        XBEEDebugPrint("Failed to Apply Changes\n");
+        if (batch->failed++ == 0) batch->failedCommand = AT_AC;
+    }
+    if (batch->write.result != API_SEND_SUCCESS) {
+        XBEEDebugPrint("Failed to Write Config\n");
+        if (batch->failed++ == 0) batch->failedCommand = AT_WR;
+    } else if (write) {
+        self->shadow.dirty = false;
+    }
+    return batch->failed == 0;
+}
+
+
+/**
+ * @brief Initializes a receive ring buffer over caller provided storage.
+ * 
+ * The ring is meant to be filled from a UART RX interrupt or DMA completion handler 
+ * and drained by the API frame parser. The storage must stay valid for as long as the 
+ * ring is attached to an XBee instance.
+ * 
+ * @param[out] ring Pointer to the ring to initialize.
+ * @param[in] storage Buffer used to hold received bytes.
+ * @param[in] size Size of the storage in bytes, must be a power of two no larger than 32768.
+ * 
+ * @return bool Returns true if the ring was initialized, false if the size is invalid.
+ */
+bool XBeeRxRingInit(XBeeRxRing* ring, uint8_t* storage, uint16_t size) {
+    if ((ring == NULL) || (storage == NULL) || (size < 2) || (size > 32768) || (size & (size - 1))) {
+        return false;
+    }
+    ring->buffer = storage;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overruns = 0;
+    return true;
+}
+
+/**
+ * @brief Pushes one received byte into the ring.
+ * 
+ * Safe to call from the UART RX interrupt while the main loop parses frames, as long 
+ * as there is a single producer. Bytes that do not fit are dropped and counted in 
+ * `overruns`.
+ * 
+ * @param[in] ring Pointer to the ring.
+ * @param[in] byte The received byte.
+ * 
+ * @return bool Returns true if the byte was stored, false if the ring was full.
+ */
+bool XBeeRxRingPut(XBeeRxRing* ring, uint8_t byte) {
+    uint16_t head = ring->head;
+    if ((uint16_t)(head - ring->tail) > ring->mask) {
+        ring->overruns++;
+        return false;
+    }
+    ring->buffer[head & ring->mask] = byte;
+    ring->head = head + 1;
+    return true;
+}
+
+/**
+ * @brief Pushes a block of received bytes into the ring.
+ * 
+ * Intended for DMA completion or FIFO drain handlers that deliver several bytes at 
+ * once. Bytes that do not fit are dropped and counted in `overruns`.
+ * 
+ * @param[in] ring Pointer to the ring.
+ * @param[in] data Pointer to the received bytes.
+ * @param[in] length Number of bytes received.
+ * 
+ * @return uint16_t The number of bytes stored.
+ */
+uint16_t XBeeRxRingWrite(XBeeRxRing* ring, const uint8_t* data, uint16_t length) {
+    uint16_t head = ring->head;
+    uint16_t space = (uint16_t)(ring->mask + 1 - (uint16_t)(head - ring->tail));
+    uint16_t count = (length < space) ? length : space;
+
+    for (uint16_t i = 0; i < count; i++) {
+        ring->buffer[(uint16_t)(head + i) & ring->mask] = data[i];
+    }
+    ring->head = head + count;
+    ring->overruns += length - count;
+    return count;
+}
+
+/**
+ * @brief Switches the XBee instance to receive through an ISR/DMA fed ring buffer.
+ * 
+ * Once attached, the API frame parser reads from the ring instead of calling 
+ * `PortUartRead`, and complete frames are handed to the handlers as views into the 
+ * ring. If the hardware table provides `PortUartAttachRing`, it is called so the port 
+ * layer can route its RX interrupt into the ring; otherwise the application is 
+ * responsible for calling `XBeeRxRingPut()` from its UART interrupt. Pass NULL to go 
+ * back to `PortUartRead`. The ring must hold at least one maximum sized frame plus 
+ * its 4 header and checksum bytes.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] ring Pointer to an initialized ring, or NULL to detach.
+ * 
+ * @return bool Returns true if the ring was attached, otherwise false.
+ */
+bool XBeeAttachRxRing(XBee* self, XBeeRxRing* ring) {
+    self->rxRing = ring;
+    if (ring != NULL) {
+        self->rx.scan = ring->tail;
+    }
+    apiResetRxParser(self);
+    if (self->htable->PortUartAttachRing != NULL) {
+        return self->htable->PortUartAttachRing(self->portContext, ring) == 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Registers the handler called for a received API frame type.
+ * 
+ * Received frames are dispatched with one lookup in a per-instance map, so the cost does 
+ * not grow with the number of frame types handled. The subclass fills the map with its 
+ * own handlers when the instance is created; applications can add handlers for any other 
+ * type (e.g. IO samples or remote AT responses) or replace the subclass ones. Types 
+ * that share a handler and context share one of the `XBEE_FRAME_HANDLER_SLOTS` slots.
+ * 
+ * AT command responses and modem status frames drive the library's own request and 
+ * parameter tracking and cannot be replaced.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] frameType Received frame type, 0x80-0xFF.
+ * @param[in] handler Handler to call, or NULL to remove the current handler.
+ * @param[in] ctx User pointer passed to the handler.
+ * 
+ * @return bool Returns true on success, false if the type is reserved or out of range, 
+ * or if all handler slots are in use.
+ */
+bool XBeeRegisterFrameHandler(XBee* self, uint8_t frameType, XBeeFrameHandler handler, void* ctx) {
+    if ((frameType < XBEE_FRAME_HANDLER_FIRST_TYPE) || (frameType == XBEE_API_TYPE_AT_RESPONSE) 
+        || (frameType == XBEE_API_TYPE_MODEM_STATUS)) {
+        return false;
+    }
+    return apiSetFrameHandler(self, frameType, handler, ctx);
+}
+
+/**
+ * @brief Checks whether a frame ID is owned by an outstanding request.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] frameId Frame ID to check.
+ * 
+ * @return bool Returns true if a transmission or AT command is still waiting for a response with this frame ID.
+ */
+bool XBeeFrameIdInUse(XBee* self, uint8_t frameId) {
+    for (int i = 0; i < self->txTableSize; i++) {
+        if (self->txTable[i].frameId == frameId) return true;
+    }
+    for (xbee_at_request_t *request = self->atPending; request != NULL; request = request->next) {
+        if (request->frameId == frameId) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the frame ID the next `apiSendFrame()` call will use.
+ * 
+ * The frame ID counter is advanced past IDs that are still owned by outstanding 
+ * requests, so a late response can never be matched to the wrong request.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint8_t The frame ID to send the next request with.
+ */
+uint8_t XBeeReserveFrameId(XBee* self) {
+    while (XBeeFrameIdInUse(self, self->frameIdCntr)) {
+        self->frameIdCntr++;
+        if (self->frameIdCntr == 0) self->frameIdCntr = 1;
+    }
+    return self->frameIdCntr;
+}
+
+/**
+ * @brief Reserves a TX table entry for the next frame sent by this instance.
+ * 
+ * The entry is keyed by the frame ID that the next `apiSendFrame()` call will use, see 
+ * `XBeeReserveFrameId()`. The caller must 
+ * send the frame right after this call, or release the entry with `XBeeTxTableCancel()` 
+ * if sending fails.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] timeoutMs Time to wait for the TX status frame before reporting `XBEE_TX_STATUS_TIMEOUT`.
+ * @param[in] callback Completion callback, may be NULL.
+ * @param[in] ctx User pointer passed to the callback.
+ * 
+ * @return uint8_t The frame ID the request must be sent with, or 0 if the table is full.
+ */
+uint8_t XBeeTxTableAdd(XBee* self, uint32_t timeoutMs, XBeeTxCompleteCallback callback, void* ctx) {
+    XBeeTxEntry *slot = NULL;
+    for (int i = 0; i < self->txTableSize; i++) {
+        if (self->txTable[i].frameId == 0) {
+            slot = &self->txTable[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        XBEEDebugPrint("TX table full\n");
+        return 0;
+    }
+
+    slot->frameId = XBeeReserveFrameId(self);
+    slot->deadline = self->htable->PortMillis(self->portContext) + timeoutMs;
+    slot->startTime = XBeeStatsTimestamp(self);
+    slot->callback = callback;
+    slot->ctx = ctx;
+    return slot->frameId;
+}
+
+/**
+ * @brief Releases a TX table entry without invoking its callback.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] frameId Frame ID returned by `XBeeTxTableAdd()`.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeTxTableCancel(XBee* self, uint8_t frameId) {
+    for (int i = 0; i < self->txTableSize; i++) {
+        if ((frameId != 0) && (self->txTable[i].frameId == frameId)) {
+            self->txTable[i].frameId = 0;
+        }
+    }
+}
+
+/**
+ * @brief Completes the outstanding transmission matching a received TX status frame.
+ * 
+ * The entry is released before its callback runs, so the callback may queue the next 
+ * transmission right away.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] frameId Frame ID carried by the TX status frame.
+ * @param[in] status Delivery status carried by the TX status frame.
+ * @param[in] report Subclass specific, parsed status passed to the callback.
+ * 
+ * @return bool Returns true if an outstanding request matched the frame ID, otherwise false.
+ */
+bool XBeeTxTableComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report) {
+    for (int i = 0; i < self->txTableSize; i++) {
+        XBeeTxEntry *entry = &self->txTable[i];
+        if ((frameId != 0) && (entry->frameId == frameId)) {
+            XBeeTxCompleteCallback callback = entry->callback;
+            void *ctx = entry->ctx;
+            entry->frameId = 0;
+            XBeeStatsRecordLatency(self, &self->stats.txLatency, entry->startTime);
+            XBEETraceEvent(self, XBEE_TRACE_TX_STATUS, 0, frameId, status, 0, XBeeStatsTimestamp(self) - entry->startTime);
+            if (callback) {
+                callback(self, frameId, status, report, ctx);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Times out outstanding transmissions whose TX status frame never arrived.
+ * 
+ * Called from the subclass process function. Each expired request is released and its 
+ * callback is invoked with `XBEE_TX_STATUS_TIMEOUT` and a NULL report.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeTxTableExpire(XBee* self) {
+    uint32_t now = self->htable->PortMillis(self->portContext);
+    for (int i = 0; i < self->txTableSize; i++) {
+        XBeeTxEntry *entry = &self->txTable[i];
+        if ((entry->frameId != 0) && ((int32_t)(now - entry->deadline) >= 0)) {
+            uint8_t frameId = entry->frameId;
+            XBeeTxCompleteCallback callback = entry->callback;
+            void *ctx = entry->ctx;
+            entry->frameId = 0;
+            self->stats.txTimeouts++;
+            XBEEDebugPrint("TX status timeout for frame 0x%02X\n", frameId);
+            XBEETraceEvent(self, XBEE_TRACE_TX_TIMEOUT, 0, frameId, 0, 0, 0);
+            if (callback) {
+                callback(self, frameId, XBEE_TX_STATUS_TIMEOUT, NULL, ctx);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of transmissions still waiting for a TX status frame.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint8_t Number of outstanding transmissions.
+ */
+uint8_t XBeeTxPending(XBee* self) {
+    uint8_t pending = 0;
+    for (int i = 0; i < self->txTableSize; i++) {
+        if (self->txTable[i].frameId != 0) pending++;
+    }
+    return pending;
+}
+
+/**
+ * @brief Copies the statistics of an instance.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[out] stats Receives a snapshot of the counters and latencies.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeGetStats(XBee* self, XBeeStats* stats) {
+    *stats = self->stats;
+}
+
+/**
+ * @brief Clears all counters and latencies of an instance.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeResetStats(XBee* self) {
+    memset(&self->stats, 0, sizeof(self->stats));
+    self->stats.atLatency.min = UINT32_MAX;
+    self->stats.txLatency.min = UINT32_MAX;
+    self->stats.timeUnitUs = self->htable->PortMicros ? 1 : 1000;
+}
+
+/**
+ * @brief Returns the current time in the unit the latency statistics are kept in.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint32_t `PortMicros()` if the port provides it, otherwise `PortMillis()`.
+ */
+uint32_t XBeeStatsTimestamp(XBee* self) {
+    if (self->htable->PortMicros) {
+        return self->htable->PortMicros(self->portContext);
+    }
+    return self->htable->PortMillis(self->portContext);
+}
+
+/**
+ * @brief Adds the time elapsed since `startTime` to a latency distribution.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] latency Distribution to update.
+ * @param[in] startTime `XBeeStatsTimestamp()` at the start of the measured stage.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeStatsRecordLatency(XBee* self, XBeeLatencyStats* latency, uint32_t startTime) {
+    uint32_t elapsed = XBeeStatsTimestamp(self) - startTime;
+    uint8_t bucket = 0;
+    for (uint32_t value = elapsed; (value != 0) && (bucket < XBEE_STATS_HISTOGRAM_BUCKETS - 1); value >>= 1) {
+        bucket++;
+    }
+
+    latency->count++;
+    latency->total += elapsed;
+    if (elapsed < latency->min) latency->min = elapsed;
+    if (elapsed > latency->max) latency->max = elapsed;
+    latency->histogram[bucket]++;
+}
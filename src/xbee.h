@@ -46,9 +46,118 @@ extern "C"
 #include <stdlib.h>
 #include "config.h"
 #include "port.h"
+#include "xbee_at_cmds.h"
 
 // Abstract base class for XBee
 typedef struct XBee XBee;
+struct xbee_at_request_s;
+typedef struct XBeeConfigBatch XBeeConfigBatch;
+typedef struct XBeeTrace XBeeTrace;
+
+/**
+ * @typedef XBeeRxRing
+ * @brief Single-producer receive ring buffer fed by a UART ISR or DMA.
+ *
+ * The port layer (or the application's UART interrupt) pushes received bytes with
+ * `XBeeRxRingPut()`/`XBeeRxRingWrite()`, and the frame parser consumes them in place.
+ * `head` and `tail` are free-running counters masked on access, so the storage size
+ * must be a power of two. Bytes of a frame stay in the ring until the frame has been
+ * handled, which lets handlers receive a view into the ring instead of a copy.
+ */
+typedef struct {
+    uint8_t *buffer;              ///< Ring storage
+    uint16_t mask;                ///< Storage size - 1
+    volatile uint16_t head;       ///< Next write position, advanced by the producer
+    volatile uint16_t tail;       ///< Oldest byte still owned by the parser
+    volatile uint32_t overruns;   ///< Bytes dropped because the ring was full
+} XBeeRxRing;
+
+/**
+ * @brief Delivery status reported to a TX completion callback when no TX status frame arrived in time.
+ */
+#define XBEE_TX_STATUS_TIMEOUT 0xFF
+
+/**
+ * @brief Returned by `XBeeNextDeadline()` when nothing is waiting for a timeout, and 
+ * accepted by `XBeeWait()` to wait without a limit of its own.
+ */
+#define XBEE_WAIT_FOREVER 0xFFFFFFFFUL
+
+/**
+ * @typedef XBeeTxCompleteCallback
+ * @brief Per-request completion callback for asynchronous transmissions.
+ *
+ * Called from `XBeeProcess()` once the TX status frame matching `frameId` has been
+ * received, or with `XBEE_TX_STATUS_TIMEOUT` when the request expired. `report` points
+ * to the subclass specific status (an `XBeeLRPacket_t` for XBee LR) and is NULL on
+ * timeout. It is only valid for the duration of the call.
+ */
+typedef void (*XBeeTxCompleteCallback)(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx);
+
+/**
+ * @typedef XBeeTxEntry
+ * @brief Outstanding transmission waiting for its TX status frame.
+ */
+typedef struct {
+    uint8_t frameId;                  ///< Frame ID of the request, 0 if the entry is free
+    uint32_t deadline;                ///< PortMillis() time after which the request times out
+    uint32_t startTime;               ///< XBeeStatsTimestamp() when the request was added
+    XBeeTxCompleteCallback callback;  ///< Completion callback, may be NULL
+    void* ctx;                        ///< User pointer passed to the callback
+} XBeeTxEntry;
+
+/**
+ * @typedef XBeeShadow
+ * @brief In-RAM shadow of module parameters, keyed by `at_command_t`.
+ *
+ * Written parameters are remembered as a hash of the value last accepted by the module, 
+ * so a setter called with the same value again returns without any UART traffic. Immutable 
+ * parameters (LV, VR) are cached by value after the first read. `dirty` tracks whether 
+ * anything was changed since the last WR so `XBeeConfigCommit()` can skip redundant writes to flash. The 
+ * shadow is cleared on RE/NR and whenever the module reports a reset.
+ */
+typedef struct {
+    struct {
+        at_command_t command;     ///< Parameter command
+        uint8_t length;           ///< Length of the value
+        uint32_t hash;            ///< FNV-1a hash of the value
+    } writes[XBEE_SHADOW_WRITE_ENTRIES];
+    uint8_t writeCount;           ///< Number of used write entries
+    struct {
+        at_command_t command;     ///< Parameter command
+        uint8_t length;           ///< Length of the value
+        uint8_t value[XBEE_SHADOW_READ_VALUE_SIZE]; ///< Value returned by the module
+    } reads[XBEE_SHADOW_READ_ENTRIES];
+    uint8_t readCount;            ///< Number of used read entries
+    bool dirty;                   ///< Parameters were changed since the last WR
+} XBeeShadow;
+
+/**
+ * @brief First frame type routed through the frame handler table.
+ *
+ * Frames sent by the module to the host all have bit 7 set, so the handler map only 
+ * covers 0x80-0xFF.
+ */
+#define XBEE_FRAME_HANDLER_FIRST_TYPE 0x80
+#define XBEE_FRAME_HANDLER_MAP_SIZE   (0x100 - XBEE_FRAME_HANDLER_FIRST_TYPE)
+
+/**
+ * @typedef XBeeFrameHandler
+ * @brief Handler for one or more received API frame types.
+ *
+ * `frame` points to the received `xbee_api_frame_t`, whose data is only valid for the 
+ * duration of the call. `ctx` is the pointer given at registration.
+ */
+typedef void (*XBeeFrameHandler)(XBee* self, void* frame, void* ctx);
+
+/**
+ * @typedef XBeeFrameHandlerSlot
+ * @brief Registered frame handler and its context.
+ */
+typedef struct {
+    XBeeFrameHandler handler;     ///< Handler, NULL if the slot is free
+    void* ctx;                    ///< User pointer passed to the handler
+} XBeeFrameHandlerSlot;
 
 /**
  * @typedef XBeeVTable
@@ -71,6 +180,9 @@ typedef struct {
     bool (*connected)(XBee* self);
     void (*handleRxPacketFrame)(XBee* self, void *frame);
     void (*handleTransmitStatusFrame)(XBee* self, void *frame);
+    void (*handleModemStatusFrame)(XBee* self, void *frame);
+    uint32_t (*nextDeadline)(XBee* self, uint32_t now); ///< Optional: ms until the subclass' next timeout, `XBEE_WAIT_FOREVER` if none
+    void (*configCommitted)(XBee* self, at_command_t command); ///< Optional: a parameter queued in a configuration batch is now in effect
 } XBeeVTable;
 
 
@@ -83,14 +195,41 @@ typedef struct {
  * The use of a virtual table allows the XBee library to abstract platform differences,
  * enabling the same code to run on different hardware or operating systems by providing
  * the appropriate function implementations for each platform.
+ *
+ * `PortUartRead` is a bulk, non-blocking read: it must copy `min(available, length)`
+ * already buffered bytes in one call and return the count (0 when nothing is buffered,
+ * negative on failure). The frame parser relies on this to drain a whole frame per call.
+ * When an `XBeeRxRing` is attached the parser reads from the ring instead and
+ * `PortUartRead` is not used.
+ *
+ * `PortUartWrite` may accept fewer bytes than requested. When `PortUartTxSpace` is 
+ * provided, frames are written in chunks that fit the TX buffer and the sender polls 
+ * for space instead of sleeping between partial writes.
+ *
+ * When `PortUartSetFlowControl` enables flow control, the port must hold off the module 
+ * through RTS while its RX buffer is nearly full, and `PortUartWrite` must not send while 
+ * the module holds off the host through CTS (returning 0 is fine, the sender retries).
+ *
+ * `PortWaitForRx` lets the blocking calls and `XBeeWait()` sleep instead of polling every 
+ * millisecond. It must return as soon as a byte is received (or is already buffered) or 
+ * after `timeoutMs`, whichever comes first; returning early for any other reason is fine. 
+ * Without it the library waits with `PortDelay(1)`.
+ * 
+ * Every function receives the instance's port context (see `XBeeSetPortContext()`) as 
+ * its first argument, so one table can drive several modules on different UARTs.
  */
 typedef struct {
-    int (*PortUartRead)(uint8_t *buffer, int length);
-    int (*PortUartWrite)(const uint8_t *buf, uint16_t len);
-    uint32_t (*PortMillis)(void);
-    void (*PortFlushRx)(void);
-    int (*PortUartInit)(uint32_t baudrate, void *device);
-    void (*PortDelay)(uint32_t ms);
+    int (*PortUartRead)(void *ctx, uint8_t *buffer, int length);
+    int (*PortUartWrite)(void *ctx, const uint8_t *buf, uint16_t len);
+    uint32_t (*PortMillis)(void *ctx);
+    void (*PortFlushRx)(void *ctx);
+    int (*PortUartInit)(void *ctx, uint32_t baudrate, void *device);
+    void (*PortDelay)(void *ctx, uint32_t ms);
+    int (*PortUartAttachRing)(void *ctx, XBeeRxRing *ring); ///< Optional: route the UART RX ISR/DMA into a ring, may be NULL
+    int (*PortUartTxSpace)(void *ctx); ///< Optional: free space in the UART TX buffer, may be NULL
+    uint32_t (*PortMicros)(void *ctx); ///< Optional: microsecond clock for latency statistics, may be NULL
+    int (*PortUartSetFlowControl)(void *ctx, bool enable); ///< Optional: enable RTS/CTS flow control, may be NULL
+    void (*PortWaitForRx)(void *ctx, uint32_t timeoutMs); ///< Optional: sleep until UART RX activity or the timeout, may be NULL
 } XBeeHTable;
 
 /**
@@ -110,6 +249,106 @@ typedef struct {
     void (*OnSendCallback)(XBee* self, void * data);
 } XBeeCTable;
 
+/**
+ * @enum xbee_rx_state_t
+ * @brief States of the incremental API frame parser.
+ *
+ * The parser advances one state at a time as bytes arrive from the UART, so a
+ * frame can be assembled across any number of calls to `apiReceiveApiFrame()`.
+ */
+typedef enum {
+    XBEE_RX_STATE_DELIMITER = 0,  ///< Waiting for the 0x7E start delimiter
+    XBEE_RX_STATE_LENGTH_MSB,     ///< Waiting for the length MSB
+    XBEE_RX_STATE_LENGTH_LSB,     ///< Waiting for the length LSB
+    XBEE_RX_STATE_DATA,           ///< Receiving frame data
+    XBEE_RX_STATE_CHECKSUM        ///< Waiting for the checksum byte
+} xbee_rx_state_t;
+
+/**
+ * @typedef XBeeRxParser
+ * @brief State of the resumable API frame parser kept in each XBee instance.
+ *
+ * The checksum is summed while data bytes arrive, so a frame is validated and
+ * ready for dispatch as soon as its checksum byte lands. Without a ring the frame
+ * data is read straight into `data`; with a ring it is parsed in place and `data`
+ * is only used when a frame wraps around the end of the ring.
+ *
+ * In escaped API mode (AP=2) the frame data is unescaped into `data` as it arrives, in 
+ * both modes. A 0x7E can then only be a start delimiter, so it always starts a new frame.
+ */
+typedef struct {
+    xbee_rx_state_t state;        ///< Current parser state
+    uint16_t length;              ///< Frame data length announced in the header
+    uint16_t index;               ///< Number of frame data bytes received so far
+    uint8_t checksum;             ///< Running sum of the frame data bytes
+    uint32_t lastByteTime;        ///< Time the last byte of the pending frame was read
+    uint16_t scan;                ///< Ring mode: next ring position to parse
+    uint16_t start;               ///< Ring mode: ring position of the first frame data byte
+    uint8_t *data;                ///< Frame data (pull mode) or wrapped ring frames
+    uint16_t size;                ///< Size of `data`, the largest frame accepted
+    bool escape;                  ///< Escaped mode: the previous byte was the 0x7D escape
+    uint16_t rawStart;            ///< Escaped pull mode: first unparsed byte read ahead into `data`
+    uint16_t rawEnd;              ///< Escaped pull mode: end of the bytes read ahead into `data`
+} XBeeRxParser;
+
+/**
+ * @typedef XBeeLatencyStats
+ * @brief Latency distribution of one stage, in `XBeeStats::timeUnitUs` units.
+ *
+ * `histogram[0]` counts samples of 0, `histogram[i]` samples from 2^(i-1) up to 
+ * 2^i - 1 and the last bucket everything above. The average is `total / count`.
+ */
+typedef struct {
+    uint32_t count;               ///< Number of samples
+    uint64_t total;               ///< Sum of all samples
+    uint32_t min;                 ///< Smallest sample, UINT32_MAX while count is 0
+    uint32_t max;                 ///< Largest sample
+    uint32_t histogram[XBEE_STATS_HISTOGRAM_BUCKETS]; ///< Samples per power of two bucket
+} XBeeLatencyStats;
+
+/**
+ * @typedef XBeeStats
+ * @brief Counters kept by the frame layer of each XBee instance.
+ *
+ * They are always updated, independent of the debug prints, and cost an increment 
+ * per event. Latencies are timed with `PortMicros` when the port provides it and with 
+ * `PortMillis` otherwise, see `timeUnitUs`.
+ */
+typedef struct {
+    uint32_t framesReceived;      ///< Frames that passed the checksum
+    uint32_t framesSent;          ///< Frames completely written to the UART
+    uint32_t checksumErrors;      ///< Frames dropped for `API_RECEIVE_ERROR_INVALID_CHECKSUM`
+    uint32_t delimiterResyncs;    ///< Bytes skipped while searching for the 0x7E start delimiter
+    uint32_t framesAborted;       ///< Escaped mode: partial frames cut short by a new start delimiter
+    uint32_t framesTooLarge;      ///< Frames dropped because their length was 0 or did not fit the receive buffer
+    uint32_t rxTimeouts;          ///< Frames abandoned because the module stopped sending mid-frame
+    uint32_t uartErrors;          ///< Failures reported by PortUartRead, PortUartWrite or PortUartTxSpace
+    uint32_t uartWriteTimeouts;   ///< Frames that could not be written in time
+    uint32_t atTimeouts;          ///< AT requests that got no response
+    uint32_t txTimeouts;          ///< Transmissions that got no TX status
+    XBeeLatencyStats atLatency;   ///< AT command sent to AT response received
+    XBeeLatencyStats txLatency;   ///< Transmission requested to TX status received
+    uint16_t timeUnitUs;          ///< Unit of the latencies in microseconds, 1 or 1000
+} XBeeStats;
+
+// Values of `XBee::apiMode`, matching the AP parameter
+#define XBEE_API_MODE 1
+#define XBEE_API_MODE_ESCAPED 2
+
+/**
+ * @typedef XBeeStorage
+ * @brief Buffers an XBee instance works with, provided by its creator.
+ *
+ * `XBeeLRCreate()` allocates them with the defaults from config.h. With `XBeeLRInitStatic()` 
+ * they can be placed anywhere (typically static arrays) and sized per instance.
+ */
+typedef struct {
+    uint8_t *rxBuffer;            ///< Receive buffer, sets the largest accepted frame
+    uint16_t rxBufferSize;        ///< Size of `rxBuffer` in bytes
+    XBeeTxEntry *txTable;         ///< Storage for outstanding transmissions
+    uint8_t txTableSize;          ///< Number of entries in `txTable`
+} XBeeStorage;
+
 /**
  * @typedef XBee
  * @brief Represents an XBee device instance.
@@ -124,12 +363,29 @@ struct XBee {
     const XBeeHTable* htable;
     const XBeeCTable* ctable;
     uint8_t frameIdCntr;
+    uint32_t baudRate;            ///< Current UART baud rate, used to scale write timeouts
+    uint8_t apiMode;              ///< API mode spoken on the UART: 1 (AP=1) or 2 (escaped, AP=2)
+    void *device;                 ///< UART device passed to XBeeInit(), used to reopen it at a new baud rate
     bool txStatusReceived;        ///< Flag to indicate if TX Status frame was received
     uint8_t deliveryStatus;        ///< Stores the delivery status of the transmitted frame
+    XBeeRxParser rx;               ///< Incremental API frame parser state
+    XBeeRxRing *rxRing;            ///< Optional ISR/DMA fed receive ring, NULL to read through PortUartRead
+    XBeeTxEntry *txTable;                    ///< Transmissions waiting for a TX status frame
+    uint8_t txTableSize;                     ///< Number of entries in txTable
+    struct xbee_at_request_s *atPending;     ///< AT commands waiting for their response
+    XBeeConfigBatch *configBatch;            ///< Open configuration batch, NULL when setters apply immediately
+    XBeeShadow shadow;                       ///< Cache of parameters known to be held by the module
+    void *portContext;                       ///< Passed to every XBeeHTable function
+    uint8_t frameHandlerMap[XBEE_FRAME_HANDLER_MAP_SIZE]; ///< Frame type - 0x80 to handler slot + 1, 0 if unhandled
+    XBeeFrameHandlerSlot frameHandlers[XBEE_FRAME_HANDLER_SLOTS]; ///< Handlers referenced by frameHandlerMap
+    void *userContext;                       ///< Owner of the instance, for routing XBeeCTable callbacks
+    XBeeStats stats;                         ///< Frame layer counters and latencies
+    XBeeTrace *trace;                        ///< Optional binary trace ring, NULL when not tracing
 
 };
 
 // Interface functions to call the methods
+void XBeeInitInstance(XBee* self, const XBeeStorage* storage, const XBeeCTable* cTable, const XBeeHTable* hTable);
 bool XBeeInit(XBee* self, uint32_t baudrate, void* device);
 bool XBeeConnect(XBee* self);
 bool XBeeDisconnect(XBee* self);
@@ -137,10 +393,44 @@ uint8_t XBeeSendData(XBee* self, const void*);
 bool XBeeSoftReset(XBee* self);
 void XBeeHardReset(XBee* self);
 void XBeeProcess(XBee* self);
+void XBeeProcessAll(XBee* const* instances, uint8_t count);
+uint32_t XBeeNextDeadline(XBee* self);
+void XBeeWait(XBee* self, uint32_t maxMs);
+void XBeeSetPortContext(XBee* self, void* portContext);
+void XBeeSetUserContext(XBee* self, void* userContext);
+void* XBeeGetUserContext(XBee* self);
 bool XBeeConnected(XBee* self);
 bool XBeeWriteConfig(XBee* self);
 bool XBeeApplyChanges(XBee* self);
 bool XBeeSetAPIOptions(XBee* self, const uint8_t value);
+uint32_t XBeeBaudRateCode(uint32_t baudRate);
+bool XBeeSetBaudRate(XBee* self, uint32_t baudRate);
+bool XBeeSetFlowControl(XBee* self, bool enable);
+bool XBeeSetAPIMode(XBee* self, uint8_t mode);
+bool XBeeSetHostAPIMode(XBee* self, uint8_t mode);
+bool XBeeSetParameter(XBee* self, at_command_t command, const uint8_t* parameter, uint8_t paramLength);
+bool XBeeSetParameterUint32(XBee* self, at_command_t command, uint32_t value);
+bool XBeeGetParameter(XBee* self, at_command_t command, uint8_t* responseBuffer, uint8_t bufferSize, uint8_t* responseLength);
+void XBeeShadowInvalidate(XBee* self);
+bool XBeeConfigBegin(XBee* self, XBeeConfigBatch* batch);
+bool XBeeConfigAdd(XBee* self, at_command_t command, const uint8_t* parameter, uint8_t paramLength);
+bool XBeeConfigCommit(XBee* self, bool apply, bool write);
+bool XBeeRxRingInit(XBeeRxRing* ring, uint8_t* storage, uint16_t size);
+bool XBeeRxRingPut(XBeeRxRing* ring, uint8_t byte);
+uint16_t XBeeRxRingWrite(XBeeRxRing* ring, const uint8_t* data, uint16_t length);
+bool XBeeAttachRxRing(XBee* self, XBeeRxRing* ring);
+bool XBeeRegisterFrameHandler(XBee* self, uint8_t frameType, XBeeFrameHandler handler, void* ctx);
+bool XBeeFrameIdInUse(XBee* self, uint8_t frameId);
+void XBeeGetStats(XBee* self, XBeeStats* stats);
+void XBeeResetStats(XBee* self);
+uint32_t XBeeStatsTimestamp(XBee* self);
+void XBeeStatsRecordLatency(XBee* self, XBeeLatencyStats* latency, uint32_t startTime);
+uint8_t XBeeReserveFrameId(XBee* self);
+uint8_t XBeeTxTableAdd(XBee* self, uint32_t timeoutMs, XBeeTxCompleteCallback callback, void* ctx);
+void XBeeTxTableCancel(XBee* self, uint8_t frameId);
+bool XBeeTxTableComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report);
+void XBeeTxTableExpire(XBee* self);
+uint8_t XBeeTxPending(XBee* self);
 
 #if defined(__cplusplus)
 }
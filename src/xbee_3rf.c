@@ -0,0 +1,743 @@
+/**
+ * @file xbee_3rf.c
+ * @brief Implementation of the XBee 3 RF (Zigbee / 802.15.4 / DigiMesh) subclass.
+ *
+ * This file contains the implementation of the XBee 3 RF specific functions, including
+ * initialization, association tracking, addressed transmissions and received packet
+ * handling. Transmissions use the same TX table as the XBee LR subclass, so several
+ * frames can be in flight, and received packets are parsed in place in the RX buffer.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_3rf.h"
+#include "xbee_api_frames.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// XBee3RF specific implementations
+
+
+/**
+ * @brief Checks if the XBee 3 RF module is part of a network.
+ *
+ * Association changes are tracked from modem status frames, so this function is answered
+ * from cached state. Only the first call after initialization (or after a module reset)
+ * sends an AT command (`AT_AI`) to learn the association state. DigiMesh and 802.15.4
+ * modules report an AI of 0 as soon as they are running and are always connected.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ *
+ * @return bool Returns true if the module is associated, otherwise false.
+ */
+bool XBee3RFConnected(XBee* self) {
+    XBee3RF *rf = (XBee3RF *)self;
+
+    if (!rf->associationKnown) {
+        uint8_t response = 0xFF;
+        uint8_t responseLength;
+        int status;
+
+        // Send the AT_AI command to query the Association Indication
+        status = apiSendAtCommandAndGetResponse(self, AT_AI, NULL, 0, &response, &responseLength, 5000);
+
+        if (status == API_SEND_SUCCESS) {
+            rf->associated = (response == 0);
+            rf->associationKnown = true;
+        } else {
+            XBEEDebugPrint("Failed to receive AT_AI response, error code: %d\n", status);
+        }
+    }
+    return rf->associated;
+}
+
+/**
+ * @brief Initializes the XBee 3 RF module for communication.
+ *
+ * This function opens the UART through the platform-specific `PortUartInit()` of the
+ * handler table. The association state is learned again on the next `XBee3RFConnected()`.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] baudrate The baud rate for serial communication.
+ * @param[in] device The path to the serial device (e.g., "/dev/ttyUSB0").
+ *
+ * @return bool Returns true if the initialization is successful, otherwise false.
+ */
+bool XBee3RFInit(XBee* self, uint32_t baudRate, void* device) {
+    XBee3RF *rf = (XBee3RF *)self;
+    rf->associated = false;
+    rf->associationKnown = false;
+    rf->associating = false;
+    return (self->htable->PortUartInit(self->portContext, baudRate, device)) == UART_SUCCESS ? true:false;
+}
+
+/**
+ * @brief Processes incoming data and events for the XBee 3 RF module.
+ *
+ * This function must be called continuously in the main loop of the application.
+ * It consumes whatever bytes the UART has buffered, dispatches each frame as soon as
+ * it is complete and reports transmissions whose TX status never arrived. It never
+ * waits for data.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFProcess(XBee* self) {
+    xbee_api_frame_t frame;
+    int status;
+    while ((status = apiReceiveApiFrame(self, &frame)) != API_RECEIVE_PENDING) {
+        if (status == API_RECEIVE_SUCCESS) {
+            apiHandleFrame(self, &frame);
+        } else if (status == API_RECEIVE_ERROR_UART_FAILURE) {
+            XBEEDebugPrint("Error receiving frame.\n");
+            break;
+        } else if (status != API_RECEIVE_ERROR_INVALID_START_DELIMITER) {
+            XBEEDebugPrint("Error receiving frame.\n");
+        }
+    }
+
+    // Report transmissions and AT commands whose response never arrived
+    XBeeTxTableExpire(self);
+    apiAtRequestExpire(self);
+
+    // End a wait of XBee3RFConnect() that ran out of time
+    XBee3RF *rf = (XBee3RF *)self;
+    if (rf->associating && ((int32_t)(self->htable->PortMillis(self->portContext) - rf->associationDeadline) >= 0)) {
+        rf->associating = false;
+    }
+}
+
+/**
+ * @brief Returns the time until `XBee3RFConnect()` stops waiting, the `nextDeadline` of the vtable.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] now Current PortMillis() time.
+ *
+ * @return uint32_t Milliseconds until the association wait ends, 0 if it has ended,
+ * or `XBEE_WAIT_FOREVER` if no wait is in progress.
+ */
+static uint32_t XBee3RFNextDeadline(XBee* self, uint32_t now) {
+    XBee3RF *rf = (XBee3RF *)self;
+    if (!rf->associating) {
+        return XBEE_WAIT_FOREVER;
+    }
+    int32_t remaining = (int32_t)(rf->associationDeadline - now);
+    return (remaining > 0) ? (uint32_t)remaining : 0;
+}
+
+/**
+ * @brief Waits for the XBee 3 RF module to become part of a network.
+ *
+ * The module forms or joins its network on its own, so there is no request to send:
+ * this function returns at once if the module is associated, and otherwise processes
+ * received frames until the joined modem status arrives or `XBEE_3RF_ASSOCIATION_TIMEOUT_MS`
+ * has passed. The function is blocking.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ *
+ * @return bool Returns true if the module is associated.
+ */
+bool XBee3RFConnect(XBee* self) {
+    XBee3RF *rf = (XBee3RF *)self;
+    if (XBee3RFConnected(self)) {
+        return true;
+    }
+
+    rf->associating = true;
+    rf->associationDeadline = self->htable->PortMillis(self->portContext) + XBEE_3RF_ASSOCIATION_TIMEOUT_MS;
+    while (rf->associating && !rf->associated) {
+        XBee3RFProcess(self);
+        if (rf->associating && !rf->associated) {
+            // Sleep until the modem status arrives or the wait ends
+            XBeeWait(self, XBEE_WAIT_FOREVER);
+        }
+    }
+    rf->associating = false;
+
+    if (!rf->associated) {
+        XBEEDebugPrint("Module did not associate\n");
+    }
+    return rf->associated;
+}
+
+/**
+ * @brief Disconnects from the network using the XBee 3 RF module.
+ *
+ * The module stays part of its network, there is nothing to tear down.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ *
+ * @return bool Returns true.
+ */
+bool XBee3RFDisconnect(XBee* self) {
+    (void)self;
+    return true;
+}
+
+// Cache entry of a 64-bit address, NULL if it is not cached
+static XBee3RFAddressEntry* XBee3RFFindAddress(XBee3RF* rf, uint64_t address64) {
+    for (uint8_t i = 0; i < XBEE_3RF_ADDRESS_CACHE_SIZE; i++) {
+        if ((rf->addressCache[i].address64 == address64) && (address64 != 0)) {
+            return &rf->addressCache[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Returns the cache entry of a 64-bit address, replacing the least recently used one if needed.
+ *
+ * The coordinator and broadcast addresses are never cached, NULL is returned for them.
+ */
+static XBee3RFAddressEntry* XBee3RFUseAddress(XBee3RF* rf, uint64_t address64) {
+    if ((address64 == XBEE_3RF_COORDINATOR_ADDRESS) || (address64 == XBEE_3RF_BROADCAST_ADDRESS)) {
+        return NULL;
+    }
+    XBee3RFAddressEntry* entry = XBee3RFFindAddress(rf, address64);
+    if (entry == NULL) {
+        entry = &rf->addressCache[0];
+        for (uint8_t i = 0; i < XBEE_3RF_ADDRESS_CACHE_SIZE; i++) {
+            if (rf->addressCache[i].address64 == 0) {
+                entry = &rf->addressCache[i];
+                break;
+            }
+            if ((int32_t)(rf->addressCache[i].lastUse - entry->lastUse) < 0) {
+                entry = &rf->addressCache[i];
+            }
+        }
+        entry->address64 = address64;
+        entry->address16 = XBEE_3RF_ADDRESS16_UNKNOWN;
+        entry->frameId = 0;
+    }
+    entry->lastUse = rf->addressUse++;
+    return entry;
+}
+
+/**
+ * @brief Returns the cached 16-bit network address of a node.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] address64 64-bit address of the node.
+ * @param[out] address16 Receives the 16-bit address, may be NULL.
+ *
+ * @return bool Returns true if a 16-bit address is known for the node.
+ */
+bool XBee3RFLookupAddress(XBee* self, uint64_t address64, uint16_t* address16) {
+    XBee3RFAddressEntry* entry = XBee3RFFindAddress((XBee3RF *)self, address64);
+    if ((entry == NULL) || (entry->address16 == XBEE_3RF_ADDRESS16_UNKNOWN)) {
+        return false;
+    }
+    if (address16 != NULL) {
+        *address16 = entry->address16;
+    }
+    return true;
+}
+
+/**
+ * @brief Stores the 16-bit network address of a node in the address cache.
+ *
+ * The cache is filled from received packets and TX status frames; this function seeds
+ * it, e.g. with addresses found by a node discovery. Passing `XBEE_3RF_ADDRESS16_UNKNOWN`
+ * makes the next transmission to the node discover its address again.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] address64 64-bit address of the node.
+ * @param[in] address16 16-bit address of the node.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFCacheAddress(XBee* self, uint64_t address64, uint16_t address16) {
+    XBee3RFAddressEntry* entry = XBee3RFUseAddress((XBee3RF *)self, address64);
+    if (entry != NULL) {
+        entry->address16 = address16;
+    }
+}
+
+/**
+ * @brief Forgets every cached 16-bit address, e.g. after the network was re-formed.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFFlushAddressCache(XBee* self) {
+    XBee3RF *rf = (XBee3RF *)self;
+    memset(rf->addressCache, 0, sizeof(rf->addressCache));
+}
+
+/**
+ * @brief Queues data for transmission to a node or as a broadcast without waiting for the result.
+ *
+ * This function sends a TX request frame (0x10) and returns as soon as the frame has been
+ * written to the UART. Set `packet->address64` to `XBEE_3RF_BROADCAST_ADDRESS` for a broadcast.
+ * For a unicast with `packet->address16` set to `XBEE_3RF_ADDRESS16_UNKNOWN` the address cache
+ * supplies the 16-bit address last reported for the destination, so the module does not have
+ * to discover it again. The request is recorded in the TX table under its frame ID; when the
+ * matching TX status frame is received by `XBeeProcess()`, `callback` is invoked with the
+ * delivery status and the parsed `XBee3RFPacket_t`. If no status arrives within
+ * `XBEE_3RF_TX_STATUS_TIMEOUT_MS` the callback is invoked with `XBEE_TX_STATUS_TIMEOUT`. Up to
+ * `XBEE_TX_TABLE_SIZE` requests can be outstanding at the same time.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in,out] packet Packet to send. `packet->frameId` is set to the frame ID used.
+ * @param[in] callback Completion callback, may be NULL.
+ * @param[in] ctx User pointer passed to the callback.
+ *
+ * @return uint8_t The frame ID of the request, or 0 if it could not be sent or the payload
+ * does not fit an API frame.
+ */
+uint8_t XBee3RFSendDataAsync(XBee* self, XBee3RFPacket_t* packet, XBeeTxCompleteCallback callback, void* ctx) {
+    XBee3RF *rf = (XBee3RF *)self;
+    uint8_t header[13];
+
+    // Frame type, header and payload must fit one API frame
+    if ((uint32_t)packet->payloadSize + sizeof(header) + 1 > XBEE_MAX_FRAME_DATA_SIZE) {
+        XBEEDebugPrint("Payload of %u bytes does not fit an API frame\n", packet->payloadSize);
+        return 0;
+    }
+
+    uint8_t frameId = XBeeTxTableAdd(self, XBEE_3RF_TX_STATUS_TIMEOUT_MS, callback, ctx);
+    if (frameId == 0) {
+        return 0;  // Too many transmissions outstanding
+    }
+
+    // A frame ID names one outstanding request: an entry still holding it from a request 
+    // that timed out must not take the status, and the 16-bit address, of this one
+    for (uint8_t i = 0; i < XBEE_3RF_ADDRESS_CACHE_SIZE; i++) {
+        if (rf->addressCache[i].frameId == frameId) {
+            rf->addressCache[i].frameId = 0;
+        }
+    }
+
+    // Take the 16-bit address from the cache unless the caller supplied one
+    uint16_t address16 = packet->address16;
+    XBee3RFAddressEntry* entry = XBee3RFUseAddress(rf, packet->address64);
+    if (entry != NULL) {
+        if (address16 == XBEE_3RF_ADDRESS16_UNKNOWN) {
+            address16 = entry->address16;
+        }
+        if (address16 != XBEE_3RF_ADDRESS16_UNKNOWN) {
+            rf->addressHits++;
+        } else {
+            rf->addressMisses++;
+        }
+        entry->frameId = frameId;
+    } else {
+        address16 = XBEE_3RF_ADDRESS16_UNKNOWN;
+    }
+
+    // Prepare the API frame, the payload is streamed from the caller's buffer
+    packet->frameId = frameId;
+    header[0] = frameId;
+    for (uint8_t i = 0; i < 8; i++) {
+        header[1 + i] = (uint8_t)(packet->address64 >> (56 - 8 * i));
+    }
+    header[9] = (uint8_t)(address16 >> 8);
+    header[10] = (uint8_t)address16;
+    header[11] = packet->broadcastRadius;
+    header[12] = packet->options;
+    xbee_iovec_t iov[2] = {
+        {header, sizeof(header)},
+        {packet->payload, packet->payloadSize},
+    };
+
+    // Send the frame
+    int send_status = apiSendFrameV(self, XBEE_API_TYPE_TX_REQUEST, iov, 2);
+    if (send_status != API_SEND_SUCCESS) {
+        XBeeTxTableCancel(self, frameId);
+        if ((entry != NULL) && (entry->frameId == frameId)) {
+            entry->frameId = 0;
+        }
+        return 0;  // Failed to send the frame
+    }
+    return frameId;
+}
+
+// Completion state of a blocking XBee3RFSendData() call
+typedef struct {
+    bool done;
+    uint8_t status;
+} XBee3RFSendWait;
+
+static void XBee3RFSendDataComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+    (void)self;
+    (void)frameId;
+    (void)report;
+    XBee3RFSendWait *wait = (XBee3RFSendWait *)ctx;
+    wait->status = status;
+    wait->done = true;
+}
+
+/**
+ * @brief Sends data to a node or as a broadcast using the XBee 3 RF module.
+ *
+ * The function is blocking: it is a wrapper around `XBee3RFSendDataAsync()` that keeps
+ * processing received frames (including the status of other outstanding requests) until
+ * the TX status of the packet has been received.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] data Pointer to the data to be sent, encapsulated in an XBee3RFPacket_t structure.
+ *
+ * @return xbee_deliveryStatus_t, 0 if successful, 0xFF if the frame could not be sent or timed out
+ */
+uint8_t XBee3RFSendData(XBee* self, const void* data) {
+    XBee3RFPacket_t *packet = (XBee3RFPacket_t*) data;
+    XBee3RFSendWait wait = {false, XBEE_TX_STATUS_TIMEOUT};
+
+    if (XBee3RFSendDataAsync(self, packet, XBee3RFSendDataComplete, &wait) == 0) {
+        return XBEE_TX_STATUS_TIMEOUT;  // Failed to send the frame
+    }
+
+    // Block until the TX status frame arrives, XBee3RFProcess() reports the timeout
+    while (!wait.done) {
+        XBee3RFProcess(self);
+        if (!wait.done) {
+            XBeeWait(self, XBEE_WAIT_FOREVER);
+        }
+    }
+
+    if (wait.status == XBEE_TX_STATUS_TIMEOUT) {
+        XBEEDebugPrint("Failed to receive TX Request Status frame\n");
+    } else if (wait.status) {
+        XBEEDebugPrint("TX Delivery Status 0x%02X\n", wait.status);
+    }
+    return wait.status;
+}
+
+/**
+ * @brief Restarts the XBee 3 RF module with `AT_FR`.
+ *
+ * The module answers before it restarts and reports the restart in a modem status. The
+ * association state and the 16-bit address cache are cleared, since the network may be
+ * formed or joined again with other addresses; the next `XBee3RFConnected()` asks the
+ * module with `AT_AI` again.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ *
+ * @return bool Returns true if the module accepted the reset, otherwise false.
+ */
+bool XBee3RFSoftReset(XBee* self) {
+    uint8_t responseLength;
+    int status = apiSendAtCommandAndGetResponse(self, AT_FR, NULL, 0, NULL, &responseLength, 5000);
+    if (status != API_SEND_SUCCESS) {
+        XBEEDebugPrint("Failed to reset the module\n");
+        return false;
+    }
+
+    XBee3RF *rf = (XBee3RF *)self;
+    rf->associated = false;
+    rf->associationKnown = false;
+    rf->associating = false;
+    memset(rf->addressCache, 0, sizeof(rf->addressCache));
+    return true;
+}
+
+/**
+ * @brief Resets the XBee 3 RF module.
+ *
+ * The hardware table has no reset line, so this performs the `AT_FR` reset of
+ * `XBee3RFSoftReset()`.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFHardReset(XBee* self) {
+    XBee3RFSoftReset(self);
+}
+
+// Reads a big-endian 64-bit address
+static uint64_t XBee3RFReadAddress64(const uint8_t* data) {
+    uint64_t address = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        address = (address << 8) | data[i];
+    }
+    return address;
+}
+
+/**
+ * @brief Parses an RX packet frame and invokes the receive callback function.
+ *
+ * Handles the RX packet (0x90) and explicit RX indicator (0x91) frames. The source
+ * addresses are stored in the address cache so that a reply needs no address discovery,
+ * and the payload is passed to `OnReceiveCallback` in place, pointing into the frame.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] param Pointer to the received API frame data.
+ *
+ * @return void This function does not return a value.
+ */
+static void XBee3RFHandleRxPacket(XBee* self, void *param) {
+
+    if (param == NULL) return;
+
+    xbee_api_frame_t *frame = (xbee_api_frame_t *)param;
+    if (frame->type != XBEE_API_TYPE_3RF_RX_PACKET && frame->type != XBEE_API_TYPE_3RF_RX_EXPLICIT_PACKET) return;
+
+    XBee3RFPacket_t packet = {0}; // Allocate on the stack and zero-initialize
+
+    APIFrameDebugPrint("RX Packet Data: ");
+    for (int i = 0; i < frame->length; i++) {
+        APIFrameDebugPrint("0x%02X ", frame->data[i]);
+    }
+    APIFrameDebugPrint("\n");
+
+    uint8_t headerLength = (frame->type == XBEE_API_TYPE_3RF_RX_EXPLICIT_PACKET) ? 18 : 12;
+    if (frame->length < headerLength) {
+        return;  // Truncated frame, too short for the fixed fields
+    }
+
+    packet.address64 = XBee3RFReadAddress64(&frame->data[1]);
+    packet.address16 = (uint16_t)(frame->data[9] << 8 | frame->data[10]);
+    if (frame->type == XBEE_API_TYPE_3RF_RX_EXPLICIT_PACKET) {
+        packet.sourceEndpoint = frame->data[11];
+        packet.destinationEndpoint = frame->data[12];
+        packet.clusterId = (uint16_t)(frame->data[13] << 8 | frame->data[14]);
+        packet.profileId = (uint16_t)(frame->data[15] << 8 | frame->data[16]);
+        packet.options = frame->data[17];
+    } else {
+        packet.options = frame->data[11];
+    }
+    packet.payloadSize = frame->length - headerLength;
+    packet.payload = &(frame->data[headerLength]); // Point directly to the payload in the frame data
+
+    // The sender's addresses are current, replies to it can skip address discovery
+    if (packet.address16 != XBEE_3RF_ADDRESS16_UNKNOWN) {
+        XBee3RFCacheAddress(self, packet.address64, packet.address16);
+    }
+
+    if (self->ctable->OnReceiveCallback) {
+        self->ctable->OnReceiveCallback(self, &packet); // Pass the address of the stack variable
+    }
+}
+
+/**
+ * @brief Parses a TX status frame and completes the request it belongs to.
+ *
+ * Handles the extended TX status (0x8B) of Zigbee and DigiMesh firmware and the TX status
+ * (0x89) of 802.15.4 firmware. The 16-bit address reported in an extended status is stored
+ * for the destination of the last frame sent to it; a failed address or route discovery
+ * drops the cached address so the next transmission discovers it again.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] param Pointer to the received API frame data.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFHandleTransmitStatus(XBee* self, void *param) {
+
+    if (param == NULL) return;
+
+    xbee_api_frame_t *frame = (xbee_api_frame_t *)param;
+    if (frame->type != XBEE_API_TYPE_TX_STATUS && frame->type != XBEE_API_TYPE_3RF_EXTENDED_TX_STATUS) return;
+    if (frame->length < ((frame->type == XBEE_API_TYPE_3RF_EXTENDED_TX_STATUS) ? 7 : 3)) return;
+
+    XBee3RFPacket_t packet = {0}; // Allocate on the stack and zero-initialize
+
+    APIFrameDebugPrint("Received Transmit Status Frame: ");
+    for (int i = 1; i < frame->length; i++) {
+        APIFrameDebugPrint("0x%02X ", frame->data[i]);
+    }
+    APIFrameDebugPrint("\n");
+
+    packet.frameId = frame->data[1];
+    packet.address16 = XBEE_3RF_ADDRESS16_UNKNOWN;
+    if (frame->type == XBEE_API_TYPE_3RF_EXTENDED_TX_STATUS) {
+        packet.address16 = (uint16_t)(frame->data[2] << 8 | frame->data[3]);
+        packet.retries = frame->data[4];
+        packet.status = frame->data[5];
+        packet.discovery = frame->data[6];
+    } else {
+        packet.status = frame->data[2];
+    }
+
+    // Update the cache entry of the destination this frame was sent to
+    XBee3RF *rf = (XBee3RF *)self;
+    for (uint8_t i = 0; i < XBEE_3RF_ADDRESS_CACHE_SIZE; i++) {
+        XBee3RFAddressEntry* entry = &rf->addressCache[i];
+        if ((entry->address64 == 0) || (entry->frameId != packet.frameId)) {
+            continue;
+        }
+        packet.address64 = entry->address64;
+        entry->frameId = 0;
+        if ((packet.status == XBEE_3RF_DELIVERY_ADDRESS_NOT_FOUND) || (packet.status == XBEE_3RF_DELIVERY_ROUTE_NOT_FOUND)) {
+            entry->address16 = XBEE_3RF_ADDRESS16_UNKNOWN;
+        } else if ((packet.status == 0) && (packet.address16 != XBEE_3RF_ADDRESS16_UNKNOWN)) {
+            entry->address16 = packet.address16;
+        }
+        break;
+    }
+
+    // Store the delivery status in the XBee instance
+    self->deliveryStatus = packet.status;
+
+    // Set the txStatusReceived flag to indicate the status frame was received
+    self->txStatusReceived = true;
+
+    // Complete the outstanding request this status belongs to
+    XBeeTxTableComplete(self, packet.frameId, packet.status, &packet);
+
+    if (self->ctable->OnSendCallback) {
+        self->ctable->OnSendCallback(self, &packet); // Pass the address of the stack variable
+    }
+}
+
+/**
+ * @brief Tracks the association state from modem status frames.
+ *
+ * A joined or coordinator started status invokes `OnConnectCallback`. A disassociated
+ * status or a module reset while associated invokes `OnDisconnectCallback`; cached 16-bit
+ * addresses are dropped because the node may get new ones when it rejoins.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] param Pointer to the received modem status frame.
+ *
+ * @return void This function does not return a value.
+ */
+static void XBee3RFHandleModemStatus(XBee* self, void *param) {
+    if (param == NULL) return;
+
+    xbee_api_frame_t *frame = (xbee_api_frame_t *)param;
+    if ((frame->type != XBEE_API_TYPE_MODEM_STATUS) || (frame->length < 2)) return;
+
+    XBee3RF *rf = (XBee3RF *)self;
+    bool wasAssociated = rf->associated;
+
+    switch (frame->data[1]) {
+        case XBEE_3RF_MODEM_STATUS_JOINED:
+        case XBEE_3RF_MODEM_STATUS_COORDINATOR_STARTED:
+            rf->associated = true;
+            rf->associationKnown = true;
+            if (!wasAssociated && self->ctable->OnConnectCallback) {
+                self->ctable->OnConnectCallback(self);
+            }
+            break;
+        case XBEE_3RF_MODEM_STATUS_DISASSOCIATED:
+        case 0x00: // Hardware reset
+        case 0x01: // Watchdog reset
+            rf->associated = false;
+            rf->associationKnown = (frame->data[1] == XBEE_3RF_MODEM_STATUS_DISASSOCIATED);
+            XBee3RFFlushAddressCache(self);
+            if (wasAssociated && self->ctable->OnDisconnectCallback) {
+                self->ctable->OnDisconnectCallback(self);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// VTable for XBee3RF
+const XBeeVTable XBee3RFVTable = {
+    .init = XBee3RFInit,
+    .process = XBee3RFProcess,
+    .connect = XBee3RFConnect,
+    .disconnect = XBee3RFDisconnect,
+    .sendData = XBee3RFSendData,
+    .softReset = XBee3RFSoftReset,
+    .hardReset = XBee3RFHardReset,
+    .connected = XBee3RFConnected,
+    .handleRxPacketFrame = XBee3RFHandleRxPacket,
+    .handleTransmitStatusFrame = XBee3RFHandleTransmitStatus,
+    .handleModemStatusFrame = XBee3RFHandleModemStatus,
+    .nextDeadline = XBee3RFNextDeadline,
+};
+
+// Frame types routed to the vtable handlers above
+static const uint8_t XBee3RFTxStatusTypes[] = { XBEE_API_TYPE_TX_STATUS, XBEE_API_TYPE_3RF_EXTENDED_TX_STATUS };
+static const uint8_t XBee3RFRxPacketTypes[] = { XBEE_API_TYPE_3RF_RX_PACKET, XBEE_API_TYPE_3RF_RX_EXPLICIT_PACKET };
+
+/**
+ * @brief Initializes an XBee3RF instance in caller provided memory.
+ *
+ * This is the allocation-free constructor, see `XBeeLRInitStatic()`. Do not pass the
+ * instance to `XBee3RFDestroy()`.
+ *
+ * @param[out] instance Memory for the instance.
+ * @param[in] storage Buffers the instance works with, must outlive the instance.
+ * @param[in] cTable Pointer to the callback table containing function pointers for handling XBee events.
+ * @param[in] hTable Pointer to the handler table containing platform-specific function implementations.
+ *
+ * @return XBee3RF* Pointer to the initialized instance (`instance`), or NULL if an argument is invalid.
+ */
+XBee3RF* XBee3RFInitStatic(XBee3RF* instance, const XBeeStorage* storage, const XBeeCTable* cTable, const XBeeHTable* hTable) {
+    if ((instance == NULL) || (storage == NULL) || (storage->rxBuffer == NULL) || (storage->rxBufferSize == 0) ||
+        ((storage->txTable == NULL) && (storage->txTableSize != 0))) {
+        return NULL;
+    }
+    memset(instance, 0, sizeof(*instance));
+    XBeeInitInstance(&instance->base, storage, cTable, hTable);
+    instance->base.vtable = &XBee3RFVTable;
+    apiRegisterDefaultHandlers(&instance->base, XBee3RFTxStatusTypes, sizeof(XBee3RFTxStatusTypes),
+        XBee3RFRxPacketTypes, sizeof(XBee3RFRxPacketTypes));
+    apiResetRxParser(&instance->base);
+    return instance;
+}
+
+// Heap block used by XBee3RFCreate(), the instance comes first so XBee3RFDestroy() can free it
+typedef struct {
+    XBee3RF instance;
+    uint8_t rxBuffer[XBEE_MAX_FRAME_DATA_SIZE];
+    XBeeTxEntry txTable[XBEE_TX_TABLE_SIZE];
+} XBee3RFAllocation;
+
+/**
+ * @brief Constructor for creating an XBee3RF instance.
+ *
+ * This function allocates memory for a new XBee3RF instance, with buffers sized by
+ * `XBEE_MAX_FRAME_DATA_SIZE` and `XBEE_TX_TABLE_SIZE`, and initializes it through
+ * `XBee3RFInitStatic()`. Release it with `XBee3RFDestroy()`.
+ *
+ * @param[in] cTable Pointer to the callback table containing function pointers for handling XBee events.
+ * @param[in] hTable Pointer to the handler table containing platform-specific function implementations.
+ *
+ * @return XBee3RF* Pointer to the newly created XBee3RF instance, or NULL if the allocation failed.
+ */
+XBee3RF* XBee3RFCreate(const XBeeCTable* cTable, const XBeeHTable* hTable) {
+    XBee3RFAllocation* allocation = (XBee3RFAllocation*)malloc(sizeof(XBee3RFAllocation));
+    if (allocation == NULL) {
+        XBEEDebugPrint("Failed to allocate XBee3RF instance\n");
+        return NULL;
+    }
+    XBeeStorage storage = {
+        allocation->rxBuffer, sizeof(allocation->rxBuffer),
+        allocation->txTable, XBEE_TX_TABLE_SIZE,
+    };
+    return XBee3RFInitStatic(&allocation->instance, &storage, cTable, hTable);
+}
+
+/**
+ * @brief Destroys an XBee3RF instance created with `XBee3RFCreate()`.
+ *
+ * @param[in] self Pointer to the instance, may be NULL.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFDestroy(XBee3RF* self) {
+    free(self);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file xbee_3rf.h
+ * @brief Header file for the XBee 3 RF (Zigbee / 802.15.4 / DigiMesh) subclass.
+ *
+ * This file defines the interface for the XBee 3 RF subclass, which extends the
+ * functionality of the base XBee class to support the XBee 3 RF modules in their
+ * Zigbee, 802.15.4 and DigiMesh firmwares. Transmissions are addressed with 64-bit
+ * addresses; the 16-bit network address the module reports for each destination is
+ * kept in a small cache, so repeated sends to the same node skip address discovery.
+ * Several unicast frames can wait for their TX status at the same time.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+
+#ifndef XBEE3RF_H
+#define XBEE3RF_H
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#include "xbee.h"
+#include "config.h"
+
+// Special destination addresses
+#define XBEE_3RF_BROADCAST_ADDRESS 0x000000000000FFFFULL
+#define XBEE_3RF_COORDINATOR_ADDRESS 0x0000000000000000ULL
+#define XBEE_3RF_ADDRESS16_UNKNOWN 0xFFFE
+
+// TX options
+#define XBEE_3RF_TX_OPTION_DISABLE_ACK 0x01
+#define XBEE_3RF_TX_OPTION_DISABLE_ROUTE_DISCOVERY 0x02
+
+// Receive options
+#define XBEE_3RF_RX_OPTION_ACKNOWLEDGED 0x01
+#define XBEE_3RF_RX_OPTION_BROADCAST 0x02
+
+// Delivery status values that invalidate a cached 16-bit address
+#define XBEE_3RF_DELIVERY_ADDRESS_NOT_FOUND 0x24
+#define XBEE_3RF_DELIVERY_ROUTE_NOT_FOUND 0x25
+
+// Modem status values reported by the XBee 3 RF module
+#define XBEE_3RF_MODEM_STATUS_JOINED 0x02
+#define XBEE_3RF_MODEM_STATUS_DISASSOCIATED 0x03
+#define XBEE_3RF_MODEM_STATUS_COORDINATOR_STARTED 0x06
+
+// Structure for XBee 3 RF packet
+typedef struct XBee3RFPacket_s{
+    uint64_t address64;          // Destination for TX, source for RX
+    uint16_t address16;          // 16-bit network address, XBEE_3RF_ADDRESS16_UNKNOWN to use the cache
+    uint8_t payloadSize;
+    uint8_t *payload;
+    uint8_t options;             // TX options for TX, receive options for RX
+    uint8_t status;
+    uint8_t frameId;
+    //For TX only
+    uint8_t broadcastRadius;     // Hops of a broadcast, 0 for the network maximum
+    uint8_t retries;             // Transmission retries reported in the TX status
+    uint8_t discovery;           // Discovery overhead reported in the TX status
+    //For explicit RX only
+    uint8_t sourceEndpoint;
+    uint8_t destinationEndpoint;
+    uint16_t clusterId;
+    uint16_t profileId;
+}XBee3RFPacket_t;
+
+/**
+ * @brief Entry of the 64-bit to 16-bit address cache.
+ */
+typedef struct {
+    uint64_t address64;          ///< 64-bit address of the node, 0 if the entry is free
+    uint16_t address16;          ///< Last 16-bit address reported for it, or XBEE_3RF_ADDRESS16_UNKNOWN
+    uint8_t frameId;             ///< Frame ID of the last transmission to the node, 0 once its status arrived
+    uint32_t lastUse;            ///< Use stamp, the least recently used entry is replaced
+} XBee3RFAddressEntry;
+
+// Subclass for XBee3RF
+typedef struct {
+    XBee base;  // Inherit from XBee
+    bool associated;                  ///< Module is part of a network, valid once associationKnown is set
+    bool associationKnown;            ///< Association was confirmed by ATAI or a modem status
+    bool associating;                 ///< XBee3RFConnect() is waiting for the module to associate
+    uint32_t associationDeadline;     ///< End of the wait of XBee3RFConnect()
+    XBee3RFAddressEntry addressCache[XBEE_3RF_ADDRESS_CACHE_SIZE];
+    uint32_t addressUse;              ///< Stamp given to the next cache entry used
+    uint32_t addressHits;             ///< Unicast sends that used a cached 16-bit address
+    uint32_t addressMisses;           ///< Unicast sends that left address discovery to the module
+} XBee3RF;
+
+
+XBee3RF* XBee3RFCreate(const XBeeCTable* cTable, const XBeeHTable* hTable);
+XBee3RF* XBee3RFInitStatic(XBee3RF* instance, const XBeeStorage* storage, const XBeeCTable* cTable, const XBeeHTable* hTable);
+void XBee3RFDestroy(XBee3RF* self);
+uint8_t XBee3RFSendDataAsync(XBee* self, XBee3RFPacket_t* packet, XBeeTxCompleteCallback callback, void* ctx);
+bool XBee3RFLookupAddress(XBee* self, uint64_t address64, uint16_t* address16);
+void XBee3RFCacheAddress(XBee* self, uint64_t address64, uint16_t address16);
+void XBee3RFFlushAddressCache(XBee* self);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEE3RF_H
@@ -0,0 +1,258 @@
+/**
+ * @file xbee_3rf_remote_at.c
+ * @brief Remote AT command fan-out: one command set applied to a list of nodes.
+ *
+ * Every slot works on one destination at a time and holds the AT request of its current
+ * command. A slot is refilled with the next destination from the completion callback of
+ * its last command, so the number of remote commands in flight stays at the number of
+ * slots until the list runs out.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_3rf_remote_at.h"
+#include <string.h>
+
+static void XBee3RFRemoteAtComplete(XBee* self, xbee_at_request_t* request);
+
+/**
+ * @brief Sends the current command of a slot to its destination.
+ *
+ * The 16-bit address last reported for the destination is used when it is known, so the
+ * module does not have to discover it again.
+ */
+static int XBee3RFRemoteAtSubmit(XBee3RFRemoteAt* fanout, XBee3RFRemoteAtSlot* slot) {
+    const XBee3RFRemoteAtCommand* command = &fanout->commands[slot->command];
+    uint64_t address64 = fanout->targets[slot->target];
+    uint16_t address16 = XBEE_3RF_ADDRESS16_UNKNOWN;
+    uint8_t options = 0;
+
+    (void)XBee3RFLookupAddress(fanout->xbee, address64, &address16);
+    if (fanout->apply && (slot->command == fanout->commandCount - 1)) {
+        options |= XBEE_REMOTE_AT_OPTION_APPLY_CHANGES;
+    }
+
+    apiAtRequestInit(&slot->request, slot->response, sizeof(slot->response), XBee3RFRemoteAtComplete, slot);
+    return apiSendRemoteAtCommandAsync(fanout->xbee, &slot->request, address64, address16, options,
+        command->command, command->parameter, command->paramLength, fanout->timeoutMs);
+}
+
+/**
+ * @brief Reports the result of a slot's destination and frees the slot.
+ */
+static void XBee3RFRemoteAtFinish(XBee3RFRemoteAt* fanout, XBee3RFRemoteAtSlot* slot, int result) {
+    slot->active = false;
+    if (result == API_SEND_SUCCESS) {
+        fanout->succeeded++;
+    } else {
+        fanout->failed++;
+        XBEEDebugPrint("Remote AT to node %u failed, error code: %d\n", slot->target, result);
+    }
+    if (fanout->callback) {
+        fanout->callback(fanout, slot->target, result, &slot->request, fanout->ctx);
+    }
+}
+
+/**
+ * @brief Gives the next destinations to free slots and sends the commands that are not in flight.
+ *
+ * Stops at the first UART failure; the remaining slots are filled again by
+ * `XBee3RFRemoteAtProcess()`. Any other send error fails the destination.
+ */
+static void XBee3RFRemoteAtFill(XBee3RFRemoteAt* fanout) {
+    for (uint8_t i = 0; i < XBEE_3RF_REMOTE_AT_IN_FLIGHT; i++) {
+        XBee3RFRemoteAtSlot* slot = &fanout->slots[i];
+        while (true) {
+            if (!slot->active) {
+                if (fanout->nextTarget >= fanout->targetCount) {
+                    break;
+                }
+                slot->target = fanout->nextTarget++;
+                slot->command = 0;
+                slot->attempt = 0;
+                slot->active = true;
+            } else if (apiAtRequestPending(&slot->request)) {
+                break;
+            }
+
+            int status = XBee3RFRemoteAtSubmit(fanout, slot);
+            if (status == API_SEND_SUCCESS) {
+                break;
+            }
+            if (status == API_SEND_ERROR_UART_FAILURE) {
+                return;
+            }
+            XBee3RFRemoteAtFinish(fanout, slot, status);
+        }
+    }
+}
+
+/**
+ * @brief Completion callback of a slot's request: moves on, retries or fails the destination.
+ */
+static void XBee3RFRemoteAtComplete(XBee* self, xbee_at_request_t* request) {
+    XBee3RFRemoteAtSlot* slot = (XBee3RFRemoteAtSlot*)request->ctx;
+    XBee3RFRemoteAt* fanout = slot->fanout;
+    uint64_t address64 = fanout->targets[slot->target];
+    bool txFailure = (request->result == API_SEND_AT_CMD_ERROR) &&
+        (request->commandStatus == XBEE_REMOTE_AT_STATUS_TX_FAILURE);
+
+    if (request->result == API_SEND_SUCCESS) {
+        XBee3RFCacheAddress(self, address64, request->remoteAddress16);
+        if (++slot->command >= fanout->commandCount) {
+            XBee3RFRemoteAtFinish(fanout, slot, API_SEND_SUCCESS);
+        } else {
+            slot->attempt = 0;
+        }
+    } else if (((request->result == API_SEND_AT_CMD_RESONSE_TIMEOUT) || txFailure) &&
+        (slot->attempt < fanout->retries)) {
+        // Not answered or not delivered, the route may have changed since the address was cached
+        if (txFailure) {
+            XBee3RFCacheAddress(self, address64, XBEE_3RF_ADDRESS16_UNKNOWN);
+        }
+        slot->attempt++;
+        fanout->retransmissions++;
+    } else {
+        XBee3RFRemoteAtFinish(fanout, slot, request->result);
+    }
+
+    XBee3RFRemoteAtFill(fanout);
+}
+
+/**
+ * @brief Initializes a caller-owned fan-out bound to an XBee 3 RF instance.
+ *
+ * @param[out] fanout Pointer to the fan-out to initialize.
+ * @param[in] xbee XBee 3 RF instance the remote commands are sent through.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFRemoteAtInit(XBee3RFRemoteAt* fanout, XBee* xbee) {
+    memset(fanout, 0, sizeof(*fanout));
+    fanout->xbee = xbee;
+    fanout->timeoutMs = XBEE_3RF_REMOTE_AT_TIMEOUT_MS;
+    fanout->retries = XBEE_3RF_REMOTE_AT_RETRIES;
+    for (uint8_t i = 0; i < XBEE_3RF_REMOTE_AT_IN_FLIGHT; i++) {
+        fanout->slots[i].fanout = fanout;
+    }
+}
+
+/**
+ * @brief Starts sending a command set to a list of nodes.
+ *
+ * The first `XBEE_3RF_REMOTE_AT_IN_FLIGHT` destinations are sent their first command right
+ * away; the rest follow from `XBeeProcess()` as destinations complete. The callback is
+ * invoked once per destination. The target list and the command set, including the
+ * parameter buffers, must stay valid until `XBee3RFRemoteAtBusy()` returns false.
+ *
+ * @param[in,out] fanout Pointer to the fan-out, not busy.
+ * @param[in] targets 64-bit addresses of the destinations.
+ * @param[in] targetCount Number of destinations.
+ * @param[in] commands Commands sent to every destination, in order.
+ * @param[in] commandCount Number of commands, at least 1.
+ * @param[in] apply Send the last command with the apply changes option.
+ * @param[in] callback Called with the result of each destination, may be NULL.
+ * @param[in] ctx User pointer passed to the callback.
+ *
+ * @return bool Returns true if the fan-out was started, false if it is busy or the arguments are invalid.
+ */
+bool XBee3RFRemoteAtStart(XBee3RFRemoteAt* fanout, const uint64_t* targets, uint16_t targetCount,
+    const XBee3RFRemoteAtCommand* commands, uint8_t commandCount, bool apply,
+    XBee3RFRemoteAtCallback callback, void* ctx) {
+    if (XBee3RFRemoteAtBusy(fanout) || (targets == NULL) || (commands == NULL) || (commandCount == 0)) {
+        return false;
+    }
+
+    fanout->targets = targets;
+    fanout->targetCount = targetCount;
+    fanout->nextTarget = 0;
+    fanout->commands = commands;
+    fanout->commandCount = commandCount;
+    fanout->apply = apply;
+    fanout->callback = callback;
+    fanout->ctx = ctx;
+    fanout->succeeded = 0;
+    fanout->failed = 0;
+    fanout->retransmissions = 0;
+
+    XBee3RFRemoteAtFill(fanout);
+    return true;
+}
+
+/**
+ * @brief Sends the commands that could not be written to the UART earlier.
+ *
+ * Responses and timeouts are handled by `XBeeProcess()`; this only needs to be called
+ * while the UART is refusing frames, and does nothing otherwise.
+ *
+ * @param[in,out] fanout Pointer to the fan-out.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFRemoteAtProcess(XBee3RFRemoteAt* fanout) {
+    if (XBee3RFRemoteAtBusy(fanout)) {
+        XBee3RFRemoteAtFill(fanout);
+    }
+}
+
+/**
+ * @brief Checks whether destinations are still being worked on.
+ *
+ * @param[in] fanout Pointer to the fan-out.
+ *
+ * @return bool Returns true until every destination has been reported to the callback.
+ */
+bool XBee3RFRemoteAtBusy(const XBee3RFRemoteAt* fanout) {
+    if (fanout->nextTarget < fanout->targetCount) {
+        return true;
+    }
+    for (uint8_t i = 0; i < XBEE_3RF_REMOTE_AT_IN_FLIGHT; i++) {
+        if (fanout->slots[i].active) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Stops the fan-out without invoking the callback for the remaining destinations.
+ *
+ * Commands already delivered to a node are not undone. Responses that arrive later are ignored.
+ *
+ * @param[in,out] fanout Pointer to the fan-out.
+ *
+ * @return void This function does not return a value.
+ */
+void XBee3RFRemoteAtCancel(XBee3RFRemoteAt* fanout) {
+    for (uint8_t i = 0; i < XBEE_3RF_REMOTE_AT_IN_FLIGHT; i++) {
+        XBee3RFRemoteAtSlot* slot = &fanout->slots[i];
+        if (slot->active) {
+            apiAtRequestCancel(fanout->xbee, &slot->request);
+            slot->active = false;
+        }
+    }
+    fanout->nextTarget = fanout->targetCount;
+}
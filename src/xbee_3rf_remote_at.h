@@ -0,0 +1,125 @@
+/**
+ * @file xbee_3rf_remote_at.h
+ * @brief Remote AT command fan-out: one command set applied to a list of nodes.
+ *
+ * Each destination gets the commands of the set in order, sent as remote AT commands
+ * (0x17) through the library's AT transaction engine. Up to `XBEE_3RF_REMOTE_AT_IN_FLIGHT`
+ * destinations are worked on at the same time, each with its own frame ID, so the round
+ * trips through the mesh overlap instead of adding up. A command that is not answered in
+ * time, or that the local module could not deliver, is sent again up to the configured
+ * number of retries; a command the remote node rejects fails its destination right away.
+ * The callback reports the result of every destination once all of its commands have
+ * completed.
+ *
+ * With `apply` set, the last command of the set carries the apply changes option, so
+ * parameters written by the earlier commands take effect together. Add `AT_WR` as the
+ * last command to also save them on the remote nodes.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#ifndef XBEE3RF_REMOTE_AT_H
+#define XBEE3RF_REMOTE_AT_H
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#include "xbee_3rf.h"
+#include "xbee_api_frames.h"
+#include "config.h"
+
+typedef struct XBee3RFRemoteAt_s XBee3RFRemoteAt;
+
+/**
+ * @brief One command of the set sent to every destination.
+ */
+typedef struct {
+    at_command_t command;         ///< AT command
+    const uint8_t* parameter;     ///< Value to set, NULL to query the parameter
+    uint8_t paramLength;          ///< Length of the value
+} XBee3RFRemoteAtCommand;
+
+/**
+ * @typedef XBee3RFRemoteAtCallback
+ * @brief Called once per destination when all of its commands have completed or one has failed.
+ *
+ * `result` is `API_SEND_SUCCESS` or the `API_SEND_*` error of the failed command. `response`
+ * is the request of the last command sent: its `commandStatus`, `responseBuffer` (up to
+ * `XBEE_3RF_REMOTE_AT_RESPONSE_SIZE` bytes) and `responseLength` are valid until the callback
+ * returns.
+ */
+typedef void (*XBee3RFRemoteAtCallback)(XBee3RFRemoteAt* fanout, uint16_t target, int result,
+    const xbee_at_request_t* response, void* ctx);
+
+/**
+ * @brief Destination being worked on, with the request of its current command.
+ */
+typedef struct {
+    XBee3RFRemoteAt* fanout;      ///< Owner, reached from the request completion callback
+    xbee_at_request_t request;    ///< Request of the current command
+    uint16_t target;              ///< Index of the destination in the target list
+    uint8_t command;              ///< Index of the current command in the set
+    uint8_t attempt;              ///< Retries made for the current command
+    bool active;                  ///< A destination is assigned to this slot
+    uint8_t response[XBEE_3RF_REMOTE_AT_RESPONSE_SIZE]; ///< Response data of the current command
+} XBee3RFRemoteAtSlot;
+
+/**
+ * @brief Caller-owned fan-out state, bound to one XBee 3 RF instance.
+ */
+struct XBee3RFRemoteAt_s {
+    XBee* xbee;                   ///< Instance the commands are sent through
+    const uint64_t* targets;      ///< 64-bit addresses of the destinations, owned by the caller
+    uint16_t targetCount;         ///< Number of destinations
+    uint16_t nextTarget;          ///< First destination not yet assigned to a slot
+    const XBee3RFRemoteAtCommand* commands; ///< Command set, owned by the caller
+    uint8_t commandCount;         ///< Number of commands in the set
+    bool apply;                   ///< Send the last command with the apply changes option
+    uint32_t timeoutMs;           ///< Time to wait for each response, XBEE_3RF_REMOTE_AT_TIMEOUT_MS by default
+    uint8_t retries;              ///< Retries of an unanswered command, XBEE_3RF_REMOTE_AT_RETRIES by default
+    XBee3RFRemoteAtCallback callback;
+    void* ctx;
+    XBee3RFRemoteAtSlot slots[XBEE_3RF_REMOTE_AT_IN_FLIGHT];
+    uint16_t succeeded;           ///< Destinations that accepted every command
+    uint16_t failed;              ///< Destinations that failed
+    uint32_t retransmissions;     ///< Commands sent again after a timeout or delivery failure
+};
+
+void XBee3RFRemoteAtInit(XBee3RFRemoteAt* fanout, XBee* xbee);
+bool XBee3RFRemoteAtStart(XBee3RFRemoteAt* fanout, const uint64_t* targets, uint16_t targetCount,
+    const XBee3RFRemoteAtCommand* commands, uint8_t commandCount, bool apply,
+    XBee3RFRemoteAtCallback callback, void* ctx);
+void XBee3RFRemoteAtProcess(XBee3RFRemoteAt* fanout);
+bool XBee3RFRemoteAtBusy(const XBee3RFRemoteAt* fanout);
+void XBee3RFRemoteAtCancel(XBee3RFRemoteAt* fanout);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEE3RF_REMOTE_AT_H
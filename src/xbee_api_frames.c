@@ -35,32 +35,12 @@
 #include "xbee_api_frames.h"
 #include "xbee.h"
 #include "port.h"
+#include "xbee_trace.h"
 #include <stdio.h>
 #include <string.h>
 
 // API Frame Functions
 
-/**
- * @brief Calculates the checksum for an API frame.
- * 
- * This function computes the checksum for a given XBee API frame. The checksum 
- * is calculated by summing the bytes of the frame starting from the fourth byte 
- * (index 3) to the end of the frame and then subtracting the sum from 0xFF. 
- * The resulting checksum ensures the integrity of the data in the API frame.
- * 
- * @param[in] frame Pointer to the API frame data.
- * @param[in] len Length of the API frame data.
- * 
- * @return uint8_t The calculated checksum value.
- */
-static uint8_t calculateChecksum(const uint8_t *frame, uint16_t len) {
-    uint8_t sum = 0;
-    for (uint16_t i = 3; i < len; i++) {
-        sum += frame[i];
-    }
-    return 0xFF - sum;
-}
-
 /**
  * @brief Sends an XBee API frame.
  * 
@@ -79,65 +59,193 @@ static uint8_t calculateChecksum(const uint8_t *frame, uint16_t len) {
  * or a non-zero error code (`API_SEND_ERROR_UART_FAILURE`) if there is a failure.
  */
 int apiSendFrame(XBee* self, uint8_t frameType, const uint8_t *data, uint16_t len) {
-    uint8_t frame[256];
-    uint16_t frameLength = 0;
-    self->frameIdCntr++;
-    if (self->frameIdCntr == 0) self->frameIdCntr = 1; // Reset frame counter when 0
+    xbee_iovec_t iov = {data, len};
+    return apiSendFrameV(self, frameType, &iov, 1);
+}
 
-    // Start delimiter
-    frame[frameLength++] = 0x7E;
+/**
+ * @brief Writes bytes to the UART, retrying partial writes until the deadline.
+ * 
+ * When the port reports its free TX buffer space, the bytes are written in chunks that 
+ * fit and the function polls for space without sleeping. Otherwise it only sleeps when 
+ * a write made no progress at all.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] data Bytes to write.
+ * @param[in] length Number of bytes to write.
+ * @param[in] startTime PortMillis() time the frame started.
+ * @param[in] timeoutMs Time the whole frame may take.
+ * 
+ * @return int Returns 0 (`API_SEND_SUCCESS`) or `API_SEND_ERROR_UART_FAILURE`.
+ */
+static int apiUartWriteAll(XBee* self, const uint8_t *data, uint16_t length, uint32_t startTime, uint32_t timeoutMs) {
+    const XBeeHTable *htable = self->htable;
+    uint16_t written = 0;
 
-    // Length MSB and LSB
-    frame[frameLength++] = (len + 1) >> 8;
-    frame[frameLength++] = (len + 1) & 0xFF;
+    while (written < length) {
+        uint16_t chunk = length - written;
+        if (htable->PortUartTxSpace) {
+            int space = htable->PortUartTxSpace(self->portContext);
+            if (space < 0) {
+                self->stats.uartErrors++;
+                return API_SEND_ERROR_UART_FAILURE;
+            }
+            if ((uint16_t)space < chunk) {
+                chunk = (uint16_t)space;
+            }
+        }
+
+        int bytes_written = 0;
+        if (chunk > 0) {
+            bytes_written = htable->PortUartWrite(self->portContext, data + written, chunk);
+            if (bytes_written < 0) {
+                self->stats.uartErrors++;
+                return API_SEND_ERROR_UART_FAILURE;
+            }
+            written += bytes_written;
+        }
 
-    // Frame type
-    frame[frameLength++] = frameType;
+        if (written < length) {
+            // Check for timeout
+            if ((htable->PortMillis(self->portContext) - startTime) > timeoutMs) {
+                APIFrameDebugPrint("Error: Frame sending timeout after %lu ms\n", (unsigned long)(htable->PortMillis(self->portContext) - startTime));
+                self->stats.uartWriteTimeouts++;
+                return API_SEND_ERROR_UART_FAILURE;
+            }
+            if ((bytes_written == 0) && (htable->PortUartTxSpace == NULL)) {
+                htable->PortDelay(self->portContext, 1);
+            }
+        }
+    }
+    return API_SEND_SUCCESS;
+}
 
-    // Frame data
-    memcpy(&frame[frameLength], data, len);
-    frameLength += len;
+// Bytes escaped in API mode 2: 0x11 (XON), 0x13 (XOFF), 0x7D (escape) and 0x7E (delimiter), one bit per value below 0x80
+static const uint8_t apiEscapeMap[16] = {0x00, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60};
 
-    // Calculate and add checksum
-    frame[frameLength] = calculateChecksum(frame, frameLength);
-    frameLength++;
+static inline bool apiNeedsEscape(uint8_t byte) {
+    return (byte < 0x80) && (apiEscapeMap[byte >> 3] & (1u << (byte & 7)));
+}
 
-    // Print the API frame in hex format
-    APIFrameDebugPrint("Sending API Frame: ");
-    for (uint16_t i = 0; i < frameLength; i++) {
-        APIFrameDebugPrint("0x%02X ", frame[i]);
+/**
+ * @brief Writes bytes to the UART in escaped API mode.
+ * 
+ * Runs of bytes that need no escaping are written in one piece straight from `data`; 
+ * only the bytes in between are sent as escape sequences.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] data Bytes to write.
+ * @param[in] length Number of bytes to write.
+ * @param[in] startTime PortMillis() time the frame started.
+ * @param[in] timeoutMs Time the whole frame may take.
+ * 
+ * @return int Returns 0 (`API_SEND_SUCCESS`) or `API_SEND_ERROR_UART_FAILURE`.
+ */
+static int apiUartWriteEscaped(XBee* self, const uint8_t *data, uint16_t length, uint32_t startTime, uint32_t timeoutMs) {
+    uint16_t run = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        if (!apiNeedsEscape(data[i])) {
+            continue;
+        }
+        uint8_t escape[2] = {0x7D, (uint8_t)(data[i] ^ 0x20)};
+        int status = apiUartWriteAll(self, &data[run], i - run, startTime, timeoutMs);
+        if (status == API_SEND_SUCCESS) {
+            status = apiUartWriteAll(self, escape, sizeof(escape), startTime, timeoutMs);
+        }
+        if (status != API_SEND_SUCCESS) {
+            return status;
+        }
+        run = i + 1;
     }
-    APIFrameDebugPrint("\n");
+    return apiUartWriteAll(self, &data[run], length - run, startTime, timeoutMs);
+}
 
-    // Measure the time taken to send the frame
-    uint32_t startTime = portMillis();
-    int totalBytesWritten = 0;
+// Writes frame bytes after the start delimiter, escaping them in API mode 2
+static int apiUartWriteFrameBytes(XBee* self, const uint8_t *data, uint16_t length, uint32_t startTime, uint32_t timeoutMs) {
+    if (self->apiMode == XBEE_API_MODE_ESCAPED) {
+        return apiUartWriteEscaped(self, data, length, startTime, timeoutMs);
+    }
+    return apiUartWriteAll(self, data, length, startTime, timeoutMs);
+}
 
-    while (totalBytesWritten < frameLength) {
-        int bytes_written = self->htable->PortUartWrite(frame + totalBytesWritten, frameLength - totalBytesWritten);
-        if (bytes_written < 0) {
-            return API_SEND_ERROR_UART_FAILURE;
-        }
+/**
+ * @brief Sends an XBee API frame gathered from several pieces of data.
+ * 
+ * The start delimiter, length and frame type are written first, then every piece 
+ * of `iov` is streamed straight from the caller's memory, and the checksum, folded in 
+ * while the pieces go out, is written last. No staging copy of the frame is made. The 
+ * write timeout is `UART_WRITE_TIMEOUT_MS` plus the time the frame needs on the wire 
+ * at the configured baud rate. In escaped API mode everything after the start delimiter 
+ * is escaped on the way out, see `apiUartWriteEscaped()`. Like `apiSendFrame()`, the 
+ * frame ID counter is incremented with each call.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] frameType The type of the API frame to send.
+ * @param[in] iov Pieces of frame data, in order.
+ * @param[in] iovCount Number of pieces.
+ * 
+ * @return int Returns 0 (`API_SEND_SUCCESS`) if the frame is successfully sent, 
+ * `API_SEND_ERROR_FRAME_TOO_LARGE` if the data does not fit in a frame, or 
+ * `API_SEND_ERROR_UART_FAILURE` if the UART failed or timed out.
+ */
+int apiSendFrameV(XBee* self, uint8_t frameType, const xbee_iovec_t *iov, uint8_t iovCount) {
+    uint32_t len = 0;
+    for (uint8_t i = 0; i < iovCount; i++) {
+        len += iov[i].length;
+    }
+    if (len + 1 > XBEE_MAX_FRAME_DATA_SIZE) {
+        APIFrameDebugPrint("Error: Frame data too large (%lu bytes)\n", (unsigned long)len);
+        return API_SEND_ERROR_FRAME_TOO_LARGE;
+    }
+
+    self->frameIdCntr++;
+    if (self->frameIdCntr == 0) self->frameIdCntr = 1; // Reset frame counter when 0
+
+    // Start delimiter, length MSB and LSB, frame type
+    uint8_t header[4] = {0x7E, (uint8_t)((len + 1) >> 8), (uint8_t)((len + 1) & 0xFF), frameType};
+    uint8_t sum = frameType;
 
-        totalBytesWritten += bytes_written;
+    // Time the frame needs on the wire (10 bits per byte, escaping at most doubles it) plus the fixed allowance
+    uint32_t baudRate = self->baudRate ? self->baudRate : 9600;
+    uint32_t wireBytes = (self->apiMode == XBEE_API_MODE_ESCAPED) ? (len + 5) * 2 : (len + 5);
+    uint32_t timeoutMs = UART_WRITE_TIMEOUT_MS + ((wireBytes * 10000UL) + baudRate - 1) / baudRate;
+    uint32_t startTime = self->htable->PortMillis(self->portContext);
 
-        // Check for timeout
-        if ((portMillis() - startTime) > UART_WRITE_TIMEOUT_MS) {
-            APIFrameDebugPrint("Error: Frame sending timeout after %lu ms\n", portMillis() - startTime);
-            return API_SEND_ERROR_UART_FAILURE;
+    APIFrameDebugPrint("Sending API Frame: 0x7E 0x%02X 0x%02X 0x%02X ", header[1], header[2], frameType);
+
+    int status = apiUartWriteAll(self, header, 1, startTime, timeoutMs);
+    if (status == API_SEND_SUCCESS) {
+        status = apiUartWriteFrameBytes(self, &header[1], sizeof(header) - 1, startTime, timeoutMs);
+    }
+    // Most frame types carry their frame ID in the first data byte
+    uint8_t traceFrameId = ((iovCount != 0) && (iov[0].length != 0)) ? iov[0].data[0] : 0;
+    for (uint8_t i = 0; (i < iovCount) && (status == API_SEND_SUCCESS); i++) {
+        // Frame data, checksum folded in as it goes out
+        for (uint16_t j = 0; j < iov[i].length; j++) {
+            sum += iov[i].data[j];
+            APIFrameDebugPrint("0x%02X ", iov[i].data[j]);
         }
-        portDelay(1);
+        status = apiUartWriteFrameBytes(self, iov[i].data, iov[i].length, startTime, timeoutMs);
+    }
+    if (status == API_SEND_SUCCESS) {
+        uint8_t checksum = 0xFF - sum;
+        APIFrameDebugPrint("0x%02X\n", checksum);
+        status = apiUartWriteFrameBytes(self, &checksum, 1, startTime, timeoutMs);
+    }
+    XBEETraceEvent(self, XBEE_TRACE_FRAME_TX, frameType, traceFrameId, (uint8_t)-status, (uint16_t)(len + 1), 0);
+    if (status != API_SEND_SUCCESS) {
+        return status;
     }
 
-#if API_FRAME_DEBUG_PRINT_ENABLED
-    uint32_t elapsed_time = portMillis() - startTime;
-#endif
-    APIFrameDebugPrint("UART write completed in %lu ms\n", elapsed_time);
+    APIFrameDebugPrint("UART write completed in %lu ms\n", (unsigned long)(self->htable->PortMillis(self->portContext) - startTime));
+    self->stats.framesSent++;
 
     // Return success if everything went well
     return API_SEND_SUCCESS;
 }
 
+// Builds and sends an AT command (0x08) or queue parameter (0x09) frame
+static int apiSendAtFrame(XBee* self, uint8_t frameType, at_command_t command, const uint8_t *parameter, uint8_t paramLength);
 
 /**
  * @brief Sends an AT command through an API frame.
@@ -158,35 +266,69 @@ int apiSendFrame(XBee* self, uint8_t frameType, const uint8_t *data, uint16_t le
  * `API_SEND_ERROR_INVALID_COMMAND`, etc.).
  */
 int apiSendAtCommand(XBee* self,at_command_t command, const uint8_t *parameter, uint8_t paramLength) {
-    uint8_t frame_data[128];
-    uint16_t frameLength = 0;
+    return apiSendAtFrame(self, XBEE_API_TYPE_AT_COMMAND, command, parameter, paramLength);
+}
 
-   // Check if the parameter length is too large
-    if (paramLength > 128) {
-        return API_SEND_ERROR_FRAME_TOO_LARGE;
+/**
+ * @brief Queues an AT parameter value through an API frame.
+ * 
+ * Same as `apiSendAtCommand()` but uses the 0x09 queue parameter frame type: the module 
+ * answers with an AT response right away, but only applies the value once AC is sent.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] command The AT command to be sent, specified as an `at_command_t` enum.
+ * @param[in] parameter Pointer to the parameter data to be queued (can be NULL).
+ * @param[in] paramLength Length of the parameter data in bytes (0 if no parameters).
+ * 
+ * @return int Returns 0 (`API_SEND_SUCCESS`) if the frame is successfully sent, or a non-zero error code.
+ */
+int apiQueueAtParameter(XBee* self,at_command_t command, const uint8_t *parameter, uint8_t paramLength) {
+    return apiSendAtFrame(self, XBEE_API_TYPE_AT_COMMAND_QUEUE, command, parameter, paramLength);
+}
+
+// Sends a remote AT command frame (0x17) to the node a request is addressed to
+static int apiSendRemoteAtFrame(XBee* self, const xbee_at_request_t *request, const uint8_t *parameter, uint8_t paramLength) {
+    uint8_t frame_data[14];
+
+    if (!atCommandIsValid(request->command)) {
+        return API_SEND_ERROR_INVALID_COMMAND;
     }
 
-    // Frame ID
-    frame_data[frameLength++] = self->frameIdCntr;
+    // Frame ID, destination addresses, options and AT Command, the parameter is sent from the caller's buffer
+    frame_data[0] = self->frameIdCntr;
+    for (uint8_t i = 0; i < 8; i++) {
+        frame_data[1 + i] = (uint8_t)(request->remoteAddress >> (56 - 8 * i));
+    }
+    frame_data[9] = (uint8_t)(request->remoteAddress16 >> 8);
+    frame_data[10] = (uint8_t)request->remoteAddress16;
+    frame_data[11] = request->remoteOptions;
+    frame_data[12] = XBEE_AT_CHAR_HIGH(request->command);
+    frame_data[13] = XBEE_AT_CHAR_LOW(request->command);
+
+    APIFrameDebugPrint("Sending Remote AT Command: %c%c\n", frame_data[12], frame_data[13]);
 
-    // AT Command (2 bytes)
-    const char *cmd_str = atCommandToString(command);
+    xbee_iovec_t iov[2] = {
+        {frame_data, sizeof(frame_data)},
+        {parameter, (parameter != NULL) ? paramLength : 0},
+    };
+    return apiSendFrameV(self, XBEE_API_TYPE_REMOTE_AT_COMMAND, iov, 2);
+}
 
-    if (cmd_str == NULL) {
+static int apiSendAtFrame(XBee* self, uint8_t frameType, at_command_t command, const uint8_t *parameter, uint8_t paramLength) {
+    uint8_t frame_data[3];
+
+    // AT Command (2 bytes), packed in the enum value
+    if (!atCommandIsValid(command)) {
         return API_SEND_ERROR_INVALID_COMMAND;
     }
-    
-    frame_data[frameLength++] = cmd_str[0];
-    frame_data[frameLength++] = cmd_str[1];
 
-    // AT Command Parameter
-    if (paramLength > 0) {
-        memcpy(&frame_data[frameLength], parameter, paramLength);
-        frameLength += paramLength;
-    }
+    // Frame ID and AT Command, the parameter is sent from the caller's buffer
+    frame_data[0] = self->frameIdCntr;
+    frame_data[1] = XBEE_AT_CHAR_HIGH(command);
+    frame_data[2] = XBEE_AT_CHAR_LOW(command);
 
     // Print the AT command and parameter in a readable format
-    APIFrameDebugPrint("Sending AT Command: %s\n", cmd_str);
+    APIFrameDebugPrint("Sending AT Command: %c%c\n", frame_data[1], frame_data[2]);
     if (paramLength > 0) {
         APIFrameDebugPrint("Parameter: ");
         for (uint8_t i = 0; i < paramLength; i++) {
@@ -197,61 +339,396 @@ int apiSendAtCommand(XBee* self,at_command_t command, const uint8_t *parameter,
         APIFrameDebugPrint("No Parameters\n");
     }
 
-    // Use api_send_frame to send the complete frame
-    return apiSendFrame(self, XBEE_API_TYPE_AT_COMMAND, frame_data, frameLength);
+    xbee_iovec_t iov[2] = {
+        {frame_data, sizeof(frame_data)},
+        {parameter, (parameter != NULL) ? paramLength : 0},
+    };
+    return apiSendFrameV(self, frameType, iov, 2);
 }
 
 /**
- * @brief Reads a specified number of bytes from the UART with a timeout mechanism.
+ * @brief Resets the incremental API frame parser.
  * 
- * This function attempts to read a specified number of bytes from the UART interface associated with
- * the XBee instance. It continuously reads data until the requested length is received or a timeout occurs.
- * If the UART read operation fails or the timeout is exceeded, the function returns an appropriate error code.
+ * Discards any partially received frame and makes the parser wait for the next 
+ * start delimiter. Called on initialization and whenever a frame is rejected. In 
+ * ring mode the bytes of the discarded frame are released back to the producer.
  * 
- * @param[in] self Pointer to the XBee instance, which contains the UART hardware table and other settings.
- * @param[out] buffer Pointer to the buffer where the received bytes will be stored.
- * @param[in] length The number of bytes to read from the UART.
- * @param[in] timeoutMs The maximum time in milliseconds to wait for the complete data to be read.
+ * @param[in] self Pointer to the XBee instance.
  * 
- * @return api_receive_status_t Returns API_RECEIVE_SUCCESS if the specified number of bytes are successfully read.
- *         Returns API_RECEIVE_ERROR_UART_FAILURE if the UART read operation fails.
- *         Returns API_RECEIVE_ERROR_TIMEOUT_DATA if the timeout is exceeded before the required bytes are read.
+ * @return void This function does not return a value.
  */
-static api_receive_status_t readBytesWithTimeout(XBee* self, uint8_t* buffer, int length, uint32_t timeoutMs) {
-    int totalBytesReceived = 0;
-    int bytes_received = 0;
-    uint32_t startTime = portMillis();
+void apiResetRxParser(XBee* self) {
+    self->rx.state = XBEE_RX_STATE_DELIMITER;
+    self->rx.length = 0;
+    self->rx.index = 0;
+    self->rx.checksum = 0;
+    self->rx.escape = false;
+    self->rx.rawStart = 0;
+    self->rx.rawEnd = 0;
+    if (self->rxRing != NULL) {
+        self->rxRing->tail = self->rx.scan;
+    }
+}
 
-    while (totalBytesReceived < length) {
-        bytes_received = self->htable->PortUartRead(buffer + totalBytesReceived, length - totalBytesReceived);
-        
-        if (bytes_received > 0) {
-            totalBytesReceived += bytes_received;
+/**
+ * @brief Fetches the next run of input bytes for the frame parser.
+ * 
+ * Without a ring, up to `max` bytes are read from the UART straight into `dst`. With 
+ * a ring, no bytes are copied: `*bytes` points at the next contiguous run of unparsed 
+ * bytes inside the ring and the scan position is advanced past them.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] dst Destination for UART reads when no ring is attached.
+ * @param[in] max Maximum number of bytes to fetch.
+ * @param[out] bytes Set to the location of the fetched bytes.
+ * 
+ * @return int The number of bytes fetched, 0 if none are available, or negative on UART failure.
+ */
+static int rxFetch(XBee* self, uint8_t *dst, uint16_t max, const uint8_t **bytes) {
+    XBeeRxRing *ring = self->rxRing;
+    if (ring == NULL) {
+        *bytes = dst;
+        return self->htable->PortUartRead(self->portContext, dst, max);
+    }
+
+    uint16_t offset = self->rx.scan & ring->mask;
+    uint16_t count = (uint16_t)(ring->head - self->rx.scan);
+    uint16_t contiguous = (uint16_t)(ring->mask + 1 - offset);
+    if (count > contiguous) count = contiguous;
+    if (count > max) count = max;
+
+    *bytes = &ring->buffer[offset];
+    self->rx.scan += count;
+    return count;
+}
+
+/**
+ * @brief Returns a pointer to the data of the frame that has just been validated.
+ * 
+ * In ring mode the frame is handed out in place, unless it wraps around the end of 
+ * the ring, in which case the two halves are joined in the parser buffer.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint8_t* Pointer to the first byte (frame type) of the frame data.
+ */
+static uint8_t *rxFrameData(XBee* self) {
+    XBeeRxRing *ring = self->rxRing;
+    XBeeRxParser *rx = &self->rx;
+    if (ring == NULL) {
+        return rx->data;
+    }
+
+    uint16_t offset = rx->start & ring->mask;
+    uint16_t first = (uint16_t)(ring->mask + 1 - offset);
+    if (rx->length <= first) {
+        return &ring->buffer[offset];
+    }
+    memcpy(rx->data, &ring->buffer[offset], first);
+    memcpy(&rx->data[first], ring->buffer, rx->length - first);
+    return rx->data;
+}
+
+// Starts a new frame in escaped mode after a start delimiter
+static void rxEscapedStart(XBeeRxParser *rx) {
+    rx->state = XBEE_RX_STATE_LENGTH_MSB;
+    rx->length = 0;
+    rx->index = 0;
+    rx->checksum = 0;
+    rx->escape = false;
+}
+
+/**
+ * @brief Keeps the fetched bytes after `used` for the next call.
+ * 
+ * In ring mode the scan position is moved back over them. In pull mode they were read 
+ * ahead into the frame buffer, where they are left behind the data written so far.
+ */
+static void rxKeep(XBee* self, const uint8_t *bytes, int used, int received) {
+    XBeeRxParser *rx = &self->rx;
+    if (self->rxRing != NULL) {
+        rx->scan -= (uint16_t)(received - used);
+    } else if ((bytes >= rx->data) && (bytes < rx->data + rx->size) && (used < received)) {
+        rx->rawStart = (uint16_t)(bytes - rx->data) + used;
+        rx->rawEnd = (uint16_t)(bytes - rx->data) + received;
+    }
+}
+
+/**
+ * @brief `rxFetch()` that first returns the bytes kept by `rxKeep()` in pull mode.
+ * 
+ * Kept bytes destined for the frame buffer are moved to `dst`. They always lie at or 
+ * behind it, so the move never overwrites kept bytes not yet returned.
+ */
+static int rxTake(XBee* self, uint8_t *dst, uint16_t max, const uint8_t **bytes) {
+    XBeeRxParser *rx = &self->rx;
+    if (rx->rawStart == rx->rawEnd) {
+        return rxFetch(self, dst, max, bytes);
+    }
+    uint16_t count = (uint16_t)(rx->rawEnd - rx->rawStart);
+    if (count > max) count = max;
+    uint8_t *src = &rx->data[rx->rawStart];
+    rx->rawStart += count;
+    if (rx->rawStart == rx->rawEnd) {
+        rx->rawStart = rx->rawEnd = 0;
+    }
+    if ((dst >= rx->data) && (dst < rx->data + rx->size)) {
+        memmove(dst, src, count);
+        *bytes = dst;
+    } else {
+        *bytes = src;
+    }
+    return count;
+}
+
+/**
+ * @brief Skips input up to the next start delimiter, a block at a time.
+ * 
+ * Called after a byte other than 0x7E was read between frames. Whole runs of buffered 
+ * input are searched with memchr() instead of parsing them byte by byte, so line 
+ * garbage such as a boot banner is skipped in one call. The bytes after a delimiter 
+ * found are kept for the frame that follows it.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint32_t The number of bytes skipped, not counting the one already read.
+ */
+static uint32_t rxResync(XBee* self) {
+    XBeeRxParser *rx = &self->rx;
+    uint32_t skipped = 0;
+
+    while (1) {
+        const uint8_t *bytes;
+        int received;
+        if (rx->rawStart != rx->rawEnd) {
+            bytes = &rx->data[rx->rawStart];
+            received = rx->rawEnd - rx->rawStart;
+            rx->rawStart = rx->rawEnd = 0;
+        } else {
+            received = rxFetch(self, rx->data, rx->size, &bytes);
+        }
+        if (received <= 0) {
+            break;  // Input exhausted, a UART failure is reported by the next call
         }
 
-        // Check for timeout
-        if (portMillis() - startTime >= timeoutMs) {
-            return API_RECEIVE_ERROR_TIMEOUT_DATA;
+        const uint8_t *delimiter = (const uint8_t *)memchr(bytes, 0x7E, (size_t)received);
+        if (delimiter == NULL) {
+            skipped += (uint32_t)received;
+            if (self->rxRing != NULL) {
+                self->rxRing->tail = rx->scan;  // Give the skipped bytes back to the producer
+            }
+            continue;
         }
-        portDelay(1);  // Add a 1 ms delay to prevent busy-waiting
+        int used = (int)(delimiter - bytes) + 1;
+        skipped += (uint32_t)(used - 1);
+        rxKeep(self, bytes, used, received);
+        rx->state = XBEE_RX_STATE_LENGTH_MSB;
+        break;
+    }
+    if (self->rxRing != NULL) {
+        self->rxRing->tail = rx->scan;
     }
+    return skipped;
+}
+
+/**
+ * @brief Goes back over a frame that failed its checksum to look for a delimiter inside it.
+ * 
+ * A delimiter that was corrupted, or a frame cut short by a module reset, makes the 
+ * parser take the start of the next real frame as data. The bytes after the rejected 
+ * delimiter are therefore searched again instead of being dropped. The length MSB 
+ * cannot be a delimiter (an MSB of 0x7E is always rejected as too large), so the search 
+ * starts at the length LSB. In ring mode the bytes are still in the ring. In pull mode 
+ * they are the frame data in the parser buffer, followed by the checksum and any bytes 
+ * read ahead, unless the frame filled the whole buffer.
+ */
+static void rxRewind(XBee* self, uint8_t checksumByte) {
+    XBeeRxParser *rx = &self->rx;
+    uint16_t length = rx->length;
+    uint8_t lengthLsb = (uint8_t)(length & 0xFF);
 
-    return API_RECEIVE_SUCCESS;
+    if (self->rxRing != NULL) {
+        rx->state = XBEE_RX_STATE_DELIMITER;
+        rx->scan = (uint16_t)(rx->start - 1);
+        return;
+    }
+    // Bytes read ahead behind the checksum follow it, they always start past it
+    uint16_t keptStart = rx->rawStart;
+    uint16_t keptEnd = rx->rawEnd;
+    apiResetRxParser(self);
+    if (length < rx->size) {
+        rx->data[length++] = checksumByte;
+        memmove(&rx->data[length], &rx->data[keptStart], keptEnd - keptStart);
+        length += keptEnd - keptStart;
+    }
+    rx->rawStart = 0;
+    rx->rawEnd = length;
+    if (lengthLsb == 0x7E) {
+        rx->state = XBEE_RX_STATE_LENGTH_MSB;
+    }
+}
+
+/**
+ * @brief Escaped API mode (AP=2) variant of `apiReceiveApiFrame()`.
+ * 
+ * Bytes are unescaped as they are parsed and the frame data is always assembled in the 
+ * parser buffer. In pull mode the data bytes are read straight into that buffer and 
+ * unescaped in place, which is safe because unescaping only ever shrinks them. A 0x7E 
+ * always starts a new frame, so a corrupted frame costs only itself.
+ */
+static api_receive_status_t apiReceiveEscapedFrame(XBee* self, xbee_api_frame_t *frame, uint32_t now) {
+    XBeeRxParser *rx = &self->rx;
+    uint8_t byte = 0;
+
+    while (1) {
+        const uint8_t *bytes;
+        int received;
+        if (self->rxRing != NULL) {
+            // The frame is assembled in the parser buffer, every parsed ring byte can be released
+            self->rxRing->tail = rx->scan;
+        }
+        if (rx->rawStart != rx->rawEnd) {
+            // Bytes read ahead by the previous call
+            bytes = &rx->data[rx->rawStart];
+            received = rx->rawEnd - rx->rawStart;
+            rx->rawStart = rx->rawEnd = 0;
+        } else if (rx->state == XBEE_RX_STATE_DATA) {
+            // Escape sequences only make the data longer, so this never reads past the frame
+            received = rxFetch(self, &rx->data[rx->index], rx->length - rx->index, &bytes);
+        } else if (rx->state == XBEE_RX_STATE_DELIMITER) {
+            // Between frames, take a block and search it for the delimiter
+            received = rxFetch(self, rx->data, rx->size, &bytes);
+        } else {
+            received = rxFetch(self, &byte, 1, &bytes);
+        }
+
+        if (received < 0) {
+            apiResetRxParser(self);
+            self->stats.uartErrors++;
+            XBEETraceEvent(self, XBEE_TRACE_UART_ERROR, 0, 0, 0, 0, 0);
+            return API_RECEIVE_ERROR_UART_FAILURE;
+        }
+
+        if (received == 0) {
+            if ((rx->state != XBEE_RX_STATE_DELIMITER) && ((now - rx->lastByteTime) >= UART_READ_TIMEOUT_MS)) {
+                xbee_rx_state_t state = rx->state;
+                XBEETraceEvent(self, XBEE_TRACE_RX_TIMEOUT, 0, 0, state, (state >= XBEE_RX_STATE_DATA) ? rx->index : 0, 0);
+                apiResetRxParser(self);
+                self->stats.rxTimeouts++;
+                APIFrameDebugPrint("Error: Timeout occurred while waiting for the rest of the frame.\n");
+                if (state == XBEE_RX_STATE_DATA) return API_RECEIVE_ERROR_TIMEOUT_DATA;
+                if (state == XBEE_RX_STATE_CHECKSUM) return API_RECEIVE_ERROR_TIMEOUT_CHECKSUM;
+                return API_RECEIVE_ERROR_TIMEOUT_LENGTH;
+            }
+            return API_RECEIVE_PENDING;
+        }
+        rx->lastByteTime = now;
+
+        for (int i = 0; i < received; i++) {
+            uint8_t value = bytes[i];
+            if (value == 0x7E) {
+                if (rx->state != XBEE_RX_STATE_DELIMITER) {
+                    APIFrameDebugPrint("Error: Start delimiter inside a frame, resynchronizing.\n");
+                    self->stats.framesAborted++;
+                }
+                rxEscapedStart(rx);
+                continue;
+            }
+            if (rx->state == XBEE_RX_STATE_DELIMITER) {
+                const uint8_t *delimiter = (const uint8_t *)memchr(&bytes[i], 0x7E, (size_t)(received - i));
+                int skip = (delimiter != NULL) ? (int)(delimiter - &bytes[i]) : (received - i);
+                self->stats.delimiterResyncs += (uint32_t)skip;
+                XBEETraceEvent(self, XBEE_TRACE_RESYNC, 0, 0, 0, (uint16_t)skip, 0);
+                i += skip - 1;
+                continue;
+            }
+            if (value == 0x7D) {
+                rx->escape = true;
+                continue;
+            }
+            if (rx->escape) {
+                value ^= 0x20;
+                rx->escape = false;
+            }
+
+            switch (rx->state) {
+                case XBEE_RX_STATE_LENGTH_MSB:
+                    rx->length = (uint16_t)value << 8;
+                    rx->state = XBEE_RX_STATE_LENGTH_LSB;
+                    break;
+
+                case XBEE_RX_STATE_LENGTH_LSB:
+                    rx->length |= value;
+                    if ((rx->length == 0) || (rx->length > rx->size)) {
+                        APIFrameDebugPrint("Error: Frame length exceeds buffer size.\n");
+                        rx->state = XBEE_RX_STATE_DELIMITER;
+                        self->stats.framesTooLarge++;
+                        XBEETraceEvent(self, XBEE_TRACE_FRAME_TOO_LARGE, 0, 0, 0, rx->length, 0);
+                        rxKeep(self, bytes, i + 1, received);
+                        return API_RECEIVE_ERROR_FRAME_TOO_LARGE;
+                    }
+                    rx->state = (rx->length > 0) ? XBEE_RX_STATE_DATA : XBEE_RX_STATE_CHECKSUM;
+                    break;
+
+                case XBEE_RX_STATE_DATA:
+                    rx->data[rx->index++] = value;
+                    rx->checksum += value;
+                    if (rx->index == rx->length) {
+                        rx->state = XBEE_RX_STATE_CHECKSUM;
+                    }
+                    break;
+
+                case XBEE_RX_STATE_CHECKSUM:
+                    rx->checksum += value;
+                    rx->state = XBEE_RX_STATE_DELIMITER;
+                    rxKeep(self, bytes, i + 1, received);
+                    if (rx->checksum != 0xFF) {
+                        APIFrameDebugPrint("Error: Invalid checksum. Expected 0xFF, but calculated 0x%02X.\n", rx->checksum);
+                        self->stats.checksumErrors++;
+                        XBEETraceEvent(self, XBEE_TRACE_CHECKSUM_ERROR, 0, 0, 0, rx->length, 0);
+                        return API_RECEIVE_ERROR_INVALID_CHECKSUM;
+                    }
+                    self->stats.framesReceived++;
+                    frame->data = rx->data;
+                    frame->type = frame->data[0];
+                    frame->length = rx->length;
+                    frame->checksum = value;
+                    return API_RECEIVE_SUCCESS;
+
+                default:
+                    break;
+            }
+        }
+    }
 }
 
 /**
  * @brief Checks for and receives an XBee API frame, populating the provided frame pointer.
  * 
- * This function attempts to read and receive an XBee API frame from the UART interface. 
- * It validates the received data by checking the start delimiter, frame length, and checksum. 
- * If the frame is successfully received and validated, the frame structure is populated 
- * with the received data. The function returns API_RECEIVE_SUCCESS if successful, or an 
- * error code from `api_receive_status_t` if any step in the process fails, including timeout.
+ * This function advances a resumable parser (start delimiter, length, data, checksum) 
+ * using only the bytes currently available, and returns immediately when it runs out 
+ * of input. The checksum is summed while the data arrives, so a frame is returned as 
+ * soon as its checksum byte has been read. A partially received frame is kept in the 
+ * XBee instance and resumed on the next call; it is discarded if the module sends 
+ * nothing for `UART_READ_TIMEOUT_MS` in the middle of a frame.
+ * 
+ * Corrupt input is recovered from without losing the frame that follows it. Bytes 
+ * between frames are searched a block at a time for the next 0x7E, a length of 0 or 
+ * one larger than the receive buffer is rejected as soon as its byte arrives, and 
+ * after a checksum failure the bytes of the rejected frame are searched again for a 
+ * delimiter, see `rxResync()` and `rxRewind()`.
+ * 
+ * In escaped API mode (AP=2) the bytes are unescaped on the fly, see `apiReceiveEscapedFrame()`.
+ * 
+ * The frame is not copied: `frame->data` points into the parser buffer, or into the 
+ * receive ring when one is attached (always the parser buffer in escaped mode). The view stays valid until the next call to this 
+ * function, so handlers must not re-enter the receive path while they use it.
  * 
  * @param[in] self Pointer to the XBee instance.
- * @param[out] frame Pointer to an `xbee_api_frame_t` structure where the received frame data will be stored.
+ * @param[out] frame Pointer to an `xbee_api_frame_t` structure that receives a view of the frame.
  * 
- * @return api_receive_status_t Returns API_RECEIVE_SUCCESS if the frame is successfully received, or an error code if a failure occurs.
+ * @return api_receive_status_t Returns API_RECEIVE_SUCCESS if a frame is complete, API_RECEIVE_PENDING if 
+ * more bytes are needed, or an error code if the frame was rejected.
  */
 api_receive_status_t apiReceiveApiFrame(XBee* self, xbee_api_frame_t *frame) {
     if (!frame) {
@@ -259,111 +736,511 @@ api_receive_status_t apiReceiveApiFrame(XBee* self, xbee_api_frame_t *frame) {
         return API_RECEIVE_ERROR_INVALID_POINTER;
     }
 
-    memset(frame, 0, sizeof(xbee_api_frame_t));
+    XBeeRxParser *rx = &self->rx;
+    XBeeRxRing *ring = self->rxRing;
+    uint32_t now = self->htable->PortMillis(self->portContext);
+    uint8_t byte = 0;
+
+    // Release the ring bytes of the frame handed out by the previous call
+    if ((ring != NULL) && (rx->state == XBEE_RX_STATE_DELIMITER)) {
+        ring->tail = rx->scan;
+    }
+
+    if (self->apiMode == XBEE_API_MODE_ESCAPED) {
+        return apiReceiveEscapedFrame(self, frame, now);
+    }
+
+    while (1) {
+        const uint8_t *bytes;
+        int received;
+        if (rx->state == XBEE_RX_STATE_DATA) {
+            // Take as much of the remaining frame data as is available
+            received = rxTake(self, &rx->data[rx->index], rx->length - rx->index, &bytes);
+        } else {
+            received = rxTake(self, &byte, 1, &bytes);
+        }
+
+        if (received < 0) {
+            apiResetRxParser(self);
+            self->stats.uartErrors++;
+            XBEETraceEvent(self, XBEE_TRACE_UART_ERROR, 0, 0, 0, 0, 0);
+            return API_RECEIVE_ERROR_UART_FAILURE;
+        }
+
+        if (received == 0) {
+            // Nothing buffered, give up on a frame the module stopped sending
+            if ((rx->state != XBEE_RX_STATE_DELIMITER) && ((now - rx->lastByteTime) >= UART_READ_TIMEOUT_MS)) {
+                xbee_rx_state_t state = rx->state;
+                XBEETraceEvent(self, XBEE_TRACE_RX_TIMEOUT, 0, 0, state, (state >= XBEE_RX_STATE_DATA) ? rx->index : 0, 0);
+                apiResetRxParser(self);
+                self->stats.rxTimeouts++;
+                APIFrameDebugPrint("Error: Timeout occurred while waiting for the rest of the frame.\n");
+                if (state == XBEE_RX_STATE_DATA) return API_RECEIVE_ERROR_TIMEOUT_DATA;
+                if (state == XBEE_RX_STATE_CHECKSUM) return API_RECEIVE_ERROR_TIMEOUT_CHECKSUM;
+                return API_RECEIVE_ERROR_TIMEOUT_LENGTH;
+            }
+            return API_RECEIVE_PENDING;
+        }
+        rx->lastByteTime = now;
+
+        switch (rx->state) {
+            case XBEE_RX_STATE_DELIMITER:
+                if (bytes[0] != 0x7E) {
+                    APIFrameDebugPrint("Error: Invalid start delimiter. Expected 0x7E, but received 0x%02X.\n", bytes[0]);
+                    uint32_t skipped = 1 + rxResync(self);
+                    self->stats.delimiterResyncs += skipped;
+                    // arg1 is 16 bits wide; the counter above keeps the full count
+                    XBEETraceEvent(self, XBEE_TRACE_RESYNC, 0, 0, 0,
+                                   (uint16_t)((skipped > 0xFFFF) ? 0xFFFF : skipped), 0);
+                    return API_RECEIVE_ERROR_INVALID_START_DELIMITER;
+                }
+                rx->state = XBEE_RX_STATE_LENGTH_MSB;
+                break;
+
+            case XBEE_RX_STATE_LENGTH_MSB:
+                rx->length = (uint16_t)bytes[0] << 8;
+                if (rx->length > rx->size) {
+                    // Rejected before the LSB arrives; the byte may itself start the real frame
+                    APIFrameDebugPrint("Error: Frame length exceeds buffer size.\n");
+                    rx->state = (bytes[0] == 0x7E) ? XBEE_RX_STATE_LENGTH_MSB : XBEE_RX_STATE_DELIMITER;
+                    self->stats.framesTooLarge++;
+                    XBEETraceEvent(self, XBEE_TRACE_FRAME_TOO_LARGE, 0, 0, 0, rx->length, 0);
+                    return API_RECEIVE_ERROR_FRAME_TOO_LARGE;
+                }
+                rx->state = XBEE_RX_STATE_LENGTH_LSB;
+                break;
+
+            case XBEE_RX_STATE_LENGTH_LSB:
+                rx->length |= bytes[0];
+                APIFrameDebugPrint("Frame length received: %d bytes\n", rx->length);
+                if ((rx->length == 0) || (rx->length > rx->size) ||
+                    ((ring != NULL) && (rx->length + 4 > ring->mask + 1))) {
+                    APIFrameDebugPrint("Error: Frame length exceeds buffer size.\n");
+                    rx->state = (bytes[0] == 0x7E) ? XBEE_RX_STATE_LENGTH_MSB : XBEE_RX_STATE_DELIMITER;
+                    self->stats.framesTooLarge++;
+                    XBEETraceEvent(self, XBEE_TRACE_FRAME_TOO_LARGE, 0, 0, 0, rx->length, 0);
+                    return API_RECEIVE_ERROR_FRAME_TOO_LARGE;
+                }
+                rx->index = 0;
+                rx->checksum = 0;
+                rx->start = rx->scan;
+                rx->state = (rx->length > 0) ? XBEE_RX_STATE_DATA : XBEE_RX_STATE_CHECKSUM;
+                break;
+
+            case XBEE_RX_STATE_DATA:
+                // Fold the new bytes into the checksum as they arrive
+                for (int i = 0; i < received; i++) {
+                    rx->checksum += bytes[i];
+                }
+                rx->index += received;
+                if (rx->index == rx->length) {
+                    rx->state = XBEE_RX_STATE_CHECKSUM;
+                }
+                break;
+
+            case XBEE_RX_STATE_CHECKSUM:
+                rx->checksum += bytes[0];
+                if (rx->checksum != 0xFF) {
+                    APIFrameDebugPrint("Error: Invalid checksum. Expected 0xFF, but calculated 0x%02X.\n", rx->checksum);
+                    rxRewind(self, bytes[0]);
+                    self->stats.checksumErrors++;
+                    XBEETraceEvent(self, XBEE_TRACE_CHECKSUM_ERROR, 0, 0, 0, rx->length, 0);
+                    return API_RECEIVE_ERROR_INVALID_CHECKSUM;
+                }
+                rx->state = XBEE_RX_STATE_DELIMITER;
+                self->stats.framesReceived++;
+
+                // Hand out a view of the frame, no copy
+                frame->data = rxFrameData(self);
+                frame->type = frame->data[0];
+                frame->length = rx->length;
+                frame->checksum = bytes[0];
+                return API_RECEIVE_SUCCESS; // Successfully received a frame
+        }
+    }
+}
+
 
-    // Attempt to read the start delimiter with timeout
-    uint8_t start_delimiter;
-    api_receive_status_t result = readBytesWithTimeout(self, &start_delimiter, 1, UART_READ_TIMEOUT_MS);
-    if (result != API_RECEIVE_SUCCESS) {
-        //APIFrameDebugPrint("Error: Timeout occurred while waiting to read start delimiter.\n");
-        return API_RECEIVE_ERROR_TIMEOUT_START_DELIMITER;
+/**
+ * @brief Calls the handler registered for the received API frame type.
+ * 
+ * This function processes a received XBee API frame by looking up the frame's type in 
+ * the instance's handler map and calling the handler in that slot. If no handler is 
+ * registered for the type, a debug message is printed.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] frame Pointer to the received API frame to be handled.
+ * 
+ * @return void This function does not return a value.
+ */
+void apiHandleFrame(XBee* self, xbee_api_frame_t *frame){
+    uint8_t slot = 0;
+    if (frame->type >= XBEE_FRAME_HANDLER_FIRST_TYPE) {
+        slot = self->frameHandlerMap[frame->type - XBEE_FRAME_HANDLER_FIRST_TYPE];
     }
-    APIFrameDebugPrint("Start delimiter received: 0x%02X\n", start_delimiter);
+    XBEETraceEvent(self, XBEE_TRACE_FRAME_RX, frame->type, (frame->length > 1) ? frame->data[1] : 0, slot == 0,
+        frame->length, 0);
+    if (slot == 0) {
+        APIFrameDebugPrint("Received unknown frame type: 0x%02X\n", frame->type);
+        return;
+    }
+    const XBeeFrameHandlerSlot *entry = &self->frameHandlers[slot - 1];
+    entry->handler(self, frame, entry->ctx);
+}
 
-    if (start_delimiter != 0x7E) {
-        APIFrameDebugPrint("Error: Invalid start delimiter. Expected 0x7E, but received 0x%02X.\n", start_delimiter);
-        return API_RECEIVE_ERROR_INVALID_START_DELIMITER;
+/**
+ * @brief Checks whether a handler slot is still referenced by any frame type.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] slot Handler slot + 1, as stored in the handler map.
+ * 
+ * @return bool Returns true if at least one frame type maps to the slot.
+ */
+static bool apiFrameHandlerSlotUsed(XBee* self, uint8_t slot) {
+    for (uint16_t i = 0; i < XBEE_FRAME_HANDLER_MAP_SIZE; i++) {
+        if (self->frameHandlerMap[i] == slot) {
+            return true;
+        }
     }
+    return false;
+}
 
-    // Read length with timeout
-    uint8_t length_bytes[2];
-    result = readBytesWithTimeout(self, length_bytes, 2, UART_READ_TIMEOUT_MS);
-    if (result != API_RECEIVE_SUCCESS) {
-        APIFrameDebugPrint("Error: Timeout occurred while waiting to read frame length.\n");
-        return API_RECEIVE_ERROR_TIMEOUT_LENGTH;
+/**
+ * @brief Sets or removes the handler for a received frame type.
+ * 
+ * Frame types registered with the same handler and context share a slot. A slot is 
+ * released once no frame type refers to it. Unlike `XBeeRegisterFrameHandler()` this 
+ * does not protect the frame types used internally by the library.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] frameType Received frame type, 0x80-0xFF.
+ * @param[in] handler Handler to call, or NULL to remove the current handler.
+ * @param[in] ctx User pointer passed to the handler.
+ * 
+ * @return bool Returns true on success, false if the type is out of range or all slots are in use.
+ */
+bool apiSetFrameHandler(XBee* self, uint8_t frameType, XBeeFrameHandler handler, void *ctx) {
+    if (frameType < XBEE_FRAME_HANDLER_FIRST_TYPE) {
+        return false;
     }
-    uint16_t length = (length_bytes[0] << 8) | length_bytes[1];
-    APIFrameDebugPrint("Frame length received: %d bytes\n", length);
+    uint8_t *mapEntry = &self->frameHandlerMap[frameType - XBEE_FRAME_HANDLER_FIRST_TYPE];
+    uint8_t previous = *mapEntry;
 
-    if (length > XBEE_MAX_FRAME_DATA_SIZE) {
-        APIFrameDebugPrint("Error: Frame length exceeds buffer size.\n");
-        return API_RECEIVE_ERROR_FRAME_TOO_LARGE;
+    // Release the current slot first so it can be reused below
+    *mapEntry = 0;
+    if ((previous != 0) && !apiFrameHandlerSlotUsed(self, previous)) {
+        self->frameHandlers[previous - 1].handler = NULL;
+        self->frameHandlers[previous - 1].ctx = NULL;
+    }
+    if (handler == NULL) {
+        return true;
     }
 
-    // Read the frame data with timeout
-    result = readBytesWithTimeout(self, frame->data, length, UART_READ_TIMEOUT_MS);
-    if (result != API_RECEIVE_SUCCESS) {
-        APIFrameDebugPrint("Error: Timeout occurred while waiting to read frame data.\n");
-        return API_RECEIVE_ERROR_TIMEOUT_DATA;
+    uint8_t freeSlot = 0;
+    for (uint8_t i = 0; i < XBEE_FRAME_HANDLER_SLOTS; i++) {
+        XBeeFrameHandlerSlot *entry = &self->frameHandlers[i];
+        if ((entry->handler == handler) && (entry->ctx == ctx)) {
+            *mapEntry = i + 1;
+            return true;
+        }
+        if ((entry->handler == NULL) && (freeSlot == 0)) {
+            freeSlot = i + 1;
+        }
     }
-    APIFrameDebugPrint("Complete frame data received: ");
-    for (int i = 0; i < length; i++) {
-        APIFrameDebugPrint("0x%02X ", frame->data[i]);
+    if (freeSlot == 0) {
+        // Out of slots, keep the previous handler
+        if ((previous != 0) && (self->frameHandlers[previous - 1].handler != NULL)) {
+            *mapEntry = previous;
+        }
+        APIFrameDebugPrint("No free frame handler slot for type 0x%02X\n", frameType);
+        return false;
     }
-    APIFrameDebugPrint("\n");
+    self->frameHandlers[freeSlot - 1].handler = handler;
+    self->frameHandlers[freeSlot - 1].ctx = ctx;
+    *mapEntry = freeSlot;
+    return true;
+}
 
-    // Read the checksum with timeout
-    result = readBytesWithTimeout(self, &(frame->checksum), 1, UART_READ_TIMEOUT_MS);
-    if (result != API_RECEIVE_SUCCESS) {
-        APIFrameDebugPrint("Error: Timeout occurred while waiting to read checksum.\n");
-        return API_RECEIVE_ERROR_TIMEOUT_CHECKSUM;
+static void apiDispatchAtResponse(XBee* self, void *frame, void *ctx) {
+    (void)ctx;
+    xbeeHandleAtResponse(self, (xbee_api_frame_t*)frame);
+}
+
+static void apiDispatchRemoteAtResponse(XBee* self, void *frame, void *ctx) {
+    (void)ctx;
+    xbeeHandleRemoteAtResponse(self, (xbee_api_frame_t*)frame);
+}
+
+static void apiDispatchModemStatus(XBee* self, void *frame, void *ctx) {
+    (void)ctx;
+    xbeeHandleModemStatus(self, (xbee_api_frame_t*)frame);
+    if (self->vtable->handleModemStatusFrame) {
+        self->vtable->handleModemStatusFrame(self, frame);
     }
+}
 
-    // Populate frame structure
-    frame->length = length;
-    frame->type = frame->data[0];
+static void apiDispatchTransmitStatus(XBee* self, void *frame, void *ctx) {
+    (void)ctx;
+    self->vtable->handleTransmitStatusFrame(self, frame);
+}
 
-    // Check and verify the checksum
-    uint8_t checksum = frame->checksum;
-    for (int i = 0; i < length; i++) {
-        checksum += frame->data[i];
+static void apiDispatchRxPacket(XBee* self, void *frame, void *ctx) {
+    (void)ctx;
+    self->vtable->handleRxPacketFrame(self, frame);
+}
+
+/**
+ * @brief Fills the frame handler map from the instance's vtable.
+ * 
+ * Registers the library's local and remote AT response and modem status handling, and routes the given 
+ * TX status and RX packet frame types to the subclass vtable handlers when present. 
+ * Called by subclasses once their vtable is set, before any application handlers are 
+ * registered.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] txStatusTypes Frame types routed to `handleTransmitStatusFrame`.
+ * @param[in] txStatusCount Number of entries in `txStatusTypes`.
+ * @param[in] rxPacketTypes Frame types routed to `handleRxPacketFrame`.
+ * @param[in] rxPacketCount Number of entries in `rxPacketTypes`.
+ * 
+ * @return void This function does not return a value.
+ */
+void apiRegisterDefaultHandlers(XBee* self, const uint8_t *txStatusTypes, uint8_t txStatusCount, 
+    const uint8_t *rxPacketTypes, uint8_t rxPacketCount) {
+    (void)apiSetFrameHandler(self, XBEE_API_TYPE_AT_RESPONSE, apiDispatchAtResponse, NULL);
+    (void)apiSetFrameHandler(self, XBEE_API_TYPE_REMOTE_AT_RESPONSE, apiDispatchRemoteAtResponse, NULL);
+    (void)apiSetFrameHandler(self, XBEE_API_TYPE_MODEM_STATUS, apiDispatchModemStatus, NULL);
+    for (uint8_t i = 0; (i < txStatusCount) && self->vtable->handleTransmitStatusFrame; i++) {
+        (void)apiSetFrameHandler(self, txStatusTypes[i], apiDispatchTransmitStatus, NULL);
     }
-    if (checksum != 0xFF) {
-        APIFrameDebugPrint("Error: Invalid checksum. Expected 0xFF, but calculated 0x%02X.\n", checksum);
-        return API_RECEIVE_ERROR_INVALID_CHECKSUM;
+    for (uint8_t i = 0; (i < rxPacketCount) && self->vtable->handleRxPacketFrame; i++) {
+        (void)apiSetFrameHandler(self, rxPacketTypes[i], apiDispatchRxPacket, NULL);
     }
+}
+
+static int apiSubmitAtRequest(XBee* self, xbee_at_request_t *request, uint8_t frameType, at_command_t command, 
+    const uint8_t *parameter, uint8_t paramLength, uint32_t timeoutMs);
 
-    return API_RECEIVE_SUCCESS; // Successfully received a frame
+/**
+ * @brief Prepares a caller-owned AT request for `apiSendAtCommandAsync()`.
+ * 
+ * @param[out] request Pointer to the request to initialize.
+ * @param[in] responseBuffer Buffer that receives the response data (can be NULL).
+ * @param[in] responseSize Size of `responseBuffer` in bytes.
+ * @param[in] callback Completion callback (can be NULL to poll with `apiAtRequestPending()`).
+ * @param[in] ctx User pointer passed to the callback through the request.
+ * 
+ * @return void This function does not return a value.
+ */
+void apiAtRequestInit(xbee_at_request_t *request, uint8_t *responseBuffer, uint8_t responseSize, 
+    xbee_at_callback_t callback, void *ctx) {
+    memset(request, 0, sizeof(*request));
+    request->responseBuffer = responseBuffer;
+    request->responseSize = responseBuffer ? responseSize : 0;
+    request->callback = callback;
+    request->ctx = ctx;
 }
 
+/**
+ * @brief Sends an AT command without waiting for its response.
+ * 
+ * This function allocates a frame ID for the command, sends it and links the request into 
+ * the instance's pending list. The matching 0x88 AT response is picked up by `XBeeProcess()`, 
+ * which completes the request and invokes its callback. Any number of requests can be 
+ * outstanding at the same time, each one is matched by frame ID and command.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in,out] request Request prepared with `apiAtRequestInit()`, must stay valid until it completes.
+ * @param[in] command The AT command to be sent, specified as an `at_command_t` enum.
+ * @param[in] parameter Pointer to the parameter data to be included with the AT command (can be NULL).
+ * @param[in] paramLength Length of the parameter data in bytes (0 if no parameters).
+ * @param[in] timeoutMs The timeout period in milliseconds within which the response must be received.
+ * 
+ * @return int Returns 0 (`API_SEND_SUCCESS`) if the command was sent, or the error code of `apiSendAtCommand()`. 
+ * The request is not queued on failure.
+ */
+int apiSendAtCommandAsync(XBee* self, xbee_at_request_t *request, at_command_t command, 
+    const uint8_t *parameter, uint8_t paramLength, uint32_t timeoutMs) {
+    request->remote = false;
+    return apiSubmitAtRequest(self, request, XBEE_API_TYPE_AT_COMMAND, command, parameter, paramLength, timeoutMs);
+}
 
 /**
- * @brief Calls registered handlers based on the received API frame type.
+ * @brief Queues an AT parameter value without waiting for its response.
  * 
- * This function processes a received XBee API frame by calling the appropriate 
- * handler function based on the frame's type. It supports handling AT responses, 
- * modem status, transmit status, and received packet frames. For each frame type, 
- * the corresponding handler function is invoked if it is registered in the XBee 
- * virtual table (vtable). If the frame type is unknown, a debug message is printed.
+ * Same as `apiSendAtCommandAsync()` but sends a 0x09 queue parameter frame, so the value 
+ * only takes effect once AC is sent.
  * 
  * @param[in] self Pointer to the XBee instance.
- * @param[in] frame The received API frame to be handled.
+ * @param[in,out] request Request prepared with `apiAtRequestInit()`, must stay valid until it completes.
+ * @param[in] command The AT command to be queued, specified as an `at_command_t` enum.
+ * @param[in] parameter Pointer to the parameter data (can be NULL).
+ * @param[in] paramLength Length of the parameter data in bytes (0 if no parameters).
+ * @param[in] timeoutMs The timeout period in milliseconds within which the response must be received.
+ * 
+ * @return int Returns 0 (`API_SEND_SUCCESS`) if the frame was sent, or a non-zero error code.
+ */
+int apiQueueAtParameterAsync(XBee* self, xbee_at_request_t *request, at_command_t command, 
+    const uint8_t *parameter, uint8_t paramLength, uint32_t timeoutMs) {
+    request->remote = false;
+    return apiSubmitAtRequest(self, request, XBEE_API_TYPE_AT_COMMAND_QUEUE, command, parameter, paramLength, timeoutMs);
+}
+
+/**
+ * @brief Sends an AT command to another node of the network without waiting for its response.
+ * 
+ * Same as `apiSendAtCommandAsync()` but sends a 0x17 remote AT command frame to the node 
+ * with the given addresses. The request is completed by the 0x97 remote AT response from that 
+ * node, with `remoteAddress16` updated to the 16-bit address it reported. A command status of 
+ * `XBEE_REMOTE_AT_STATUS_TX_FAILURE` means the command never reached the node. Any number of 
+ * local and remote requests can be outstanding at the same time, each with its own frame ID.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in,out] request Request prepared with `apiAtRequestInit()`, must stay valid until it completes.
+ * @param[in] address64 64-bit address of the remote node.
+ * @param[in] address16 16-bit address of the remote node, 0xFFFE if it is not known.
+ * @param[in] options Remote command options, e.g. `XBEE_REMOTE_AT_OPTION_APPLY_CHANGES`.
+ * @param[in] command The AT command to be sent, specified as an `at_command_t` enum.
+ * @param[in] parameter Pointer to the parameter data (can be NULL).
+ * @param[in] paramLength Length of the parameter data in bytes (0 if no parameters).
+ * @param[in] timeoutMs The timeout period in milliseconds within which the response must be received.
+ * 
+ * @return int Returns 0 (`API_SEND_SUCCESS`) if the frame was sent, or a non-zero error code.
+ */
+int apiSendRemoteAtCommandAsync(XBee* self, xbee_at_request_t *request, uint64_t address64, uint16_t address16, 
+    uint8_t options, at_command_t command, const uint8_t *parameter, uint8_t paramLength, uint32_t timeoutMs) {
+    request->remote = true;
+    request->remoteAddress = address64;
+    request->remoteAddress16 = address16;
+    request->remoteOptions = options;
+    return apiSubmitAtRequest(self, request, XBEE_API_TYPE_REMOTE_AT_COMMAND, command, parameter, paramLength, timeoutMs);
+}
+
+// Sends an AT frame and links the request into the pending list
+static int apiSubmitAtRequest(XBee* self, xbee_at_request_t *request, uint8_t frameType, at_command_t command, 
+    const uint8_t *parameter, uint8_t paramLength, uint32_t timeoutMs) {
+    request->command = command;
+    request->frameId = XBeeReserveFrameId(self);
+    request->responseLength = 0;
+    request->commandStatus = 0;
+    request->startTime = XBeeStatsTimestamp(self);
+
+    int status = request->remote ? apiSendRemoteAtFrame(self, request, parameter, paramLength) : 
+        apiSendAtFrame(self, frameType, command, parameter, paramLength);
+    if (status != API_SEND_SUCCESS) {
+        request->pending = false;
+        request->result = status;
+        return status;
+    }
+
+    request->deadline = self->htable->PortMillis(self->portContext) + timeoutMs;
+    request->pending = true;
+    request->result = API_SEND_SUCCESS;
+    request->next = self->atPending;
+    self->atPending = request;
+    return API_SEND_SUCCESS;
+}
+
+/**
+ * @brief Checks whether an AT request is still waiting for its response.
+ * 
+ * @param[in] request Pointer to the request.
+ * 
+ * @return bool Returns true while the request is outstanding, false once `request->result` is valid.
+ */
+bool apiAtRequestPending(const xbee_at_request_t *request) {
+    return request->pending;
+}
+
+/**
+ * @brief Blocks until an AT request has completed.
+ * 
+ * Received frames keep being dispatched through `XBeeProcess()` while waiting, so the 
+ * request is completed by its response or by its timeout. It must not be called from a 
+ * frame handler or callback.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] request Pointer to a request submitted with `apiSendAtCommandAsync()`.
+ * 
+ * @return int The result of the request (`API_SEND_SUCCESS` or an `API_SEND_*` error code).
+ */
+int apiAtRequestWait(XBee* self, xbee_at_request_t *request) {
+    while (apiAtRequestPending(request)) {
+        XBeeProcess(self);
+        if (apiAtRequestPending(request)) {
+            // XBeeProcess() has drained the UART, wait for more bytes or the request's deadline
+            XBeeWait(self, XBEE_WAIT_FOREVER);
+        }
+    }
+    return request->result;
+}
+
+// Unlinks a request from the pending list without completing it
+static bool apiAtRequestUnlink(XBee* self, xbee_at_request_t *request) {
+    for (xbee_at_request_t **link = &self->atPending; *link != NULL; link = &(*link)->next) {
+        if (*link == request) {
+            *link = request->next;
+            request->next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Removes a request from the pending list, stores its result and runs its callback
+static void apiAtRequestComplete(XBee* self, xbee_at_request_t *request, int result) {
+    if (result == API_SEND_AT_CMD_RESONSE_TIMEOUT) {
+        XBEETraceEvent(self, XBEE_TRACE_AT_TIMEOUT, 0, request->frameId, 0, request->command, 0);
+    } else {
+        XBEETraceEvent(self, XBEE_TRACE_AT_RESPONSE, request->remote ? XBEE_API_TYPE_REMOTE_AT_RESPONSE : XBEE_API_TYPE_AT_RESPONSE,
+            request->frameId, request->commandStatus, request->command, XBeeStatsTimestamp(self) - request->startTime);
+    }
+    apiAtRequestUnlink(self, request);
+    request->pending = false;
+    request->result = result;
+    if (request->callback) {
+        request->callback(self, request);
+    }
+}
+
+/**
+ * @brief Cancels an outstanding AT request without invoking its callback.
+ * 
+ * A response that arrives later is ignored, and the request can be reused right away.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] request Pointer to the request.
  * 
  * @return void This function does not return a value.
  */
-void apiHandleFrame(XBee* self, xbee_api_frame_t frame){
-    switch (frame.type) {
-        case XBEE_API_TYPE_AT_RESPONSE:
-            xbeeHandleAtResponse(self, &frame);
-            break;
-        case XBEE_API_TYPE_MODEM_STATUS:
-            xbeeHandleModemStatus(self, &frame);
-            break;
-        case XBEE_API_TYPE_TX_STATUS:
-        case XBEE_API_TYPE_LR_EXPLICIT_TX_STATUS:
-            if(self->vtable->handleTransmitStatusFrame){
-                self->vtable->handleTransmitStatusFrame(self, &frame);
-            }
-            break;
-        case XBEE_API_TYPE_LR_RX_PACKET:
-        case XBEE_API_TYPE_LR_EXPLICIT_RX_PACKET:
-            if(self->vtable->handleRxPacketFrame){
-                self->vtable->handleRxPacketFrame(self, &frame);
-            }
-            break;
-        default:
-            APIFrameDebugPrint("Received unknown frame type: 0x%02X\n", frame.type);
-            break;
+void apiAtRequestCancel(XBee* self, xbee_at_request_t *request) {
+    if (apiAtRequestUnlink(self, request)) {
+        request->pending = false;
+        request->result = API_SEND_AT_CMD_RESONSE_TIMEOUT;
+    }
+}
+
+/**
+ * @brief Times out AT requests whose response never arrived.
+ * 
+ * Called from the subclass process function.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return void This function does not return a value.
+ */
+void apiAtRequestExpire(XBee* self) {
+    uint32_t now = self->htable->PortMillis(self->portContext);
+    xbee_at_request_t *request = self->atPending;
+    while (request != NULL) {
+        xbee_at_request_t *next = request->next;
+        if ((int32_t)(now - request->deadline) >= 0) {
+            APIFrameDebugPrint("Timeout waiting for AT response.\n");
+            self->stats.atTimeouts++;
+            apiAtRequestComplete(self, request, API_SEND_AT_CMD_RESONSE_TIMEOUT);
+            next = self->atPending; // The callback may have changed the list
+        }
+        request = next;
     }
 }
 
@@ -371,16 +1248,17 @@ void apiHandleFrame(XBee* self, xbee_api_frame_t frame){
  * @brief Sends an AT command via an API frame and waits for the response.
  * 
  * This function sends an AT command using an XBee API frame and then waits for a response 
- * from the XBee module within a specified timeout period. The response is captured and 
- * stored in the provided response buffer. The function continuously checks for incoming 
- * frames and processes them until the expected AT response frame is received or the 
- * timeout period elapses.
+ * from the XBee module within a specified timeout period. It is a blocking wrapper around 
+ * `apiSendAtCommandAsync()`: received frames keep being dispatched through `XBeeProcess()` 
+ * while it waits, and only the AT response matching the frame ID and command of this request 
+ * completes it. It must not be called from a frame handler or callback.
  * 
  * @param[in] self Pointer to the XBee instance.
  * @param[in] command The AT command to be sent, specified as an `at_command_t` enum.
  * @param[in] parameter Pointer to the parameter data to be included with the AT command (can be NULL).
+ * @param[in] paramLength Length of the parameter data in bytes (0 if no parameters).
  * @param[out] responseBuffer Pointer to a buffer where the AT command response will be stored.
- * @param[out] responseLength Pointer to a variable where the length of the response will be stored.
+ * @param[out] responseLength Pointer to a variable where the length of the response will be stored (can be NULL).
  * @param[in] timeoutMs The timeout period in milliseconds within which the response must be received.
  * 
  * @return int Returns 0 (`API_SEND_SUCCESS`) if the AT command is successfully sent and a valid response is received, 
@@ -388,57 +1266,25 @@ void apiHandleFrame(XBee* self, xbee_api_frame_t frame){
  */
 int apiSendAtCommandAndGetResponse(XBee* self, at_command_t command, const uint8_t *parameter, uint8_t paramLength, uint8_t *responseBuffer, 
     uint8_t *responseLength, uint32_t timeoutMs) {
-    // Send the AT command using API frame
-    apiSendAtCommand(self, command, (const uint8_t *)parameter, paramLength);
-
-    // Get the start time using the platform-specific function
-    uint32_t startTime = self->htable->PortMillis();
-    
-    // Wait and receive the response within the timeout period
-    xbee_api_frame_t frame;
-    int status;
+    xbee_at_request_t request;
 
-    while (1) {
-        // Attempt to receive the API frame
-        status = apiReceiveApiFrame(self, &frame);
-
-        // Check if a valid frame was received
-        if (status == 0) {
-            // Check if the received frame is an AT response
-            if (frame.type == XBEE_API_TYPE_AT_RESPONSE) {
-
-                // Extract the AT command response
-                *responseLength = frame.length - 5;  // Subtract the frame ID and AT command bytes
-                APIFrameDebugPrint("responseLength: %u\n", *responseLength);
-                if(frame.data[4] == 0){
-                    if((responseBuffer != NULL) && (*responseLength)){
-                        memcpy(responseBuffer, &frame.data[5], *responseLength);
-                    }
-                }else{
-                    APIFrameDebugPrint("API Frame AT CMD Error.\n");
-                    return API_SEND_AT_CMD_ERROR;
-                }
-            
-                // Return success
-                return API_SEND_SUCCESS;
-            } 
-            else{
-                apiHandleFrame(self, frame);
-            }
-        }
+    // The response buffer size is not known here, accept anything that fits in a frame
+    apiAtRequestInit(&request, responseBuffer, XBEE_MAX_FRAME_DATA_SIZE - 5, NULL, NULL);
+    if (apiSendAtCommandAsync(self, &request, command, parameter, paramLength, timeoutMs) == API_SEND_SUCCESS) {
+        (void)apiAtRequestWait(self, &request);
+    }
 
-        // Check if the timeout period has elapsed using platform-specific time
-        if ((self->htable->PortMillis() - startTime) >= timeoutMs) {
-            APIFrameDebugPrint("Timeout waiting for AT response.\n");
-            return API_SEND_AT_CMD_RESONSE_TIMEOUT;
-        }
-        
-        self->htable->PortDelay(1);
+    if (responseLength != NULL) {
+        *responseLength = request.responseLength;
     }
+    return request.result;
 }
 
-//Print out AT Response
+//Print out AT Response and complete the matching pending request
 void xbeeHandleAtResponse(XBee* self, xbee_api_frame_t *frame) {
+    // Frame ID, AT command and command status
+    if (frame->length < 5) return;
+
 #if API_FRAME_DEBUG_PRINT_ENABLED
     // The first byte of frame->data is the Frame ID
     uint8_t frame_id = frame->data[1];
@@ -468,12 +1314,83 @@ void xbeeHandleAtResponse(XBee* self, xbee_api_frame_t *frame) {
     } else {
         APIFrameDebugPrint("  No additional data.\n");
     }
+
+    // Complete the pending request this response belongs to
+    for (xbee_at_request_t *request = self->atPending; request != NULL; request = request->next) {
+        if (request->remote || (request->frameId != frame->data[1]) ||
+            (request->command != (at_command_t)XBEE_AT_CODE(frame->data[2], frame->data[3]))) {
+            continue;
+        }
+
+        uint8_t length = (frame->length > 5) ? (uint8_t)(frame->length - 5) : 0;
+        request->commandStatus = frame->data[4];
+        request->responseLength = length;
+        if (length > request->responseSize) {
+            length = request->responseSize;
+        }
+        if ((request->commandStatus == 0) && length) {
+            memcpy(request->responseBuffer, &frame->data[5], length);
+        }
+        if (request->commandStatus != 0) {
+            APIFrameDebugPrint("API Frame AT CMD Error.\n");
+        } else if ((request->command == AT_RE) || (request->command == AT_NR)) {
+            // Parameters were restored or the network stack was reset, forget what was cached
+            XBeeShadowInvalidate(self);
+        }
+        XBeeStatsRecordLatency(self, &self->stats.atLatency, request->startTime);
+        apiAtRequestComplete(self, request, (request->commandStatus == 0) ? API_SEND_SUCCESS : API_SEND_AT_CMD_ERROR);
+        break;
+    }
+}
+
+//Complete the pending remote request a remote AT response belongs to
+void xbeeHandleRemoteAtResponse(XBee* self, xbee_api_frame_t *frame) {
+    // Frame ID, source addresses, AT command and command status
+    if ((frame->type != XBEE_API_TYPE_REMOTE_AT_RESPONSE) || (frame->length < 15)) return;
+
+    uint64_t address64 = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        address64 = (address64 << 8) | frame->data[2 + i];
+    }
+    at_command_t command = (at_command_t)XBEE_AT_CODE(frame->data[12], frame->data[13]);
+
+    APIFrameDebugPrint("Remote AT Response: %c%c, status %d\n", frame->data[12], frame->data[13], frame->data[14]);
+
+    for (xbee_at_request_t *request = self->atPending; request != NULL; request = request->next) {
+        if (!request->remote || (request->frameId != frame->data[1]) || (request->command != command) ||
+            (request->remoteAddress != address64)) {
+            continue;
+        }
+
+        uint8_t length = (frame->length > 15) ? (uint8_t)(frame->length - 15) : 0;
+        request->commandStatus = frame->data[14];
+        request->responseLength = length;
+        if (request->commandStatus == 0) {
+            request->remoteAddress16 = (uint16_t)(frame->data[10] << 8 | frame->data[11]);
+        }
+        if (length > request->responseSize) {
+            length = request->responseSize;
+        }
+        if ((request->commandStatus == 0) && length) {
+            memcpy(request->responseBuffer, &frame->data[15], length);
+        }
+        XBeeStatsRecordLatency(self, &self->stats.atLatency, request->startTime);
+        apiAtRequestComplete(self, request, (request->commandStatus == 0) ? API_SEND_SUCCESS : API_SEND_AT_CMD_ERROR);
+        break;
+    }
 }
 
 //Should be moved to be handled by user?
 void xbeeHandleModemStatus(XBee* self, xbee_api_frame_t *frame) {
-    if (frame->type != XBEE_API_TYPE_MODEM_STATUS) return;
+    if ((frame->type != XBEE_API_TYPE_MODEM_STATUS) || (frame->length < 2)) return;
 
     APIFrameDebugPrint("Modem Status: %d\n", frame->data[1]);
-    // Add further processing as needed
+
+    // Hardware or watchdog reset: the module reloaded its saved configuration
+    if ((frame->data[1] == 0x00) || (frame->data[1] == 0x01)) {
+        XBeeShadowInvalidate(self);
+        self->shadow.readCount = 0;
+        self->shadow.dirty = false;
+    }
+    // Subclass specific processing is done by the handleModemStatusFrame vtable hook
 }
@@ -46,7 +46,6 @@ extern "C"
 #include "xbee.h"
 #include "config.h"
 
-#define XBEE_MAX_FRAME_DATA_SIZE 256
 #define API_SEND_SUCCESS 0
 #define API_SEND_ERROR_TIMEOUT -1
 #define API_SEND_ERROR_INVALID_COMMAND -2
@@ -132,6 +131,9 @@ typedef enum {
  * @var XBEE_API_TYPE_AT_COMMAND
  *     Frame type for sending AT commands to the XBee module. The command is executed
  *     locally by the module.
+ * @var XBEE_API_TYPE_AT_COMMAND_QUEUE
+ *     Frame type for queueing a parameter value. The module validates and stores the 
+ *     value, but only applies it when an AC (or an AT command frame) is received.
  * @var XBEE_API_TYPE_TX_REQUEST
  *     Frame type for transmitting data to another device in the network. This frame
  *     initiates the transmission of a data packet.
@@ -170,6 +172,9 @@ typedef enum {
  * @var XBEE_API_TYPE_3RF_RX_EXPLICIT_PACKET
  *     Frame type specific to XBee 3 RF modules for receiving explicitly addressed data packets.
  *     It includes addressing information along with the received payload.
+ * @var XBEE_API_TYPE_3RF_EXTENDED_TX_STATUS
+ *     Frame type specific to XBee 3 RF modules reporting the delivery status of a TX request
+ *     together with the 16-bit address used, the retry count and the discovery overhead.
  *
  * @var XBEE_API_TYPE_CELLULAR_TX_IPV4
  *     Frame type specific to XBee Cellular modules for transmitting IPv4 data packets. It initiates
@@ -201,6 +206,7 @@ typedef enum {
 
     /**< XBee Common API Frames */
     XBEE_API_TYPE_AT_COMMAND = 0x08,               ///< Frame for sending AT commands
+    XBEE_API_TYPE_AT_COMMAND_QUEUE = 0x09,         ///< Frame for queueing AT parameter values
     XBEE_API_TYPE_TX_REQUEST = 0x10,               ///< Frame for transmitting data
     XBEE_API_TYPE_MODEM_STATUS = 0x8A,             ///< Frame for modem status reports
     XBEE_API_TYPE_AT_RESPONSE = 0x88,              ///< Frame for receiving AT command responses
@@ -218,6 +224,7 @@ typedef enum {
     XBEE_API_TYPE_3RF_REMOTE_AT_RESPONSE = 0x97,   ///< Frame for receiving remote AT responses (XBee 3 RF)
     XBEE_API_TYPE_3RF_RX_PACKET = 0x90,            ///< Frame for receiving data packets (XBee 3 RF)
     XBEE_API_TYPE_3RF_RX_EXPLICIT_PACKET = 0x91,   ///< Frame for receiving explicitly addressed packets (XBee 3 RF)
+    XBEE_API_TYPE_3RF_EXTENDED_TX_STATUS = 0x8B,   ///< Frame for extended delivery status reports (XBee 3 RF)
 
     /**< XBee Cellular Specific API Frames */
     XBEE_API_TYPE_CELLULAR_TX_IPV4 = 0x20,         ///< Frame for transmitting IPv4 data (XBee Cellular)
@@ -242,8 +249,11 @@ typedef enum {
  * This enum defines the possible status codes that can be returned by the 
  * `api_receive_api_frame` function. These status codes indicate whether the frame 
  * was successfully received or if there was an error, and if so, what type of error occurred.
+ * `API_RECEIVE_PENDING` means no complete frame is available yet; the bytes read so far
+ * are kept in the parser and the frame is resumed on the next call.
  */
 typedef enum {
+    API_RECEIVE_PENDING = 1,                  ///< No complete frame yet, parser state retained
     API_RECEIVE_SUCCESS = 0,                  ///< Frame received successfully
     API_RECEIVE_ERROR_INVALID_POINTER = -1,   ///< Invalid frame pointer (NULL)
     API_RECEIVE_ERROR_TIMEOUT_START_DELIMITER = -2, ///< Timeout or error reading start delimiter
@@ -282,36 +292,134 @@ typedef enum {
  *     The checksum is calculated over the frame's data and is essential for detecting 
  *     transmission errors.
  * @var xbee_api_frame_t::data
- *     The actual data contained within the API frame. This array holds the payload or 
- *     command data associated with the frame type. The size of this array is defined by 
- *     `XBEE_MAX_FRAME_DATA_SIZE`, which should be set according to the maximum expected 
- *     frame size in the application.
+ *     Pointer to the frame data, starting with the frame type byte. Received frames are 
+ *     not copied: the pointer refers to the parser buffer or to the receive ring, and is 
+ *     only valid until the next call to `apiReceiveApiFrame()`.
  *
  * Example Usage:
  * @code
  * xbee_api_frame_t frame;
- * frame.type = XBEE_API_TYPE_TX_REQUEST;
- * frame.length = 10;
- * frame.data[0] = 0x01; // Example payload data
- * frame.checksum = calculateChecksum(frame.data, frame.length);
+ * if (apiReceiveApiFrame(self, &frame) == API_RECEIVE_SUCCESS) {
+ *     apiHandleFrame(self, &frame);
+ * }
  * @endcode
  */
 typedef struct {
     xbee_api_frame_type_t type;  ///< Type of the API frame
     uint16_t length;             ///< Length of the frame data
     uint8_t checksum;            ///< Checksum of the API frame
-    uint8_t data[XBEE_MAX_FRAME_DATA_SIZE]; ///< Frame data
+    uint8_t *data;               ///< View of the frame data
 } xbee_api_frame_t;
 
+/**
+ * @typedef xbee_iovec_t
+ * @brief One piece of frame data for `apiSendFrameV()`.
+ *
+ * A frame is described as a list of pieces (e.g. a small header built on the stack 
+ * followed by the caller's payload), which are streamed to the UART without being 
+ * copied into a staging buffer first.
+ */
+typedef struct {
+    const uint8_t *data;         ///< Start of the piece
+    uint16_t length;             ///< Length of the piece in bytes
+} xbee_iovec_t;
+
+typedef struct xbee_at_request_s xbee_at_request_t;
+
+/**
+ * @typedef xbee_at_callback_t
+ * @brief Completion callback of an asynchronous AT command.
+ *
+ * Called from `XBeeProcess()` after the request has been removed from the pending list,
+ * so the callback may submit the same request again.
+ */
+typedef void (*xbee_at_callback_t)(XBee* self, xbee_at_request_t *request);
+
+/**
+ * @struct xbee_at_request_s
+ * @brief Caller-owned state of an asynchronous AT command.
+ *
+ * The request is linked into the instance's pending list by `apiSendAtCommandAsync()` and 
+ * must stay in scope until it completes or is cancelled. When the 0x88 AT response with the 
+ * same frame ID and command arrives, the response data is copied into `responseBuffer` (up to 
+ * `responseSize` bytes), `responseLength` is set to the full length reported by the module and 
+ * `result` is set to `API_SEND_SUCCESS` or `API_SEND_AT_CMD_ERROR`. If no response arrives in 
+ * time, `result` is set to `API_SEND_AT_CMD_RESONSE_TIMEOUT`. Requests sent with 
+ * `apiSendRemoteAtCommandAsync()` are completed the same way by the 0x97 remote AT response 
+ * from the addressed node.
+ */
+struct xbee_at_request_s {
+    at_command_t command;          ///< AT command that was sent
+    uint8_t frameId;               ///< Frame ID the command was sent with
+    bool pending;                  ///< True until the request completes
+    int result;                    ///< API_SEND_SUCCESS or an API_SEND_* error code once complete
+    uint8_t commandStatus;         ///< Command status byte of the AT response
+    uint8_t *responseBuffer;       ///< Destination for the response data, may be NULL
+    uint8_t responseSize;          ///< Size of `responseBuffer`
+    uint8_t responseLength;        ///< Response data length reported by the module
+    uint32_t deadline;             ///< PortMillis() time after which the request times out
+    uint32_t startTime;            ///< XBeeStatsTimestamp() when the command was sent
+    xbee_at_callback_t callback;   ///< Completion callback, may be NULL
+    void *ctx;                     ///< User pointer for the callback
+    bool remote;                   ///< Sent to another node as a remote AT command (0x17)
+    uint64_t remoteAddress;        ///< 64-bit address of the remote node
+    uint16_t remoteAddress16;      ///< 16-bit address the command was sent to, updated from the response
+    uint8_t remoteOptions;         ///< Remote command options, see XBEE_REMOTE_AT_OPTION_APPLY_CHANGES
+    xbee_at_request_t *next;       ///< Next pending request
+};
+
+// Remote AT command option that applies the value on the remote node right away
+#define XBEE_REMOTE_AT_OPTION_APPLY_CHANGES 0x02
+
+// Command status of a remote AT response whose command never reached the remote node
+#define XBEE_REMOTE_AT_STATUS_TX_FAILURE 0x04
+
+/**
+ * @struct XBeeConfigBatch
+ * @brief Caller-owned state of a batched configuration transaction.
+ *
+ * Opened with `XBeeConfigBegin()`. While it is open, parameter setters queue their value 
+ * with an 0x09 frame into the next free request instead of waiting for a round trip, and 
+ * `XBeeConfigCommit()` applies everything with a single AC and collects all responses.
+ */
+struct XBeeConfigBatch {
+    xbee_at_request_t requests[XBEE_CONFIG_BATCH_SIZE]; ///< Queued parameters
+    xbee_at_request_t apply;       ///< AC request sent by the commit
+    xbee_at_request_t write;       ///< WR request sent by the commit
+    uint8_t count;                 ///< Number of queued parameters
+    uint32_t hashes[XBEE_CONFIG_BATCH_SIZE]; ///< Shadow hashes of the queued values
+    uint8_t lengths[XBEE_CONFIG_BATCH_SIZE]; ///< Lengths of the queued values
+    uint8_t failed;                ///< Number of parameters that could not be queued or were rejected
+    at_command_t failedCommand;    ///< First command that failed
+};
 
 // Function prototypes
 api_receive_status_t apiReceiveApiFrame(XBee* self, xbee_api_frame_t *frame);
+void apiResetRxParser(XBee* self);
 int apiSendAtCommand(XBee* self,at_command_t command, const uint8_t *parameter, uint8_t paramLength);
+int apiQueueAtParameter(XBee* self,at_command_t command, const uint8_t *parameter, uint8_t paramLength);
 int apiSendFrame(XBee* self,uint8_t frame_type, const uint8_t *data, uint16_t len);
+int apiSendFrameV(XBee* self, uint8_t frameType, const xbee_iovec_t *iov, uint8_t iovCount);
 int apiSendAtCommandAndGetResponse(XBee* self, at_command_t command, const uint8_t *parameter, 
     uint8_t paramLength, uint8_t *responseBuffer, uint8_t *responseLength, uint32_t timeoutMs);
-void apiHandleFrame(XBee* self,xbee_api_frame_t frame);
+void apiAtRequestInit(xbee_at_request_t *request, uint8_t *responseBuffer, uint8_t responseSize, 
+    xbee_at_callback_t callback, void *ctx);
+int apiSendAtCommandAsync(XBee* self, xbee_at_request_t *request, at_command_t command, 
+    const uint8_t *parameter, uint8_t paramLength, uint32_t timeoutMs);
+int apiQueueAtParameterAsync(XBee* self, xbee_at_request_t *request, at_command_t command, 
+    const uint8_t *parameter, uint8_t paramLength, uint32_t timeoutMs);
+int apiSendRemoteAtCommandAsync(XBee* self, xbee_at_request_t *request, uint64_t address64, uint16_t address16, 
+    uint8_t options, at_command_t command, const uint8_t *parameter, uint8_t paramLength, uint32_t timeoutMs);
+bool apiAtRequestPending(const xbee_at_request_t *request);
+int apiAtRequestWait(XBee* self, xbee_at_request_t *request);
+void apiAtRequestCancel(XBee* self, xbee_at_request_t *request);
+void apiAtRequestExpire(XBee* self);
+bool apiSetFrameHandler(XBee* self, uint8_t frameType, XBeeFrameHandler handler, void *ctx);
+void apiRegisterDefaultHandlers(XBee* self, const uint8_t *txStatusTypes, uint8_t txStatusCount, 
+    const uint8_t *rxPacketTypes, uint8_t rxPacketCount);
+void apiHandleFrame(XBee* self,xbee_api_frame_t *frame);
 void xbeeHandleAtResponse(XBee* self,xbee_api_frame_t *frame);
+void xbeeHandleRemoteAtResponse(XBee* self, xbee_api_frame_t *frame);
 void xbeeHandleModemStatus(XBee* self,xbee_api_frame_t *frame);
 void xbeeHandleRxPacket(XBee* self,xbee_api_frame_t *frame);
 
@@ -41,8 +41,19 @@ extern "C"
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "config.h"
 
+/**
+ * @brief Packs a two character AT command into its `at_command_t` value.
+ *
+ * The first character is held in the high byte, so the command goes on the wire as 
+ * `XBEE_AT_CHAR_HIGH(command)` followed by `XBEE_AT_CHAR_LOW(command)` without any lookup.
+ */
+#define XBEE_AT_CODE(first, second) ((((uint16_t)(first)) << 8) | (uint8_t)(second))
+#define XBEE_AT_CHAR_HIGH(command)  ((uint8_t)(((uint16_t)(command)) >> 8))
+#define XBEE_AT_CHAR_LOW(command)   ((uint8_t)(command))
+
 /**
  * @enum at_command_t
  * @brief Enumeration of common and module-specific XBee AT commands.
@@ -52,129 +63,160 @@ extern "C"
  *
  * AT commands allow users to configure the XBee module, control its behavior,
  * and query various parameters such as network status, signal strength, and device settings.
+ *
+ * Each value is the command's two characters packed with `XBEE_AT_CODE()`. Module 
+ * specific aliases (`AT_DE_RF`, `AT_WR_RF`, `AT_RI_CELL`) therefore have the same value 
+ * as the command they are sent as, and the value alone cannot tell them apart: `AT_DE` 
+ * is the Device EUI on XBee LR and the Destination Endpoint on XBee 3 RF. A switch on 
+ * `at_command_t` can hold only one label of each pair, and anything keyed by the value, 
+ * such as the parameter cache, treats both names as one command.
  */
 typedef enum {
     /**< XBee Common AT Commands */
-    AT_,     /**< Placeholder for unspecified commands */
-    AT_CN,   /**< Exit Command Mode */
-    AT_AP,   /**< API Enable */
-    AT_BD,   /**< Baud Rate */
-    AT_WR,   /**< Write to non-volatile memory */
-    AT_RE,   /**< Restore factory defaults */
-    AT_VR,   /**< Firmware Version */
-    AT_AC,   /**< Apply Changes */
-    AT_NR,   /**< Network Reset */
-    AT_DD,   /**< Device Type Identifier */
-    AT_ID,   /**< PAN ID */
-    AT_NI,   /**< Node Identifier */
-    AT_DL,   /**< Destination Address Low */
-    AT_DH,   /**< Destination Address High */
-    AT_SH,   /**< Serial Number High */
-    AT_SL,   /**< Serial Number Low */
-    AT_PL,   /**< Power Level */
-    AT_AI,   /**< Association Indication */
-    AT_RP,   /**< RSSI PWM Timer */
-    AT_RN,   /**< Random Delay Slots */
-    AT_RR,   /**< Retries */
-    AT_ND,   /**< Node Discover */
-    AT_NO,   /**< Network Discovery Options */
-    AT_RO,   /**< Packetization Timeout */
-    AT_SM,   /**< Sleep Mode */
-    AT_SO,   /**< Sleep Options */
-    AT_SP,   /**< Sleep Period */
-    AT_ST,   /**< Time Before Sleep */
-    AT_IS,   /**< Force Sample (IO) */
-    AT_P0,   /**< DIO0/AD0 Configuration */
-    AT_P1,   /**< DIO1/AD1 Configuration */
-    AT_P2,   /**< DIO2/AD2 Configuration */
-    AT_P3,   /**< DIO3/AD3 Configuration */
-    AT_P4,   /**< DIO4 Configuration */
-    AT_P5,   /**< DIO5 Configuration */
-    AT_P6,   /**< DIO6 Configuration */
-    AT_P7,   /**< DIO7 Configuration */
-    AT_P8,   /**< DIO8 Configuration */
-    AT_PR,   /**< Pull-up Resistor Enable */
-    AT_RI,   /**< Ring Indicator */
-    AT_CT,   /**< Command Mode Timeout */
-    AT_GT,   /**< Guard Times */
-    AT_SB,   /**< Stop Bits */
-    AT_D7,   /**< DIO7 Configuration */
-    AT_D8,   /**< DIO8 Configuration */
-    AT_D9,   /**< DIO9 Configuration */
-    AT_DA,   /**< DIO10 Configuration */
-    AT_DB,   /**< RSSI for Last Hop */
-    AT_DC,   /**< DIO Change Detect */
-    AT_FT,   /**< Flow Control Threshold */
-    AT_GU,   /**< DIO Pull-up Resistor Enable */
-    AT_HS,   /**< Hardware Sleep Control */
-    AT_IT,   /**< RSSI Timer */
-    AT_NJ,   /**< Node Join Time */
-    AT_JN,   /**< Join Notification */
-    AT_JT,   /**< Join Time */
-    AT_JV,   /**< Channel Verification */
-    AT_LD,   /**< Node Discovery Time */
-    AT_AO,   /**< API Options */
+    AT_ = XBEE_AT_CODE('A', 'T'),       /**< Placeholder for unspecified commands */
+    AT_CN = XBEE_AT_CODE('C', 'N'),     /**< Exit Command Mode */
+    AT_AP = XBEE_AT_CODE('A', 'P'),     /**< API Enable */
+    AT_BD = XBEE_AT_CODE('B', 'D'),     /**< Baud Rate */
+    AT_WR = XBEE_AT_CODE('W', 'R'),     /**< Write to non-volatile memory; same value as AT_WR_RF */
+    AT_RE = XBEE_AT_CODE('R', 'E'),     /**< Restore factory defaults */
+    AT_FR = XBEE_AT_CODE('F', 'R'),     /**< Software Reset */
+    AT_VR = XBEE_AT_CODE('V', 'R'),     /**< Firmware Version */
+    AT_AC = XBEE_AT_CODE('A', 'C'),     /**< Apply Changes */
+    AT_NR = XBEE_AT_CODE('N', 'R'),     /**< Network Reset */
+    AT_DD = XBEE_AT_CODE('D', 'D'),     /**< Device Type Identifier */
+    AT_ID = XBEE_AT_CODE('I', 'D'),     /**< PAN ID */
+    AT_NI = XBEE_AT_CODE('N', 'I'),     /**< Node Identifier */
+    AT_DL = XBEE_AT_CODE('D', 'L'),     /**< Destination Address Low */
+    AT_DH = XBEE_AT_CODE('D', 'H'),     /**< Destination Address High */
+    AT_SH = XBEE_AT_CODE('S', 'H'),     /**< Serial Number High */
+    AT_SL = XBEE_AT_CODE('S', 'L'),     /**< Serial Number Low */
+    AT_PL = XBEE_AT_CODE('P', 'L'),     /**< Power Level */
+    AT_AI = XBEE_AT_CODE('A', 'I'),     /**< Association Indication */
+    AT_RP = XBEE_AT_CODE('R', 'P'),     /**< RSSI PWM Timer */
+    AT_RN = XBEE_AT_CODE('R', 'N'),     /**< Random Delay Slots */
+    AT_RR = XBEE_AT_CODE('R', 'R'),     /**< Retries */
+    AT_ND = XBEE_AT_CODE('N', 'D'),     /**< Node Discover */
+    AT_NO = XBEE_AT_CODE('N', 'O'),     /**< Network Discovery Options */
+    AT_RO = XBEE_AT_CODE('R', 'O'),     /**< Packetization Timeout */
+    AT_SM = XBEE_AT_CODE('S', 'M'),     /**< Sleep Mode */
+    AT_SO = XBEE_AT_CODE('S', 'O'),     /**< Sleep Options */
+    AT_SP = XBEE_AT_CODE('S', 'P'),     /**< Sleep Period */
+    AT_ST = XBEE_AT_CODE('S', 'T'),     /**< Time Before Sleep */
+    AT_IS = XBEE_AT_CODE('I', 'S'),     /**< Force Sample (IO) */
+    AT_P0 = XBEE_AT_CODE('P', '0'),     /**< DIO0/AD0 Configuration */
+    AT_P1 = XBEE_AT_CODE('P', '1'),     /**< DIO1/AD1 Configuration */
+    AT_P2 = XBEE_AT_CODE('P', '2'),     /**< DIO2/AD2 Configuration */
+    AT_P3 = XBEE_AT_CODE('P', '3'),     /**< DIO3/AD3 Configuration */
+    AT_P4 = XBEE_AT_CODE('P', '4'),     /**< DIO4 Configuration */
+    AT_P5 = XBEE_AT_CODE('P', '5'),     /**< DIO5 Configuration */
+    AT_P6 = XBEE_AT_CODE('P', '6'),     /**< DIO6 Configuration */
+    AT_P7 = XBEE_AT_CODE('P', '7'),     /**< DIO7 Configuration */
+    AT_P8 = XBEE_AT_CODE('P', '8'),     /**< DIO8 Configuration */
+    AT_PR = XBEE_AT_CODE('P', 'R'),     /**< Pull-up Resistor Enable */
+    AT_RI = XBEE_AT_CODE('R', 'I'),     /**< Ring Indicator; same value as AT_RI_CELL */
+    AT_CT = XBEE_AT_CODE('C', 'T'),     /**< Command Mode Timeout */
+    AT_GT = XBEE_AT_CODE('G', 'T'),     /**< Guard Times */
+    AT_SB = XBEE_AT_CODE('S', 'B'),     /**< Stop Bits */
+    AT_D6 = XBEE_AT_CODE('D', '6'),     /**< DIO6/RTS Configuration */
+    AT_D7 = XBEE_AT_CODE('D', '7'),     /**< DIO7 Configuration */
+    AT_D8 = XBEE_AT_CODE('D', '8'),     /**< DIO8 Configuration */
+    AT_D9 = XBEE_AT_CODE('D', '9'),     /**< DIO9 Configuration */
+    AT_DA = XBEE_AT_CODE('D', 'A'),     /**< DIO10 Configuration */
+    AT_DB = XBEE_AT_CODE('D', 'B'),     /**< RSSI for Last Hop */
+    AT_DC = XBEE_AT_CODE('D', 'C'),     /**< DIO Change Detect */
+    AT_FT = XBEE_AT_CODE('F', 'T'),     /**< Flow Control Threshold */
+    AT_GU = XBEE_AT_CODE('G', 'U'),     /**< DIO Pull-up Resistor Enable */
+    AT_HS = XBEE_AT_CODE('H', 'S'),     /**< Hardware Sleep Control */
+    AT_IT = XBEE_AT_CODE('I', 'T'),     /**< RSSI Timer */
+    AT_NJ = XBEE_AT_CODE('N', 'J'),     /**< Node Join Time */
+    AT_JN = XBEE_AT_CODE('J', 'N'),     /**< Join Notification */
+    AT_JT = XBEE_AT_CODE('J', 'T'),     /**< Join Time */
+    AT_JV = XBEE_AT_CODE('J', 'V'),     /**< Channel Verification */
+    AT_LD = XBEE_AT_CODE('L', 'D'),     /**< Node Discovery Time */
+    AT_AO = XBEE_AT_CODE('A', 'O'),     /**< API Options */
 
     /**< XBee 3 RF Specific AT Commands */
-    AT_CE,   /**< Coordinator Enable */
-    AT_SE,   /**< Source Endpoint */
-    AT_DE_RF,/**< Destination Endpoint (RF specific) */
-    AT_CI,   /**< Cluster Identifier */
-    AT_BH,   /**< Broadcast Hops */
-    AT_YS,   /**< Sleep Status */
-    AT_WR_RF,/**< Write to non-volatile memory (RF specific) */
+    AT_CE = XBEE_AT_CODE('C', 'E'),     /**< Coordinator Enable */
+    AT_SE = XBEE_AT_CODE('S', 'E'),     /**< Source Endpoint */
+    AT_DE_RF = XBEE_AT_CODE('D', 'E'),  /**< Destination Endpoint (RF specific); same value as AT_DE, the LR Device EUI */
+    AT_CI = XBEE_AT_CODE('C', 'I'),     /**< Cluster Identifier */
+    AT_BH = XBEE_AT_CODE('B', 'H'),     /**< Broadcast Hops */
+    AT_YS = XBEE_AT_CODE('Y', 'S'),     /**< Sleep Status */
+    AT_WR_RF = XBEE_AT_CODE('W', 'R'),  /**< Write to non-volatile memory (RF specific); same value as AT_WR */
 
     /**< XBee 3 Cellular Specific AT Commands */
-    AT_IP,   /**< IP Address */
-    AT_MA,   /**< MAC Address */
-    AT_OK,   /**< Cellular OK Command */
-    AT_RI_CELL, /**< Ring Indicator (Cellular Specific) */
-    AT_SR,   /**< Serial Number */
-    AT_TD,   /**< Transmit Delay */
-    AT_TR,   /**< Transmission Retry Count */
-    AT_TS,   /**< Transmission Status */
-    AT_UK,   /**< Unlock Password */
-    AT_VE,   /**< Voltage Supply */
-    AT_VL,   /**< Cellular Module Version */
+    AT_IP = XBEE_AT_CODE('I', 'P'),     /**< IP Address */
+    AT_MA = XBEE_AT_CODE('M', 'A'),     /**< MAC Address */
+    AT_OK = XBEE_AT_CODE('O', 'K'),     /**< Cellular OK Command */
+    AT_RI_CELL = XBEE_AT_CODE('R', 'I'), /**< Ring Indicator (Cellular Specific); same value as AT_RI */
+    AT_SR = XBEE_AT_CODE('S', 'R'),     /**< Serial Number */
+    AT_TD = XBEE_AT_CODE('T', 'D'),     /**< Transmit Delay */
+    AT_TR = XBEE_AT_CODE('T', 'R'),     /**< Transmission Retry Count */
+    AT_TS = XBEE_AT_CODE('T', 'S'),     /**< Transmission Status */
+    AT_UK = XBEE_AT_CODE('U', 'K'),     /**< Unlock Password */
+    AT_VE = XBEE_AT_CODE('V', 'E'),     /**< Voltage Supply */
+    AT_VL = XBEE_AT_CODE('V', 'L'),     /**< Cellular Module Version */
 
     /**< XBee LR Specific AT Commands */
-    AT_DE,   /**< LoRaWAN Device EUI */
-    AT_AK,   /**< LoRaWAN Application Key */
-    AT_AE,   /**< LoRaWAN Application EUI */
-    AT_NK,   /**< LoRaWAN Network Key */
-    AT_JS,   /**< LoRaWAN Join Status */
-    AT_LC,   /**< LoRaWAN Class */
-    AT_AM,   /**< LoRaWAN Activation Mode */
-    AT_AD,   /**< LoRaWAN ADR */
-    AT_DR,   /**< LoRaWAN DataRate */
-    AT_LR,   /**< LoRaWAN Region */
+    AT_DE = XBEE_AT_CODE('D', 'E'),     /**< LoRaWAN Device EUI; same value as AT_DE_RF, the RF Destination Endpoint */
+    AT_AK = XBEE_AT_CODE('A', 'K'),     /**< LoRaWAN Application Key */
+    AT_AE = XBEE_AT_CODE('A', 'E'),     /**< LoRaWAN Application EUI */
+    AT_NK = XBEE_AT_CODE('N', 'K'),     /**< LoRaWAN Network Key */
+    AT_JS = XBEE_AT_CODE('J', 'S'),     /**< LoRaWAN Join Status */
+    AT_LC = XBEE_AT_CODE('L', 'C'),     /**< LoRaWAN Class */
+    AT_AM = XBEE_AT_CODE('A', 'M'),     /**< LoRaWAN Activation Mode */
+    AT_AD = XBEE_AT_CODE('A', 'D'),     /**< LoRaWAN ADR */
+    AT_DR = XBEE_AT_CODE('D', 'R'),     /**< LoRaWAN DataRate */
+    AT_LR = XBEE_AT_CODE('L', 'R'),     /**< LoRaWAN Region */
     //AT_DC,   /**< LoRaWAN Duty Cycle */
-    AT_LV,   /**< LoRaWAN Spec Version */
-    AT_J1,   /**< LoRaWAN Join RX1 Delay */
-    AT_J2,   /**< LoRaWAN Join RX2 Delay */
-    AT_D1,   /**< LoRaWAN RX1 Delay */
-    AT_D2,   /**< LoRaWAN RX2 Delay */
-    AT_XD,   /**< LoRaWAN RX2 Data Rate */ 
-    AT_XF,   /**< LoRaWAN RX2 Frequency */ 
-    AT_PO,   /**< LoRaWAN Transmit Power */ 
-    AT_CM,   /**< LoRaWAN Channels Mask */
+    AT_LV = XBEE_AT_CODE('L', 'V'),     /**< LoRaWAN Spec Version */
+    AT_J1 = XBEE_AT_CODE('J', '1'),     /**< LoRaWAN Join RX1 Delay */
+    AT_J2 = XBEE_AT_CODE('J', '2'),     /**< LoRaWAN Join RX2 Delay */
+    AT_D1 = XBEE_AT_CODE('D', '1'),     /**< LoRaWAN RX1 Delay */
+    AT_D2 = XBEE_AT_CODE('D', '2'),     /**< LoRaWAN RX2 Delay */
+    AT_XD = XBEE_AT_CODE('X', 'D'),     /**< LoRaWAN RX2 Data Rate */
+    AT_XF = XBEE_AT_CODE('X', 'F'),     /**< LoRaWAN RX2 Frequency */
+    AT_PO = XBEE_AT_CODE('P', 'O'),     /**< LoRaWAN Transmit Power */
+    AT_CM = XBEE_AT_CODE('C', 'M'),     /**< LoRaWAN Channels Mask */
 
     // ... (other existing AT commands) ...
 
 } at_command_t;
 
 
+/**
+ * @brief Checks that an AT command value holds two valid command characters.
+ *
+ * @param command The AT command enum to check.
+ * @return bool True if both characters are upper case letters or digits.
+ */
+bool atCommandIsValid(at_command_t command);
+
+// Size of the buffer atCommandToStringBuffer() writes: two command characters and the terminator
+#define XBEE_AT_STRING_SIZE 3
+
 /**
  * @brief Converts an AT command enum to its corresponding string representation.
  *
- * This function takes an AT command enum and returns the corresponding string representation
- * that can be sent to the XBee module.
+ * This function unpacks the two command characters of an AT command enum into a 
+ * static buffer, which the next call overwrites. It is meant for debug output; frames 
+ * are built from `XBEE_AT_CHAR_HIGH()`/`XBEE_AT_CHAR_LOW()` instead. Aliases with the 
+ * same value, such as `AT_DE` and `AT_DE_RF`, give the same string.
  *
- * @param command The AT command enum to convert.
- * @return const char* The string representation of the AT command.
+ * @param[in] command The AT command enum to convert.
+ * @return const char* The command characters, or NULL if the command is invalid.
  */
 const char* atCommandToString(at_command_t command);
 
+/**
+ * @brief Reentrant variant of `atCommandToString()`, writing into the caller's buffer.
+ *
+ * @param[in] command The AT command enum to convert.
+ * @param[out] buffer Buffer of at least `XBEE_AT_STRING_SIZE` bytes that receives the string.
+ * @return const char* `buffer`, or NULL if the command is invalid.
+ */
+const char* atCommandToStringBuffer(at_command_t command, char *buffer);
+
 #if defined(__cplusplus)
 }
 #endif
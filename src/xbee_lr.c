@@ -34,11 +34,15 @@
 
 #include "xbee_lr.h"
 #include "xbee_api_frames.h"
+#include "xbee_lr_airtime.h"
+#include "xbee_lr_frag.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
 static void SendJoinReqApiFrame(XBee* self);
+static void XBeeLRJoinStep(XBee* self);
+static void XBeeLRJoinAttemptFailed(XBee* self);
 
 // XBeeLR specific implementations
 
@@ -46,33 +50,38 @@ static void SendJoinReqApiFrame(XBee* self);
 /**
  * @brief Checks if the XBee LR module is connected to the LoRaWAN network.
  * 
- * This function sends an AT command (`AT_JS`) to the XBee LR module to query the 
- * Join Status, determining whether the module is currently connected to the LoRaWAN network. 
- * It returns true if the module is connected (i.e., has joined the network) and false otherwise. 
- * The function also handles the communication with the module and provides debug output in case 
- * of communication errors.
+ * The join state is tracked from modem status frames, so this function is answered from 
+ * cached state without any UART traffic. Only the first call after initialization (or after 
+ * a module reset) sends an AT command (`AT_JS`) to learn whether the module was already 
+ * joined. It returns true if the module is connected (i.e., has joined the network) and 
+ * false otherwise.
  * 
  * @param[in] self Pointer to the XBee instance.
  * 
  * @return bool Returns true if the XBee LR module is connected to the network, otherwise false.
  */
 bool XBeeLRConnected(XBee* self) {
-    // Implement logic to check XBeeLR network connection
-    uint8_t response = 0;
-    uint8_t responseLength;
-    int status;
+    XBeeLR *lr = (XBeeLR *)self;
 
-    // Send the AT_JS command to query the Join Status
-    status = apiSendAtCommandAndGetResponse(self, AT_JS, NULL, 0, &response, &responseLength, 5000);
+    // Join changes are tracked from modem status frames, only ask the module once
+    if (!lr->joinStateKnown) {
+        uint8_t response = 0;
+        uint8_t responseLength;
+        int status;
 
-    if (status == API_SEND_SUCCESS) {
-        // Print the received reponse
-        // XBEEDebugPrint("ATJS Resp: %u \n", response);
-        // XBEEDebugPrint("Join Status: %s \n", response ? "Joined" : "Not Joined");
-    } else {
-        XBEEDebugPrint("Failed to receive AT_JS response, error code: %d\n", status);
+        // Send the AT_JS command to query the Join Status
+        status = apiSendAtCommandAndGetResponse(self, AT_JS, NULL, 0, &response, &responseLength, 5000);
+
+        if (status == API_SEND_SUCCESS) {
+            if ((lr->joinState == XBEE_LR_JOIN_IDLE) || response) {
+                lr->joinState = response ? XBEE_LR_JOIN_JOINED : XBEE_LR_JOIN_IDLE;
+            }
+            lr->joinStateKnown = true;
+        } else {
+            XBEEDebugPrint("Failed to receive AT_JS response, error code: %d\n", status);
+        }
     }
-    return response;  
+    return lr->joinState == XBEE_LR_JOIN_JOINED;
 }
 
 /**
@@ -91,7 +100,11 @@ bool XBeeLRConnected(XBee* self) {
  */
 bool XBeeLRInit(XBee* self, uint32_t baudRate, void* device) {
     // Implement XBeeLR initialization
-    return (self->htable->PortUartInit(baudRate, device)) == UART_SUCCESS ? true:false;
+    XBeeLR *lr = (XBeeLR *)self;
+    lr->joinState = XBEE_LR_JOIN_IDLE;
+    lr->joinStateKnown = false;
+    lr->joinAttempt = 0;
+    return (self->htable->PortUartInit(self->portContext, baudRate, device)) == UART_SUCCESS ? true:false;
 }
 
 /**
@@ -99,8 +112,9 @@ bool XBeeLRInit(XBee* self, uint32_t baudRate, void* device) {
  * 
  * This function must be called continuously in the main loop of the application. 
  * It handles the reception and processing of API frames from the XBee LR module.
- * The function checks for incoming frames, and if a frame is successfully received,
- * it is processed accordingly. 
+ * The function consumes whatever bytes the UART has buffered and dispatches each 
+ * frame as soon as it is complete. It never waits for data, so it returns 
+ * immediately when nothing has arrived.
  * 
  * @param[in] self Pointer to the XBee instance.
  * 
@@ -109,46 +123,193 @@ bool XBeeLRInit(XBee* self, uint32_t baudRate, void* device) {
 void XBeeLRProcess(XBee* self) {
     // Implement XBeeLR specific process logic
     xbee_api_frame_t frame;
-    int status = apiReceiveApiFrame(self,&frame);
-    if (status == API_SEND_SUCCESS) {
-        apiHandleFrame(self,frame);
-    } else if (status != API_RECEIVE_ERROR_TIMEOUT_START_DELIMITER) {
-        XBEEDebugPrint("Error receiving frame.\n");
+    int status;
+    while ((status = apiReceiveApiFrame(self, &frame)) != API_RECEIVE_PENDING) {
+        if (status == API_RECEIVE_SUCCESS) {
+            apiHandleFrame(self, &frame);
+        } else if (status == API_RECEIVE_ERROR_UART_FAILURE) {
+            XBEEDebugPrint("Error receiving frame.\n");
+            break;
+        } else if (status != API_RECEIVE_ERROR_INVALID_START_DELIMITER) {
+            XBEEDebugPrint("Error receiving frame.\n");
+        }
+    }
+
+    // Report transmissions and AT commands whose response never arrived
+    XBeeTxTableExpire(self);
+    apiAtRequestExpire(self);
+
+    // Advance the join state machine
+    XBeeLRJoinStep(self);
+}
+
+
+// Sends a join request and starts waiting for the joined modem status
+static void XBeeLRJoinAttempt(XBee* self) {
+    XBeeLR *lr = (XBeeLR *)self;
+    lr->joinAttempt++;
+    lr->joinState = XBEE_LR_JOIN_JOINING;
+    lr->joinDeadline = self->htable->PortMillis(self->portContext) + lr->joinPolicy.attemptTimeoutMs;
+    XBEEDebugPrint("Join attempt %u\n", lr->joinAttempt);
+    SendJoinReqApiFrame(self);
+}
+
+/**
+ * @brief Advances the join state machine, called from `XBeeLRProcess()`.
+ * 
+ * Handles attempt timeouts and backoff expiry. Joins themselves are detected from 
+ * modem status frames in `XBeeLRHandleModemStatus()`.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return void This function does not return a value.
+ */
+static void XBeeLRJoinStep(XBee* self) {
+    XBeeLR *lr = (XBeeLR *)self;
+    if ((lr->joinState != XBEE_LR_JOIN_JOINING) && (lr->joinState != XBEE_LR_JOIN_BACKOFF)) {
+        return;
+    }
+    if ((int32_t)(self->htable->PortMillis(self->portContext) - lr->joinDeadline) < 0) {
+        return;
+    }
+
+    if (lr->joinState == XBEE_LR_JOIN_BACKOFF) {
+        XBeeLRJoinAttempt(self);
+        return;
+    }
+
+    XBEEDebugPrint("Join attempt %u timed out\n", lr->joinAttempt);
+    XBeeLRJoinAttemptFailed(self);
+}
+
+/**
+ * @brief Ends a failed join attempt, by timeout or by modem status.
+ * 
+ * Starts the backoff before the next attempt, or fails the join and invokes 
+ * `OnDisconnectCallback` once the policy's attempts are used up.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return void This function does not return a value.
+ */
+static void XBeeLRJoinAttemptFailed(XBee* self) {
+    XBeeLR *lr = (XBeeLR *)self;
+    if ((lr->joinPolicy.attempts != 0) && (lr->joinAttempt >= lr->joinPolicy.attempts)) {
+        XBEEDebugPrint("Failed to Join\n");
+        lr->joinState = XBEE_LR_JOIN_FAILED;
+        lr->joinStateKnown = true;
+        if (self->ctable->OnDisconnectCallback) {
+            self->ctable->OnDisconnectCallback(self);
+        }
+        return;
     }
+
+    uint32_t backoff = lr->joinPolicy.backoffMs;
+    for (uint8_t i = 1; (i < lr->joinAttempt) && (backoff < lr->joinPolicy.maxBackoffMs); i++) {
+        backoff *= 2;
+    }
+    if (backoff > lr->joinPolicy.maxBackoffMs) {
+        backoff = lr->joinPolicy.maxBackoffMs;
+    }
+    lr->joinState = XBEE_LR_JOIN_BACKOFF;
+    lr->joinDeadline = self->htable->PortMillis(self->portContext) + backoff;
+}
+
+/**
+ * @brief Returns the time until the join state machine has to act, the `nextDeadline` of the vtable.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] now Current PortMillis() time.
+ * 
+ * @return uint32_t Milliseconds until the current attempt or backoff ends, 0 if it has ended, 
+ * or `XBEE_WAIT_FOREVER` if no join is in progress.
+ */
+static uint32_t XBeeLRNextDeadline(XBee* self, uint32_t now) {
+    XBeeLR *lr = (XBeeLR *)self;
+    if ((lr->joinState != XBEE_LR_JOIN_JOINING) && (lr->joinState != XBEE_LR_JOIN_BACKOFF)) {
+        return XBEE_WAIT_FOREVER;
+    }
+    int32_t remaining = (int32_t)(lr->joinDeadline - now);
+    return (remaining > 0) ? (uint32_t)remaining : 0;
+}
+
+/**
+ * @brief Starts joining the LoRaWAN network without waiting for the result.
+ * 
+ * This function sends a join request and returns immediately. The join is then driven 
+ * from `XBeeProcess()`: the joined modem status completes it and invokes `OnConnectCallback`, 
+ * failed attempts are retried according to the join policy (see `XBeeLRSetJoinPolicy()`), and 
+ * `OnDisconnectCallback` is invoked once every attempt has failed. Progress can also be 
+ * polled with `XBeeLRGetJoinState()`.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return bool Returns true if a join was started or one is already in progress.
+ */
+bool XBeeLRConnectAsync(XBee* self) {
+    XBeeLR *lr = (XBeeLR *)self;
+    if ((lr->joinState == XBEE_LR_JOIN_JOINING) || (lr->joinState == XBEE_LR_JOIN_BACKOFF)) {
+        return true;
+    }
+    lr->joinAttempt = 0;
+    XBeeLRJoinAttempt(self);
+    return true;
+}
+
+/**
+ * @brief Sets the retry policy used when joining the LoRaWAN network.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] policy Pointer to the policy to copy.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeLRSetJoinPolicy(XBee* self, const XBeeLRJoinPolicy* policy) {
+    ((XBeeLR *)self)->joinPolicy = *policy;
 }
 
+/**
+ * @brief Returns the current state of the join state machine.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return xbee_lr_join_state_t The current join state.
+ */
+xbee_lr_join_state_t XBeeLRGetJoinState(XBee* self) {
+    return ((XBeeLR *)self)->joinState;
+}
 
 /**
  * @brief Attempts to connect to the LoRaWAN network using the XBee LR module.
  * 
  * This function initiates the connection process to a LoRaWAN network by sending 
- * a join request. The function is currently blocking, meaning it waits until 
- * the connection attempt is completed before returning. A future enhancement (@todo) 
- * could add support for non-blocking operation.
+ * a join request. The function is blocking: it is a wrapper around `XBeeLRConnectAsync()` 
+ * that keeps processing received frames until the join succeeded or the join policy 
+ * gave up. Use `XBeeLRConnectAsync()` to join without blocking.
  * 
  * @param[in] self Pointer to the XBee instance.
  * 
- * @return bool Returns true if the connection process was initiated
+ * @return bool Returns true if the module joined the network
  * 
  */
 bool XBeeLRConnect(XBee* self) {
     // Implement XBeeLR specific connection logic 
-    SendJoinReqApiFrame(self);
-
-    // Start the timeout timer
-    uint32_t startTime = portMillis();
+    XBeeLR *lr = (XBeeLR *)self;
+    XBeeLRConnectAsync(self);
 
-    while ((portMillis() - startTime) < CONNECTION_TIMEOUT_MS) {
-        if (XBeeLRConnected(self)) {
-            XBEEDebugPrint("Successfully Joined\n");
-            return true; // Successfully joined
+    while ((lr->joinState == XBEE_LR_JOIN_JOINING) || (lr->joinState == XBEE_LR_JOIN_BACKOFF)) {
+        XBeeLRProcess(self);
+        if ((lr->joinState == XBEE_LR_JOIN_JOINING) || (lr->joinState == XBEE_LR_JOIN_BACKOFF)) {
+            // Sleep until the modem status arrives or the attempt or backoff ends
+            XBeeWait(self, XBEE_WAIT_FOREVER);
         }
-
-        portDelay(500); // Delay between checks 
     }
 
-    XBEEDebugPrint("Failed to Join\n");
-    return false; // Timeout reached without successful join
+    if (lr->joinState == XBEE_LR_JOIN_JOINED) {
+        XBEEDebugPrint("Successfully Joined\n");
+        return true; // Successfully joined
+    }
+    return false; // No attempt succeeded
 }
 
 /**
@@ -163,72 +324,132 @@ bool XBeeLRConnect(XBee* self) {
  * @return bool Returns true if the disconnection process was initiated.
  */
 bool XBeeLRDisconnect(XBee* self) {
+    (void)self;
     // Implement XBeeLR specific disconnection logic
     return true;
 }
 
+/**
+ * @brief Queues data for transmission over the network without waiting for the result.
+ * 
+ * This function sends a LoRaWAN TX request frame and returns as soon as the frame has 
+ * been written to the UART. The request is recorded in the TX table under its frame ID; 
+ * when the matching TX status frame is received by `XBeeProcess()`, `callback` is invoked 
+ * with the delivery status and the parsed `XBeeLRPacket_t` (DR, channel, power and counter 
+ * for explicit status frames). If no status arrives within `SEND_DATA_TIMEOUT_MS` the 
+ * callback is invoked with `XBEE_TX_STATUS_TIMEOUT`. Up to `XBEE_TX_TABLE_SIZE` requests 
+ * can be outstanding at the same time.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in,out] packet Packet to send. `packet->frameId` is set to the frame ID used.
+ * @param[in] callback Completion callback, may be NULL.
+ * @param[in] ctx User pointer passed to the callback.
+ * 
+ * @return uint8_t The frame ID of the request, or 0 if it could not be sent, the payload 
+ * does not fit an API frame or it exceeds `XBeeLRGetMaxPayload()` at the current DR.
+ */
+uint8_t XBeeLRSendDataAsync(XBee* self, XBeeLRPacket_t* packet, XBeeTxCompleteCallback callback, void* ctx) {
+    uint8_t header[3];
+
+    // Frame type, header and payload must fit one API frame
+    if ((uint32_t)packet->payloadSize + sizeof(header) + 1 > XBEE_MAX_FRAME_DATA_SIZE) {
+        XBEEDebugPrint("Payload of %u bytes does not fit an API frame\n", packet->payloadSize);
+        return 0;
+    }
+    // The module rejects payloads above the DR limit; use xbee_lr_frag.h for larger data
+    uint8_t maxPayload = XBeeLRGetMaxPayload(self);
+    if ((maxPayload != 0) && (packet->payloadSize > maxPayload)) {
+        XBEEDebugPrint("Payload of %u bytes exceeds the %u bytes allowed at the current DR\n", packet->payloadSize, maxPayload);
+        return 0;
+    }
+
+    uint8_t frameId = XBeeTxTableAdd(self, SEND_DATA_TIMEOUT_MS, callback, ctx);
+    if (frameId == 0) {
+        return 0;  // Too many transmissions outstanding
+    }
+
+    // Prepare the API frame, the payload is streamed from the caller's buffer
+    packet->frameId = frameId;
+    header[0] = frameId;
+    header[1] = packet->port;
+    header[2] = packet->ack & 0x01;
+    xbee_iovec_t iov[2] = {
+        {header, sizeof(header)},
+        {packet->payload, packet->payloadSize},
+    };
+
+    // Send the frame
+    int send_status = apiSendFrameV(self, XBEE_API_TYPE_LR_TX_REQUEST, iov, 2);
+    if (send_status != API_SEND_SUCCESS) {
+        XBeeTxTableCancel(self, frameId);
+        return 0;  // Failed to send the frame
+    }
+    return frameId;
+}
+
+// Completion state of a blocking XBeeLRSendData() call
+typedef struct {
+    bool done;
+    uint8_t status;
+} XBeeLRSendWait;
+
+static void XBeeLRSendDataComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+    (void)self;
+    (void)frameId;
+    (void)report;
+    XBeeLRSendWait *wait = (XBeeLRSendWait *)ctx;
+    wait->status = status;
+    wait->done = true;
+}
+
 /**
  * @brief Sends data over the network using the XBee LR module.
  * 
  * This function constructs and sends a data packet over the network using an XBee LR module.
- * The function is currently blocking, meaning it waits until the data is fully transmitted
- * before returning. A future enhancement (@todo) could add support for non-blocking operation.
+ * The function is blocking, meaning it waits until the TX status of the packet has been 
+ * received before returning. It is a wrapper around `XBeeLRSendDataAsync()` and keeps 
+ * processing received frames (including the status of other outstanding requests) while 
+ * it waits.
  * 
  * @param[in] self Pointer to the XBee instance.
  * @param[in] data Pointer to the data to be sent, encapsulated in an XBeeLRPacket_t structure.
  * 
- * @return xbee_deliveryStatus_t, 0 if successful
+ * @return xbee_deliveryStatus_t, 0 if successful, 0xFF if the frame could not be sent or timed out
  * 
  */
 uint8_t XBeeLRSendData(XBee* self, const void* data) {
-    // Prepare and send the API frame
     XBeeLRPacket_t *packet = (XBeeLRPacket_t*) data;
-    uint8_t frame_data[128];  // Adjust size as needed
-    packet->frameId = self->frameIdCntr;
-    frame_data[0] = self->frameIdCntr;
-    frame_data[1] = packet->port;
-    frame_data[2] = packet->ack & 0x01;
-    memcpy(&frame_data[3], packet->payload, packet->payloadSize);
+    XBeeLRSendWait wait = {false, XBEE_TX_STATUS_TIMEOUT};
 
-    // Send the frame
-    int send_status = apiSendFrame(self, XBEE_API_TYPE_LR_TX_REQUEST, frame_data, 3 + packet->payloadSize);
-    if (send_status != API_SEND_SUCCESS) {
-        return 0;  // Failed to send the frame
+    if (XBeeLRSendDataAsync(self, packet, XBeeLRSendDataComplete, &wait) == 0) {
+        return XBEE_TX_STATUS_TIMEOUT;  // Failed to send the frame
     }
 
-    // Block and wait for the XBEE_API_TYPE_TX_STATUS frame
-    uint32_t startTime = portMillis();  // Get the current time in milliseconds
-
-    self->txStatusReceived = false;  // Reset the status flag before waiting
-
-    while ((portMillis() - startTime) < SEND_DATA_TIMEOUT_MS) {
-        // Process incoming frames using XBeeLRProcess
+    // Block until the TX status frame arrives, XBeeLRProcess() reports the timeout
+    while (!wait.done) {
         XBeeLRProcess(self);
-
-        // Check if the status frame was received
-        if (self->txStatusReceived) {
-            // Return the delivery status
-            if(self->deliveryStatus){
-                XBEEDebugPrint("TX Delivery Status 0x%02X\n", self->deliveryStatus );
-            }
-            return self->deliveryStatus;
+        if (!wait.done) {
+            // XBeeLRProcess() has drained the UART, wait for the TX status or its deadline
+            XBeeWait(self, XBEE_WAIT_FOREVER);
         }
-
-        // Add a small delay here to avoid busy-waiting
-        portDelay(10);  // Delay for 10 ms
     }
 
-    // Timeout reached without receiving the expected frame
-    XBEEDebugPrint("Failed to receive TX Request Status frame\n");
-    return 0xFF;  // Indicate failure or timeout
+    if (wait.status == XBEE_TX_STATUS_TIMEOUT) {
+        XBEEDebugPrint("Failed to receive TX Request Status frame\n");
+    } else if (wait.status) {
+        XBEEDebugPrint("TX Delivery Status 0x%02X\n", wait.status);
+    }
+    return wait.status;
 }
 
 bool XBeeLRSoftReset(XBee* self) {
+    (void)self;
     // Implement XBeeLR specific soft reset logic
     return true;
 }
 
 void XBeeLRHardReset(XBee* self) {
+    (void)self;
     // Implement XBeeLR specific hard reset logic
 }
 
@@ -248,11 +469,9 @@ void XBeeLRHardReset(XBee* self) {
  * @return bool Returns true if the AppEUI was successfully set, otherwise false.
  */
 bool XBeeLRSetAppEUI(XBee* self, const char* value) {
-    uint8_t response[17];
-    uint8_t responseLength;
     uint8_t paramLength = (value != NULL) ? strlen(value) : 0;
-    int status = apiSendAtCommandAndGetResponse(self, AT_AE, value, paramLength, response, &responseLength, 5000);
-    if(status != API_SEND_SUCCESS){
+
+    if (!XBeeSetParameter(self, AT_AE, (const uint8_t*)value, paramLength)) {
         XBEEDebugPrint("Failed to set App EUI\n");
         return false;
     }
@@ -273,11 +492,9 @@ bool XBeeLRSetAppEUI(XBee* self, const char* value) {
  * @return bool Returns true if the AppKey was successfully set, otherwise false.
  */
 bool XBeeLRSetAppKey(XBee* self, const char* value) {
-    uint8_t response[33];
-    uint8_t responseLength;
     uint8_t paramLength = (value != NULL) ? strlen(value) : 0;
-    int status = apiSendAtCommandAndGetResponse(self, AT_AK, value, paramLength, response, &responseLength, 5000);
-    if(status != API_SEND_SUCCESS){
+
+    if (!XBeeSetParameter(self, AT_AK, (const uint8_t*)value, paramLength)) {
         XBEEDebugPrint("Failed to set App Key\n");
         return false;
     }
@@ -299,11 +516,9 @@ bool XBeeLRSetAppKey(XBee* self, const char* value) {
  * @return bool Returns true if the NwkKey was successfully set, otherwise false.
  */
 bool XBeeLRSetNwkKey(XBee* self, const char* value) {
-    uint8_t response[33];
-    uint8_t responseLength;
     uint8_t paramLength = (value != NULL) ? strlen(value) : 0;
-    int status = apiSendAtCommandAndGetResponse(self, AT_NK, value, paramLength, response, &responseLength, 5000);
-    if(status != API_SEND_SUCCESS){
+
+    if (!XBeeSetParameter(self, AT_NK, (const uint8_t*)value, paramLength)) {
         XBEEDebugPrint("Failed to set Nwk Key\n");
         return false;
     }
@@ -325,10 +540,7 @@ bool XBeeLRSetNwkKey(XBee* self, const char* value) {
  * @return bool Returns true if the Class was successfully set, otherwise false.
  */
 bool XBeeLRSetClass(XBee* self, const char value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-    int status = apiSendAtCommandAndGetResponse(self, AT_LC, (const uint8_t *) &value, 1, response, &responseLength, 5000);
-    if(status != API_SEND_SUCCESS){
+    if (!XBeeSetParameter(self, AT_LC, (const uint8_t*)&value, 1)) {
         XBEEDebugPrint("Failed to set Class\n");
         return false;
     }
@@ -344,12 +556,7 @@ bool XBeeLRSetClass(XBee* self, const char value) {
  * @return bool Returns true if the Activation Mode was successfully set, otherwise false.
  */
 bool XBeeLRSetActivationMode(XBee* self, const uint8_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_AM, &value, 1, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameter(self, AT_AM, &value, 1)) {
         XBEEDebugPrint("Failed to set Activation Mode\n");
         return false;
     }
@@ -366,12 +573,7 @@ bool XBeeLRSetActivationMode(XBee* self, const uint8_t value) {
  * @return bool Returns true if the ADR was successfully set, otherwise false.
  */
 bool XBeeLRSetADR(XBee* self, const uint8_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_AD, &value, 1, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameter(self, AT_AD, &value, 1)) {
         XBEEDebugPrint("Failed to set ADR\n");
         return false;
     }
@@ -382,21 +584,24 @@ bool XBeeLRSetADR(XBee* self, const uint8_t value) {
 /**
  * @brief Sends the AT_DR command to set the LoRaWAN DataRate on the XBee LR module.
  * 
+ * Inside a configuration batch the value used for airtime and payload limits only 
+ * changes once `XBeeConfigCommit()` has applied it.
+ * 
  * @param[in] self Pointer to the XBee instance.
  * @param[in] value The DataRate to be set.
  * 
  * @return bool Returns true if the DataRate was successfully set, otherwise false.
  */
 bool XBeeLRSetDataRate(XBee* self, const uint8_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_DR, &value, 1, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameter(self, AT_DR, &value, 1)) {
         XBEEDebugPrint("Failed to set DataRate\n");
         return false;
     }
+    if (self->configBatch != NULL) {
+        ((XBeeLR*)self)->batchDataRate = value;  // Only queued, see XBeeLRConfigCommitted()
+    } else {
+        ((XBeeLR*)self)->dataRate = value;  // Used by the airtime calculator
+    }
 
     return true;
 }
@@ -404,21 +609,24 @@ bool XBeeLRSetDataRate(XBee* self, const uint8_t value) {
 /**
  * @brief Sends the AT_LR command to set the LoRaWAN Region on the XBee LR module.
  * 
+ * Inside a configuration batch the region used for airtime and payload limits only 
+ * changes once `XBeeConfigCommit()` has applied it.
+ * 
  * @param[in] self Pointer to the XBee instance.
  * @param[in] value The Region to be set.
  * 
  * @return bool Returns true if the Region was successfully set, otherwise false.
  */
 bool XBeeLRSetRegion(XBee* self, const uint8_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_LR, &value, 1, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameter(self, AT_LR, &value, 1)) {
         XBEEDebugPrint("Failed to set Region\n");
         return false;
     }
+    if (self->configBatch != NULL) {
+        ((XBeeLR*)self)->batchRegion = value;  // Only queued, see XBeeLRConfigCommitted()
+    } else {
+        ((XBeeLR*)self)->region = value;  // Used by the airtime calculator
+    }
 
     return true;
 }
@@ -432,12 +640,7 @@ bool XBeeLRSetRegion(XBee* self, const uint8_t value) {
  * @return bool Returns true if the Duty Cycle was successfully set, otherwise false.
  */
 bool XBeeLRSetDutyCycle(XBee* self, const uint8_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_DC, &value, 1, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameter(self, AT_DC, &value, 1)) {
         XBEEDebugPrint("Failed to set Duty Cycle\n");
         return false;
     }
@@ -445,28 +648,31 @@ bool XBeeLRSetDutyCycle(XBee* self, const uint8_t value) {
     return true;
 }
 
-// /**
-//  * @brief Sends the AT_LV command to get the LoRaWAN Spec Version on the XBee LR module.
-//  * 
-//  * @param[in] self Pointer to the XBee instance.
-//  * @param[in] value The Spec Version to be set.
-//  * 
-//  * @return bool Returns true if the Spec Version was successfully set, otherwise false.
-//  */
-// bool XBeeLRGetSpecVersion(XBee* self, const char value) {
-//     uint8_t response[33];
-//     uint8_t responseLength;
-//     uint8_t paramLength = 1;
-
-//     int status = apiSendAtCommandAndGetResponse(self, AT_LV, &value, paramLength, response, &responseLength, 5000);
+/**
+ * @brief Sends the AT_LV command to get the LoRaWAN Spec Version on the XBee LR module.
+ * 
+ * The Spec Version cannot change while the module runs, so it is only queried once and 
+ * answered from the shadow cache afterwards.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[out] responseBuffer Buffer that receives the Spec Version as a null-terminated string.
+ * @param[in] buffer_size Size of the response buffer.
+ * 
+ * @return bool Returns true if the Spec Version was successfully retrieved, otherwise false.
+ */
+bool XBeeLRGetSpecVersion(XBee* self, char* responseBuffer, uint8_t buffer_size) {
+    if ((responseBuffer == NULL) || (buffer_size == 0)) {
+        return false;
+    }
+    memset(responseBuffer, 0, buffer_size);
 
-//     if (status != API_SEND_SUCCESS) {
-//         XBEEDebugPrint("Failed to set Spec Version\n");
-//         return false;
-//     }
+    if (!XBeeGetParameter(self, AT_LV, (uint8_t*)responseBuffer, buffer_size - 1, NULL)) {
+        XBEEDebugPrint("Failed to get Spec Version\n");
+        return false;
+    }
 
-//     return true;
-// }
+    return true;
+}
 
 /**
  * @brief Sends the AT_J1 command to set the LoRaWAN Join RX1 Delay on the XBee LR module.
@@ -477,13 +683,7 @@ bool XBeeLRSetDutyCycle(XBee* self, const uint8_t value) {
  * @return bool Returns true if the Join RX1 Delay was successfully set, otherwise false.
  */
 bool XBeeLRSetJoinRX1Delay(XBee* self, const uint32_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-    uint8_t paramLength = sizeof(value);
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_J1, (const uint8_t*)&value, paramLength, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameterUint32(self, AT_J1, value)) {
         XBEEDebugPrint("Failed to set Join RX1 Delay\n");
         return false;
     }
@@ -500,13 +700,7 @@ bool XBeeLRSetJoinRX1Delay(XBee* self, const uint32_t value) {
  * @return bool Returns true if the Join RX2 Delay was successfully set, otherwise false.
  */
 bool XBeeLRSetJoinRX2Delay(XBee* self, const uint32_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-    uint8_t paramLength = sizeof(value);
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_J2, (const uint8_t*)&value, paramLength, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameterUint32(self, AT_J2, value)) {
         XBEEDebugPrint("Failed to set Join RX2 Delay\n");
         return false;
     }
@@ -523,13 +717,7 @@ bool XBeeLRSetJoinRX2Delay(XBee* self, const uint32_t value) {
  * @return bool Returns true if the RX1 Delay was successfully set, otherwise false.
  */
 bool XBeeLRSetRX1Delay(XBee* self, const uint32_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-    uint8_t paramLength = sizeof(value);
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_D1, (const uint8_t*)&value, paramLength, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameterUint32(self, AT_D1, value)) {
         XBEEDebugPrint("Failed to set RX1 Delay\n");
         return false;
     }
@@ -546,13 +734,7 @@ bool XBeeLRSetRX1Delay(XBee* self, const uint32_t value) {
  * @return bool Returns true if the RX2 Delay was successfully set, otherwise false.
  */
 bool XBeeLRSetRX2Delay(XBee* self, const uint32_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-    uint8_t paramLength = sizeof(value);
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_D2, (const uint8_t*)&value, paramLength, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameterUint32(self, AT_D2, value)) {
         XBEEDebugPrint("Failed to set RX2 Delay\n");
         return false;
     }
@@ -569,13 +751,9 @@ bool XBeeLRSetRX2Delay(XBee* self, const uint32_t value) {
  * @return bool Returns true if the RX2 Data Rate was successfully set, otherwise false.
  */
 bool XBeeLRSetRX2DataRate(XBee* self, const uint8_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
     uint8_t paramLength = sizeof(value);
 
-    int status = apiSendAtCommandAndGetResponse(self,AT_XD, (const uint8_t*)&value, paramLength, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameter(self, AT_XD, (const uint8_t*)&value, paramLength)) {
         XBEEDebugPrint("Failed to set RX2 Data Rate\n");
         return false;
     }
@@ -592,13 +770,7 @@ bool XBeeLRSetRX2DataRate(XBee* self, const uint8_t value) {
  * @return bool Returns true if the RX2 Frequency was successfully set, otherwise false.
  */
 bool XBeeLRSetRX2Frequency(XBee* self, const uint32_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
-    uint8_t paramLength = sizeof(value);
-
-    int status = apiSendAtCommandAndGetResponse(self, AT_XF, (uint8_t*)&value, paramLength, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameterUint32(self, AT_XF, value)) {
         XBEEDebugPrint("Failed to set RX2 Frequency\n");
         return false;
     }
@@ -615,13 +787,9 @@ bool XBeeLRSetRX2Frequency(XBee* self, const uint32_t value) {
  * @return bool Returns true if the Transmit Power was successfully set, otherwise false.
  */
 bool XBeeLRSetTransmitPower(XBee* self, const uint8_t value) {
-    uint8_t response[33];
-    uint8_t responseLength;
     uint8_t paramLength = sizeof(value);
 
-    int status = apiSendAtCommandAndGetResponse(self, AT_PO, &value, paramLength, response, &responseLength, 5000);
-
-    if (status != API_SEND_SUCCESS) {
+    if (!XBeeSetParameter(self, AT_PO, &value, paramLength)) {
         XBEEDebugPrint("Failed to set Transmit Power\n");
         return false;
     }
@@ -632,10 +800,12 @@ bool XBeeLRSetTransmitPower(XBee* self, const uint8_t value) {
  * @brief Sends the AT_DE command to read the LoRaWAN DevEUI from the XBee LR module.
  * 
  * This function retrieves the LoRaWAN DevEUI (Device Extended Unique Identifier) 
- * from the XBee LR module by sending the AT command `AT_DE`. The function is 
- * blocking, meaning it waits for a response from the module or until a timeout occurs. 
- * If the command fails to send or the module does not respond, a debug message is printed. 
- * The DevEUI is stored in the provided response buffer.
+ * from the XBee LR module by sending the AT command `AT_DE`. The DevEUI is programmed 
+ * at the factory, so only the first call queries the module and blocks until it answers 
+ * or a timeout occurs; later calls are answered from the copy kept in the instance. The 
+ * copy lives here rather than in the parameter shadow because `AT_DE` is the writable 
+ * Destination Endpoint on XBee 3 RF. If the command fails to send or the module does not 
+ * respond, a debug message is printed. The DevEUI is stored in the provided response buffer.
  * 
  * @param[in] self Pointer to the XBee instance.
  * @param[out] responseBuffer Buffer to store the retrieved DevEUI.
@@ -650,14 +820,23 @@ bool XBeeLRGetDevEUI(XBee* self, uint8_t* responseBuffer, uint8_t buffer_size) {
     }
     memset(responseBuffer,0,buffer_size);
 
-    // Send the AT_DE command to query the DevEUI
-    uint8_t responseLength;
-    int status = apiSendAtCommandAndGetResponse(self, AT_DE, NULL, 0, responseBuffer, &responseLength, 5000);
+    XBeeLR* lr = (XBeeLR*)self;
+    if (lr->devEuiLength != 0) {
+        uint8_t length = (lr->devEuiLength < (buffer_size - 1)) ? lr->devEuiLength : (uint8_t)(buffer_size - 1);
+        memcpy(responseBuffer, lr->devEui, length);
+        return true;
+    }
 
-    if (status != API_SEND_SUCCESS) {
-        XBEEDebugPrint("Failed to receive AT_DE response, error code: %d\n", status);
+    // Send the AT_DE command to query the DevEUI
+    uint8_t length = 0;
+    if (!XBeeGetParameter(self, AT_DE, responseBuffer, buffer_size - 1, &length)) {
+        XBEEDebugPrint("Failed to receive AT_DE response\n");
         return false;
     }
+    if ((length != 0) && (length <= (buffer_size - 1)) && (length <= sizeof(lr->devEui))) {
+        memcpy(lr->devEui, responseBuffer, length);
+        lr->devEuiLength = length;
+    }
     return true;  
 }
 
@@ -675,11 +854,9 @@ bool XBeeLRGetDevEUI(XBee* self, uint8_t* responseBuffer, uint8_t buffer_size) {
  * @return bool Returns true if the Channels Mask was successfully set; otherwise, false.
  */
 bool XBeeLRSetChannelsMask(XBee* self, const char* value) {
-    uint8_t response[33];
-    uint8_t responseLength;
     uint8_t paramLength = (value != NULL) ? strlen(value) : 0;
-    int status = apiSendAtCommandAndGetResponse(self, AT_CM, value, paramLength, response, &responseLength, 5000);
-    if(status != API_SEND_SUCCESS){
+
+    if (!XBeeSetParameter(self, AT_CM, (const uint8_t*)value, paramLength)) {
         XBEEDebugPrint("Failed to set Channels Mask\n");
         return false;
     }
@@ -697,12 +874,104 @@ bool XBeeLRSetChannelsMask(XBee* self, const char* value) {
  * @param[in] self Pointer to the XBee instance.
  */
 static void SendJoinReqApiFrame(XBee* self) {
-    uint8_t frame_id = self->frameIdCntr;
+    // Skip frame IDs still waited on, so the join status cannot complete another request
+    uint8_t frame_id = XBeeReserveFrameId(self);
 
     // Call the api_send_frame function to send the Join Request API frame
     apiSendFrame(self, XBEE_API_TYPE_LR_JOIN_REQUEST, &frame_id, 1);
 }
 
+/**
+ * @brief Attaches a queue that received packets are stored in.
+ * 
+ * From then on downlinks are copied into the queue by the RX packet handler and 
+ * `OnReceiveCallback` is no longer called, so packets received while the library waits 
+ * inside a blocking call are kept for the application instead of being delivered from 
+ * within that call. The queue must outlive the instance, or be detached first.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] queue Queue to attach, emptied here, or NULL to call `OnReceiveCallback` again.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeLRAttachRxQueue(XBee* self, XBeeLRRxQueue* queue) {
+    if (queue != NULL) {
+        memset(queue, 0, sizeof(*queue));
+    }
+    ((XBeeLR*)self)->rxQueue = queue;
+}
+
+/**
+ * @brief Takes the oldest packet from the attached RX queue.
+ * 
+ * `packet->payload` points into the queue slot, which stays valid until the next call; 
+ * the slot is freed then, so call again once the packet has been processed.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[out] packet Receives the packet.
+ * 
+ * @return bool Returns true if a packet was returned, false if the queue is empty or none is attached.
+ */
+bool XBeeLRReceive(XBee* self, XBeeLRPacket_t* packet) {
+    XBeeLRRxQueue* queue = ((XBeeLR*)self)->rxQueue;
+    if (queue == NULL) {
+        return false;
+    }
+    if (queue->held) {
+        queue->tail = (uint8_t)((queue->tail + 1) % XBEE_LR_RX_QUEUE_SLOTS);
+        queue->count--;
+        queue->held = false;
+    }
+    if (queue->count == 0) {
+        return false;
+    }
+    XBeeLRRxSlot* slot = &queue->slots[queue->tail];
+    *packet = slot->packet;
+    packet->payload = slot->data;
+    queue->held = true;
+    return true;
+}
+
+/**
+ * @brief Returns the number of packets waiting in the attached RX queue.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint8_t Packets not yet returned by `XBeeLRReceive()`, 0 if no queue is attached.
+ */
+uint8_t XBeeLRRxPending(XBee* self) {
+    XBeeLRRxQueue* queue = ((XBeeLR*)self)->rxQueue;
+    if (queue == NULL) {
+        return 0;
+    }
+    return (uint8_t)(queue->count - (queue->held ? 1 : 0));
+}
+
+/**
+ * @brief Copies a received packet into the next free slot of an RX queue.
+ */
+static void XBeeLRRxQueuePut(XBeeLRRxQueue* queue, const XBeeLRPacket_t* packet) {
+    if (queue->count >= XBEE_LR_RX_QUEUE_SLOTS) {
+        queue->overflows++;
+        XBEEDebugPrint("RX queue full, packet dropped\n");
+        return;
+    }
+    if (packet->payloadSize > XBEE_LR_RX_QUEUE_PAYLOAD_SIZE) {
+        queue->oversized++;
+        XBEEDebugPrint("RX packet of %u bytes does not fit a queue slot\n", packet->payloadSize);
+        return;
+    }
+    XBeeLRRxSlot* slot = &queue->slots[queue->head];
+    slot->packet = *packet;
+    slot->packet.payload = NULL;
+    memcpy(slot->data, packet->payload, packet->payloadSize);
+    queue->head = (uint8_t)((queue->head + 1) % XBEE_LR_RX_QUEUE_SLOTS);
+    queue->count++;
+    if (queue->count > queue->highWater) {
+        queue->highWater = queue->count;
+    }
+}
+
 /**
  * @brief Parses an RX_PACKET frame and invokes the receive callback function.
  * 
@@ -711,7 +980,8 @@ static void SendJoinReqApiFrame(XBee* self) {
  * RSSI, SNR, and payload. If the frame is of type `XBEE_API_TYPE_LR_RX_PACKET` or 
  * `XBEE_API_TYPE_LR_EXPLICIT_RX_PACKET`, the parsed data is stored in an `XBeeLRPacket_t` 
  * structure, and the receive callback function (`OnReceiveCallback`) is called with this 
- * data. The function ensures that the callback is only invoked if the receive data is valid.
+ * data, or the packet is copied into the RX queue if one is attached. The function 
+ * ensures that the callback is only invoked if the receive data is valid.
  * 
  * @param[in] self Pointer to the XBee instance.
  * @param[in] param Pointer to the received API frame data.
@@ -733,6 +1003,10 @@ static void XBeeLRHandleRxPacket(XBee* self, void *param) {
     }
     APIFrameDebugPrint("\n");
 
+    if (frame->length < ((frame->type == XBEE_API_TYPE_LR_EXPLICIT_RX_PACKET) ? 10 : 2)) {
+        return;  // Truncated frame, too short for the fixed fields
+    }
+
     if (frame->type == XBEE_API_TYPE_LR_EXPLICIT_RX_PACKET) {
         packet.port = frame->data[1];
         packet.rssi = frame->data[2];
@@ -748,6 +1022,17 @@ static void XBeeLRHandleRxPacket(XBee* self, void *param) {
         packet.payload = &(frame->data[2]); // Point directly to the payload in the frame data
     }
 
+    // Fragments and acknowledgements on the port of an attached fragmentation layer are consumed by it
+    XBeeLR* lr = (XBeeLR*)self;
+    if ((lr->frag != NULL) && XBeeLRFragHandleRx(lr->frag, &packet)) {
+        return;
+    }
+
+    if (lr->rxQueue != NULL) {
+        XBeeLRRxQueuePut(lr->rxQueue, &packet);
+        return;
+    }
+
     if (self->ctable->OnReceiveCallback) {
         self->ctable->OnReceiveCallback(self, &packet); // Pass the address of the stack variable
     }
@@ -769,22 +1054,44 @@ void XBeeLRHandleTransmitStatus(XBee* self, void *param) {
     }
     APIFrameDebugPrint("\n");
 
+    // Frame ID and status, plus DR, channel, power and counter in the explicit status
+    uint16_t minLength = (frame->type == XBEE_API_TYPE_LR_EXPLICIT_TX_STATUS) ? 10 : 3;
+    if (frame->length < minLength) {
+        XBEEDebugPrint("Transmit status frame too short (%u bytes)\n", frame->length);
+        return;
+    }
+
     packet.frameId = frame->data[1];
     packet.status = frame->data[2];
 
     // Store the delivery status in the XBee instance
     self->deliveryStatus = frame->data[2];  // Extract Delivery Status
 
+    // Learn the join state from the first uplink when no ATJS or modem status told it yet
+    XBeeLR *lr = (XBeeLR *)self;
+    if (!lr->joinStateKnown && (lr->joinState == XBEE_LR_JOIN_IDLE)) {
+        if (packet.status == 0) {
+            lr->joinState = XBEE_LR_JOIN_JOINED;
+            lr->joinStateKnown = true;
+        } else if (packet.status == XBEE_DELIVERY_STATUS_NOT_JOINED) {
+            lr->joinStateKnown = true;
+        }
+    }
+
     if (frame->type == XBEE_API_TYPE_LR_EXPLICIT_TX_STATUS) {
         packet.dr = frame->data[3];
         packet.channel = frame->data[4];
         packet.power = frame->data[5];
         packet.counter = frame->data[6] << 24 | frame->data[7] << 16 | frame->data[8] << 8 | frame->data[9];
+        ((XBeeLR*)self)->dataRate = packet.dr;  // Follows ADR changes
     }
 
     // Set the txStatusReceived flag to indicate the status frame was received
     self->txStatusReceived = true;
 
+    // Complete the outstanding request this status belongs to
+    XBeeTxTableComplete(self, packet.frameId, packet.status, &packet);
+
     if (self->ctable->OnSendCallback) {
         self->ctable->OnSendCallback(self, &packet); // Pass the address of the stack variable
     }
@@ -792,6 +1099,76 @@ void XBeeLRHandleTransmitStatus(XBee* self, void *param) {
 }
 
 
+/**
+ * @brief Tracks the join state from modem status frames.
+ * 
+ * A joined status completes a pending join (or reports an unsolicited rejoin) and invokes 
+ * `OnConnectCallback`. A disassociated status during a join attempt fails that attempt 
+ * right away. A disassociated status or a module reset while joined invokes 
+ * `OnDisconnectCallback`.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] param Pointer to the received modem status frame.
+ * 
+ * @return void This function does not return a value.
+ */
+static void XBeeLRHandleModemStatus(XBee* self, void *param) {
+    if (param == NULL) return;
+
+    xbee_api_frame_t *frame = (xbee_api_frame_t *)param;
+    if ((frame->type != XBEE_API_TYPE_MODEM_STATUS) || (frame->length < 2)) return;
+
+    XBeeLR *lr = (XBeeLR *)self;
+    bool wasJoined = (lr->joinState == XBEE_LR_JOIN_JOINED);
+
+    switch (frame->data[1]) {
+        case XBEE_LR_MODEM_STATUS_JOINED:
+            lr->joinState = XBEE_LR_JOIN_JOINED;
+            lr->joinStateKnown = true;
+            if (!wasJoined && self->ctable->OnConnectCallback) {
+                self->ctable->OnConnectCallback(self);
+            }
+            break;
+        case XBEE_LR_MODEM_STATUS_DISASSOCIATED:
+            if (lr->joinState == XBEE_LR_JOIN_JOINING) {
+                // The attempt got no join accept, back off now instead of at the attempt timeout
+                XBEEDebugPrint("Join attempt %u failed\n", lr->joinAttempt);
+                XBeeLRJoinAttemptFailed(self);
+                break;
+            }
+            // fall through
+        case 0x00: // Hardware reset
+        case 0x01: // Watchdog reset
+            if (wasJoined) {
+                lr->joinState = XBEE_LR_JOIN_IDLE;
+                lr->joinStateKnown = (frame->data[1] == XBEE_LR_MODEM_STATUS_DISASSOCIATED);
+                if (self->ctable->OnDisconnectCallback) {
+                    self->ctable->OnDisconnectCallback(self);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Takes over the region and data rate of a committed configuration batch.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] command Parameter of the batch that is now in effect.
+ * 
+ * @return void This function does not return a value.
+ */
+static void XBeeLRConfigCommitted(XBee* self, at_command_t command) {
+    XBeeLR *lr = (XBeeLR *)self;
+    if (command == AT_DR) {
+        lr->dataRate = lr->batchDataRate;
+    } else if (command == AT_LR) {
+        lr->region = lr->batchRegion;
+    }
+}
+
 // VTable for XBeeLR
 const XBeeVTable XBeeLRVTable = {
     .init = XBeeLRInit,
@@ -804,30 +1181,93 @@ const XBeeVTable XBeeLRVTable = {
     .connected = XBeeLRConnected,
     .handleRxPacketFrame = XBeeLRHandleRxPacket,
     .handleTransmitStatusFrame = XBeeLRHandleTransmitStatus,
+    .handleModemStatusFrame = XBeeLRHandleModemStatus,
+    .nextDeadline = XBeeLRNextDeadline,
+    .configCommitted = XBeeLRConfigCommitted,
 };
 
+// Frame types routed to the vtable handlers above
+static const uint8_t XBeeLRTxStatusTypes[] = { XBEE_API_TYPE_TX_STATUS, XBEE_API_TYPE_LR_EXPLICIT_TX_STATUS };
+static const uint8_t XBeeLRRxPacketTypes[] = { XBEE_API_TYPE_LR_RX_PACKET, XBEE_API_TYPE_LR_EXPLICIT_RX_PACKET };
+
 /**
- * @brief Constructor for creating an XBeeLR instance.
+ * @brief Initializes an XBeeLR instance in caller provided memory.
  * 
- * This function allocates memory for a new XBeeLR instance and initializes it 
- * with the provided callback table (`cTable`) and handler table (`hTable`). 
- * The function sets up the virtual table (`vtable`) for XBee LR-specific operations 
- * and assigns the callback and handler tables to the instance. The newly created 
- * instance is then returned to the caller.
+ * This is the allocation-free constructor: the instance and all of its buffers are 
+ * owned by the caller, typically as static variables, so each application sizes its 
+ * RAM use at compile time (see `XBeeStorage`). Every field is initialized, so the 
+ * instance is safe to use before `XBeeInit()`. Do not pass it to `XBeeLRDestroy()`.
  * 
+ * @param[out] instance Memory for the instance.
+ * @param[in] storage Buffers the instance works with, must outlive the instance.
  * @param[in] cTable Pointer to the callback table containing function pointers for handling XBee events.
  * @param[in] hTable Pointer to the handler table containing platform-specific function implementations.
  * 
- * @return XBeeLR* Pointer to the newly created XBeeLR instance.
+ * @return XBeeLR* Pointer to the initialized instance (`instance`), or NULL if an argument is invalid.
  */
-XBeeLR* XBeeLRCreate(const XBeeCTable* cTable, const XBeeHTable* hTable) {
-    XBeeLR* instance = (XBeeLR*)malloc(sizeof(XBeeLR));
+XBeeLR* XBeeLRInitStatic(XBeeLR* instance, const XBeeStorage* storage, const XBeeCTable* cTable, const XBeeHTable* hTable) {
+    if ((instance == NULL) || (storage == NULL) || (storage->rxBuffer == NULL) || (storage->rxBufferSize == 0) ||
+        ((storage->txTable == NULL) && (storage->txTableSize != 0))) {
+        return NULL;
+    }
+    memset(instance, 0, sizeof(*instance));
+    XBeeInitInstance(&instance->base, storage, cTable, hTable);
     instance->base.vtable = &XBeeLRVTable;
-    instance->base.htable = hTable;
-    instance->base.ctable = cTable;
+    instance->joinState = XBEE_LR_JOIN_IDLE;
+    instance->joinStateKnown = false;
+    instance->joinAttempt = 0;
+    instance->joinPolicy.attempts = XBEE_LR_JOIN_ATTEMPTS;
+    instance->joinPolicy.attemptTimeoutMs = CONNECTION_TIMEOUT_MS;
+    instance->joinPolicy.backoffMs = XBEE_LR_JOIN_BACKOFF_MS;
+    instance->joinPolicy.maxBackoffMs = XBEE_LR_JOIN_MAX_BACKOFF_MS;
+    instance->region = XBEE_LR_DEFAULT_REGION;
+    instance->dataRate = XBEE_LR_DEFAULT_DATA_RATE;
+    apiRegisterDefaultHandlers(&instance->base, XBeeLRTxStatusTypes, sizeof(XBeeLRTxStatusTypes), 
+        XBeeLRRxPacketTypes, sizeof(XBeeLRRxPacketTypes));
+    apiResetRxParser(&instance->base);
     return instance;
 }
 
+// Heap block used by XBeeLRCreate(), the instance comes first so XBeeLRDestroy() can free it
+typedef struct {
+    XBeeLR instance;
+    uint8_t rxBuffer[XBEE_MAX_FRAME_DATA_SIZE];
+    XBeeTxEntry txTable[XBEE_TX_TABLE_SIZE];
+} XBeeLRAllocation;
+
+/**
+ * @brief Constructor for creating an XBeeLR instance.
+ * 
+ * This function allocates memory for a new XBeeLR instance, with buffers sized by 
+ * `XBEE_MAX_FRAME_DATA_SIZE` and `XBEE_TX_TABLE_SIZE`, and initializes it with the 
+ * provided callback table (`cTable`) and handler table (`hTable`) through 
+ * `XBeeLRInitStatic()`. Release it with `XBeeLRDestroy()`.
+ * 
+ * @param[in] cTable Pointer to the callback table containing function pointers for handling XBee events.
+ * @param[in] hTable Pointer to the handler table containing platform-specific function implementations.
+ * 
+ * @return XBeeLR* Pointer to the newly created XBeeLR instance, or NULL if the allocation failed.
+ */
+XBeeLR* XBeeLRCreate(const XBeeCTable* cTable, const XBeeHTable* hTable) {
+    XBeeLRAllocation* allocation = (XBeeLRAllocation*)malloc(sizeof(XBeeLRAllocation));
+    if (allocation == NULL) {
+        XBEEDebugPrint("Failed to allocate XBeeLR instance\n");
+        return NULL;
+    }
+    XBeeStorage storage = {
+        allocation->rxBuffer, sizeof(allocation->rxBuffer),
+        allocation->txTable, XBEE_TX_TABLE_SIZE,
+    };
+    return XBeeLRInitStatic(&allocation->instance, &storage, cTable, hTable);
+}
+
+/**
+ * @brief Destroys an XBeeLR instance created with `XBeeLRCreate()`.
+ * 
+ * @param[in] self Pointer to the instance, may be NULL.
+ * 
+ * @return void This function does not return a value.
+ */
 void XBeeLRDestroy(XBeeLR* self) {
     free(self);
 }
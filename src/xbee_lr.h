@@ -67,14 +67,97 @@ typedef struct XBeeLRPacket_s{
     int8_t power;
 }XBeeLRPacket_t;
 
+// Delivery status the scheduler reports for an uplink that no longer fits the current DR
+#define XBEE_LR_TX_STATUS_PAYLOAD_TOO_LARGE 0xFE
+
+// Modem status values reported by the XBee LR module
+#define XBEE_LR_MODEM_STATUS_JOINED 0x02
+#define XBEE_LR_MODEM_STATUS_DISASSOCIATED 0x03
+
+/**
+ * @enum xbee_lr_join_state_t
+ * @brief States of the non-blocking LoRaWAN join state machine.
+ */
+typedef enum {
+    XBEE_LR_JOIN_IDLE = 0,   ///< Not joined, no join in progress
+    XBEE_LR_JOIN_JOINING,    ///< Join request sent, waiting for the joined modem status
+    XBEE_LR_JOIN_BACKOFF,    ///< Attempt failed, waiting before the next one
+    XBEE_LR_JOIN_JOINED,     ///< Joined to the network
+    XBEE_LR_JOIN_FAILED      ///< All attempts failed
+} xbee_lr_join_state_t;
+
+/**
+ * @brief Retry policy of the LoRaWAN join state machine.
+ *
+ * Each attempt waits `attemptTimeoutMs` for the joined modem status. After a failed 
+ * attempt the next one starts after `backoffMs`, doubling for every further attempt 
+ * up to `maxBackoffMs`. An `attempts` value of 0 retries forever.
+ */
+typedef struct {
+    uint8_t attempts;            ///< Number of join attempts, 0 for no limit
+    uint32_t attemptTimeoutMs;   ///< Time to wait for the joined modem status
+    uint32_t backoffMs;          ///< Delay before the second attempt
+    uint32_t maxBackoffMs;       ///< Upper bound of the retry delay
+} XBeeLRJoinPolicy;
+
+/**
+ * @brief Received packet held in a slot of an `XBeeLRRxQueue`.
+ */
+typedef struct {
+    XBeeLRPacket_t packet;                         ///< Metadata of the packet, payload excluded
+    uint8_t data[XBEE_LR_RX_QUEUE_PAYLOAD_SIZE];   ///< Copy of the payload
+} XBeeLRRxSlot;
+
+/**
+ * @brief Caller-owned queue of received packets, drained with `XBeeLRReceive()`.
+ * 
+ * While a queue is attached, the RX packet handler copies every downlink into the next 
+ * free slot instead of calling `OnReceiveCallback`, so the application processes them 
+ * outside the frame parser. When every slot is in use the new packet is dropped.
+ */
+typedef struct {
+    XBeeLRRxSlot slots[XBEE_LR_RX_QUEUE_SLOTS];
+    uint8_t head;                 ///< Slot the next packet is stored in
+    uint8_t tail;                 ///< Slot of the oldest packet
+    uint8_t count;                ///< Used slots, including a held one
+    bool held;                    ///< The tail slot was returned by XBeeLRReceive() and is freed by the next call
+    uint8_t highWater;            ///< Most slots ever in use at once
+    uint32_t overflows;           ///< Packets dropped because every slot was in use
+    uint32_t oversized;           ///< Packets dropped because the payload did not fit a slot
+} XBeeLRRxQueue;
+
+struct XBeeLRFrag_s;
+
 // Subclass for XBeeLR
 typedef struct {
     XBee base;  // Inherit from XBee
     // Add XBeeLR specific attributes here like methods specific to an XBee type
+    xbee_lr_join_state_t joinState;   ///< Current join state, valid once joinStateKnown is set
+    bool joinStateKnown;              ///< Join state was confirmed by ATJS or a modem status
+    XBeeLRJoinPolicy joinPolicy;      ///< Retry policy used by XBeeLRConnectAsync()
+    uint8_t joinAttempt;              ///< Attempts made in the current join
+    uint32_t joinDeadline;            ///< End of the current attempt or backoff
+    uint8_t region;                   ///< Region last set with XBeeLRSetRegion(), see xbee_lr_region_t
+    uint8_t dataRate;                 ///< Data rate last set, or reported by an explicit TX status
+    uint8_t batchRegion;              ///< Region queued in the open configuration batch, takes effect on commit
+    uint8_t batchDataRate;            ///< Data rate queued in the open configuration batch, takes effect on commit
+    struct XBeeLRFrag_s* frag;        ///< Fragmentation layer taking downlinks on its port, or NULL
+    XBeeLRRxQueue* rxQueue;           ///< Queue received packets are stored in, or NULL to call OnReceiveCallback
+    uint8_t devEui[XBEE_SHADOW_READ_VALUE_SIZE]; ///< DevEUI read by the first XBeeLRGetDevEUI() call
+    uint8_t devEuiLength;             ///< Length of devEui, 0 until it was read
 } XBeeLR;
 
 
 XBeeLR* XBeeLRCreate(const XBeeCTable* cTable, const XBeeHTable* hTable);
+XBeeLR* XBeeLRInitStatic(XBeeLR* instance, const XBeeStorage* storage, const XBeeCTable* cTable, const XBeeHTable* hTable);
+void XBeeLRDestroy(XBeeLR* self);
+bool XBeeLRConnectAsync(XBee* self);
+void XBeeLRSetJoinPolicy(XBee* self, const XBeeLRJoinPolicy* policy);
+xbee_lr_join_state_t XBeeLRGetJoinState(XBee* self);
+uint8_t XBeeLRSendDataAsync(XBee* self, XBeeLRPacket_t* packet, XBeeTxCompleteCallback callback, void* ctx);
+void XBeeLRAttachRxQueue(XBee* self, XBeeLRRxQueue* queue);
+bool XBeeLRReceive(XBee* self, XBeeLRPacket_t* packet);
+uint8_t XBeeLRRxPending(XBee* self);
 bool XBeeLRGetDevEUI(XBee* self, uint8_t* responseBuffer, uint8_t buffer_size);
 bool XBeeLRSetAppEUI(XBee* self, const char* value);
 bool XBeeLRSetAppKey(XBee* self, const char* value);
@@ -0,0 +1,247 @@
+/**
+ * @file xbee_lr_airtime.c
+ * @brief LoRa time-on-air calculator and payload size planner for the XBee LR subclass.
+ * 
+ * The time on air follows the Semtech LoRa modem formula. The data rate tables follow 
+ * the LoRaWAN regional parameters for uplinks, with the uplink dwell time limit off 
+ * and no FOpts in the frame header.
+ * 
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_lr_airtime.h"
+#include <string.h>
+
+// One uplink data rate of a region: spreading factor (0 for FSK), bandwidth and max FRMPayload
+typedef struct {
+    uint8_t spreadingFactor;
+    uint16_t bandwidthKhz;
+    uint8_t maxPayload;
+} XBeeLRDataRateEntry;
+
+// EU868, also used for the other regions sharing its uplink data rates
+static const XBeeLRDataRateEntry XBeeLRDataRatesEU868[] = {
+    {12, 125, 51}, {11, 125, 51}, {10, 125, 51}, {9, 125, 115},
+    {8, 125, 242}, {7, 125, 242}, {7, 250, 242}, {0, 50, 242},
+};
+
+static const XBeeLRDataRateEntry XBeeLRDataRatesUS915[] = {
+    {10, 125, 11}, {9, 125, 53}, {8, 125, 125}, {7, 125, 242}, {8, 500, 242},
+};
+
+static const XBeeLRDataRateEntry XBeeLRDataRatesAU915[] = {
+    {12, 125, 51}, {11, 125, 51}, {10, 125, 51}, {9, 125, 115},
+    {8, 125, 242}, {7, 125, 242}, {8, 500, 242},
+};
+
+static const XBeeLRDataRateEntry XBeeLRDataRatesAS923[] = {
+    {12, 125, 51}, {11, 125, 51}, {10, 125, 115}, {9, 125, 242},
+    {8, 125, 242}, {7, 125, 242}, {7, 250, 242}, {0, 50, 242},
+};
+
+static const XBeeLRDataRateEntry XBeeLRDataRatesKR920[] = {
+    {12, 125, 51}, {11, 125, 51}, {10, 125, 51}, {9, 125, 115}, {8, 125, 242}, {7, 125, 242},
+};
+
+static const XBeeLRDataRateEntry XBeeLRDataRatesIN865[] = {
+    {12, 125, 51}, {11, 125, 51}, {10, 125, 51}, {9, 125, 115},
+    {8, 125, 242}, {7, 125, 242}, {0, 0, 0}, {0, 50, 242},
+};
+
+#define XBEE_LR_COUNT_OF(table) ((uint8_t)(sizeof(table) / sizeof((table)[0])))
+
+/**
+ * @brief Looks up the uplink data rate entry of a region.
+ * 
+ * @return const XBeeLRDataRateEntry* The entry, or NULL for an unknown region or an undefined data rate.
+ */
+static const XBeeLRDataRateEntry* XBeeLRDataRateLookup(uint8_t region, uint8_t dataRate) {
+    const XBeeLRDataRateEntry* table;
+    uint8_t count;
+
+    switch (region) {
+        case XBEE_LR_REGION_EU868:
+            table = XBeeLRDataRatesEU868; count = XBEE_LR_COUNT_OF(XBeeLRDataRatesEU868);
+            break;
+        case XBEE_LR_REGION_US915:
+            table = XBeeLRDataRatesUS915; count = XBEE_LR_COUNT_OF(XBeeLRDataRatesUS915);
+            break;
+        case XBEE_LR_REGION_AU915:
+            table = XBeeLRDataRatesAU915; count = XBEE_LR_COUNT_OF(XBeeLRDataRatesAU915);
+            break;
+        case XBEE_LR_REGION_AS923_1:
+        case XBEE_LR_REGION_AS923_2:
+        case XBEE_LR_REGION_AS923_3:
+        case XBEE_LR_REGION_AS923_4:
+            table = XBeeLRDataRatesAS923; count = XBEE_LR_COUNT_OF(XBeeLRDataRatesAS923);
+            break;
+        case XBEE_LR_REGION_KR920:
+            table = XBeeLRDataRatesKR920; count = XBEE_LR_COUNT_OF(XBeeLRDataRatesKR920);
+            break;
+        case XBEE_LR_REGION_IN865:
+            table = XBeeLRDataRatesIN865; count = XBEE_LR_COUNT_OF(XBeeLRDataRatesIN865);
+            break;
+        default:
+            return NULL;
+    }
+    if ((dataRate >= count) || (table[dataRate].maxPayload == 0)) {
+        return NULL;
+    }
+    return &table[dataRate];
+}
+
+/**
+ * @brief Computes the time on air of a LoRa or FSK frame.
+ * 
+ * @param[in] modulation Modulation of the frame.
+ * @param[in] phyPayloadSize PHY payload length in bytes (FRMPayload + `XBEE_LR_MAC_OVERHEAD` for LoRaWAN).
+ * 
+ * @return uint32_t The time on air in microseconds, or 0 for an invalid modulation.
+ */
+uint32_t XBeeLRAirtimeUs(const XBeeLRModulation* modulation, uint16_t phyPayloadSize) {
+    if (modulation->spreadingFactor == 0) {
+        // FSK: preamble (5), sync word (3), length (1), payload and CRC (2)
+        if (modulation->bandwidthKhz == 0) {
+            return 0;
+        }
+        uint32_t bits = ((uint32_t)modulation->preambleSymbols + 3 + 1 + phyPayloadSize + 2) * 8;
+        return (bits * 1000UL + modulation->bandwidthKhz - 1) / modulation->bandwidthKhz;
+    }
+
+    uint8_t sf = modulation->spreadingFactor;
+    if ((sf < 6) || (sf > 12) || (modulation->bandwidthKhz == 0)) {
+        return 0;
+    }
+    // Low data rate optimization is mandated when a symbol lasts 16 ms or more
+    uint32_t symbolUs = ((uint32_t)1 << sf) * 1000UL / modulation->bandwidthKhz;
+    int32_t lowDataRateOptimize = (symbolUs >= 16000) ? 1 : 0;
+
+    int32_t numerator = 8 * (int32_t)phyPayloadSize - 4 * sf + 28 + (modulation->crc ? 16 : 0) - 
+        (modulation->explicitHeader ? 0 : 20);
+    int32_t denominator = 4 * (sf - 2 * lowDataRateOptimize);
+    uint32_t payloadSymbols = 8;
+    if (numerator > 0) {
+        payloadSymbols += (uint32_t)((numerator + denominator - 1) / denominator) * (modulation->codingRate + 4);
+    }
+
+    // Preamble plus 4.25 symbols of sync word, in quarter symbols
+    uint32_t preambleQuarters = (uint32_t)modulation->preambleSymbols * 4 + 17;
+    return symbolUs * preambleQuarters / 4 + symbolUs * payloadSymbols;
+}
+
+/**
+ * @brief Returns the uplink modulation of a LoRaWAN data rate.
+ * 
+ * @param[in] region Region, see `xbee_lr_region_t`.
+ * @param[in] dataRate LoRaWAN data rate.
+ * @param[out] modulation Modulation of the data rate.
+ * 
+ * @return bool Returns true on success, false if the region or data rate is unknown.
+ */
+bool XBeeLRDataRateModulation(uint8_t region, uint8_t dataRate, XBeeLRModulation* modulation) {
+    const XBeeLRDataRateEntry* entry = XBeeLRDataRateLookup(region, dataRate);
+    if (entry == NULL) {
+        return false;
+    }
+    modulation->spreadingFactor = entry->spreadingFactor;
+    modulation->bandwidthKhz = entry->bandwidthKhz;
+    modulation->codingRate = 1;
+    modulation->preambleSymbols = (entry->spreadingFactor == 0) ? 5 : 8;
+    modulation->explicitHeader = true;
+    modulation->crc = true;
+    return true;
+}
+
+/**
+ * @brief Returns the largest application payload (FRMPayload) allowed at a data rate.
+ * 
+ * @param[in] region Region, see `xbee_lr_region_t`.
+ * @param[in] dataRate LoRaWAN data rate.
+ * 
+ * @return uint8_t The maximum payload in bytes, or 0 if the region or data rate is unknown.
+ */
+uint8_t XBeeLRDataRateMaxPayload(uint8_t region, uint8_t dataRate) {
+    const XBeeLRDataRateEntry* entry = XBeeLRDataRateLookup(region, dataRate);
+    return (entry != NULL) ? entry->maxPayload : 0;
+}
+
+/**
+ * @brief Computes the time on air of an uplink carrying `payloadSize` application bytes.
+ * 
+ * @param[in] region Region, see `xbee_lr_region_t`.
+ * @param[in] dataRate LoRaWAN data rate.
+ * @param[in] payloadSize FRMPayload size in bytes.
+ * 
+ * @return uint32_t The time on air in milliseconds, rounded up, or 0 if the region or data rate is unknown.
+ */
+uint32_t XBeeLRPayloadAirtimeMs(uint8_t region, uint8_t dataRate, uint8_t payloadSize) {
+    XBeeLRModulation modulation;
+    if (!XBeeLRDataRateModulation(region, dataRate, &modulation)) {
+        return 0;
+    }
+    uint32_t airtimeUs = XBeeLRAirtimeUs(&modulation, (uint16_t)payloadSize + XBEE_LR_MAC_OVERHEAD);
+    return (airtimeUs + 999) / 1000;
+}
+
+/**
+ * @brief Returns the expected time on air of a packet at the instance's current data rate.
+ * 
+ * The region and data rate are the values last given to `XBeeLRSetRegion()` and 
+ * `XBeeLRSetDataRate()`, with the data rate following the explicit TX status frames 
+ * when ADR changes it.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] packet Packet to send.
+ * 
+ * @return uint32_t The time on air in milliseconds, or 0 if the region or data rate is unknown.
+ */
+uint32_t XBeeLRGetPacketAirtime(XBee* self, const XBeeLRPacket_t* packet) {
+    XBeeLR* lr = (XBeeLR*)self;
+    return XBeeLRPayloadAirtimeMs(lr->region, lr->dataRate, packet->payloadSize);
+}
+
+/**
+ * @brief Returns the largest application payload allowed at the instance's current data rate.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint8_t The maximum payload in bytes, or 0 if the region or data rate is unknown.
+ */
+uint8_t XBeeLRGetMaxPayload(XBee* self) {
+    XBeeLR* lr = (XBeeLR*)self;
+    return XBeeLRDataRateMaxPayload(lr->region, lr->dataRate);
+}
+
+/**
+ * @brief Returns the data rate the instance currently assumes for uplinks.
+ * 
+ * @param[in] self Pointer to the XBee instance.
+ * 
+ * @return uint8_t The data rate last set or reported by an explicit TX status.
+ */
+uint8_t XBeeLRGetDataRate(XBee* self) {
+    return ((XBeeLR*)self)->dataRate;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file xbee_lr_airtime.h
+ * @brief LoRa time-on-air calculator and payload size planner for the XBee LR subclass.
+ * 
+ * Computes the time on air of an uplink from its modulation (spreading factor, 
+ * bandwidth, coding rate) and length, and maps the LoRaWAN region and data rate cached 
+ * by the XBee LR instance onto that modulation and the maximum application payload.
+ * 
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#ifndef XBEELR_AIRTIME_H
+#define XBEELR_AIRTIME_H
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#include "xbee_lr.h"
+
+// LoRaWAN MAC overhead added to FRMPayload: MHDR (1), FHDR without FOpts (7), FPort (1), MIC (4)
+#define XBEE_LR_MAC_OVERHEAD 13
+
+/**
+ * @enum xbee_lr_region_t
+ * @brief Region values accepted by `XBeeLRSetRegion()`.
+ */
+typedef enum {
+    XBEE_LR_REGION_EU868 = 0,
+    XBEE_LR_REGION_US915 = 1,
+    XBEE_LR_REGION_AU915 = 2,
+    XBEE_LR_REGION_AS923_1 = 3,
+    XBEE_LR_REGION_AS923_2 = 4,
+    XBEE_LR_REGION_AS923_3 = 5,
+    XBEE_LR_REGION_AS923_4 = 6,
+    XBEE_LR_REGION_KR920 = 7,
+    XBEE_LR_REGION_IN865 = 8
+} xbee_lr_region_t;
+
+/**
+ * @brief Modulation parameters of a LoRaWAN data rate.
+ *
+ * A `spreadingFactor` of 0 denotes FSK, for which `bandwidthKhz` holds the bit rate in kbit/s.
+ */
+typedef struct {
+    uint8_t spreadingFactor;     ///< 7-12, or 0 for FSK
+    uint16_t bandwidthKhz;       ///< 125, 250 or 500 kHz, or the FSK bit rate in kbit/s
+    uint8_t codingRate;          ///< 1-4 for 4/5 to 4/8
+    uint8_t preambleSymbols;     ///< Programmed preamble length, 8 for LoRaWAN
+    bool explicitHeader;         ///< LoRa explicit header mode, used by LoRaWAN
+    bool crc;                    ///< Payload CRC present, used by LoRaWAN uplinks
+} XBeeLRModulation;
+
+uint32_t XBeeLRAirtimeUs(const XBeeLRModulation* modulation, uint16_t phyPayloadSize);
+bool XBeeLRDataRateModulation(uint8_t region, uint8_t dataRate, XBeeLRModulation* modulation);
+uint8_t XBeeLRDataRateMaxPayload(uint8_t region, uint8_t dataRate);
+uint32_t XBeeLRPayloadAirtimeMs(uint8_t region, uint8_t dataRate, uint8_t payloadSize);
+uint32_t XBeeLRGetPacketAirtime(XBee* self, const XBeeLRPacket_t* packet);
+uint8_t XBeeLRGetMaxPayload(XBee* self);
+uint8_t XBeeLRGetDataRate(XBee* self);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEELR_AIRTIME_H
@@ -0,0 +1,420 @@
+/**
+ * @file xbee_lr_coalesce.c
+ * @brief Coalescing of small records into shared uplinks, in front of the uplink scheduler.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_lr_coalesce.h"
+#include "xbee_lr_airtime.h"
+#include <string.h>
+
+/**
+ * @brief Returns the payload an uplink may carry at the current data rate.
+ *
+ * Falls back to the slowest EU868 data rate when the region or data rate is unknown.
+ */
+static uint8_t XBeeLRCoalesceMaxPayload(XBeeLRCoalescer* coalescer) {
+    uint8_t maxPayload = XBeeLRGetMaxPayload(coalescer->sched->xbee);
+    if (maxPayload == 0) {
+        maxPayload = XBeeLRDataRateMaxPayload(XBEE_LR_REGION_EU868, 0);
+    }
+    if (maxPayload > XBEE_LR_COALESCE_MAX_PAYLOAD) {
+        maxPayload = XBEE_LR_COALESCE_MAX_PAYLOAD;
+    }
+    return maxPayload;
+}
+
+static uint32_t XBeeLRCoalesceNow(XBeeLRCoalescer* coalescer) {
+    XBee* xbee = coalescer->sched->xbee;
+    return xbee->htable->PortMillis(xbee->portContext);
+}
+
+static void XBeeLRCoalesceQueue(XBeeLRCoalescer* coalescer, XBeeLRCoalesceBuffer* buffer);
+
+/**
+ * @brief Removes the first records of a buffer.
+ */
+static void XBeeLRCoalesceRemove(XBeeLRCoalesceBuffer* buffer, uint8_t count) {
+    uint8_t cut = buffer->ends[count - 1];
+    memmove(buffer->data, &buffer->data[cut], (size_t)(buffer->length - cut));
+    for (uint8_t i = count; i < buffer->records; i++) {
+        buffer->ends[i - count] = (uint8_t)(buffer->ends[i] - cut);
+    }
+    buffer->length = (uint8_t)(buffer->length - cut);
+    buffer->records = (uint8_t)(buffer->records - count);
+}
+
+/**
+ * @brief TX completion of a coalesced uplink, frees its buffer.
+ *
+ * Records left behind the uplink by a cut are queued next. An uplink the scheduler
+ * handed back because it no longer fits the DR keeps its records and is queued again,
+ * cut at the new payload size.
+ */
+static void XBeeLRCoalesceSent(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+    (void)self;
+    (void)frameId;
+    (void)report;
+    XBeeLRCoalesceBuffer* buffer = (XBeeLRCoalesceBuffer*)ctx;
+    XBeeLRCoalescer* coalescer = buffer->coalescer;
+    if (status == XBEE_LR_TX_STATUS_PAYLOAD_TOO_LARGE) {
+        coalescer->uplinks--;
+        XBeeLRCoalesceQueue(coalescer, buffer);
+        return;
+    }
+    uint8_t port = buffer->port;
+    uint8_t records = buffer->sending;
+
+    if (buffer->records > records) {
+        XBeeLRCoalesceRemove(buffer, records);
+        buffer->state = XBEE_LR_COALESCE_READY;
+    } else {
+        buffer->state = XBEE_LR_COALESCE_FREE;
+        buffer->length = 0;
+        buffer->records = 0;
+    }
+    buffer->sending = 0;
+    if (status != 0) {
+        XBEEDebugPrint("Coalesced uplink of %u records not sent, status 0x%02X\n", records, status);
+    }
+    if (coalescer->callback) {
+        coalescer->callback(coalescer, port, records, status, coalescer->ctx);
+    }
+}
+
+/**
+ * @brief Returns the buffer collecting records for a port, NULL if there is none.
+ */
+static XBeeLRCoalesceBuffer* XBeeLRCoalesceFilling(XBeeLRCoalescer* coalescer, uint8_t port) {
+    for (uint8_t i = 0; i < XBEE_LR_COALESCE_BUFFERS; i++) {
+        XBeeLRCoalesceBuffer* buffer = &coalescer->buffers[i];
+        if ((buffer->state == XBEE_LR_COALESCE_FILLING) && (buffer->port == port)) {
+            return buffer;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Returns a buffer not in use, NULL if there is none.
+ */
+static XBeeLRCoalesceBuffer* XBeeLRCoalesceFree(XBeeLRCoalescer* coalescer) {
+    for (uint8_t i = 0; i < XBEE_LR_COALESCE_BUFFERS; i++) {
+        if (coalescer->buffers[i].state == XBEE_LR_COALESCE_FREE) {
+            return &coalescer->buffers[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Removes the first record of a buffer.
+ */
+static void XBeeLRCoalesceDropFirst(XBeeLRCoalescer* coalescer, XBeeLRCoalesceBuffer* buffer) {
+    XBEEDebugPrint("Coalesced record of %u bytes no longer fits an uplink, dropped\n", buffer->ends[0]);
+    XBeeLRCoalesceRemove(buffer, 1);
+    coalescer->dropped++;
+}
+
+/**
+ * @brief Hands a closed buffer to the scheduler, or leaves it ready if the queue is full.
+ *
+ * A buffer longer than the payload of the current DR, filled before ADR lowered it, is
+ * cut at the last record that fits and the remaining records move to a free buffer. That
+ * one keeps collecting unless the port already has a filling buffer, then it is queued
+ * next. Without a free buffer they stay behind the uplink and are queued after its TX
+ * status.
+ */
+static void XBeeLRCoalesceQueue(XBeeLRCoalescer* coalescer, XBeeLRCoalesceBuffer* buffer) {
+    uint8_t maxPayload = XBeeLRCoalesceMaxPayload(coalescer);
+    buffer->state = XBEE_LR_COALESCE_READY;
+
+    while ((buffer->records > 0) && (buffer->ends[0] > maxPayload)) {
+        XBeeLRCoalesceDropFirst(coalescer, buffer);
+    }
+    if (buffer->records == 0) {
+        buffer->state = XBEE_LR_COALESCE_FREE;
+        buffer->length = 0;
+        return;
+    }
+    uint8_t sending = buffer->records;
+    if (buffer->length > maxPayload) {
+        sending = 1;
+        while (buffer->ends[sending] <= maxPayload) {
+            sending++;
+        }
+    }
+    uint8_t cut = buffer->ends[sending - 1];
+    XBeeLRCoalesceBuffer* rest = (sending < buffer->records) ? XBeeLRCoalesceFree(coalescer) : NULL;
+    if (rest != NULL) {
+        rest->state = (XBeeLRCoalesceFilling(coalescer, buffer->port) == NULL) ? 
+            XBEE_LR_COALESCE_FILLING : XBEE_LR_COALESCE_READY;
+        rest->port = buffer->port;
+        rest->deadline = buffer->deadline;
+        rest->length = (uint8_t)(buffer->length - cut);
+        rest->records = (uint8_t)(buffer->records - sending);
+        memcpy(rest->data, &buffer->data[cut], rest->length);
+        for (uint8_t i = 0; i < rest->records; i++) {
+            rest->ends[i] = (uint8_t)(buffer->ends[sending + i] - cut);
+        }
+        buffer->length = cut;
+        buffer->records = sending;
+    }
+
+    XBeeLRPacket_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.port = buffer->port;
+    packet.payload = buffer->data;
+    packet.payloadSize = cut;
+    packet.ack = coalescer->ack;
+    if (XBeeLRSchedEnqueue(coalescer->sched, &packet, coalescer->priority, XBeeLRCoalesceSent, buffer)) {
+        buffer->state = XBEE_LR_COALESCE_QUEUED;
+        buffer->sending = sending;
+        coalescer->uplinks++;
+    }
+}
+
+/**
+ * @brief Checks whether a buffer whose deadline expired can leave now.
+ *
+ * While every sub-band is in its off-time the uplink would wait in the scheduler anyway,
+ * so the buffer stays open for more records until one opens.
+ */
+static bool XBeeLRCoalesceCanRelease(XBeeLRCoalescer* coalescer, uint32_t now) {
+    return (int32_t)(XBeeLRSchedNextRelease(coalescer->sched) - now) <= 0;
+}
+
+/**
+ * @brief Initializes a caller-owned coalescing stage in front of a scheduler.
+ *
+ * Uplinks are sent unconfirmed; set `ack` for confirmed uplinks, and `callback` to see the
+ * TX status of each uplink.
+ *
+ * @param[out] coalescer Pointer to the coalescing stage to initialize.
+ * @param[in] sched Scheduler the uplinks are queued on, bound to an XBee LR instance.
+ * @param[in] priority Scheduler priority of the uplinks.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeLRCoalesceInit(XBeeLRCoalescer* coalescer, XBeeLRScheduler* sched, xbee_lr_priority_t priority) {
+    memset(coalescer, 0, sizeof(*coalescer));
+    coalescer->sched = sched;
+    coalescer->priority = priority;
+    for (uint8_t i = 0; i < XBEE_LR_COALESCE_BUFFERS; i++) {
+        coalescer->buffers[i].coalescer = coalescer;
+    }
+}
+
+/**
+ * @brief Reserves room for a record in the next uplink of a port.
+ *
+ * The caller writes the `length` bytes of the record to the returned address before the
+ * next call into the coalescing stage or the scheduler. If the record does not fit the
+ * payload of the current data rate next to the records already collected, those are
+ * closed into an uplink first and the record starts a new one.
+ *
+ * @param[in] coalescer Pointer to the coalescing stage.
+ * @param[in] port LoRaWAN port of the record.
+ * @param[in] length Size of the record in bytes.
+ * @param[in] maxLatencyMs Longest time the record may wait before its uplink is queued.
+ *
+ * @return uint8_t* Where to write the record, or NULL if the record is larger than one uplink
+ * (see xbee_lr_frag.h) or every buffer is in use.
+ */
+uint8_t* XBeeLRCoalesceReserve(XBeeLRCoalescer* coalescer, uint8_t port, uint8_t length, uint32_t maxLatencyMs) {
+    uint8_t maxPayload = XBeeLRCoalesceMaxPayload(coalescer);
+    if ((length == 0) || (length > maxPayload)) {
+        return NULL;
+    }
+
+    uint32_t now = XBeeLRCoalesceNow(coalescer);
+    XBeeLRCoalesceBuffer* buffer = XBeeLRCoalesceFilling(coalescer, port);
+    while ((buffer != NULL) && (((uint16_t)buffer->length + length > maxPayload) ||
+                                (buffer->records >= XBEE_LR_COALESCE_MAX_RECORDS))) {
+        coalescer->fullFlushes++;
+        XBeeLRCoalesceQueue(coalescer, buffer);
+        // After a DR change the records that no longer fit are collected in another buffer
+        buffer = XBeeLRCoalesceFilling(coalescer, port);
+    }
+    if (buffer == NULL) {
+        buffer = XBeeLRCoalesceFree(coalescer);
+        if (buffer == NULL) {
+            coalescer->overflows++;
+            XBEEDebugPrint("No coalescing buffer free for port %u\n", port);
+            return NULL;
+        }
+        buffer->state = XBEE_LR_COALESCE_FILLING;
+        buffer->port = port;
+        buffer->length = 0;
+        buffer->records = 0;
+        buffer->deadline = now + maxLatencyMs;
+    }
+
+    // The uplink is due when the most urgent of its records is
+    uint32_t deadline = now + maxLatencyMs;
+    if ((int32_t)(deadline - buffer->deadline) < 0) {
+        buffer->deadline = deadline;
+    }
+    uint8_t* record = &buffer->data[buffer->length];
+    buffer->length += length;
+    buffer->ends[buffer->records++] = buffer->length;
+    coalescer->records++;
+    return record;
+}
+
+/**
+ * @brief Copies a record into the next uplink of a port.
+ *
+ * Same as `XBeeLRCoalesceReserve()` for a record that is already in memory.
+ *
+ * @param[in] coalescer Pointer to the coalescing stage.
+ * @param[in] port LoRaWAN port of the record.
+ * @param[in] data Record to append.
+ * @param[in] length Size of the record in bytes.
+ * @param[in] maxLatencyMs Longest time the record may wait before its uplink is queued.
+ *
+ * @return bool Returns true if the record was appended, false if it is too large or every buffer is in use.
+ */
+bool XBeeLRCoalesceAppend(XBeeLRCoalescer* coalescer, uint8_t port, const void* data, uint8_t length, uint32_t maxLatencyMs) {
+    uint8_t* record = XBeeLRCoalesceReserve(coalescer, port, length, maxLatencyMs);
+    if (record == NULL) {
+        return false;
+    }
+    memcpy(record, data, length);
+    return true;
+}
+
+/**
+ * @brief Queues the records collected for a port right away, e.g. before going to sleep.
+ *
+ * @param[in] coalescer Pointer to the coalescing stage.
+ * @param[in] port LoRaWAN port to flush.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeLRCoalesceFlush(XBeeLRCoalescer* coalescer, uint8_t port) {
+    XBeeLRCoalesceBuffer* buffer;
+    while ((buffer = XBeeLRCoalesceFilling(coalescer, port)) != NULL) {
+        XBeeLRCoalesceQueue(coalescer, buffer);
+        if (buffer->state == XBEE_LR_COALESCE_READY) {
+            break;  // Scheduler queue full, sent by XBeeLRCoalesceProcess()
+        }
+    }
+}
+
+/**
+ * @brief Queues the uplinks that are full or due.
+ *
+ * Must be called from the application's main loop, after `XBeeProcess()` and before
+ * `XBeeLRSchedProcess()`, so a due uplink is released in the same pass.
+ *
+ * @param[in] coalescer Pointer to the coalescing stage.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeLRCoalesceProcess(XBeeLRCoalescer* coalescer) {
+    uint8_t maxPayload = XBeeLRCoalesceMaxPayload(coalescer);
+    uint32_t now = XBeeLRCoalesceNow(coalescer);
+
+    for (uint8_t i = 0; i < XBEE_LR_COALESCE_BUFFERS; i++) {
+        XBeeLRCoalesceBuffer* buffer = &coalescer->buffers[i];
+        if (buffer->state == XBEE_LR_COALESCE_READY) {
+            XBeeLRCoalesceQueue(coalescer, buffer);
+        } else if (buffer->state == XBEE_LR_COALESCE_FILLING) {
+            if ((buffer->length >= maxPayload) || (buffer->records >= XBEE_LR_COALESCE_MAX_RECORDS)) {
+                coalescer->fullFlushes++;
+                XBeeLRCoalesceQueue(coalescer, buffer);
+            } else if (((int32_t)(now - buffer->deadline) >= 0) && XBeeLRCoalesceCanRelease(coalescer, now)) {
+                coalescer->deadlineFlushes++;
+                XBeeLRCoalesceQueue(coalescer, buffer);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Returns the time until `XBeeLRCoalesceProcess()` has an uplink to queue.
+ *
+ * Use it as the limit of `XBeeWait()` together with `XBeeLRSchedNextDeadline()`. Buffers
+ * waiting for room in the scheduler queue are not counted: room is made by a TX status,
+ * which ends the wait by itself.
+ *
+ * @param[in] coalescer Pointer to the coalescing stage.
+ *
+ * @return uint32_t Milliseconds until the next uplink is due, 0 if one is due now, or
+ * `XBEE_WAIT_FOREVER` if no records are collected.
+ */
+uint32_t XBeeLRCoalesceNextDeadline(XBeeLRCoalescer* coalescer) {
+    uint8_t maxPayload = XBeeLRCoalesceMaxPayload(coalescer);
+    uint32_t now = XBeeLRCoalesceNow(coalescer);
+    uint32_t wait = XBEE_WAIT_FOREVER;
+
+    for (uint8_t i = 0; i < XBEE_LR_COALESCE_BUFFERS; i++) {
+        XBeeLRCoalesceBuffer* buffer = &coalescer->buffers[i];
+        if ((buffer->state == XBEE_LR_COALESCE_READY) &&
+            (XBeeLRSchedPending(coalescer->sched) < XBEE_LR_SCHED_QUEUE_SIZE)) {
+            return 0;  // Left over from cutting an uplink, can be queued now
+        }
+        if (buffer->state != XBEE_LR_COALESCE_FILLING) {
+            continue;
+        }
+        if ((buffer->length >= maxPayload) || (buffer->records >= XBEE_LR_COALESCE_MAX_RECORDS)) {
+            return 0;
+        }
+        // A due buffer is held until the scheduler can release it
+        uint32_t due = buffer->deadline;
+        uint32_t release = XBeeLRSchedNextRelease(coalescer->sched);
+        if ((int32_t)(release - due) > 0) {
+            due = release;
+        }
+        int32_t remaining = (int32_t)(due - now);
+        if (remaining <= 0) {
+            return 0;
+        }
+        if ((uint32_t)remaining < wait) {
+            wait = (uint32_t)remaining;
+        }
+    }
+    return wait;
+}
+
+/**
+ * @brief Returns the number of records appended and not yet confirmed by a TX status.
+ *
+ * @param[in] coalescer Pointer to the coalescing stage.
+ *
+ * @return uint16_t Records in filling, ready and queued buffers.
+ */
+uint16_t XBeeLRCoalescePending(const XBeeLRCoalescer* coalescer) {
+    uint16_t count = 0;
+    for (uint8_t i = 0; i < XBEE_LR_COALESCE_BUFFERS; i++) {
+        if (coalescer->buffers[i].state != XBEE_LR_COALESCE_FREE) {
+            count += coalescer->buffers[i].records;
+        }
+    }
+    return count;
+}
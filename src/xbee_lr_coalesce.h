@@ -0,0 +1,130 @@
+/**
+ * @file xbee_lr_coalesce.h
+ * @brief Coalescing of small records into shared uplinks, in front of the uplink scheduler.
+ *
+ * Records appended for a LoRaWAN port are written back to back into a buffer that later
+ * becomes the payload of one uplink, so each uplink pays the LoRaWAN header, the
+ * preamble and the duty-cycle off-time once for several records. A buffer is handed to
+ * the scheduler when the next record would no longer fit the payload the current data
+ * rate allows, or when the latency deadline of one of its records expires, whichever
+ * comes first. While every sub-band of the scheduler is closed an expired buffer keeps
+ * collecting records, since it could not be sent any earlier.
+ *
+ * `XBeeLRCoalesceReserve()` returns the place of the next record inside the buffer,
+ * which is the buffer the uplink is later streamed from, so a record written there is
+ * never copied again. Records are not framed: the application picks a record layout
+ * the network side can split again, e.g. fixed-size or self-describing records.
+ *
+ * Each of the `XBEE_LR_COALESCE_BUFFERS` buffers is either being filled for one port,
+ * queued in or sent from the scheduler, or free; a buffer is free again once the TX
+ * status of its uplink arrived.
+ *
+ * The end of every record is kept, so a buffer filled at a faster DR is cut at the last
+ * record that fits when ADR lowers the DR before it is sent; the remaining records
+ * move to a free buffer, or without one stay in place behind the records being sent, and
+ * leave in the next uplink. An uplink still waiting in the scheduler is handed back with
+ * `XBEE_LR_TX_STATUS_PAYLOAD_TOO_LARGE` and cut the same way. A single record larger than the
+ * payload of the new DR can never be sent and is dropped, counted in `dropped`.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#ifndef XBEELR_COALESCE_H
+#define XBEELR_COALESCE_H
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#include "xbee_lr_sched.h"
+#include "config.h"
+
+typedef struct XBeeLRCoalescer_s XBeeLRCoalescer;
+
+/**
+ * @typedef XBeeLRCoalesceSentCallback
+ * @brief Called with the TX status of every coalesced uplink.
+ */
+typedef void (*XBeeLRCoalesceSentCallback)(XBeeLRCoalescer* coalescer, uint8_t port, uint8_t records,
+    uint8_t status, void* ctx);
+
+/**
+ * @brief State of a coalescing buffer.
+ */
+typedef enum {
+    XBEE_LR_COALESCE_FREE = 0,      ///< Not in use
+    XBEE_LR_COALESCE_FILLING,       ///< Collecting records for `port`
+    XBEE_LR_COALESCE_READY,         ///< Closed, waiting for room in the scheduler queue
+    XBEE_LR_COALESCE_QUEUED         ///< Queued in or sent from the scheduler, waiting for its TX status
+} xbee_lr_coalesce_state_t;
+
+/**
+ * @brief Payload of one coalesced uplink under construction.
+ */
+typedef struct {
+    XBeeLRCoalescer* coalescer;     ///< Owner, reached from the TX completion callback
+    uint8_t data[XBEE_LR_COALESCE_MAX_PAYLOAD]; ///< Records, back to back; the uplink is sent from here
+    uint8_t ends[XBEE_LR_COALESCE_MAX_RECORDS]; ///< Offset in `data` after each record
+    uint8_t length;                 ///< Bytes used in `data`
+    uint8_t records;                ///< Records in `data`
+    uint8_t sending;                ///< Records in the queued uplink, the ones after them wait for its TX status
+    uint8_t port;                   ///< LoRaWAN port of the records
+    uint8_t state;                  ///< xbee_lr_coalesce_state_t
+    uint32_t deadline;              ///< PortMillis() time the first record deadline expires
+} XBeeLRCoalesceBuffer;
+
+/**
+ * @brief Caller-owned coalescing stage bound to an uplink scheduler.
+ */
+struct XBeeLRCoalescer_s {
+    XBeeLRScheduler* sched;         ///< Scheduler the uplinks are queued on
+    xbee_lr_priority_t priority;    ///< Scheduler priority of the uplinks
+    bool ack;                       ///< Send the uplinks as confirmed uplinks
+    XBeeLRCoalesceSentCallback callback; ///< Called with the TX status of each uplink, may be NULL
+    void* ctx;                      ///< User pointer passed to the callback
+    XBeeLRCoalesceBuffer buffers[XBEE_LR_COALESCE_BUFFERS];
+    uint32_t records;               ///< Records appended
+    uint32_t uplinks;               ///< Uplinks handed to the scheduler, not counting those handed back to be cut
+    uint32_t fullFlushes;           ///< Uplinks closed because the next record did not fit, or the buffer held XBEE_LR_COALESCE_MAX_RECORDS
+    uint32_t deadlineFlushes;       ///< Uplinks closed because a record deadline expired
+    uint32_t overflows;             ///< Records refused because every buffer was in use
+    uint32_t dropped;               ///< Records dropped because they no longer fit an uplink after a DR change
+};
+
+void XBeeLRCoalesceInit(XBeeLRCoalescer* coalescer, XBeeLRScheduler* sched, xbee_lr_priority_t priority);
+uint8_t* XBeeLRCoalesceReserve(XBeeLRCoalescer* coalescer, uint8_t port, uint8_t length, uint32_t maxLatencyMs);
+bool XBeeLRCoalesceAppend(XBeeLRCoalescer* coalescer, uint8_t port, const void* data, uint8_t length, uint32_t maxLatencyMs);
+void XBeeLRCoalesceFlush(XBeeLRCoalescer* coalescer, uint8_t port);
+void XBeeLRCoalesceProcess(XBeeLRCoalescer* coalescer);
+uint32_t XBeeLRCoalesceNextDeadline(XBeeLRCoalescer* coalescer);
+uint16_t XBeeLRCoalescePending(const XBeeLRCoalescer* coalescer);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEELR_COALESCE_H
@@ -0,0 +1,555 @@
+/**
+ * @file xbee_lr_frag.c
+ * @brief Fragmentation and reassembly of transfers larger than one LoRaWAN uplink.
+ * 
+ * Only one fragment of a transfer is in the scheduler at a time: the scheduler keeps a 
+ * pointer to the payload, so the next fragment is built in the same buffer once the 
+ * TX status of the previous one arrived. The scheduler releases at most one uplink at 
+ * a time anyway, so this costs no throughput. Fragment sizes are chosen from the DR 
+ * the instance assumes when a fragment is first built, see `XBeeLRGetMaxPayload()`.
+ * 
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_lr_frag.h"
+#include "xbee_lr_airtime.h"
+#include <string.h>
+
+/**
+ * @brief Returns the data bytes a new fragment may carry at the current data rate.
+ * 
+ * Falls back to the slowest EU868 data rate when the region or data rate is unknown.
+ */
+static uint8_t XBeeLRFragDataSize(XBeeLRFrag* frag) {
+    uint8_t maxPayload = XBeeLRGetMaxPayload(frag->sched->xbee);
+    if (maxPayload == 0) {
+        maxPayload = XBeeLRDataRateMaxPayload(XBEE_LR_REGION_EU868, 0);
+    }
+    if (maxPayload > XBEE_LR_FRAG_MAX_PAYLOAD) {
+        maxPayload = XBEE_LR_FRAG_MAX_PAYLOAD;
+    }
+    return (maxPayload > XBEE_LR_FRAG_HEADER_SIZE) ? (uint8_t)(maxPayload - XBEE_LR_FRAG_HEADER_SIZE) : 0;
+}
+
+/**
+ * @brief Returns the window slot of a sequence number.
+ */
+static XBeeLRFragSlot* XBeeLRFragSlotOf(XBeeLRFrag* frag, uint8_t seq) {
+    return &frag->tx.slots[seq % XBEE_LR_FRAG_WINDOW];
+}
+
+/**
+ * @brief Ends the uplink transfer and reports its result.
+ */
+static void XBeeLRFragFinish(XBeeLRFrag* frag, bool success) {
+    XBeeLRFragSentCallback callback = frag->tx.callback;
+    void* ctx = frag->tx.ctx;
+    frag->tx.active = false;
+    frag->tx.awaitingAck = false;
+    if (!success) {
+        XBEEDebugPrint("Fragmented transfer %u failed\n", frag->tx.id);
+    }
+    if (callback) {
+        callback(frag, success, ctx);
+    }
+}
+
+/**
+ * @brief Counts a timeout or failed uplink, failing the transfer after `XBEE_LR_FRAG_RETRIES`.
+ * 
+ * @return bool Returns true if the transfer may continue.
+ */
+static bool XBeeLRFragRetry(XBeeLRFrag* frag) {
+    if (++frag->tx.retries > XBEE_LR_FRAG_RETRIES) {
+        XBeeLRFragFinish(frag, false);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief TX completion of a fragment released by the scheduler.
+ * 
+ * A failed fragment is sent again. A delivered fragment that requested an 
+ * acknowledgement starts the acknowledgement timeout, unless the acknowledgement 
+ * already arrived in a downlink before the TX status: an acknowledgement that moved 
+ * `baseSeq` past the fragment, or marked it in its bitmap, covers it.
+ */
+static void XBeeLRFragTxComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+    (void)frameId;
+    (void)report;
+    XBeeLRFrag* frag = (XBeeLRFrag*)ctx;
+    frag->tx.inFlight = false;
+    if (!frag->tx.active || ((frag->tx.buffer[0] >> 4) != frag->tx.id)) {
+        return;  // Fragment of a transfer that has already ended
+    }
+    uint8_t window = (uint8_t)(frag->tx.nextSeq - frag->tx.baseSeq);
+    if ((uint8_t)(frag->tx.inFlightSeq - frag->tx.baseSeq) >= window) {
+        return;  // Acknowledged while its TX status was pending
+    }
+
+    XBeeLRFragSlot* slot = XBeeLRFragSlotOf(frag, frag->tx.inFlightSeq);
+    if (status != 0) {
+        XBEEDebugPrint("Fragment %u not sent, status 0x%02X\n", frag->tx.inFlightSeq, status);
+        if (XBeeLRFragRetry(frag)) {
+            slot->needSend = true;
+        }
+        return;
+    }
+    if (frag->tx.inFlightAckRequest && !slot->acked) {
+        frag->tx.awaitingAck = true;
+        frag->tx.ackDeadline = self->htable->PortMillis(self->portContext) + XBEE_LR_FRAG_ACK_TIMEOUT_MS;
+    }
+}
+
+/**
+ * @brief TX completion of an acknowledgement of a downlink transfer.
+ */
+static void XBeeLRFragAckComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+    (void)self;
+    (void)frameId;
+    (void)status;
+    (void)report;
+    XBeeLRFrag* frag = (XBeeLRFrag*)ctx;
+    frag->rx.ackQueued = false;
+}
+
+/**
+ * @brief Writes the acknowledgement of the downlink transfer from the reassembly state.
+ */
+static void XBeeLRFragWriteAck(XBeeLRFrag* frag) {
+    frag->rx.ack[0] = (uint8_t)(frag->rx.id << 4) | XBEE_LR_FRAG_FLAG_ACK;
+    frag->rx.ack[1] = frag->rx.baseSeq;
+    frag->rx.ack[2] = frag->rx.bitmap;
+}
+
+/**
+ * @brief Continues the uplink transfer under a new transfer ID from its first unacknowledged byte.
+ * 
+ * Used when a fragment that has to be sent again no longer fits the current DR. Its 
+ * sequence number cannot be reused for less data, since the receiver may already hold 
+ * the original, so the window is dropped and cut again at the new fragment size. The 
+ * receiver keeps the bytes before the new start offset.
+ */
+static void XBeeLRFragRestart(XBeeLRFrag* frag) {
+    if (frag->tx.nextSeq != frag->tx.baseSeq) {
+        frag->tx.nextOffset = XBeeLRFragSlotOf(frag, frag->tx.baseSeq)->offset;
+    }
+    XBEEDebugPrint("Fragmented transfer %u continues at offset %u after a DR change\n", frag->tx.id, frag->tx.nextOffset);
+    frag->tx.id = (uint8_t)((frag->tx.id + 1) & 0x0F);
+    frag->tx.baseSeq = 0;
+    frag->tx.nextSeq = 0;
+    frag->tx.awaitingAck = false;
+}
+
+/**
+ * @brief Picks the next fragment of the uplink transfer and queues it in the scheduler.
+ * 
+ * Fragments reported missing go first, in sequence order, then new fragments while the 
+ * window has room. The fragment after which nothing else can be sent requests the 
+ * acknowledgement. A missing fragment longer than the current DR allows restarts the 
+ * window with `XBeeLRFragRestart()`.
+ */
+static void XBeeLRFragQueueNext(XBeeLRFrag* frag) {
+    XBeeLRFragSlot* slot = NULL;
+    uint8_t seq = 0;
+    bool more = false;
+    uint8_t dataSize = XBeeLRFragDataSize(frag);
+
+    uint8_t outstanding = (uint8_t)(frag->tx.nextSeq - frag->tx.baseSeq);
+    for (uint8_t i = 0; i < outstanding; i++) {
+        uint8_t candidate = (uint8_t)(frag->tx.baseSeq + i);
+        XBeeLRFragSlot* entry = XBeeLRFragSlotOf(frag, candidate);
+        if (!entry->needSend || entry->acked) {
+            continue;
+        }
+        if (slot == NULL) {
+            slot = entry;
+            seq = candidate;
+        } else {
+            more = true;
+            break;
+        }
+    }
+
+    if ((slot != NULL) && (slot->length > dataSize) && (dataSize > 0)) {
+        XBeeLRFragRestart(frag);
+        slot = NULL;
+        more = false;
+        outstanding = 0;
+    }
+
+    bool canGrow = (outstanding < XBEE_LR_FRAG_WINDOW) && (frag->tx.nextOffset < frag->tx.length);
+    if (slot == NULL) {
+        if (!canGrow) {
+            return;  // Window full, waiting for the acknowledgement
+        }
+        uint16_t remaining = (uint16_t)(frag->tx.length - frag->tx.nextOffset);
+        seq = frag->tx.nextSeq;
+        slot = XBeeLRFragSlotOf(frag, seq);
+        slot->offset = frag->tx.nextOffset;
+        slot->length = (remaining < dataSize) ? (uint8_t)remaining : dataSize;
+        slot->needSend = true;
+        slot->acked = false;
+        frag->tx.nextSeq++;
+        frag->tx.nextOffset = (uint16_t)(frag->tx.nextOffset + slot->length);
+        outstanding++;
+        more = (outstanding < XBEE_LR_FRAG_WINDOW) && (frag->tx.nextOffset < frag->tx.length);
+    } else {
+        more = more || canGrow;
+    }
+
+    uint8_t flags = more ? 0 : XBEE_LR_FRAG_FLAG_ACK_REQUEST;
+    if ((uint32_t)slot->offset + slot->length == frag->tx.length) {
+        flags |= XBEE_LR_FRAG_FLAG_LAST;
+    }
+    frag->tx.buffer[0] = (uint8_t)(frag->tx.id << 4) | flags;
+    frag->tx.buffer[1] = seq;
+    frag->tx.buffer[2] = (uint8_t)(slot->offset >> 8);
+    frag->tx.buffer[3] = (uint8_t)(slot->offset & 0xFF);
+    memcpy(&frag->tx.buffer[XBEE_LR_FRAG_HEADER_SIZE], &frag->tx.data[slot->offset], slot->length);
+
+    XBeeLRPacket_t packet = {0};
+    packet.port = frag->port;
+    packet.payload = frag->tx.buffer;
+    packet.payloadSize = (uint8_t)(XBEE_LR_FRAG_HEADER_SIZE + slot->length);
+    if (!XBeeLRSchedEnqueue(frag->sched, &packet, (xbee_lr_priority_t)frag->priority, XBeeLRFragTxComplete, frag)) {
+        return;  // Scheduler queue full, retried on the next call
+    }
+    slot->needSend = false;
+    frag->tx.inFlight = true;
+    frag->tx.inFlightSeq = seq;
+    frag->tx.inFlightAckRequest = (flags & XBEE_LR_FRAG_FLAG_ACK_REQUEST) != 0;
+    if (frag->tx.inFlightAckRequest) {
+        frag->tx.awaitingAck = false;  // Restarted once this fragment is delivered
+    }
+}
+
+/**
+ * @brief Applies an acknowledgement of the uplink transfer received in a downlink.
+ * 
+ * Every fragment before the first missing one is complete. Of the later fragments, 
+ * those not in the bitmap are sent again.
+ */
+static void XBeeLRFragHandleAck(XBeeLRFrag* frag, const uint8_t* data, uint8_t length) {
+    if (!frag->tx.active || (length < XBEE_LR_FRAG_ACK_SIZE) || ((data[0] >> 4) != frag->tx.id)) {
+        return;  // Stale or foreign acknowledgement
+    }
+    uint8_t ackBase = data[1];
+    uint8_t bitmap = data[2];
+    uint8_t outstanding = (uint8_t)(frag->tx.nextSeq - frag->tx.baseSeq);
+    if ((uint8_t)(ackBase - frag->tx.baseSeq) > outstanding) {
+        return;  // Refers to fragments that were never sent
+    }
+
+    frag->tx.baseSeq = ackBase;
+    outstanding = (uint8_t)(frag->tx.nextSeq - ackBase);
+    for (uint8_t i = 0; i < outstanding; i++) {
+        uint8_t seq = (uint8_t)(ackBase + i);
+        XBeeLRFragSlot* slot = XBeeLRFragSlotOf(frag, seq);
+        if ((i > 0) && (bitmap & (1U << (i - 1)))) {
+            slot->acked = true;
+            slot->needSend = false;
+        } else if (!slot->acked && !(frag->tx.inFlight && (seq == frag->tx.inFlightSeq))) {
+            slot->needSend = true;
+        }
+    }
+    frag->tx.awaitingAck = false;
+    frag->tx.retries = 0;
+
+    if ((outstanding == 0) && (frag->tx.nextOffset >= frag->tx.length)) {
+        XBeeLRFragFinish(frag, true);
+    }
+}
+
+/**
+ * @brief Stores a fragment of a downlink transfer and advances the reassembly window.
+ */
+static void XBeeLRFragHandleFragment(XBeeLRFrag* frag, const uint8_t* data, uint8_t length) {
+    if ((frag->rx.buffer == NULL) || (length < XBEE_LR_FRAG_HEADER_SIZE)) {
+        return;
+    }
+    uint8_t id = data[0] >> 4;
+    uint8_t flags = data[0] & 0x0F;
+    uint8_t seq = data[1];
+    uint16_t offset = (uint16_t)((data[2] << 8) | data[3]);
+    uint8_t dataLength = (uint8_t)(length - XBEE_LR_FRAG_HEADER_SIZE);
+
+    if (!frag->rx.active || (id != frag->rx.id)) {
+        // A new transfer, the first fragment received need not be the first one sent
+        frag->rx.active = true;
+        frag->rx.complete = false;
+        frag->rx.id = id;
+        frag->rx.baseSeq = 0;
+        frag->rx.bitmap = 0;
+        frag->rx.lastKnown = false;
+        frag->rx.length = 0;
+    }
+
+    uint8_t distance = (uint8_t)(seq - frag->rx.baseSeq);
+    if (!frag->rx.complete && (distance <= 8)) {
+        if ((uint32_t)offset + dataLength > frag->rx.size) {
+            XBEEDebugPrint("Fragmented transfer %u does not fit the receive buffer\n", id);
+            frag->rx.active = false;
+            return;
+        }
+        memcpy(&frag->rx.buffer[offset], &data[XBEE_LR_FRAG_HEADER_SIZE], dataLength);
+        if (flags & XBEE_LR_FRAG_FLAG_LAST) {
+            frag->rx.lastSeq = seq;
+            frag->rx.lastKnown = true;
+            frag->rx.length = (uint16_t)(offset + dataLength);
+        }
+        if (distance == 0) {
+            frag->rx.baseSeq++;
+            while (frag->rx.bitmap & 0x01) {
+                frag->rx.bitmap >>= 1;
+                frag->rx.baseSeq++;
+            }
+            frag->rx.bitmap >>= 1;
+        } else {
+            frag->rx.bitmap |= (uint8_t)(1U << (distance - 1));
+        }
+
+        if (frag->rx.lastKnown && ((uint8_t)(frag->rx.lastSeq + 1) == frag->rx.baseSeq)) {
+            frag->rx.complete = true;
+            if (frag->rx.callback) {
+                frag->rx.callback(frag, frag->rx.buffer, frag->rx.length, frag->rx.ctx);
+            }
+        }
+    }
+    // Anything else is a duplicate, which still gets an acknowledgement if it asks for one
+
+    if (flags & XBEE_LR_FRAG_FLAG_ACK_REQUEST) {
+        frag->rx.ackWanted = true;
+    }
+    if (frag->rx.ackQueued || frag->rx.ackWanted) {
+        XBeeLRFragWriteAck(frag);  // An acknowledgement still in the scheduler goes out with the latest state
+    }
+}
+
+/**
+ * @brief Initializes a caller-owned fragmentation layer and attaches it to the scheduler's instance.
+ * 
+ * Downlinks on `port` are taken over by the layer from then on and are no longer passed 
+ * to `OnReceiveCallback`. The layer must outlive the instance, or be detached first.
+ * 
+ * @param[out] frag Pointer to the fragmentation layer to initialize.
+ * @param[in] sched Scheduler the fragments are sent through, bound to an XBee LR instance.
+ * @param[in] port LoRaWAN port of the fragments and acknowledgements, in both directions.
+ * @param[in] priority Scheduler priority of the fragments.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeLRFragInit(XBeeLRFrag* frag, XBeeLRScheduler* sched, uint8_t port, xbee_lr_priority_t priority) {
+    memset(frag, 0, sizeof(*frag));
+    frag->sched = sched;
+    frag->port = port;
+    frag->priority = (uint8_t)priority;
+    ((XBeeLR*)sched->xbee)->frag = frag;
+}
+
+/**
+ * @brief Detaches the fragmentation layer from its instance.
+ * 
+ * Downlinks on its port are passed to `OnReceiveCallback` again. Fragments and 
+ * acknowledgements still in the scheduler must have completed before the layer's 
+ * memory is reused.
+ * 
+ * @param[in] frag Pointer to the fragmentation layer.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeLRFragDetach(XBeeLRFrag* frag) {
+    XBeeLR* lr = (XBeeLR*)frag->sched->xbee;
+    if (lr->frag == frag) {
+        lr->frag = NULL;
+    }
+}
+
+/**
+ * @brief Sets the buffer downlink transfers are reassembled into.
+ * 
+ * @param[in] frag Pointer to the fragmentation layer.
+ * @param[in] buffer Reassembly buffer, or NULL to ignore downlink transfers.
+ * @param[in] size Size of the buffer, the largest downlink transfer accepted.
+ * @param[in] callback Called with the reassembled transfer, which stays in `buffer` until the next one starts.
+ * @param[in] ctx User pointer passed to the callback.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeLRFragSetReceiveBuffer(XBeeLRFrag* frag, uint8_t* buffer, uint16_t size, 
+    XBeeLRFragReceiveCallback callback, void* ctx) {
+    frag->rx.buffer = buffer;
+    frag->rx.size = size;
+    frag->rx.callback = callback;
+    frag->rx.ctx = ctx;
+    frag->rx.active = false;
+}
+
+/**
+ * @brief Starts an uplink transfer.
+ * 
+ * The data is not copied and must stay valid until the callback has been called. 
+ * The transfer makes progress in `XBeeLRFragProcess()`.
+ * 
+ * @param[in] frag Pointer to the fragmentation layer.
+ * @param[in] data Data to send.
+ * @param[in] length Length of the data, 1 to 65535 bytes.
+ * @param[in] callback Called once the receiver acknowledged every fragment or the transfer failed, may be NULL.
+ * @param[in] ctx User pointer passed to the callback.
+ * 
+ * @return bool Returns true if the transfer was started, false if one is already in progress.
+ */
+bool XBeeLRFragSend(XBeeLRFrag* frag, const uint8_t* data, uint16_t length, XBeeLRFragSentCallback callback, void* ctx) {
+    if (frag->tx.active || (data == NULL) || (length == 0)) {
+        return false;
+    }
+    frag->tx.data = data;
+    frag->tx.length = length;
+    frag->tx.nextOffset = 0;
+    frag->tx.id = (uint8_t)((frag->tx.id + 1) & 0x0F);
+    frag->tx.baseSeq = 0;
+    frag->tx.nextSeq = 0;
+    frag->tx.awaitingAck = false;
+    frag->tx.retries = 0;
+    frag->tx.callback = callback;
+    frag->tx.ctx = ctx;
+    frag->tx.active = true;
+    return true;
+}
+
+/**
+ * @brief Returns whether an uplink transfer is in progress.
+ * 
+ * @param[in] frag Pointer to the fragmentation layer.
+ * 
+ * @return bool Returns true from `XBeeLRFragSend()` until its callback has been called.
+ */
+bool XBeeLRFragSending(const XBeeLRFrag* frag) {
+    return frag->tx.active;
+}
+
+/**
+ * @brief Queues the next fragment or acknowledgement and handles acknowledgement timeouts.
+ * 
+ * Must be called from the application's main loop, after `XBeeProcess()` and before 
+ * `XBeeLRSchedProcess()`. When no acknowledgement arrives within 
+ * `XBEE_LR_FRAG_ACK_TIMEOUT_MS` the last fragment is sent again to request another one, 
+ * which also gives the network a new downlink opportunity.
+ * 
+ * @param[in] frag Pointer to the fragmentation layer.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeLRFragProcess(XBeeLRFrag* frag) {
+    XBee* xbee = frag->sched->xbee;
+
+    if (frag->rx.ackWanted && !frag->rx.ackQueued) {
+        XBeeLRPacket_t packet = {0};
+        packet.port = frag->port;
+        packet.payload = frag->rx.ack;
+        packet.payloadSize = XBEE_LR_FRAG_ACK_SIZE;
+        if (XBeeLRSchedEnqueue(frag->sched, &packet, (xbee_lr_priority_t)frag->priority, XBeeLRFragAckComplete, frag)) {
+            frag->rx.ackWanted = false;
+            frag->rx.ackQueued = true;
+        }
+    }
+
+    if (!frag->tx.active || frag->tx.inFlight) {
+        return;
+    }
+    if (frag->tx.awaitingAck) {
+        uint32_t now = xbee->htable->PortMillis(xbee->portContext);
+        if ((int32_t)(now - frag->tx.ackDeadline) < 0) {
+            return;
+        }
+        XBEEDebugPrint("No acknowledgement for fragmented transfer %u\n", frag->tx.id);
+        frag->tx.awaitingAck = false;
+        if (!XBeeLRFragRetry(frag) || (frag->tx.nextSeq == frag->tx.baseSeq)) {
+            return;
+        }
+        XBeeLRFragSlot* last = XBeeLRFragSlotOf(frag, (uint8_t)(frag->tx.nextSeq - 1));
+        if (!last->acked) {
+            last->needSend = true;
+        } else {
+            // Only earlier fragments are missing, send the first of them again
+            for (uint8_t seq = frag->tx.baseSeq; seq != frag->tx.nextSeq; seq++) {
+                XBeeLRFragSlot* slot = XBeeLRFragSlotOf(frag, seq);
+                if (!slot->acked) {
+                    slot->needSend = true;
+                    break;
+                }
+            }
+        }
+    }
+    XBeeLRFragQueueNext(frag);
+}
+
+/**
+ * @brief Returns the time until `XBeeLRFragProcess()` has work to do.
+ * 
+ * Use it as the limit of `XBeeWait()` together with `XBeeLRSchedNextDeadline()`.
+ * 
+ * @param[in] frag Pointer to the fragmentation layer.
+ * 
+ * @return uint32_t Milliseconds until the acknowledgement timeout, 0 if a fragment or 
+ * acknowledgement can be queued now, or `XBEE_WAIT_FOREVER` if the layer is idle or 
+ * waiting for a TX status.
+ */
+uint32_t XBeeLRFragNextDeadline(XBeeLRFrag* frag) {
+    if (frag->rx.ackWanted && !frag->rx.ackQueued) {
+        return 0;
+    }
+    if (!frag->tx.active || frag->tx.inFlight) {
+        return XBEE_WAIT_FOREVER;
+    }
+    if (!frag->tx.awaitingAck) {
+        return 0;
+    }
+    XBee* xbee = frag->sched->xbee;
+    int32_t remaining = (int32_t)(frag->tx.ackDeadline - xbee->htable->PortMillis(xbee->portContext));
+    return (remaining > 0) ? (uint32_t)remaining : 0;
+}
+
+/**
+ * @brief Takes a downlink on the layer's port, called by the XBee LR RX packet handler.
+ * 
+ * @param[in] frag Pointer to the fragmentation layer.
+ * @param[in] packet Received downlink.
+ * 
+ * @return bool Returns true if the downlink was on the layer's port and has been consumed.
+ */
+bool XBeeLRFragHandleRx(XBeeLRFrag* frag, const XBeeLRPacket_t* packet) {
+    if ((packet->port != frag->port) || (packet->payloadSize == 0)) {
+        return false;
+    }
+    if (packet->payload[0] & XBEE_LR_FRAG_FLAG_ACK) {
+        XBeeLRFragHandleAck(frag, packet->payload, packet->payloadSize);
+    } else {
+        XBeeLRFragHandleFragment(frag, packet->payload, packet->payloadSize);
+    }
+    return true;
+}
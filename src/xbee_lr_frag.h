@@ -0,0 +1,153 @@
+/**
+ * @file xbee_lr_frag.h
+ * @brief Fragmentation and reassembly of transfers larger than one LoRaWAN uplink.
+ * 
+ * A transfer of up to 65535 bytes is split into fragments that fill the payload the 
+ * current data rate allows, so fragments grow and shrink as ADR changes the DR. A 
+ * fragment to be sent again that no longer fits the DR is not cut down under its old 
+ * sequence number: the transfer continues with a new transfer ID from the first byte 
+ * not acknowledged yet, and the receiver keeps the bytes before it. Fragments are 
+ * released one at a time through the duty-cycle scheduler. Every window of up to 
+ * `XBEE_LR_FRAG_WINDOW` fragments ends with one that requests an acknowledgement; the 
+ * receiver answers with a bitmap of the fragments it holds and only the missing ones 
+ * are sent again. Downlink transfers sent the same way by the network are reassembled 
+ * into a caller-provided buffer and acknowledged with an uplink.
+ * 
+ * Every fragment starts with a 4-byte header:
+ *  - byte 0: transfer ID (bits 7-4), last fragment (bit 3), acknowledgement requested 
+ *    (bit 2), acknowledgement frame (bit 1)
+ *  - byte 1: fragment sequence number, counting from 0 for each transfer
+ *  - bytes 2-3: byte offset of the fragment data in the transfer, big-endian
+ * 
+ * An acknowledgement is 3 bytes: byte 0 holds the transfer ID and the acknowledgement 
+ * bit, byte 1 the sequence number of the first fragment still missing and byte 2 a 
+ * bitmap of the fragments received after it (bit i for sequence number byte 1 + 1 + i).
+ * 
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#ifndef XBEELR_FRAG_H
+#define XBEELR_FRAG_H
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#include "xbee_lr_sched.h"
+#include "config.h"
+
+// Fragment header and acknowledgement layout, see the file description
+#define XBEE_LR_FRAG_HEADER_SIZE 4
+#define XBEE_LR_FRAG_ACK_SIZE 3
+#define XBEE_LR_FRAG_FLAG_LAST 0x08
+#define XBEE_LR_FRAG_FLAG_ACK_REQUEST 0x04
+#define XBEE_LR_FRAG_FLAG_ACK 0x02
+
+typedef struct XBeeLRFrag_s XBeeLRFrag;
+
+/**
+ * @typedef XBeeLRFragSentCallback
+ * @brief Called once an uplink transfer was acknowledged completely, or has failed.
+ */
+typedef void (*XBeeLRFragSentCallback)(XBeeLRFrag* frag, bool success, void* ctx);
+
+/**
+ * @typedef XBeeLRFragReceiveCallback
+ * @brief Called when a downlink transfer has been reassembled.
+ */
+typedef void (*XBeeLRFragReceiveCallback)(XBeeLRFrag* frag, const uint8_t* data, uint16_t length, void* ctx);
+
+/**
+ * @brief Fragment of the uplink window.
+ */
+typedef struct {
+    uint16_t offset;              ///< Byte offset of the fragment data in the transfer
+    uint8_t length;               ///< Data bytes, kept when the fragment is sent again at a DR it still fits
+    bool needSend;                ///< Not sent yet, or reported missing by the receiver
+    bool acked;                   ///< Acknowledged by the receiver
+} XBeeLRFragSlot;
+
+/**
+ * @brief Caller-owned fragmentation layer bound to one scheduler and one LoRaWAN port.
+ */
+struct XBeeLRFrag_s {
+    XBeeLRScheduler* sched;       ///< Scheduler the fragments and acknowledgements are queued in
+    uint8_t port;                 ///< LoRaWAN port used in both directions
+    uint8_t priority;             ///< xbee_lr_priority_t of the fragments
+    struct {
+        const uint8_t* data;      ///< Transfer being sent, owned by the caller
+        uint16_t length;          ///< Length of the transfer
+        uint16_t nextOffset;      ///< Offset of the first byte not yet in a fragment
+        uint8_t id;               ///< Transfer ID, incremented for every transfer
+        uint8_t baseSeq;          ///< Oldest fragment not acknowledged
+        uint8_t nextSeq;          ///< Sequence number of the next new fragment
+        XBeeLRFragSlot slots[XBEE_LR_FRAG_WINDOW]; ///< Window, indexed by sequence number
+        bool active;              ///< A transfer is in progress
+        bool inFlight;            ///< A fragment is in the scheduler
+        uint8_t inFlightSeq;      ///< Sequence number of that fragment
+        bool inFlightAckRequest;  ///< That fragment requests an acknowledgement
+        bool awaitingAck;         ///< Waiting for the acknowledgement until ackDeadline
+        uint32_t ackDeadline;     ///< PortMillis() time the acknowledgement is given up on
+        uint8_t retries;          ///< Timeouts and failed uplinks since the last acknowledgement
+        XBeeLRFragSentCallback callback;
+        void* ctx;
+        uint8_t buffer[XBEE_LR_FRAG_MAX_PAYLOAD]; ///< Fragment in the scheduler, header included
+    } tx;
+    struct {
+        uint8_t* buffer;          ///< Reassembly buffer, NULL to ignore downlink transfers
+        uint16_t size;            ///< Size of the buffer
+        uint16_t length;          ///< Length of the transfer, known once the last fragment arrived
+        uint8_t id;               ///< Transfer ID being reassembled
+        uint8_t baseSeq;          ///< First fragment still missing
+        uint8_t bitmap;           ///< Fragments received after baseSeq
+        uint8_t lastSeq;          ///< Sequence number of the last fragment
+        bool lastKnown;           ///< The last fragment has been received
+        bool active;              ///< A transfer is being reassembled
+        bool complete;            ///< The transfer was delivered, duplicates are only acknowledged
+        bool ackWanted;           ///< An acknowledgement must be queued
+        bool ackQueued;           ///< The acknowledgement is in the scheduler
+        uint8_t ack[XBEE_LR_FRAG_ACK_SIZE]; ///< Acknowledgement in the scheduler, updated until it is sent
+        XBeeLRFragReceiveCallback callback;
+        void* ctx;
+    } rx;
+};
+
+void XBeeLRFragInit(XBeeLRFrag* frag, XBeeLRScheduler* sched, uint8_t port, xbee_lr_priority_t priority);
+void XBeeLRFragDetach(XBeeLRFrag* frag);
+void XBeeLRFragSetReceiveBuffer(XBeeLRFrag* frag, uint8_t* buffer, uint16_t size, 
+    XBeeLRFragReceiveCallback callback, void* ctx);
+bool XBeeLRFragSend(XBeeLRFrag* frag, const uint8_t* data, uint16_t length, XBeeLRFragSentCallback callback, void* ctx);
+bool XBeeLRFragSending(const XBeeLRFrag* frag);
+void XBeeLRFragProcess(XBeeLRFrag* frag);
+uint32_t XBeeLRFragNextDeadline(XBeeLRFrag* frag);
+bool XBeeLRFragHandleRx(XBeeLRFrag* frag, const XBeeLRPacket_t* packet);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEELR_FRAG_H
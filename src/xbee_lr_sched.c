@@ -0,0 +1,318 @@
+/**
+ * @file xbee_lr_sched.c
+ * @brief Duty-cycle aware uplink scheduler for the XBee LR (LoRaWAN) subclass.
+ * 
+ * Uplinks are queued by priority and released one at a time through 
+ * `XBeeLRSendDataAsync()`. When the TX status of an uplink arrives, its estimated 
+ * airtime is charged to the sub-band of the reported channel, which then stays closed 
+ * for the off-time its duty cycle requires. The next uplink is released as soon as any 
+ * sub-band in use is open again, instead of being rejected or delayed by the module.
+ * 
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_lr_sched.h"
+#include "xbee_lr_airtime.h"
+#include "xbee_api_frames.h"
+#include <string.h>
+
+/**
+ * @brief Returns the time on air of a queued uplink at the current data rate.
+ * 
+ * Falls back to the slowest EU868 data rate when the region or data rate is unknown, 
+ * so the off-time is never underestimated.
+ */
+static uint32_t XBeeLRSchedAirtimeMs(XBeeLRScheduler* sched, const XBeeLRPacket_t* packet) {
+    uint32_t airtimeMs = XBeeLRGetPacketAirtime(sched->xbee, packet);
+    if (airtimeMs == 0) {
+        airtimeMs = XBeeLRPayloadAirtimeMs(XBEE_LR_REGION_EU868, 0, packet->payloadSize);
+    }
+    return airtimeMs;
+}
+
+/**
+ * @brief Returns the sub-band a channel is accounted against.
+ */
+static uint8_t XBeeLRSchedSubBand(const XBeeLRScheduler* sched, uint8_t channel) {
+    uint8_t subBand = channel / sched->policy.channelsPerSubBand;
+    if (subBand >= sched->policy.subBandCount) {
+        subBand = sched->policy.subBandCount - 1;
+    }
+    return subBand;
+}
+
+/**
+ * @brief Closes a sub-band for the off-time required after an uplink.
+ */
+static void XBeeLRSchedCharge(XBeeLRScheduler* sched, uint8_t subBand, uint32_t airtimeMs, uint32_t now) {
+    uint16_t divisor = sched->policy.dutyCycleDivisor[subBand];
+    if (divisor > 1) {
+        sched->subBandFreeAt[subBand] = now + airtimeMs * (uint32_t)(divisor - 1);
+    }
+}
+
+/**
+ * @brief TX completion of an uplink released by the scheduler.
+ * 
+ * Charges the uplink's airtime, frees its queue entry and forwards the result to the 
+ * callback given to `XBeeLRSchedEnqueue()`.
+ */
+static void XBeeLRSchedComplete(XBee* self, uint8_t frameId, uint8_t status, const void* report, void* ctx) {
+    XBeeLRScheduler* sched = (XBeeLRScheduler*)ctx;
+    uint32_t now = self->htable->PortMillis(self->portContext);
+
+    for (uint8_t i = 0; i < XBEE_LR_SCHED_QUEUE_SIZE; i++) {
+        XBeeLRSchedEntry* entry = &sched->queue[i];
+        if (!entry->used || (entry->frameId != frameId)) {
+            continue;
+        }
+
+        // The TX status handler has already updated the instance's DR from the report
+        const XBeeLRPacket_t* packet = (const XBeeLRPacket_t*)report;
+        uint32_t airtimeMs = XBeeLRSchedAirtimeMs(sched, &entry->packet);
+        if (packet != NULL) {
+            XBeeLRSchedCharge(sched, XBeeLRSchedSubBand(sched, packet->channel), airtimeMs, now);
+        } else {
+            // No status: the channel used is unknown, so charge every sub-band
+            for (uint8_t band = 0; band < sched->policy.subBandCount; band++) {
+                XBeeLRSchedCharge(sched, band, airtimeMs, now);
+            }
+        }
+
+        XBeeTxCompleteCallback callback = entry->callback;
+        void* userCtx = entry->ctx;
+        entry->used = false;
+        entry->frameId = 0;
+        if (sched->inFlight > 0) {
+            sched->inFlight--;
+        }
+        if (callback) {
+            callback(self, frameId, status, report, userCtx);
+        }
+        return;
+    }
+}
+
+/**
+ * @brief Initializes a caller-owned uplink scheduler.
+ * 
+ * @param[out] sched Pointer to the scheduler to initialize.
+ * @param[in] xbee XBee LR instance the uplinks are sent through.
+ * @param[in] policy Duty cycle policy, or NULL for one sub-band at 1/`XBEE_LR_SCHED_DUTY_CYCLE_DIVISOR`.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeLRSchedInit(XBeeLRScheduler* sched, XBee* xbee, const XBeeLRSchedPolicy* policy) {
+    memset(sched, 0, sizeof(*sched));
+    sched->xbee = xbee;
+    if (policy != NULL) {
+        sched->policy = *policy;
+    } else {
+        sched->policy.channelsPerSubBand = XBEE_LR_SCHED_CHANNELS_PER_SUBBAND;
+        sched->policy.subBandCount = 1;
+        sched->policy.dutyCycleDivisor[0] = XBEE_LR_SCHED_DUTY_CYCLE_DIVISOR;
+    }
+    if (sched->policy.channelsPerSubBand == 0) {
+        sched->policy.channelsPerSubBand = 1;
+    }
+    if ((sched->policy.subBandCount == 0) || (sched->policy.subBandCount > XBEE_LR_SCHED_SUBBANDS)) {
+        sched->policy.subBandCount = (sched->policy.subBandCount == 0) ? 1 : XBEE_LR_SCHED_SUBBANDS;
+    }
+    uint32_t now = xbee->htable->PortMillis(xbee->portContext);
+    for (uint8_t i = 0; i < XBEE_LR_SCHED_SUBBANDS; i++) {
+        sched->subBandFreeAt[i] = now;
+    }
+}
+
+/**
+ * @brief Queues an uplink for release by `XBeeLRSchedProcess()`.
+ * 
+ * The packet is copied, but its payload is not: the payload buffer must stay valid 
+ * until the completion callback has been called.
+ * 
+ * @param[in] sched Pointer to the scheduler.
+ * @param[in] packet Packet to send.
+ * @param[in] priority Priority of the packet.
+ * @param[in] callback Completion callback, called with the TX status, may be NULL.
+ * @param[in] ctx User pointer passed to the callback.
+ * 
+ * @return bool Returns true if the packet was queued, false if the queue is full.
+ */
+bool XBeeLRSchedEnqueue(XBeeLRScheduler* sched, const XBeeLRPacket_t* packet, xbee_lr_priority_t priority, 
+    XBeeTxCompleteCallback callback, void* ctx) {
+    for (uint8_t i = 0; i < XBEE_LR_SCHED_QUEUE_SIZE; i++) {
+        XBeeLRSchedEntry* entry = &sched->queue[i];
+        if (entry->used) {
+            continue;
+        }
+        entry->packet = *packet;
+        entry->callback = callback;
+        entry->ctx = ctx;
+        entry->priority = (uint8_t)priority;
+        entry->sequence = sched->nextSequence++;
+        entry->frameId = 0;
+        entry->used = true;
+        return true;
+    }
+    XBEEDebugPrint("Uplink queue full\n");
+    return false;
+}
+
+/**
+ * @brief Checks the join state tracked from modem status frames, without asking the module.
+ * 
+ * A join state not known yet does not hold uplinks back: the TX status of the first one 
+ * tells whether the module is joined.
+ */
+static bool XBeeLRSchedMayRelease(XBeeLRScheduler* sched) {
+    XBeeLR* lr = (XBeeLR*)sched->xbee;
+    return !lr->joinStateKnown || (lr->joinState == XBEE_LR_JOIN_JOINED);
+}
+
+/**
+ * @brief Returns the earliest PortMillis() time at which the next uplink may be released.
+ * 
+ * @param[in] sched Pointer to the scheduler.
+ * 
+ * @return uint32_t The current time if a sub-band is open, otherwise the time the first one opens.
+ */
+uint32_t XBeeLRSchedNextRelease(XBeeLRScheduler* sched) {
+    uint32_t now = sched->xbee->htable->PortMillis(sched->xbee->portContext);
+    uint32_t earliest = 0;
+    bool found = false;
+
+    for (uint8_t i = 0; i < sched->policy.subBandCount; i++) {
+        int32_t wait = (int32_t)(sched->subBandFreeAt[i] - now);
+        if ((wait <= 0) || (sched->policy.dutyCycleDivisor[i] <= 1)) {
+            return now;
+        }
+        if (!found || ((int32_t)(sched->subBandFreeAt[i] - earliest) < 0)) {
+            earliest = sched->subBandFreeAt[i];
+            found = true;
+        }
+    }
+    return found ? earliest : now;
+}
+
+/**
+ * @brief Returns the time until `XBeeLRSchedProcess()` can release the next uplink.
+ * 
+ * Use it as the limit of `XBeeWait()` so a sleeping loop wakes up when a sub-band opens. 
+ * While an uplink is in flight its TX status deadline is covered by `XBeeNextDeadline()`.
+ * 
+ * @param[in] sched Pointer to the scheduler.
+ * 
+ * @return uint32_t Milliseconds until the next release, 0 if one is possible now, or 
+ * `XBEE_WAIT_FOREVER` if nothing is queued, an uplink is in flight or the module is not 
+ * joined (the joined modem status ends the wait).
+ */
+uint32_t XBeeLRSchedNextDeadline(XBeeLRScheduler* sched) {
+    if ((sched->inFlight > 0) || (XBeeLRSchedPending(sched) == 0) || !XBeeLRSchedMayRelease(sched)) {
+        return XBEE_WAIT_FOREVER;
+    }
+    uint32_t now = sched->xbee->htable->PortMillis(sched->xbee->portContext);
+    int32_t remaining = (int32_t)(XBeeLRSchedNextRelease(sched) - now);
+    return (remaining > 0) ? (uint32_t)remaining : 0;
+}
+
+/**
+ * @brief Releases the highest priority queued uplink if the duty cycle allows it.
+ * 
+ * Must be called from the application's main loop, after `XBeeProcess()`. It never 
+ * blocks: uplinks are held while the module is known not to be joined, from the join 
+ * state kept by the modem status handler. Only one uplink is in flight at a time; the 
+ * next one is released once its TX status arrived and a sub-band is open. Packets of the same priority are sent in the order they were 
+ * queued. An uplink larger than the current DR allows is not sent; its callback gets 
+ * `XBEE_LR_TX_STATUS_PAYLOAD_TOO_LARGE` with frame ID 0 and no report.
+ * 
+ * @param[in] sched Pointer to the scheduler.
+ * 
+ * @return void This function does not return a value.
+ */
+void XBeeLRSchedProcess(XBeeLRScheduler* sched) {
+    if (sched->inFlight > 0) {
+        return;
+    }
+
+    XBeeLRSchedEntry* next = NULL;
+    for (uint8_t i = 0; i < XBEE_LR_SCHED_QUEUE_SIZE; i++) {
+        XBeeLRSchedEntry* entry = &sched->queue[i];
+        if (!entry->used || (entry->frameId != 0)) {
+            continue;
+        }
+        if ((next == NULL) || (entry->priority < next->priority) || ((entry->priority == next->priority) &&
+            ((uint16_t)(sched->nextSequence - entry->sequence) > (uint16_t)(sched->nextSequence - next->sequence)))) {
+            next = entry;
+        }
+    }
+    if (next == NULL) {
+        return;
+    }
+
+    // Queued before ADR lowered the DR: XBeeLRSendDataAsync() would refuse it forever
+    uint8_t maxPayload = XBeeLRGetMaxPayload(sched->xbee);
+    if ((maxPayload != 0) && (next->packet.payloadSize > maxPayload)) {
+        XBeeTxCompleteCallback callback = next->callback;
+        void* userCtx = next->ctx;
+        next->used = false;
+        if (callback) {
+            callback(sched->xbee, 0, XBEE_LR_TX_STATUS_PAYLOAD_TOO_LARGE, NULL, userCtx);
+        }
+        return;
+    }
+
+    uint32_t now = sched->xbee->htable->PortMillis(sched->xbee->portContext);
+    if ((int32_t)(XBeeLRSchedNextRelease(sched) - now) > 0) {
+        return;  // Every sub-band is still in its off-time
+    }
+    if (!XBeeLRSchedMayRelease(sched)) {
+        return;
+    }
+
+    uint8_t frameId = XBeeLRSendDataAsync(sched->xbee, &next->packet, XBeeLRSchedComplete, sched);
+    if (frameId == 0) {
+        return;  // TX table full or UART failure, retried on the next call
+    }
+    next->frameId = frameId;
+    sched->inFlight++;
+}
+
+/**
+ * @brief Returns the number of uplinks queued or in flight.
+ * 
+ * @param[in] sched Pointer to the scheduler.
+ * 
+ * @return uint8_t The number of used queue entries.
+ */
+uint8_t XBeeLRSchedPending(const XBeeLRScheduler* sched) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < XBEE_LR_SCHED_QUEUE_SIZE; i++) {
+        if (sched->queue[i].used) {
+            count++;
+        }
+    }
+    return count;
+}
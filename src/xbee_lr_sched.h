@@ -0,0 +1,109 @@
+/**
+ * @file xbee_lr_sched.h
+ * @brief Duty-cycle aware uplink scheduler for the XBee LR (LoRaWAN) subclass.
+ * 
+ * The scheduler holds a bounded priority queue of uplinks and releases them through 
+ * `XBeeLRSendDataAsync()` at the earliest time the regional duty cycle allows. Airtime 
+ * used per sub-band is accounted from the DR and channel reported in the explicit TX 
+ * status frame (0xD2) of every uplink, using the calculator in xbee_lr_airtime.h.
+ * 
+ * @version 1.0
+ * @date 2024-08-08
+ * 
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#ifndef XBEELR_SCHED_H
+#define XBEELR_SCHED_H
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#include "xbee_lr.h"
+#include "config.h"
+
+/**
+ * @enum xbee_lr_priority_t
+ * @brief Uplink priority, lower values are sent first.
+ */
+typedef enum {
+    XBEE_LR_PRIORITY_ALARM = 0,      ///< Alarms, sent before anything else
+    XBEE_LR_PRIORITY_TELEMETRY,      ///< Periodic telemetry
+    XBEE_LR_PRIORITY_BULK            ///< Bulk transfers, sent when nothing else is waiting
+} xbee_lr_priority_t;
+
+/**
+ * @brief Duty cycle policy of the scheduler.
+ *
+ * Sub-band `channel / channelsPerSubBand` is charged for every uplink. After an uplink 
+ * of airtime T the sub-band stays closed for `T * (dutyCycleDivisor - 1)`, so a divisor 
+ * of 100 limits it to 1% duty cycle. A divisor of 0 disables the limit (e.g. US915). 
+ * The module picks the channel of each uplink, so one is released as soon as any of 
+ * the `subBandCount` sub-bands in use is open.
+ */
+typedef struct {
+    uint8_t channelsPerSubBand;                          ///< Channels that share one budget, at least 1
+    uint8_t subBandCount;                                ///< Sub-bands the enabled channels map to, 1 to XBEE_LR_SCHED_SUBBANDS
+    uint16_t dutyCycleDivisor[XBEE_LR_SCHED_SUBBANDS];   ///< Duty cycle of each sub-band as 1/divisor
+} XBeeLRSchedPolicy;
+
+/**
+ * @brief Uplink waiting in, or sent from, the scheduler queue.
+ */
+typedef struct {
+    XBeeLRPacket_t packet;            ///< Packet to send, the payload stays owned by the caller
+    XBeeTxCompleteCallback callback;  ///< Completion callback, may be NULL
+    void* ctx;                        ///< User pointer passed to the callback
+    uint16_t sequence;                ///< Enqueue order, keeps packets of one priority FIFO
+    uint8_t priority;                 ///< xbee_lr_priority_t
+    uint8_t frameId;                  ///< Frame ID once sent, 0 while queued
+    bool used;                        ///< Entry holds a packet
+} XBeeLRSchedEntry;
+
+/**
+ * @brief Caller-owned uplink scheduler bound to one XBee LR instance.
+ */
+typedef struct {
+    XBee* xbee;                                          ///< Instance the uplinks are sent through
+    XBeeLRSchedPolicy policy;                            ///< Duty cycle policy
+    XBeeLRSchedEntry queue[XBEE_LR_SCHED_QUEUE_SIZE];    ///< Queued and in-flight uplinks
+    uint32_t subBandFreeAt[XBEE_LR_SCHED_SUBBANDS];      ///< PortMillis() time each sub-band opens again
+    uint16_t nextSequence;                               ///< Sequence given to the next enqueued packet
+    uint8_t inFlight;                                    ///< Uplinks sent and waiting for their TX status
+} XBeeLRScheduler;
+
+void XBeeLRSchedInit(XBeeLRScheduler* sched, XBee* xbee, const XBeeLRSchedPolicy* policy);
+bool XBeeLRSchedEnqueue(XBeeLRScheduler* sched, const XBeeLRPacket_t* packet, xbee_lr_priority_t priority, 
+    XBeeTxCompleteCallback callback, void* ctx);
+void XBeeLRSchedProcess(XBeeLRScheduler* sched);
+uint32_t XBeeLRSchedNextRelease(XBeeLRScheduler* sched);
+uint32_t XBeeLRSchedNextDeadline(XBeeLRScheduler* sched);
+uint8_t XBeeLRSchedPending(const XBeeLRScheduler* sched);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEELR_SCHED_H
@@ -0,0 +1,264 @@
+/**
+ * @file xbee_trace.c
+ * @brief Binary trace of frame layer events, recorded into a RAM ring and formatted later.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#include "xbee_trace.h"
+#include <stdio.h>
+#include <string.h>
+
+// Orders the record stores before the head update that publishes them, for readers on another core
+#if defined(__GNUC__)
+#define XBEE_TRACE_BARRIER() __sync_synchronize()
+#else
+#define XBEE_TRACE_BARRIER()
+#endif
+
+/**
+ * @brief Initializes a trace ring over caller provided record storage.
+ *
+ * @param[out] trace Pointer to the ring to initialize.
+ * @param[in] records Storage for the records, must stay valid while the ring is attached.
+ * @param[in] count Number of records, must be a power of two no larger than 32768.
+ *
+ * @return bool Returns true if the ring was initialized, false if the count is invalid.
+ */
+bool XBeeTraceInit(XBeeTrace* trace, XBeeTraceRecord* records, uint16_t count) {
+    if ((trace == NULL) || (records == NULL) || (count < 2) || (count > 32768) || (count & (count - 1))) {
+        return false;
+    }
+    trace->records = records;
+    trace->mask = count - 1;
+    trace->head = 0;
+    trace->tail = 0;
+    trace->lost = 0;
+    return true;
+}
+
+/**
+ * @brief Starts or stops recording the events of an XBee instance.
+ *
+ * Several instances may share one ring if they are processed from the same context.
+ *
+ * @param[in] self Pointer to the XBee instance.
+ * @param[in] trace Pointer to an initialized ring, or NULL to stop tracing.
+ *
+ * @return bool Returns true if the ring was attached, false if tracing is compiled out.
+ */
+bool XBeeAttachTrace(XBee* self, XBeeTrace* trace) {
+#if XBEE_TRACE_ENABLED
+    self->trace = trace;
+    return true;
+#else
+    (void)self;
+    (void)trace;
+    return false;
+#endif
+}
+
+/**
+ * @brief Appends a record to the instance's trace ring, overwriting the oldest one when full.
+ *
+ * Called by the library's trace points through `XBEETraceEvent()`; applications can record
+ * their own events from `XBEE_TRACE_USER` on, from the same context as the library.
+ *
+ * @param[in] self Pointer to the XBee instance, nothing is recorded if no ring is attached.
+ * @param[in] event Event, an `xbee_trace_event_t`.
+ * @param[in] frameType API frame type, 0 if none.
+ * @param[in] frameId Frame ID, 0 if none.
+ * @param[in] status Event specific status.
+ * @param[in] arg1 Event specific argument.
+ * @param[in] arg2 Event specific argument.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeTraceWrite(XBee* self, uint8_t event, uint8_t frameType, uint8_t frameId, uint8_t status, uint16_t arg1, uint32_t arg2) {
+    XBeeTrace *trace = self->trace;
+    if (trace == NULL) {
+        return;
+    }
+
+    uint32_t head = trace->head;
+    XBeeTraceRecord *record = &trace->records[head & trace->mask];
+    record->timestamp = XBeeStatsTimestamp(self);
+    record->event = event;
+    record->frameType = frameType;
+    record->frameId = frameId;
+    record->status = status;
+    record->arg1 = arg1;
+    record->arg2 = arg2;
+    XBEE_TRACE_BARRIER();
+    trace->head = head + 1;
+}
+
+/**
+ * @brief Copies the oldest unread records out of the ring.
+ *
+ * Records the writer has overwritten, or may be overwriting, are skipped and counted in
+ * `trace->lost`, so a full ring returns at most its size - 1 newest records.
+ *
+ * @param[in,out] trace Pointer to the ring.
+ * @param[out] records Receives the records, oldest first.
+ * @param[in] maxRecords Number of records `records` can hold.
+ *
+ * @return uint16_t Number of records copied, 0 if there are none.
+ */
+uint16_t XBeeTraceRead(XBeeTrace* trace, XBeeTraceRecord* records, uint16_t maxRecords) {
+    uint16_t count = 0;
+    while (count < maxRecords) {
+        uint32_t head = trace->head;
+        if (head - trace->tail > trace->mask) {
+            // The writer has wrapped onto the oldest unread record, continue after the one it writes next
+            trace->lost += head - trace->tail - trace->mask;
+            trace->tail = head - trace->mask;
+        }
+        if (trace->tail == head) {
+            break;
+        }
+
+        XBEE_TRACE_BARRIER();
+        records[count] = trace->records[trace->tail & trace->mask];
+        XBEE_TRACE_BARRIER();
+        if (trace->head - trace->tail > trace->mask) {
+            continue; // Overwritten while it was copied, dropped by the check above
+        }
+        trace->tail++;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Drops every unread record and clears the lost counter.
+ *
+ * @param[in,out] trace Pointer to the ring.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeTraceClear(XBeeTrace* trace) {
+    trace->tail = trace->head;
+    trace->lost = 0;
+}
+
+/**
+ * @brief Serializes a record into its `XBEE_TRACE_RECORD_SIZE` byte little-endian form.
+ *
+ * @param[in] record Record to encode.
+ * @param[out] out Receives `XBEE_TRACE_RECORD_SIZE` bytes.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeTraceEncode(const XBeeTraceRecord* record, uint8_t* out) {
+    for (uint8_t i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(record->timestamp >> (8 * i));
+        out[12 + i] = (uint8_t)(record->arg2 >> (8 * i));
+    }
+    out[4] = record->event;
+    out[5] = record->frameType;
+    out[6] = record->frameId;
+    out[7] = record->status;
+    out[8] = (uint8_t)record->arg1;
+    out[9] = (uint8_t)(record->arg1 >> 8);
+    out[10] = 0;
+    out[11] = 0;
+}
+
+/**
+ * @brief Parses a record serialized by `XBeeTraceEncode()`.
+ *
+ * @param[in] in `XBEE_TRACE_RECORD_SIZE` encoded bytes.
+ * @param[out] record Receives the record.
+ *
+ * @return void This function does not return a value.
+ */
+void XBeeTraceDecode(const uint8_t* in, XBeeTraceRecord* record) {
+    record->timestamp = 0;
+    record->arg2 = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        record->timestamp |= (uint32_t)in[i] << (8 * i);
+        record->arg2 |= (uint32_t)in[12 + i] << (8 * i);
+    }
+    record->event = in[4];
+    record->frameType = in[5];
+    record->frameId = in[6];
+    record->status = in[7];
+    record->arg1 = (uint16_t)(in[8] | (in[9] << 8));
+}
+
+/**
+ * @brief Formats a record as one line of text, without a line ending.
+ *
+ * @param[in] record Record to format.
+ * @param[out] buffer Receives the text, always terminated.
+ * @param[in] size Size of `buffer`, 80 bytes hold any record.
+ *
+ * @return int Length of the full line, as returned by snprintf().
+ */
+int XBeeTraceFormat(const XBeeTraceRecord* record, char* buffer, size_t size) {
+    unsigned long time = (unsigned long)record->timestamp;
+    unsigned type = record->frameType;
+    unsigned id = record->frameId;
+    unsigned status = record->status;
+    unsigned arg1 = record->arg1;
+    unsigned long arg2 = (unsigned long)record->arg2;
+    char high = (char)XBEE_AT_CHAR_HIGH(record->arg1);
+    char low = (char)XBEE_AT_CHAR_LOW(record->arg1);
+
+    switch (record->event) {
+        case XBEE_TRACE_FRAME_RX:
+            return snprintf(buffer, size, "%10lu rx        type 0x%02X id %3u len %u%s", time, type, id, arg1,
+                status ? " unhandled" : "");
+        case XBEE_TRACE_FRAME_TX:
+            if (status) {
+                return snprintf(buffer, size, "%10lu tx        type 0x%02X id %3u len %u error -%u", time, type, id, arg1, status);
+            }
+            return snprintf(buffer, size, "%10lu tx        type 0x%02X id %3u len %u", time, type, id, arg1);
+        case XBEE_TRACE_CHECKSUM_ERROR:
+            return snprintf(buffer, size, "%10lu checksum  len %u", time, arg1);
+        case XBEE_TRACE_FRAME_TOO_LARGE:
+            return snprintf(buffer, size, "%10lu too large len %u", time, arg1);
+        case XBEE_TRACE_RX_TIMEOUT:
+            return snprintf(buffer, size, "%10lu rx timeout after %u bytes", time, arg1);
+        case XBEE_TRACE_RESYNC:
+            return snprintf(buffer, size, "%10lu resync    skipped %u bytes", time, arg1);
+        case XBEE_TRACE_UART_ERROR:
+            return snprintf(buffer, size, "%10lu uart error", time);
+        case XBEE_TRACE_AT_RESPONSE:
+            return snprintf(buffer, size, "%10lu at        type 0x%02X id %3u %c%c status %u latency %lu", time, type, id,
+                high, low, status, arg2);
+        case XBEE_TRACE_AT_TIMEOUT:
+            return snprintf(buffer, size, "%10lu at        id %3u %c%c timeout", time, id, high, low);
+        case XBEE_TRACE_TX_STATUS:
+            return snprintf(buffer, size, "%10lu tx status id %3u status 0x%02X latency %lu", time, id, status, arg2);
+        case XBEE_TRACE_TX_TIMEOUT:
+            return snprintf(buffer, size, "%10lu tx status id %3u timeout", time, id);
+        default:
+            return snprintf(buffer, size, "%10lu event 0x%02X type 0x%02X id %3u status 0x%02X arg1 %u arg2 %lu", time,
+                (unsigned)record->event, type, id, status, arg1, arg2);
+    }
+}
@@ -0,0 +1,133 @@
+/**
+ * @file xbee_trace.h
+ * @brief Binary trace of frame layer events, recorded into a RAM ring and formatted later.
+ *
+ * Trace points in the frame parser, the frame sender and the AT and TX transaction tables
+ * write fixed-size records (timestamp, event, frame type, frame ID and two arguments) into a
+ * caller-owned ring attached with `XBeeAttachTrace()`. Writing a record is a handful of stores,
+ * with no formatting and no I/O, so tracing can stay on in production builds without
+ * changing the timing it is meant to observe. With no ring attached a trace point costs
+ * one NULL check; with `XBEE_TRACE_ENABLED` set to 0 in config.h it is compiled out.
+ *
+ * Records are read back with `XBeeTraceRead()` and either formatted on the device with
+ * `XBeeTraceFormat()` or sent out in the `XBEE_TRACE_RECORD_SIZE` byte little-endian form of
+ * `XBeeTraceEncode()` and decoded on a host, e.g. with `extras/host/xbee_trace_decode`:
+ *
+ *   offset 0: timestamp (4 bytes), 4: event, 5: frame type, 6: frame ID, 7: status,
+ *   offset 8: arg1 (2 bytes), 10: reserved (2 bytes), 12: arg2 (4 bytes)
+ *
+ * The ring has a single writer, the context that calls `XBeeProcess()` and the send functions.
+ * It may be read from another task or interrupt: the writer never waits, the oldest records
+ * are overwritten when the reader falls behind and are counted in `lost`.
+ *
+ * @version 1.0
+ * @date 2024-08-08
+ *
+ * @license MIT
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @author Felix Galindo
+ * @contact felix.galindo@digi.com
+ */
+
+#ifndef XBEE_TRACE_H
+#define XBEE_TRACE_H
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#include "xbee.h"
+#include "config.h"
+#include <stddef.h>
+
+// Size of an encoded record, see XBeeTraceEncode()
+#define XBEE_TRACE_RECORD_SIZE 16
+
+/**
+ * @brief Traced events, with the meaning of the record fields for each.
+ */
+typedef enum {
+    XBEE_TRACE_FRAME_RX = 1,        ///< Frame received: frame type, frame ID (first data byte), status 1 if no handler, arg1 length with the type
+    XBEE_TRACE_FRAME_TX,            ///< Frame sent: frame type, frame ID (first data byte), status -API_SEND_* on failure, arg1 length with the type
+    XBEE_TRACE_CHECKSUM_ERROR,      ///< Frame dropped for its checksum: arg1 length
+    XBEE_TRACE_FRAME_TOO_LARGE,     ///< Frame dropped for its length: arg1 length
+    XBEE_TRACE_RX_TIMEOUT,          ///< Module stopped sending in the middle of a frame: status parser state, arg1 data bytes received
+    XBEE_TRACE_RESYNC,              ///< Bytes skipped while looking for a start delimiter: arg1 bytes skipped, saturated at 0xFFFF
+    XBEE_TRACE_UART_ERROR,          ///< PortUartRead() reported an error
+    XBEE_TRACE_AT_RESPONSE,         ///< AT request completed: frame type of the response, frame ID, status command status, arg1 AT command, arg2 latency
+    XBEE_TRACE_AT_TIMEOUT,          ///< AT request timed out: frame ID, arg1 AT command
+    XBEE_TRACE_TX_STATUS,           ///< TX table entry completed: frame ID, status delivery status, arg2 latency
+    XBEE_TRACE_TX_TIMEOUT,          ///< TX table entry timed out: frame ID
+    XBEE_TRACE_USER = 0x80,         ///< First event free for application trace points
+} xbee_trace_event_t;
+
+/**
+ * @brief One trace record. Latencies are in `XBeeStatsTimestamp()` units, like the timestamp.
+ */
+typedef struct {
+    uint32_t timestamp;           ///< XBeeStatsTimestamp() when the event was recorded
+    uint8_t event;                ///< xbee_trace_event_t
+    uint8_t frameType;            ///< API frame type, 0 if none
+    uint8_t frameId;              ///< Frame ID, 0 if none
+    uint8_t status;               ///< Event specific status
+    uint16_t arg1;                ///< Event specific argument
+    uint32_t arg2;                ///< Event specific argument
+} XBeeTraceRecord;
+
+/**
+ * @brief Caller-owned trace ring over caller provided record storage.
+ *
+ * `head` and `tail` are free-running record counters masked on access, so the number of
+ * records must be a power of two.
+ */
+struct XBeeTrace {
+    XBeeTraceRecord *records;     ///< Ring storage
+    uint16_t mask;                ///< Number of records - 1
+    volatile uint32_t head;       ///< Records written, advanced by the writer only
+    uint32_t tail;                ///< Records read, advanced by the reader only
+    uint32_t lost;                ///< Records overwritten before they were read
+};
+
+#if XBEE_TRACE_ENABLED
+#define XBEETraceEvent(self, event, frameType, frameId, status, arg1, arg2) \
+    do { \
+        if ((self)->trace != NULL) { \
+            XBeeTraceWrite((self), (event), (frameType), (frameId), (status), (arg1), (arg2)); \
+        } \
+    } while (0)
+#else
+#define XBEETraceEvent(self, event, frameType, frameId, status, arg1, arg2) do { } while (0)
+#endif
+
+bool XBeeTraceInit(XBeeTrace* trace, XBeeTraceRecord* records, uint16_t count);
+bool XBeeAttachTrace(XBee* self, XBeeTrace* trace);
+void XBeeTraceWrite(XBee* self, uint8_t event, uint8_t frameType, uint8_t frameId, uint8_t status, uint16_t arg1, uint32_t arg2);
+uint16_t XBeeTraceRead(XBeeTrace* trace, XBeeTraceRecord* records, uint16_t maxRecords);
+void XBeeTraceClear(XBeeTrace* trace);
+void XBeeTraceEncode(const XBeeTraceRecord* record, uint8_t* out);
+void XBeeTraceDecode(const uint8_t* in, XBeeTraceRecord* record);
+int XBeeTraceFormat(const XBeeTraceRecord* record, char* buffer, size_t size);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // XBEE_TRACE_H